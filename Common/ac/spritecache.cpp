@@ -13,6 +13,11 @@
 //=============================================================================
 #include "core/platform.h"
 #include "ac/spritecache.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "ac/gamestructdefines.h"
 #include "debug/out.h"
 #include "gfx/bitmap.h"
@@ -30,6 +35,8 @@ using namespace AGS::Common;
 #define SPRCACHEFLAG_ERROR          0x04
 // Locked sprites are ones that should not be freed when out of cache space.
 #define SPRCACHEFLAG_LOCKED         0x08
+// Tells that the sprite is requested for the asynchronous loading.
+#define SPRCACHEFLAG_ASYNCLOAD      0x10
 
 // High-verbosity sprite cache log
 #if DEBUG_SPRITECACHE
@@ -44,9 +51,25 @@ namespace AGS
 namespace Common
 {
 
+struct SpriteCache::AsyncLoader
+{
+    // Guards reading from the sprite file
+    std::mutex FileMutex;
+    std::vector<std::thread> Threads;
+    // Guards the request and result lists, and the thread stop flag
+    std::mutex Mutex;
+    std::condition_variable RequestCV; // signals new requests or stop
+    std::condition_variable ResultCV; // signals new results
+    std::deque<sprkey_t> Requests; // requests not taken by workers yet
+    std::vector<AsyncLoadResult> Results; // results not collected yet
+    size_t Running = 0u; // number of loads in progress
+    bool Stop = false;
+};
+
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks)
     : ResourceCache(DEFAULTCACHESIZE_KB * 1024u)
     , _sprInfos(sprInfos)
+    , _async(new AsyncLoader())
 {
     _callbacks.AdjustSize = (callbacks.AdjustSize) ? callbacks.AdjustSize : DummyAdjustSize;
     _callbacks.InitSprite = (callbacks.InitSprite) ? callbacks.InitSprite : DummyInitSprite;
@@ -57,6 +80,13 @@ SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &cal
     _placeholder.reset(BitmapHelper::CreateTransparentBitmap(1, 1));
 }
 
+SpriteCache::~SpriteCache()
+{
+    SetAsyncLoadThreads(0);
+    // Dispose sprites before the file mapping they may reference
+    ResourceCache::Clear();
+}
+
 size_t SpriteCache::GetSpriteSlotCount() const
 {
     return _spriteData.size();
@@ -87,8 +117,10 @@ bool SpriteCache::IsAssetUnloaded(sprkey_t index) const
 
 void SpriteCache::Reset()
 {
+    CancelAsyncLoads();
     _file.Close();
     ResourceCache::Clear();
+    _mappedFile.reset(); // only after the sprites are disposed
     _spriteData.clear();
 }
 
@@ -208,6 +240,11 @@ bool SpriteCache::SpriteData::IsLocked() const
     return (Flags & SPRCACHEFLAG_LOCKED) != 0;
 }
 
+bool SpriteCache::SpriteData::IsAsyncLoading() const
+{
+    return (Flags & SPRCACHEFLAG_ASYNCLOAD) != 0;
+}
+
 bool SpriteCache::DoesSpriteExist(sprkey_t index) const
 {
     return (index >= 0 && (size_t)index < _spriteData.size()) && // in the valid range
@@ -240,6 +277,21 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
     return _placeholder.get();
 }
 
+Bitmap *SpriteCache::GetSpriteForWriting(sprkey_t index)
+{
+    Bitmap *image = (*this)[index];
+    if (!image->IsReadOnly())
+        return image;
+    // The pixels are in the read-only file mapping, replace with a copy;
+    // the copy has the same size, and keeps the sprite's locked state
+    std::unique_ptr<Bitmap> copy(BitmapHelper::CreateBitmapCopy(image));
+    image = copy.get();
+    const bool locked = _spriteData[index].IsLocked();
+    ResourceCache::Put(index, std::move(copy), kCacheItem_Locked * locked);
+    SprCacheLog("Copied mapped sprite %d for writing", index);
+    return image;
+}
+
 void SpriteCache::DisposeCached(sprkey_t index)
 {
     if (IsAssetSprite(index))
@@ -267,6 +319,162 @@ void SpriteCache::PrecacheSprite(sprkey_t index)
     SprCacheLog("Precached %d", index);
 }
 
+bool SpriteCache::PrecacheSpriteAsync(sprkey_t index)
+{
+    assert(index >= 0); // out of positive range indexes are valid to fail
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return false;
+    if (!_spriteData[index].IsAssetSprite() || _spriteData[index].IsError())
+        return false; // cannot precache a non-asset sprite
+    if (_spriteData[index].IsAsyncLoading() || ResourceCache::Exists(index))
+        return false; // already requested, or loaded
+
+    if (_async->Threads.empty())
+    {
+        LoadSprite(index);
+        return true;
+    }
+
+    _spriteData[index].Flags |= SPRCACHEFLAG_ASYNCLOAD;
+    _asyncPending++;
+    {
+        std::lock_guard<std::mutex> lk(_async->Mutex);
+        _async->Requests.push_back(index);
+    }
+    _async->RequestCV.notify_one();
+    SprCacheLog("Requested async load %d", index);
+    return true;
+}
+
+void SpriteCache::SetAsyncLoadThreads(size_t count)
+{
+#if defined(AGS_DISABLE_THREADS)
+    count = 0u;
+#endif
+    if (count == _async->Threads.size())
+        return;
+
+    // Stop all the current threads, and start a new set
+    CancelAsyncLoads();
+    {
+        std::lock_guard<std::mutex> lk(_async->Mutex);
+        _async->Stop = true;
+    }
+    _async->RequestCV.notify_all();
+    for (auto &thread : _async->Threads)
+        thread.join();
+    _async->Threads.clear();
+    _async->Stop = false;
+
+    for (size_t i = 0; i < count; ++i)
+        _async->Threads.emplace_back(&SpriteCache::AsyncLoadThread, this);
+}
+
+void SpriteCache::CollectAsyncLoads()
+{
+    if (_asyncPending == 0u)
+        return;
+    // NOTE: take the results out, because initializing a sprite runs
+    // user callbacks, which may access other sprites and collect again
+    std::vector<AsyncLoadResult> results;
+    {
+        std::lock_guard<std::mutex> lk(_async->Mutex);
+        if (_async->Results.empty())
+            return;
+        results.swap(_async->Results);
+    }
+
+    _asyncPending -= results.size();
+    for (auto &result : results)
+    {
+        const sprkey_t index = result.Index;
+        // The request could have been cancelled, or the sprite replaced
+        // or loaded while the request was in progress
+        if (!_spriteData[index].IsAsyncLoading())
+            continue;
+        _spriteData[index].Flags &= ~SPRCACHEFLAG_ASYNCLOAD;
+        if (!_spriteData[index].IsAssetSprite() || _spriteData[index].IsError() ||
+            ResourceCache::Exists(index))
+            continue;
+        InitLoadedSprite(index, result.Image.release(), result.Err, false);
+    }
+}
+
+bool SpriteCache::WaitAsyncLoad(sprkey_t index)
+{
+    {
+        std::unique_lock<std::mutex> lk(_async->Mutex);
+        // If the loading was not started yet, then cancel the request
+        auto it = std::find(_async->Requests.begin(), _async->Requests.end(), index);
+        if (it != _async->Requests.end())
+        {
+            _async->Requests.erase(it);
+            _spriteData[index].Flags &= ~SPRCACHEFLAG_ASYNCLOAD;
+            _asyncPending--;
+            return false;
+        }
+        // Otherwise wait for the result
+        _async->ResultCV.wait(lk, [this, index]() {
+            return std::find_if(_async->Results.begin(), _async->Results.end(),
+                [index](const AsyncLoadResult &r) { return r.Index == index; }) != _async->Results.end(); });
+    }
+    CollectAsyncLoads();
+    return true;
+}
+
+void SpriteCache::CancelAsyncLoads()
+{
+    if (_asyncPending == 0u)
+        return;
+    std::unique_lock<std::mutex> lk(_async->Mutex);
+    for (const auto index : _async->Requests)
+        _spriteData[index].Flags &= ~SPRCACHEFLAG_ASYNCLOAD;
+    _async->Requests.clear();
+    _async->ResultCV.wait(lk, [this]() { return _async->Running == 0u; });
+    for (const auto &result : _async->Results)
+        _spriteData[result.Index].Flags &= ~SPRCACHEFLAG_ASYNCLOAD;
+    _async->Results.clear();
+    _asyncPending = 0u;
+}
+
+void SpriteCache::AsyncLoadThread()
+{
+    std::vector<uint8_t> data;
+    std::unique_lock<std::mutex> lk(_async->Mutex);
+    for (;;)
+    {
+        _async->RequestCV.wait(lk, [this]() { return _async->Stop || !_async->Requests.empty(); });
+        if (_async->Stop)
+            return;
+        AsyncLoadResult result;
+        result.Index = _async->Requests.front();
+        _async->Requests.pop_front();
+        _async->Running++;
+        lk.unlock();
+
+        // Mapped sprites do not need reading at all; otherwise only reading
+        // the data has to be serialized, decompression may run in parallel
+        // with the other threads
+        Bitmap *image = nullptr;
+        if (!_file.LoadMappedSprite(result.Index, image))
+        {
+            SpriteDatHeader hdr;
+            {
+                std::lock_guard<std::mutex> file_lk(_async->FileMutex);
+                result.Err = _file.LoadRawData(result.Index, hdr, data);
+            }
+            if (result.Err)
+                result.Err = _file.LoadSpriteFromRawData(result.Index, hdr, data, image);
+        }
+        result.Image.reset(image);
+
+        lk.lock();
+        _async->Results.push_back(std::move(result));
+        _async->Running--;
+        _async->ResultCV.notify_all();
+    }
+}
+
 std::unique_ptr<Bitmap> SpriteCache::LoadSpriteNoCache(sprkey_t index)
 {
     // invalid sprite slot
@@ -337,8 +545,35 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index, bool lock)
         return nullptr;
     assert((_spriteData[index].Flags & SPRCACHEFLAG_ISASSET) != 0);
 
+    // If the sprite is being loaded in background, then take that result
+    if (_spriteData[index].IsAsyncLoading() && WaitAsyncLoad(index))
+    {
+        if (_spriteData[index].IsError())
+            return nullptr; // failed to load
+        // NOTE: the sprite could be already disposed, if the other sprites
+        // collected along with it did not fit into the cache
+        if (ResourceCache::Exists(index))
+        {
+            if (lock)
+            {
+                ResourceCache::Lock(index);
+                _spriteData[index].Flags |= SPRCACHEFLAG_LOCKED;
+            }
+            return ResourceCache::Peek(index).get();
+        }
+    }
+
     Bitmap *image{};
-    HError err = _file.LoadSprite(index, image);
+    HError err;
+    {
+        std::lock_guard<std::mutex> lk(_async->FileMutex);
+        err = _file.LoadSprite(index, image);
+    }
+    return InitLoadedSprite(index, image, err, lock);
+}
+
+Bitmap *SpriteCache::InitLoadedSprite(sprkey_t index, Bitmap *image, const HError &err, bool lock)
+{
     if (!image)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
@@ -392,24 +627,26 @@ void SpriteCache::InitNullSprite(sprkey_t index)
     _spriteData[index] = SpriteData();
 }
 
-int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index)
+int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompression compress,
+    SpriteFileIndex &index, int threads)
 {
     // Gather a list of sprites;
     // the list contains pairs, where first element tells whether the sprites
     // exists at all (either have a ready image, or found in a input file).
     // SaveSpriteFile will either use a ready image or load missing images
     // before saving to the destination.
+    CancelAsyncLoads();
     std::vector<std::pair<bool, Bitmap*>> sprites;
     for (size_t i = 0; i < _spriteData.size(); ++i)
     {
-        auto &image = ResourceCache::Get(i);
+        auto &image = ResourceCache::Peek(i);
         if (image) // optionally convert a sprite's pixel data for the saving
             _callbacks.PrewriteSprite(image.get());
         sprites.push_back(std::make_pair(
             (image || _spriteData[i].IsAssetSprite()),
             image.get()));
     }
-    return SaveSpriteFile(filename, sprites, &_file, store_flags, compress, index);
+    return SaveSpriteFile(filename, sprites, &_file, store_flags, compress, index, threads);
 }
 
 HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
@@ -447,8 +684,18 @@ HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
 
 void SpriteCache::DetachFile()
 {
+    CancelAsyncLoads();
     _file.Close();
 }
 
+bool SpriteCache::MapFile(const String &filename, soff_t offset, soff_t size)
+{
+    CancelAsyncLoads();
+    if (!_file.MapFile(filename, offset, size))
+        return false;
+    _mappedFile = _file.GetMapping();
+    return true;
+}
+
 } // namespace Common
 } // namespace AGS
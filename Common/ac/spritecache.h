@@ -17,6 +17,18 @@
 // SpriteCache provides bitmaps by demand; it uses SpriteFile to load sprites
 // and does MRU (most-recent-use) caching.
 //
+// Sprites may also be requested to load asynchronously: a pool of worker
+// threads reads and decompresses them in background, and the ready bitmaps
+// are added to the cache on the owner's thread, either when the owner
+// collects them, or when it requests one of them. The caller only has to
+// wait if it needs a sprite which is being loaded right now.
+//
+// The uncompressed sprite file may be memory-mapped, in which case the
+// uncompressed sprites are created as bitmaps referencing the mapped pixels.
+// Such sprites are loaded instantly, and do not take any memory of their own
+// until modified, so disposing them from cache is cheap: the system's file
+// cache acts as a second-level sprite cache.
+//
 // TODO: refactor engine code to allow store and return shared_ptr<Bitmap>.
 //
 // TODO: currently inherits ResourceCache<Bitmap> as protected, because sprites
@@ -83,15 +95,21 @@ public:
 
 
     SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks);
-    ~SpriteCache() = default;
+    ~SpriteCache();
 
     // Loads sprite reference information and inits sprite stream
     HError      InitFile(std::unique_ptr<Stream> &&sprite_file,
                          std::unique_ptr<Stream> &&index_file);
-    // Saves current cache contents to the file
-    int         SaveToFile(const String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index);
-    // Closes an active sprite file stream
+    // Saves current cache contents to the file;
+    // optionally uses the given number of threads for compressing sprites
+    int         SaveToFile(const String &filename, int store_flags, SpriteCompression compress,
+                           SpriteFileIndex &index, int threads = 0);
+    // Closes an active sprite file stream;
+    // a file mapping (if any) is kept until the cache is reset
     void        DetachFile();
+    // Maps the sprite file into memory, see SpriteFile::MapFile();
+    // the file region must correspond to the opened sprite stream
+    bool        MapFile(const String &filename, soff_t offset, soff_t size);
 
     inline int GetStoreFlags() const { return _file.GetStoreFlags(); }
     inline SpriteCompression GetSpriteCompression() const { return _file.GetSpriteCompression(); }
@@ -114,6 +132,8 @@ public:
     inline size_t GetExternalSize() const { return ResourceCache::GetExternalSize(); }
     // Returns maximal size limit of the cache, in bytes; this includes locked size too!
     inline size_t GetMaxCacheSize() const { return ResourceCache::GetMaxCacheSize(); }
+    // Returns the cache's hit, miss and eviction statistics
+    inline const ResourceCacheStats &GetCacheStats() const { return ResourceCache::GetStats(); }
     // Returns number of sprite slots in the bank (this includes both actual sprites and free slots)
     size_t      GetSpriteSlotCount() const;
     // Tells if the sprite storage still has unoccupied slots to put new sprites in
@@ -131,6 +151,19 @@ public:
     // Loads sprite using SpriteFile if such index is known,
     // frees the space if cache size reaches the limit
     void        PrecacheSprite(sprkey_t index);
+    // Requests to load the sprite in background, if it's not loaded yet;
+    // does not wait for the result. Loads the sprite immediately if the
+    // asynchronous loading is disabled. Returns whether a new load was
+    // started, false if the sprite is loaded, requested already, or invalid.
+    bool        PrecacheSpriteAsync(sprkey_t index);
+    // Sets the number of worker threads for the asynchronous loading;
+    // 0 disables asynchronous loading
+    void        SetAsyncLoadThreads(size_t count);
+    // Gets the number of sprites requested for asynchronous loading,
+    // which were not added to the cache yet
+    size_t      GetAsyncLoadsPending() const { return _asyncPending; }
+    // Adds the sprites loaded in background to the cache
+    void        CollectAsyncLoads();
     // Loads the sprite if necessary and returns a *copy* of bitmap, passing
     // ownership to the caller. Skips storing the sprite in the cache
     // (unless it was already there).
@@ -173,9 +206,16 @@ public:
     void        SetEmptySprite(sprkey_t index, bool as_asset);
     // Sets max cache size in bytes
     inline void SetMaxCacheSize(size_t size) { ResourceCache::SetMaxCacheSize(size); }
+    // Sets the policy which chooses the sprites to dispose when the cache is full
+    inline void SetCachePolicy(CachePolicyType type) { ResourceCache::SetPolicy(type); }
 
     // Loads (if it's not in cache yet) and returns bitmap by the sprite index
     Bitmap *operator[] (sprkey_t index);
+    // Same as operator[], but guarantees that the returned bitmap's pixels
+    // may be modified: a sprite referencing the mapped file is replaced by
+    // its own copy in cache. Use this when the sprite is passed to the code
+    // which may draw on it (e.g. plugins).
+    Bitmap *GetSpriteForWriting(sprkey_t index);
 
 protected:
     // Calculates item size; expects to return 0 if an item is invalid
@@ -185,6 +225,16 @@ protected:
 private:
     // Load sprite from game resource and put into the cache
     Bitmap *    LoadSprite(sprkey_t index, bool lock = false);
+    // Initializes the loaded sprite and puts into the cache
+    Bitmap *    InitLoadedSprite(sprkey_t index, Bitmap *image, const HError &err, bool lock);
+    // Waits for the sprite requested for asynchronous loading, and collects it;
+    // returns false if the sprite's loading was not started yet, in which case
+    // the request is cancelled
+    bool        WaitAsyncLoad(sprkey_t index);
+    // Cancels all asynchronous loading requests, waits for the running ones to finish
+    void        CancelAsyncLoads();
+    // Asynchronous loader's thread function
+    void        AsyncLoadThread();
     // Remap the given index to the sprite 0
     void        RemapSpriteToPlaceholder(sprkey_t index);
     // Initialize the empty sprite slot
@@ -215,6 +265,16 @@ private:
         bool IsExternalSprite() const;
         // Tells if sprite is locked and should not be disposed by cache logic
         bool IsLocked() const;
+        // Tells if sprite is requested for the asynchronous loading
+        bool IsAsyncLoading() const;
+    };
+
+    // Result of the asynchronous loading
+    struct AsyncLoadResult
+    {
+        sprkey_t Index = 0;
+        std::unique_ptr<Bitmap> Image;
+        HError Err;
     };
 
     // Provided map of sprite infos, to fill in loaded sprite properties
@@ -226,6 +286,15 @@ private:
 
     Callbacks  _callbacks;
     SpriteFile _file;
+    // Keeps the file mapping, for as long as cached sprites may reference it
+    std::shared_ptr<MappedFile> _mappedFile;
+
+    // Asynchronous loader's threads and synchronization; these are hidden
+    // from the header, because the threading headers cannot be used in the
+    // managed code, which includes this header (Editor)
+    struct AsyncLoader;
+    std::unique_ptr<AsyncLoader> _async;
+    size_t _asyncPending = 0u; // number of requested sprites not in cache yet
 };
 
 } // namespace Common
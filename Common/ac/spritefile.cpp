@@ -11,14 +11,20 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include "core/platform.h"
 #include "ac/spritefile.h"
 #include <algorithm>
 #include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <time.h>
 #include "core/assetmanager.h"
 #include "gfx/bitmap.h"
 #include "util/compress.h"
 #include "util/file.h"
+#include "util/mappedfile.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 
@@ -250,6 +256,7 @@ HError SpriteFile::OpenFile(std::unique_ptr<Stream> &&sprite_file,
 void SpriteFile::Close()
 {
     _stream.reset();
+    _mapping.reset();
     _spriteData.clear();
     _version = kSprfVersion_Undefined;
     _storeFlags = 0;
@@ -257,6 +264,28 @@ void SpriteFile::Close()
     _curPos = -2;
 }
 
+bool SpriteFile::MapFile(const String &filename, soff_t offset, soff_t size)
+{
+    _mapping.reset();
+    // Only uncompressed sprites may be referenced directly, and only if
+    // their pixel data is stored in the native byte order; LZ4 is fast
+    // enough to decompress the mapped sprites on demand
+#if AGS_PLATFORM_ENDIAN_BIG
+    return false;
+#else
+    if (!_stream || ((_compress != kSprCompress_None) && (_compress != kSprCompress_LZ4)) ||
+        !MappedFile::IsSupported())
+        return false;
+    if (size != _stream->GetLength())
+        return false; // does not match the opened stream
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->Open(filename, offset, size))
+        return false;
+    _mapping = mapping;
+    return true;
+#endif
+}
+
 int SpriteFile::GetStoreFlags() const
 {
     return _storeFlags;
@@ -383,22 +412,11 @@ HError SpriteFile::RebuildSpriteIndex(Stream *in, sprkey_t topmost, std::vector<
     return HError::None();
 }
 
-HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
+// Reads the sprite's pixel data following its header, and creates a ready bitmap;
+// has_data_size tells whether the data is prefixed with its size in the stream
+static HError ReadSpriteData(Stream *in, sprkey_t index, const SpriteDatHeader &hdr,
+    bool has_data_size, Bitmap *&sprite)
 {
-    sprite = nullptr;
-    if (index < 0 || (size_t)index >= _spriteData.size())
-        return new Error(String::FromFormat("LoadSprite: slot index %d out of bounds (%d - %d).",
-            index, 0, _spriteData.size() - 1));
-
-    if (_spriteData[index].Offset == 0)
-        return HError::None(); // sprite is not in file
-
-    SeekToSprite(index);
-    _curPos = -2; // mark undefined pos
-
-    SpriteDatHeader hdr;
-    ReadSprHeader(hdr, _stream.get(), _version, _compress);
-    if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
     int bpp = hdr.BPP, w = hdr.Width, h = hdr.Height;
     std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(w, h, bpp * 8));
     if (image == nullptr)
@@ -415,9 +433,9 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     { // read palette if format assumes one
         switch (pal_bpp)
         {
-        case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = _stream->ReadInt16(); }
+        case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = in->ReadInt16(); }
             break;
-        case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = _stream->ReadInt32(); }
+        case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = in->ReadInt32(); }
             break;
         default: assert(0); break;
         }
@@ -425,9 +443,7 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
         im_data = ImBufferPtr(&indexed_buf[0], indexed_buf.size(), 1);
     }
     // (Optional) Decompress the image data into the temp buffer
-    size_t in_data_size =
-        ((_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None) ?
-        (uint32_t)_stream->ReadInt32() : (w * h * bpp);
+    size_t in_data_size = has_data_size ? (uint32_t)in->ReadInt32() : (w * h * bpp);
     if (hdr.Compress != kSprCompress_None)
     {
         // TODO: rewrite this to only make a choice once the SpriteFile is initialized
@@ -439,11 +455,13 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
         bool result;
         switch (hdr.Compress)
         {
-        case kSprCompress_RLE: result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get());
+        case kSprCompress_RLE: result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, in);
+            break;
+        case kSprCompress_LZW: result = lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
             break;
-        case kSprCompress_LZW: result = lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get(), in_data_size);
+        case kSprCompress_Deflate: result = inflate_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
             break;
-        case kSprCompress_Deflate: result = inflate_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get(), in_data_size);
+        case kSprCompress_LZ4: result = lz4_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
             break;
         default: assert(!"Unsupported compression type!"); result = false; break;
         }
@@ -458,12 +476,12 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     {
         switch (im_data.BPP)
         {
-        case 1: _stream->Read(im_data.Buf, im_data.Size);
+        case 1: in->Read(im_data.Buf, im_data.Size);
             break;
-        case 2: _stream->ReadArrayOfInt16(
+        case 2: in->ReadArrayOfInt16(
                 reinterpret_cast<int16_t*>(im_data.Buf), im_data.Size / sizeof(int16_t));
             break;
-        case 4: _stream->ReadArrayOfInt32(
+        case 4: in->ReadArrayOfInt32(
                 reinterpret_cast<int32_t*>(im_data.Buf), im_data.Size / sizeof(int32_t));
             break;
         default: assert(0); break;
@@ -476,10 +494,94 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     }
 
     sprite = image.release(); // FIXME: pass unique_ptr in this function
+    return HError::None();
+}
+
+HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
+{
+    sprite = nullptr;
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return new Error(String::FromFormat("LoadSprite: slot index %d out of bounds (%d - %d).",
+            index, 0, _spriteData.size() - 1));
+
+    if (_spriteData[index].Offset == 0)
+        return HError::None(); // sprite is not in file
+    if (LoadMappedSprite(index, sprite))
+        return HError::None();
+
+    SeekToSprite(index);
+    _curPos = -2; // mark undefined pos
+
+    SpriteDatHeader hdr;
+    ReadSprHeader(hdr, _stream.get(), _version, _compress);
+    if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
+    HError err = ReadSpriteData(_stream.get(), index, hdr,
+        (_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None, sprite);
+    if (!err)
+        return err;
     _curPos = index + 1; // mark correct pos
     return HError::None();
 }
 
+bool SpriteFile::LoadMappedSprite(sprkey_t index, Bitmap *&sprite) const
+{
+    sprite = nullptr;
+    if (!_mapping || index < 0 || (size_t)index >= _spriteData.size())
+        return false;
+    const soff_t offset = _spriteData[index].Offset;
+    if (offset <= 0 || (uint64_t)offset >= _mapping->GetSize())
+        return false;
+
+    const uint8_t *data = _mapping->GetData() + offset;
+    const size_t data_size = _mapping->GetSize() - static_cast<size_t>(offset);
+    Stream in(std::make_unique<MemoryStream>(data, data_size));
+    SpriteDatHeader hdr;
+    ReadSprHeader(hdr, &in, _version, _compress);
+    if (hdr.BPP == 0) return true; // empty slot, this is normal
+    // Only the plain pixel arrays may be used as-is
+    if (((hdr.Compress != kSprCompress_None) && (hdr.Compress != kSprCompress_LZ4)) ||
+        (hdr.SFormat != kSprFmt_Undefined) ||
+        (hdr.BPP != 1 && hdr.BPP != 2 && hdr.BPP != 4) || (hdr.Width <= 0) || (hdr.Height <= 0))
+        return false;
+    const size_t px_size = hdr.Width * hdr.Height * hdr.BPP;
+    if (hdr.Compress == kSprCompress_LZ4)
+    {
+        // LZ4 sprites are decompressed from the mapped data into a new bitmap
+        const size_t in_size = (uint32_t)in.ReadInt32();
+        const size_t in_offset = static_cast<size_t>(in.GetPosition());
+        if (in_offset + in_size > data_size)
+            return false;
+        std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(hdr.Width, hdr.Height, hdr.BPP * 8));
+        if (!image)
+            return false;
+        if (!lz4_decompress(image->GetDataForWriting(), px_size, data + in_offset, in_size))
+            return false;
+        sprite = image.release();
+        return true;
+    }
+    if ((_version >= kSprfVersion_StorageFormats) && ((uint32_t)in.ReadInt32() != px_size))
+        return false;
+    const size_t px_offset = static_cast<size_t>(in.GetPosition());
+    if (px_offset + px_size > data_size)
+        return false;
+    // Pixels must be aligned to the pixel size, as the drawing code expects
+    if ((reinterpret_cast<uintptr_t>(data + px_offset) % hdr.BPP) != 0)
+        return false;
+    sprite = BitmapHelper::CreateBitmapReference(hdr.Width, hdr.Height, hdr.BPP * 8,
+        data + px_offset, data_size - px_offset);
+    return sprite != nullptr;
+}
+
+HError SpriteFile::LoadSpriteFromRawData(sprkey_t index, const SpriteDatHeader &hdr,
+    const std::vector<uint8_t> &data, Bitmap *&sprite) const
+{
+    sprite = nullptr;
+    if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
+    Stream in(std::make_unique<MemoryStream>(data.data(), data.size()));
+    return ReadSpriteData(&in, index, hdr,
+        (_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None, sprite);
+}
+
 HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data)
 {
     hdr = SpriteDatHeader();
@@ -540,7 +642,8 @@ static sprkey_t FindTopmostSprite(const std::vector<std::pair<bool, Bitmap*>> &s
 int SaveSpriteFile(const String &save_to_file,
     const std::vector<std::pair<bool, Bitmap*>> &sprites,
     SpriteFile *read_from_file,
-    int store_flags, SpriteCompression compress, SpriteFileIndex &index)
+    int store_flags, SpriteCompression compress, SpriteFileIndex &index,
+    int threads)
 {
     std::unique_ptr<Stream> output(File::CreateFile(save_to_file));
     if (output == nullptr)
@@ -548,6 +651,7 @@ int SaveSpriteFile(const String &save_to_file,
 
     sprkey_t lastslot = FindTopmostSprite(sprites);
     SpriteFileWriter writer(std::move(output));
+    writer.SetThreads(threads);
     writer.Begin(store_flags, compress, lastslot);
 
     std::unique_ptr<Bitmap> temp_bmp; // for disposing temp sprites
@@ -630,6 +734,118 @@ int SaveSpriteIndex(const String &filename, const SpriteFileIndex &index)
 }
 
 
+// Max number of the queued sprites per worker thread; limits the memory
+// taken by the copies of the bitmaps waiting to be processed and written
+static const size_t MaxJobsPerThread = 4;
+
+struct SpriteFileWriter::WriteJob
+{
+    enum JobType
+    {
+        kJob_Bitmap,
+        kJob_EmptySlot,
+        kJob_RawData
+    };
+
+    JobType Type;
+    bool Done = false; // the data is ready for writing
+    std::unique_ptr<Bitmap> Image; // a copy of the bitmap to write
+    SpriteDatHeader Hdr;
+    uint32_t Palette[256];
+    std::vector<uint8_t> IndexedBuf; // indexed bitmap data
+    std::vector<uint8_t> Data; // compressed bitmap data, or raw data
+    ImBufferCPtr ImData; // final image data, references one of the above
+
+    WriteJob(JobType type) : Type(type) {}
+};
+
+struct SpriteFileWriter::WriteQueue
+{
+    std::vector<std::thread> Threads;
+    std::mutex Mutex;
+    std::condition_variable WorkCV; // signals new work or stop to the workers
+    std::condition_variable DoneCV; // signals finished jobs to the writer
+    bool Stop = false;
+    // Sprites in the order of writing; jobs are removed from the head
+    // as soon as they are finished and written to the output
+    std::deque<std::unique_ptr<WriteJob>> Jobs;
+    // Jobs waiting for a worker thread
+    std::deque<WriteJob*> WorkQueue;
+};
+
+
+// Prepares the bitmap's data for writing, applying the storage options and
+// compression; the resulting im_data references either the bitmap's pixels,
+// or one of the provided buffers
+static void PrepareBitmapData(const Bitmap *image, int store_flags, SpriteCompression file_compress,
+    std::vector<uint8_t> &indexed_buf, std::vector<uint8_t> &comp_buf,
+    SpriteDatHeader &hdr, uint32_t palette[256], ImBufferCPtr &im_data)
+{
+    int bpp = image->GetBPP();
+    int w = image->GetWidth();
+    int h = image->GetHeight();
+    im_data = ImBufferCPtr(image->GetData(), w * h * bpp, bpp);
+
+    // (Optional) Handle storage options
+    uint32_t pal_count = 0;
+    SpriteFormat sformat = kSprFmt_Undefined;
+    if ((store_flags & kSprStore_OptimizeForSize) != 0 && (image->GetBPP() > 1))
+    { // Try to store this sprite as an indexed bitmap
+        uint32_t gen_pal_count;
+        if (CreateIndexedBitmap(image, indexed_buf, palette, gen_pal_count) && gen_pal_count > 0)
+        { // Test the resulting size, and switch if the paletted image is less
+            if (im_data.Size > (indexed_buf.size() + gen_pal_count * image->GetBPP()))
+            {
+                im_data = ImBufferCPtr(&indexed_buf[0], indexed_buf.size(), 1);
+                sformat = PaletteFormatForBPP(image->GetBPP());
+                pal_count = gen_pal_count;
+            }
+        }
+    }
+    // (Optional) Compress the image data into the temp buffer
+    SpriteCompression compress = kSprCompress_None;
+    if (file_compress != kSprCompress_None)
+    {
+        // TODO: rewrite this to only make a choice once the SpriteFile is initialized
+        // and use either function ptr or a decompressing stream class object
+        compress = file_compress;
+        Stream mems(std::make_unique<VectorStream>(comp_buf, kStream_Write));
+        bool result;
+        switch (compress)
+        {
+        case kSprCompress_RLE: result = rle_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+            break;
+        case kSprCompress_LZW: result = lzw_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+            break;
+        case kSprCompress_Deflate: result = deflate_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+            break;
+        case kSprCompress_LZ4: result = lz4_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems, im_data.Size / h);
+            break;
+        default: assert(!"Unsupported compression type!"); result = false; break;
+        }
+        // mark to write as a plain byte array
+        im_data = result ? ImBufferCPtr(&comp_buf[0], comp_buf.size(), 1) : ImBufferCPtr();
+    }
+
+    hdr = SpriteDatHeader(bpp, sformat, pal_count, compress, w, h);
+}
+
+
+SpriteFileWriter::SpriteFileWriter(std::unique_ptr<Stream> &&out)
+    : _out(std::move(out))
+{
+}
+
+SpriteFileWriter::~SpriteFileWriter()
+{
+    StopThreads();
+}
+
+void SpriteFileWriter::SetThreads(int count)
+{
+    _numThreads = std::max(0, count);
+}
+
 void SpriteFileWriter::Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot)
 {
     if (!_out) return;
@@ -661,61 +877,120 @@ void SpriteFileWriter::Begin(int store_flags, SpriteCompression compress, sprkey
         _index.Widths.reserve(numsprits);
         _index.Heights.reserve(numsprits);
     }
+
+    if (_numThreads > 0)
+    {
+        _queue.reset(new WriteQueue());
+        for (int i = 0; i < _numThreads; ++i)
+            _queue->Threads.emplace_back(&SpriteFileWriter::WorkerThread, this);
+    }
 }
 
 void SpriteFileWriter::WriteBitmap(const Bitmap *image)
 {
     if (!_out) return;
-    int bpp = image->GetBPP();
-    int w = image->GetWidth();
-    int h = image->GetHeight();
-    ImBufferCPtr im_data(image->GetData(), w * h * bpp, bpp);
+    if (_queue)
+    {
+        std::unique_ptr<WriteJob> job(new WriteJob(WriteJob::kJob_Bitmap));
+        job->Image.reset(BitmapHelper::CreateBitmapCopy(image));
+        if (job->Image)
+        {
+            QueueJob(std::move(job), true);
+            return;
+        }
+        // failed to copy, write everything queued, and continue on this thread
+        WriteFinishedJobs(0);
+    }
 
-    // (Optional) Handle storage options
     std::vector<uint8_t> indexed_buf;
     uint32_t palette[256];
-    uint32_t pal_count = 0;
-    SpriteFormat sformat = kSprFmt_Undefined;
-    if ((_storeFlags & kSprStore_OptimizeForSize) != 0 && (image->GetBPP() > 1))
-    { // Try to store this sprite as an indexed bitmap
-        uint32_t gen_pal_count;
-        if (CreateIndexedBitmap(image, indexed_buf, palette, gen_pal_count) && gen_pal_count > 0)
-        { // Test the resulting size, and switch if the paletted image is less
-            if (im_data.Size > (indexed_buf.size() + gen_pal_count * image->GetBPP()))
-            {
-                im_data = ImBufferCPtr(&indexed_buf[0], indexed_buf.size(), 1);
-                sformat = PaletteFormatForBPP(image->GetBPP());
-                pal_count = gen_pal_count;
-            }
-        }
+    SpriteDatHeader hdr;
+    ImBufferCPtr im_data;
+    PrepareBitmapData(image, _storeFlags, _compress, indexed_buf, _membuf, hdr, palette, im_data);
+    // Write the final data
+    WriteSpriteData(hdr, im_data.Buf, im_data.Size, im_data.BPP, palette);
+    _membuf.clear();
+}
+
+void SpriteFileWriter::QueueJob(std::unique_ptr<WriteJob> &&job, bool needs_work)
+{
+    {
+        std::lock_guard<std::mutex> lk(_queue->Mutex);
+        if (needs_work)
+            _queue->WorkQueue.push_back(job.get());
+        else
+            job->Done = true;
+        _queue->Jobs.push_back(std::move(job));
     }
-    // (Optional) Compress the image data into the temp buffer
-    SpriteCompression compress = kSprCompress_None;
-    if (_compress != kSprCompress_None)
+    if (needs_work)
+        _queue->WorkCV.notify_one();
+    WriteFinishedJobs(_queue->Threads.size() * MaxJobsPerThread);
+}
+
+void SpriteFileWriter::WriteFinishedJobs(size_t max_pending)
+{
+    for (;;)
     {
-        // TODO: rewrite this to only make a choice once the SpriteFile is initialized
-        // and use either function ptr or a decompressing stream class object
-        compress = _compress;
-        Stream mems(std::make_unique<VectorStream>(_membuf, kStream_Write));
-        bool result;
-        switch (compress)
+        std::unique_ptr<WriteJob> job;
         {
-        case kSprCompress_RLE: result = rle_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+            std::unique_lock<std::mutex> lk(_queue->Mutex);
+            // Sprites must be written strictly in order, so wait for the
+            // first one in queue, if there's too many pending
+            if (_queue->Jobs.size() > max_pending)
+                _queue->DoneCV.wait(lk, [this]() { return _queue->Jobs.front()->Done; });
+            else if (_queue->Jobs.empty() || !_queue->Jobs.front()->Done)
+                return;
+            job = std::move(_queue->Jobs.front());
+            _queue->Jobs.pop_front();
+        }
+
+        switch (job->Type)
+        {
+        case WriteJob::kJob_Bitmap:
+            WriteSpriteData(job->Hdr, job->ImData.Buf, job->ImData.Size, job->ImData.BPP, job->Palette);
             break;
-        case kSprCompress_LZW: result = lzw_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+        case WriteJob::kJob_EmptySlot:
+            WriteEmptySlotImpl();
             break;
-        case kSprCompress_Deflate: result = deflate_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+        case WriteJob::kJob_RawData:
+            WriteRawDataImpl(job->Hdr, job->Data.data(), job->Data.size());
             break;
-        default: assert(!"Unsupported compression type!"); result = false; break;
         }
-        // mark to write as a plain byte array
-        im_data = result ? ImBufferCPtr(&_membuf[0], _membuf.size(), 1) : ImBufferCPtr();
     }
+}
 
-    // Write the final data
-    SpriteDatHeader hdr(bpp, sformat, pal_count, compress, w, h);
-    WriteSpriteData(hdr, im_data.Buf, im_data.Size, im_data.BPP, palette);
-    _membuf.clear();
+void SpriteFileWriter::StopThreads()
+{
+    if (!_queue) return;
+    {
+        std::lock_guard<std::mutex> lk(_queue->Mutex);
+        _queue->Stop = true;
+    }
+    _queue->WorkCV.notify_all();
+    for (auto &thread : _queue->Threads)
+        thread.join();
+    _queue.reset();
+}
+
+void SpriteFileWriter::WorkerThread()
+{
+    std::unique_lock<std::mutex> lk(_queue->Mutex);
+    for (;;)
+    {
+        _queue->WorkCV.wait(lk, [this]() { return _queue->Stop || !_queue->WorkQueue.empty(); });
+        if (_queue->Stop)
+            return;
+        WriteJob *job = _queue->WorkQueue.front();
+        _queue->WorkQueue.pop_front();
+        lk.unlock();
+
+        PrepareBitmapData(job->Image.get(), _storeFlags, _compress,
+            job->IndexedBuf, job->Data, job->Hdr, job->Palette, job->ImData);
+
+        lk.lock();
+        job->Done = true;
+        _queue->DoneCV.notify_one();
+    }
 }
 
 static inline void WriteSprHeader(const SpriteDatHeader &hdr, Stream *out)
@@ -770,6 +1045,14 @@ void SpriteFileWriter::WriteSpriteData(const SpriteDatHeader &hdr,
 void SpriteFileWriter::WriteEmptySlot()
 {
     if (!_out) return;
+    if (_queue)
+        QueueJob(std::unique_ptr<WriteJob>(new WriteJob(WriteJob::kJob_EmptySlot)), false);
+    else
+        WriteEmptySlotImpl();
+}
+
+void SpriteFileWriter::WriteEmptySlotImpl()
+{
     soff_t sproff = _out->GetPosition();
     _out->WriteInt16(0); // write invalid color depth to mark empty slot
     _index.Offsets.push_back(sproff);
@@ -780,6 +1063,21 @@ void SpriteFileWriter::WriteEmptySlot()
 void SpriteFileWriter::WriteRawData(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz)
 {
     if (!_out) return;
+    if (_queue)
+    {
+        std::unique_ptr<WriteJob> job(new WriteJob(WriteJob::kJob_RawData));
+        job->Hdr = hdr;
+        job->Data.assign(data, data + data_sz);
+        QueueJob(std::move(job), false);
+    }
+    else
+    {
+        WriteRawDataImpl(hdr, data, data_sz);
+    }
+}
+
+void SpriteFileWriter::WriteRawDataImpl(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz)
+{
     soff_t sproff = _out->GetPosition();
     _index.Offsets.push_back(sproff);
     _index.Widths.push_back(hdr.Width);
@@ -790,7 +1088,13 @@ void SpriteFileWriter::WriteRawData(const SpriteDatHeader &hdr, const uint8_t *d
 
 void SpriteFileWriter::Finalize()
 {
-    if (!_out || _lastSlotPos < 0) return;
+    if (!_out) return;
+    if (_queue)
+    {
+        WriteFinishedJobs(0);
+        StopThreads();
+    }
+    if (_lastSlotPos < 0) return;
     _out->Seek(_lastSlotPos, kSeekBegin);
     _out->WriteInt32(_index.GetLastSlot());
     _out.reset();
@@ -15,7 +15,9 @@
 // SpriteFile class handles sprite file parsing and streaming sprites.
 // SpriteFileWriter manages writing sprites into the output stream one by one,
 // accumulating index information, and may therefore be suitable for a variety
-// of situations.
+// of situations. It may optionally prepare and compress the sprites on a pool
+// of worker threads, while still writing them out in the order of arrival;
+// the resulting file is the same regardless of the number of threads.
 //
 //=============================================================================
 #ifndef __AGS_CN_AC__SPRFILE_H
@@ -36,6 +38,7 @@ namespace Common
 {
 
 class Bitmap;
+class MappedFile;
 
 // TODO: research old version differences
 enum SpriteFileVersion
@@ -84,7 +87,8 @@ enum SpriteCompression
     kSprCompress_None = 0,
     kSprCompress_RLE,
     kSprCompress_LZW,
-    kSprCompress_Deflate
+    kSprCompress_Deflate,
+    kSprCompress_LZ4
 };
 
 typedef int32_t sprkey_t;
@@ -135,6 +139,15 @@ public:
                          std::vector<Size> &metrics);
     // Closes stream; no reading will be possible unless opened again
     void        Close();
+    // Maps the sprite file into memory, which lets to create the uncompressed
+    // sprites as bitmaps referencing the mapped pixel data, without copying,
+    // and decompress LZ4 sprites straight from the mapped data.
+    // The file region must correspond to the opened sprite stream.
+    // Returns false if the mapping failed or was not found useful for this file.
+    bool        MapFile(const String &filename, soff_t offset, soff_t size);
+    // Gets the current file mapping, if there's one; the bitmaps created over
+    // the mapped data must not outlive it
+    const std::shared_ptr<MappedFile> &GetMapping() const { return _mapping; }
 
     int         GetStoreFlags() const;
     // Tells if bitmaps in the file are compressed
@@ -151,6 +164,17 @@ public:
     HError      LoadSprite(sprkey_t index, Bitmap *&sprite);
     // Loads a raw sprite element data into the buffer, stores header info separately
     HError      LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data);
+    // Creates a bitmap referencing the sprite's pixels in the mapped file,
+    // or decompressed from the mapped file, if the sprite is LZ4-compressed;
+    // the referencing bitmap is read-only, and must be copied if it has to be changed;
+    // returns false if there's no mapping, or this sprite cannot be used as-is,
+    // in which case it has to be loaded normally. Safe to call from another thread.
+    bool        LoadMappedSprite(sprkey_t index, Bitmap *&sprite) const;
+    // Creates a ready bitmap from the raw sprite data, previously read by LoadRawData;
+    // this does not access the file stream, and is safe to call from another thread,
+    // for as long as the file stays open
+    HError      LoadSpriteFromRawData(sprkey_t index, const SpriteDatHeader &hdr,
+                                      const std::vector<uint8_t> &data, Bitmap *&sprite) const;
 
 private:
     // Rebuilds sprite index from the main sprite file
@@ -169,6 +193,7 @@ private:
     // Array of sprite references
     std::vector<SpriteRef> _spriteData;
     std::unique_ptr<Stream> _stream; // the sprite stream
+    std::shared_ptr<MappedFile> _mapping; // optional mapping of the sprite file
     SpriteFileVersion _version = kSprfVersion_Current;
     int _storeFlags = 0; // storage flags, specify how sprites may be stored
     SpriteCompression _compress = kSprCompress_None; // sprite compression type
@@ -182,18 +207,23 @@ private:
 class SpriteFileWriter
 {
 public:
-    SpriteFileWriter(std::unique_ptr<Stream> &&out)
-        : _out(std::move(out)) {}
-    ~SpriteFileWriter() = default;
+    SpriteFileWriter(std::unique_ptr<Stream> &&out);
+    ~SpriteFileWriter();
 
     // Get the sprite index, accumulated after write
     const SpriteFileIndex &GetIndex() const { return _index; }
 
+    // Sets the number of worker threads which prepare and compress bitmaps;
+    // 0 means that everything is done on the calling thread.
+    // Must be called before Begin.
+    void SetThreads(int count);
+
     // Initializes new sprite file format;
     // store_flags are SpriteStorage;
     // optionally hint how many sprites will be written.
     void Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot = -1);
-    // Writes a bitmap into file, compressing if necessary
+    // Writes a bitmap into file, compressing if necessary;
+    // if worker threads are used, then the bitmap is copied for processing
     void WriteBitmap(const Bitmap *image);
     // Writes an empty slot marker
     void WriteEmptySlot();
@@ -203,10 +233,28 @@ public:
     void Finalize();
 
 private:
+    // A sprite queued for writing, when using worker threads
+    struct WriteJob;
+    // Worker threads and the queue of sprites; these are hidden from the
+    // header, because the threading headers cannot be used in the managed
+    // code, which includes this header (Editor)
+    struct WriteQueue;
+
     // Writes prepared image data in a proper file format, following explicit data_bpp rule
     void WriteSpriteData(const SpriteDatHeader &hdr,
         const uint8_t *im_data, size_t im_data_sz, int im_bpp,
         const uint32_t palette[256]);
+    // Adds a job to the write queue, and writes out the finished ones
+    void QueueJob(std::unique_ptr<WriteJob> &&job, bool needs_work);
+    // Writes out the finished jobs from the head of the queue; waits until
+    // there's no more than max_pending jobs left in the queue
+    void WriteFinishedJobs(size_t max_pending);
+    // Stops and joins the worker threads, discarding any unwritten jobs
+    void StopThreads();
+    // Worker thread's function, prepares the queued bitmaps for writing
+    void WorkerThread();
+    void WriteEmptySlotImpl();
+    void WriteRawDataImpl(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz);
 
     std::unique_ptr<Stream> _out;
     int _storeFlags = 0;
@@ -216,6 +264,10 @@ private:
     SpriteFileIndex _index;
     // compression buffer
     std::vector<uint8_t> _membuf;
+
+    int _numThreads = 0;
+    // Worker threads, only created if requested
+    std::unique_ptr<WriteQueue> _queue;
 };
 
 
@@ -224,10 +276,12 @@ private:
 // Accepts available sprites as pairs of bool and Bitmap pointer, where boolean value
 // tells if sprite exists and Bitmap pointer may be null;
 // If a sprite's bitmap is missing, it will try reading one from the input file stream.
+// Optionally uses the given number of threads for compressing sprites.
 int SaveSpriteFile(const String &save_to_file,
     const std::vector<std::pair<bool, Bitmap*>> &sprites,
     SpriteFile *read_from_file, // optional file to read missing sprites from
-    int store_flags, SpriteCompression compress, SpriteFileIndex &index);
+    int store_flags, SpriteCompression compress, SpriteFileIndex &index,
+    int threads = 0);
 // Saves sprite index table in a separate file
 int SaveSpriteIndex(const String &filename, const SpriteFileIndex &index);
 
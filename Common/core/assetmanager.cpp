@@ -205,6 +205,39 @@ bool AssetManager::GetAssetTime(const String &asset_name, time_t &ft, const Stri
     return false;
 }
 
+bool AssetManager::GetAssetLocation(const String &asset_name, AssetLocation &loc, const String &filter) const
+{
+    for (const auto *lib : _activeLibs)
+    {
+        if (!lib->TestFilter(filter)) continue; // filter does not match
+
+        if (IsAssetLibDir(lib))
+        {
+            String filename = File::FindFileCI(lib->BaseDir, asset_name);
+            if (filename.IsEmpty())
+                continue;
+            loc.FileName = filename;
+            loc.Offset = 0;
+            loc.Size = File::GetFileSize(filename);
+            return true;
+        }
+        else
+        {
+            auto it_found = lib->Lookup.find(asset_name);
+            if (it_found == lib->Lookup.end())
+                continue;
+            const AssetInfo &a = lib->AssetInfos[it_found->second];
+            if (lib->RealLibFiles[a.LibUid].IsEmpty())
+                continue;
+            loc.FileName = lib->RealLibFiles[a.LibUid];
+            loc.Offset = a.Offset;
+            loc.Size = a.Size;
+            return true;
+        }
+    }
+    return false;
+}
+
 void AssetManager::FindAssets(std::vector<String> &assets, const String &wildcard,
     const String &filter) const
 {
@@ -74,6 +74,14 @@ struct AssetPath
     AssetPath(const String &name = "", const String &filter = "") : Name(name), Filter(filter) {}
 };
 
+// AssetLocation describes the asset's physical location: a file and a region in it
+struct AssetLocation
+{
+    String FileName; // file containing the asset
+    soff_t Offset = 0; // asset's position in the file (in bytes)
+    soff_t Size = 0; // asset's size (in bytes)
+};
+
 // AssetLibEntry describes AssetLibrary registered in the AssetManager,
 // and the filters applied to that library
 struct AssetLibEntry
@@ -127,6 +135,9 @@ public:
     // Tries to get asset's "file time" (last modification time).
     // Note that for the assets packed within a CLIB format this will return library's time instead.
     bool         GetAssetTime(const String &asset_name, time_t &ft, const String &filter = "") const;
+    // Tries to find the asset's location; assets packed within a library are
+    // reported as a region of the library file.
+    bool         GetAssetLocation(const String &asset_name, AssetLocation &loc, const String &filter = "") const;
     // Searches in all the registered locations and collects a list of
     // assets using given wildcard pattern
     // TODO: variant accepting std::regex instead of wildcard, and replace uses where convenient
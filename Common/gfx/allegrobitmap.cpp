@@ -57,8 +57,10 @@ Bitmap::Bitmap(Bitmap &&bmp)
     _pixelData = std::move(bmp._pixelData);
     _alBitmap = bmp._alBitmap;
     _isDataOwner = bmp._isDataOwner;
+    _isReadOnly = bmp._isReadOnly;
     bmp._alBitmap = nullptr;
     bmp._isDataOwner = false;
+    bmp._isReadOnly = false;
 }
 
 Bitmap::~Bitmap()
@@ -136,6 +138,22 @@ bool Bitmap::Create(PixelBuffer &&pxbuf)
     return true;
 }
 
+bool Bitmap::CreateReference(int width, int height, int color_depth, const uint8_t *data, size_t data_sz)
+{
+    Destroy();
+
+    // Allegro's BITMAP has no notion of constant pixels, we must remember that ourselves
+    BITMAP *bitmap = create_bitmap_userdata(color_depth, width, height, const_cast<uint8_t*>(data), data_sz, 0u, nullptr);
+    if (!bitmap)
+        return false;
+
+    // We own the BITMAP object, but not the pixel data
+    _alBitmap = bitmap;
+    _isDataOwner = true;
+    _isReadOnly = true;
+    return true;
+}
+
 bool Bitmap::CreateSubBitmap(Bitmap *src, const Rect &rc)
 {
     if (src == this || src->_alBitmap == _alBitmap)
@@ -193,6 +211,7 @@ void Bitmap::ForgetAllegroBitmap()
 {
     _alBitmap = nullptr;
     _isDataOwner = false;
+    _isReadOnly = false;
     _pixelData = {};
 }
 
@@ -204,6 +223,7 @@ void Bitmap::Destroy()
     }
     _alBitmap = nullptr;
     _isDataOwner = false;
+    _isReadOnly = false;
     _pixelData = {};
 }
 
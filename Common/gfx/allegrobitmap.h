@@ -64,6 +64,10 @@ public:
     bool    CreateTransparent(int width, int height, int color_depth = 0);
     // Create Bitmap and attach prepared pixel buffer
     bool    Create(PixelBuffer &&pxbuf);
+    // Create Bitmap referencing the external pixel data, which is not owned.
+    // The referenced data is treated as read-only, see IsReadOnly().
+    // WARNING: the pixel data MUST be kept in memory for as long as bitmap exists!
+    bool    CreateReference(int width, int height, int color_depth, const uint8_t *data, size_t data_sz);
     // Creates a sub-bitmap of the given bitmap; the sub-bitmap is a reference to
     // particular region inside a parent.
     // WARNING: the parent bitmap MUST be kept in memory for as long as sub-bitmap exists!
@@ -109,6 +113,12 @@ public:
     {
         return is_same_bitmap(_alBitmap, other->_alBitmap) != 0;
     }
+    // Checks if bitmap references read-only pixel data, which must not be
+    // modified; such bitmap has to be copied before drawing onto it.
+    inline bool IsReadOnly() const
+    {
+        return _isReadOnly;
+    }
     // Checks if bitmap cannot be used
     inline bool IsNull() const
     {
@@ -282,6 +292,7 @@ private:
     std::unique_ptr<uint8_t[]> _pixelData;
     BITMAP *_alBitmap = nullptr;
     bool    _isDataOwner = false;
+    bool    _isReadOnly = false;
 };
 
 
@@ -75,6 +75,17 @@ Bitmap *CreateBitmap(PixelBuffer &&pxbuf)
     return bitmap;
 }
 
+Bitmap *CreateBitmapReference(int width, int height, int color_depth, const uint8_t *data, size_t data_sz)
+{
+    Bitmap *bitmap = new Bitmap();
+    if (!bitmap->CreateReference(width, height, color_depth, data, data_sz))
+    {
+        delete bitmap;
+        return nullptr;
+    }
+    return bitmap;
+}
+
 Bitmap *CreateSubBitmap(Bitmap *src, const Rect &rc)
 {
 	Bitmap *bitmap = new Bitmap();
@@ -175,6 +186,38 @@ void ReplaceAlphaWithRGBMask(Bitmap *bmp, int alpha_threshold)
     }
 }
 
+bool NeedsMakeOpaqueSkipMask(const Bitmap *bmp)
+{
+    if (bmp->GetColorDepth() < 32)
+        return false; // no alpha channel
+
+    for (int i = 0; i < bmp->GetHeight(); ++i)
+    {
+        const uint32_t *line = reinterpret_cast<const uint32_t*>(bmp->GetScanLine(i));
+        const uint32_t *line_end = line + bmp->GetWidth();
+        for (const uint32_t *px = line; px != line_end; ++px)
+            if ((*px != MASK_COLOR_32) && (geta32(*px) != 255))
+                return true;
+    }
+    return false;
+}
+
+bool NeedsReplaceAlphaWithRGBMask(const Bitmap *bmp, int alpha_threshold)
+{
+    if (bmp->GetColorDepth() < 32)
+        return false; // no alpha channel
+
+    for (int i = 0; i < bmp->GetHeight(); ++i)
+    {
+        const uint32_t *line = reinterpret_cast<const uint32_t*>(bmp->GetScanLine(i));
+        const uint32_t *line_end = line + bmp->GetWidth();
+        for (const uint32_t *px = line; px != line_end; ++px)
+            if ((*px != MASK_COLOR_32) && (geta32(*px) <= alpha_threshold))
+                return true;
+    }
+    return false;
+}
+
 // Functor that copies the "mask color" pixels from source to dest
 template <class TPx, size_t BPP_>
 struct PixelTransCpy
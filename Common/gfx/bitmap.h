@@ -68,6 +68,10 @@ namespace BitmapHelper
     Bitmap *CreateTransparentBitmap(int width, int height, int color_depth = 0);
     // Create Bitmap and attach prepared pixel buffer
     Bitmap *CreateBitmap(PixelBuffer &&pxbuf);
+    // Creates a bitmap referencing the external pixel data, which is not owned,
+    // and must not be modified (see Bitmap::IsReadOnly).
+    // WARNING: the pixel data MUST be kept in memory for as long as bitmap exists!
+    Bitmap *CreateBitmapReference(int width, int height, int color_depth, const uint8_t *data, size_t data_sz);
     // Creates a sub-bitmap of the given bitmap; the sub-bitmap is a reference to
     // particular region inside a parent.
     // WARNING: the parent bitmap MUST be kept in memory for as long as sub-bitmap exists!
@@ -108,6 +112,10 @@ namespace BitmapHelper
     inline void ReplaceZeroAlphaWithRGBMask(Bitmap *bmp) { ReplaceAlphaWithRGBMask(bmp, 0); }
     // Replaces less than 50% transparent (alpha < 128) pixels with standard mask color.
     inline void ReplaceHalfAlphaWithRGBMask(Bitmap *bmp) { ReplaceAlphaWithRGBMask(bmp, 127); }
+    // Tells if MakeOpaqueSkipMask would change any pixel of the given bitmap.
+    bool    NeedsMakeOpaqueSkipMask(const Bitmap *bmp);
+    // Tells if ReplaceAlphaWithRGBMask would change any pixel of the given bitmap.
+    bool    NeedsReplaceAlphaWithRGBMask(const Bitmap *bmp, int alpha_threshold);
     // Copy transparency mask and/or alpha channel from one bitmap into another.
     // Destination and mask bitmaps must be of the same pixel format.
     // Transparency is merged, meaning that fully transparent pixels on
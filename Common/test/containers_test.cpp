@@ -0,0 +1,194 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <map>
+#include <set>
+#include <string>
+#include "gtest/gtest.h"
+#include "util/btree.h"
+#include "util/flathash.h"
+#include "util/smallstring.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+// Integer keys, with a deliberately bad hash, to test collisions
+struct IntKeyTraits
+{
+    static uint32_t Hash(int key) { return static_cast<uint32_t>(key % 7); }
+    static bool Equals(int stored, int key) { return stored == key; }
+    static int Compare(int stored, int key) { return (stored < key) ? -1 : (stored > key ? 1 : 0); }
+    static int MakeKey(int key) { return key; }
+};
+
+// String keys, looked up by the C-string
+struct StrKeyTraits
+{
+    static uint32_t Hash(const char *key) { return static_cast<uint32_t>(std::hash<std::string>()(key)); }
+    static bool Equals(const SmallString &stored, const char *key) { return strcmp(stored.GetCStr(), key) == 0; }
+    static int Compare(const SmallString &stored, const char *key) { return strcmp(stored.GetCStr(), key); }
+    static SmallString MakeKey(const char *key) { return SmallString(key, strlen(key)); }
+};
+
+} // namespace
+
+TEST(Containers, SmallString) {
+    SmallString empty;
+    ASSERT_TRUE(empty.IsEmpty());
+    ASSERT_STREQ(empty.GetCStr(), "");
+
+    const char *long_text = "this text is too long to be stored inline";
+    SmallString s1("short", 5);
+    SmallString s2(long_text, strlen(long_text));
+    ASSERT_STREQ(s1.GetCStr(), "short");
+    ASSERT_EQ(s1.GetLength(), 5u);
+    ASSERT_STREQ(s2.GetCStr(), long_text);
+    ASSERT_EQ(s2.GetLength(), strlen(long_text));
+
+    SmallString s3(s2);
+    ASSERT_STREQ(s3.GetCStr(), long_text);
+    ASSERT_NE(s3.GetCStr(), s2.GetCStr());
+    SmallString s4(std::move(s3));
+    ASSERT_STREQ(s4.GetCStr(), long_text);
+    ASSERT_TRUE(s3.IsEmpty());
+    s4 = s1;
+    ASSERT_STREQ(s4.GetCStr(), "short");
+    s1 = std::move(s2);
+    ASSERT_STREQ(s1.GetCStr(), long_text);
+    ASSERT_TRUE(s2.IsEmpty());
+}
+
+TEST(Containers, FlatHashMap) {
+    FlatHashMap<int, int, IntKeyTraits> map;
+    std::map<int, int> ref;
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.find(1), map.end());
+    // Add, overwrite and remove keys in a pseudo-random order,
+    // and compare with the reference map
+    for (int i = 0; i < 10000; ++i)
+    {
+        const int key = (i * 7919) % 1000;
+        if (i % 3 == 2)
+        {
+            auto it = map.find(key);
+            ASSERT_EQ(it != map.end(), ref.count(key) != 0);
+            if (it != map.end())
+                map.erase(it);
+            ref.erase(key);
+        }
+        else
+        {
+            map[key] = i;
+            ref[key] = i;
+        }
+        ASSERT_EQ(map.size(), ref.size());
+    }
+    for (int key = 0; key < 1000; ++key)
+    {
+        auto it = map.find(key);
+        ASSERT_EQ(map.count(key), ref.count(key));
+        if (it != map.end())
+        {
+            ASSERT_EQ(it->second, ref[key]);
+        }
+    }
+    size_t count = 0u;
+    for (const auto &entry : map)
+    {
+        ASSERT_EQ(entry.second, ref[entry.first]);
+        count++;
+    }
+    ASSERT_EQ(count, ref.size());
+    map.clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.begin(), map.end());
+}
+
+TEST(Containers, FlatHashSet) {
+    FlatHashSet<SmallString, StrKeyTraits> set;
+    ASSERT_TRUE(set.insert("apple").second);
+    ASSERT_TRUE(set.insert("a long fruit name that is not stored inline").second);
+    ASSERT_FALSE(set.insert("apple").second);
+    ASSERT_EQ(set.size(), 2u);
+    ASSERT_EQ(set.count("apple"), 1u);
+    ASSERT_EQ(set.count("pear"), 0u);
+    set.erase(set.find("apple"));
+    ASSERT_EQ(set.count("apple"), 0u);
+    ASSERT_EQ(set.count("a long fruit name that is not stored inline"), 1u);
+    ASSERT_EQ(set.size(), 1u);
+}
+
+TEST(Containers, BTreeMap) {
+    BTreeMap<int, int, IntKeyTraits> map;
+    std::map<int, int> ref;
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.find(1), map.end());
+    // Use enough keys to have many leaves split and merged
+    for (int i = 0; i < 20000; ++i)
+    {
+        const int key = (i * 7919) % 5000;
+        if (i % 3 == 2 || (i > 15000 && i % 2 == 0))
+        {
+            auto it = map.find(key);
+            ASSERT_EQ(it != map.end(), ref.count(key) != 0);
+            if (it != map.end())
+                map.erase(it);
+            ref.erase(key);
+        }
+        else
+        {
+            map[key] = i;
+            ref[key] = i;
+        }
+        ASSERT_EQ(map.size(), ref.size());
+    }
+    // Test the entries are sorted and match the reference map
+    auto ref_it = ref.begin();
+    for (auto it = map.begin(); it != map.end(); ++it, ++ref_it)
+    {
+        ASSERT_NE(ref_it, ref.end());
+        ASSERT_EQ(it->first, ref_it->first);
+        ASSERT_EQ(it->second, ref_it->second);
+    }
+    ASSERT_EQ(ref_it, ref.end());
+    for (int key = 0; key < 5000; ++key)
+        ASSERT_EQ(map.count(key), ref.count(key));
+    // Remove everything
+    while (!map.empty())
+        map.erase(map.begin());
+    ASSERT_EQ(map.begin(), map.end());
+}
+
+TEST(Containers, BTreeSet) {
+    BTreeSet<SmallString, StrKeyTraits> set;
+    std::set<std::string> ref;
+    char buf[32];
+    for (int i = 0; i < 1000; ++i)
+    {
+        snprintf(buf, sizeof(buf), "item%d", (i * 7919) % 500);
+        ASSERT_EQ(set.insert(buf).second, ref.insert(buf).second);
+    }
+    ASSERT_EQ(set.size(), ref.size());
+    auto ref_it = ref.begin();
+    for (const auto &item : set)
+    {
+        ASSERT_STREQ(item.GetCStr(), ref_it->c_str());
+        ++ref_it;
+    }
+    ASSERT_EQ(set.count("item10"), 1u);
+    set.erase(set.find("item10"));
+    ASSERT_EQ(set.count("item10"), 0u);
+    ASSERT_EQ(set.count("item11"), 1u);
+}
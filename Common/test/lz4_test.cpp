@@ -0,0 +1,98 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/lz4.h"
+
+namespace
+{
+
+std::vector<uint8_t> Compress(const std::vector<uint8_t> &src)
+{
+    std::vector<uint8_t> dst(lz4_compress_bound(src.size()));
+    size_t sz = lz4_compress_block(src.data(), src.size(), dst.data(), dst.size());
+    dst.resize(sz);
+    return dst;
+}
+
+void TestRoundTrip(const std::vector<uint8_t> &src)
+{
+    std::vector<uint8_t> comp = Compress(src);
+    ASSERT_GT(comp.size(), 0u);
+    ASSERT_LE(comp.size(), lz4_compress_bound(src.size()));
+    std::vector<uint8_t> out(src.size());
+    ASSERT_TRUE(lz4_decompress_block(comp.data(), comp.size(), out.data(), out.size()));
+    ASSERT_EQ(out, src);
+}
+
+} // namespace
+
+TEST(LZ4, RoundTrip) {
+    // Empty and small inputs, stored as literals only
+    TestRoundTrip({});
+    TestRoundTrip({ 1 });
+    TestRoundTrip({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 });
+
+    // Repeating data, compresses into overlapping matches
+    std::vector<uint8_t> fill(100000, 0xAB);
+    TestRoundTrip(fill);
+    ASSERT_LT(Compress(fill).size(), fill.size() / 100);
+    std::vector<uint8_t> pattern(5000);
+    for (size_t i = 0; i < pattern.size(); ++i)
+        pattern[i] = static_cast<uint8_t>(i % 3);
+    TestRoundTrip(pattern);
+
+    // Sprite-like data: runs of transparent pixels and random pixels
+    std::vector<uint8_t> image(70000);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        image[i] = ((i / 256) % 4 == 0) ? static_cast<uint8_t>(seed >> 16) : 0;
+    }
+    TestRoundTrip(image);
+    ASSERT_LT(Compress(image).size(), image.size());
+
+    // Random data, which does not compress
+    std::vector<uint8_t> noise(10000);
+    for (size_t i = 0; i < noise.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        noise[i] = static_cast<uint8_t>(seed >> 16);
+    }
+    TestRoundTrip(noise);
+}
+
+TEST(LZ4, MalformedData) {
+    std::vector<uint8_t> src(1000);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = static_cast<uint8_t>(i % 10);
+    std::vector<uint8_t> comp = Compress(src);
+    std::vector<uint8_t> out(src.size());
+    // Wrong output size
+    ASSERT_FALSE(lz4_decompress_block(comp.data(), comp.size(), out.data(), out.size() - 1));
+    out.resize(src.size() + 1);
+    ASSERT_FALSE(lz4_decompress_block(comp.data(), comp.size(), out.data(), out.size()));
+    out.resize(src.size());
+    // Truncated input
+    for (size_t sz = 0; sz < comp.size(); ++sz)
+        ASSERT_FALSE(lz4_decompress_block(comp.data(), sz, out.data(), out.size()));
+    // Match offset pointing before the start of output
+    const uint8_t bad_offset[] = { 0x10, 'a', 0x10, 0x00, 0x10, 'b' };
+    ASSERT_FALSE(lz4_decompress_block(bad_offset, sizeof(bad_offset), out.data(), 6));
+    const uint8_t good_offset[] = { 0x10, 'a', 0x01, 0x00, 0x10, 'b' };
+    ASSERT_TRUE(lz4_decompress_block(good_offset, sizeof(good_offset), out.data(), 6));
+    ASSERT_EQ(std::string(reinterpret_cast<char*>(out.data()), 6), "aaaaab");
+}
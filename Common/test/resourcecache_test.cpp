@@ -0,0 +1,193 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "util/resourcecache.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+// Test cache, where each item's value is also its size
+class TestCache : public ResourceCache<int, int>
+{
+public:
+    TestCache(size_t max_size, CachePolicyType policy)
+        : ResourceCache(max_size)
+    {
+        SetPolicy(policy);
+    }
+
+private:
+    size_t CalcSize(const int &item) override { return item; }
+};
+
+} // namespace
+
+TEST(ResourceCache, LRU) {
+    TestCache cache(10, kCachePolicy_LRU);
+    cache.Put(1, 3);
+    cache.Put(2, 3);
+    cache.Put(3, 3);
+    ASSERT_EQ(cache.GetCacheSize(), 9u);
+    ASSERT_EQ(cache.Get(1), 3);
+    // the least recently used is disposed
+    cache.Put(4, 3);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_FALSE(cache.Exists(2));
+    ASSERT_TRUE(cache.Exists(3));
+    ASSERT_TRUE(cache.Exists(4));
+    ASSERT_EQ(cache.GetCacheSize(), 9u);
+    // put a big item, which requires disposing several
+    cache.Put(5, 7);
+    ASSERT_TRUE(cache.Exists(4));
+    ASSERT_TRUE(cache.Exists(5));
+    ASSERT_EQ(cache.GetCacheSize(), 10u);
+
+    ASSERT_EQ(cache.Get(2), 0);
+    const ResourceCacheStats &stats = cache.GetStats();
+    ASSERT_EQ(stats.Hits, 1u);
+    ASSERT_EQ(stats.Misses, 1u);
+    ASSERT_EQ(stats.Evictions, 3u);
+    ASSERT_EQ(stats.EvictedSize, 9u);
+    // peeking is not counted
+    ASSERT_EQ(cache.Peek(4), 3);
+    ASSERT_EQ(cache.Peek(2), 0);
+    ASSERT_EQ(stats.Hits, 1u);
+    ASSERT_EQ(stats.Misses, 1u);
+    cache.ResetStats();
+    ASSERT_EQ(cache.GetStats().Evictions, 0u);
+}
+
+TEST(ResourceCache, LockedAndExternal) {
+    TestCache cache(10, kCachePolicy_LRU);
+    cache.Put(1, 3, TestCache::kCacheItem_Locked);
+    cache.Put(2, 3);
+    cache.Put(3, 5, TestCache::kCacheItem_External);
+    cache.Put(4, 3);
+    ASSERT_EQ(cache.GetCacheSize(), 9u);
+    ASSERT_EQ(cache.GetLockedSize(), 3u);
+    ASSERT_EQ(cache.GetExternalSize(), 5u);
+    // locked and external items are not disposed
+    cache.Put(5, 3);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_FALSE(cache.Exists(2));
+    ASSERT_TRUE(cache.Exists(3));
+    cache.Lock(4);
+    cache.Put(6, 5);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(4));
+    ASSERT_FALSE(cache.Exists(5));
+    ASSERT_TRUE(cache.Exists(6));
+    ASSERT_EQ(cache.GetCacheSize(), 11u); // no more items to dispose
+    ASSERT_EQ(cache.GetLockedSize(), 6u);
+    // released item may be disposed again
+    cache.Release(1);
+    cache.Put(7, 1);
+    ASSERT_FALSE(cache.Exists(6));
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_EQ(cache.GetLockedSize(), 3u);
+    // only free items are disposed
+    cache.DisposeFreeItems();
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(3));
+    ASSERT_TRUE(cache.Exists(4));
+    ASSERT_FALSE(cache.Exists(7));
+    ASSERT_EQ(cache.GetCacheSize(), 3u);
+    ASSERT_EQ(cache.GetLockedSize(), 3u);
+    ASSERT_EQ(cache.GetExternalSize(), 5u);
+    cache.Release(4);
+    ASSERT_EQ(cache.Remove(4), 3);
+    ASSERT_EQ(cache.GetCacheSize(), 0u);
+    cache.Dispose(3);
+    ASSERT_EQ(cache.GetExternalSize(), 0u);
+}
+
+TEST(ResourceCache, LRU2) {
+    // Item 1 is used twice, item 2 is used many times but in quick succession;
+    // then a series of items used once should not dispose item 1,
+    // as it would happen with LRU
+    for (int policy = kCachePolicy_LRU; policy <= kCachePolicy_LRU2; ++policy)
+    {
+        TestCache cache(4, static_cast<CachePolicyType>(policy));
+        cache.Put(1, 1);
+        cache.Put(2, 1);
+        for (int i = 0; i < 20; ++i)
+            cache.Get(2);
+        cache.Get(1);
+        cache.Put(3, 1);
+        cache.Put(4, 1);
+        cache.Put(5, 1);
+        cache.Put(6, 1);
+        cache.Put(7, 1);
+        ASSERT_EQ(cache.Exists(1), policy == kCachePolicy_LRU2);
+        ASSERT_FALSE(cache.Exists(2));
+        ASSERT_TRUE(cache.Exists(7));
+        ASSERT_EQ(cache.GetStats().Evictions, 3u);
+    }
+
+    // Item which is loaded again soon after disposal is counted as frequent
+    TestCache cache(2, kCachePolicy_LRU2);
+    cache.Put(1, 1);
+    cache.Put(2, 1);
+    cache.Put(3, 1);
+    ASSERT_FALSE(cache.Exists(1));
+    cache.Put(1, 1);
+    cache.Put(4, 1);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(4));
+}
+
+TEST(ResourceCache, GreedyDual) {
+    // The big item is disposed first, even if used recently
+    for (int policy = kCachePolicy_LRU; policy <= kCachePolicy_GreedyDual; policy += kCachePolicy_GreedyDual)
+    {
+        TestCache cache(10, static_cast<CachePolicyType>(policy));
+        cache.Put(1, 1);
+        cache.Put(2, 8);
+        cache.Get(2);
+        cache.Put(3, 2);
+        ASSERT_EQ(cache.Exists(1), policy == kCachePolicy_GreedyDual);
+        ASSERT_EQ(cache.Exists(2), policy == kCachePolicy_LRU);
+        ASSERT_TRUE(cache.Exists(3));
+    }
+
+    // Items which are not used age out, even if small
+    TestCache cache(10, kCachePolicy_GreedyDual);
+    cache.Put(1, 1);
+    for (int i = 0; i < 4; ++i)
+    {
+        cache.Put(2, 5);
+        cache.Put(3, 5); // disposes 2, then 1 after a few rounds
+    }
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(3));
+}
+
+TEST(ResourceCache, ChangePolicy) {
+    TestCache cache(10, kCachePolicy_LRU);
+    cache.Put(1, 4);
+    cache.Put(2, 4, TestCache::kCacheItem_Locked);
+    cache.SetPolicy(kCachePolicy_GreedyDual);
+    ASSERT_EQ(cache.GetPolicy(), kCachePolicy_GreedyDual);
+    ASSERT_EQ(cache.GetCacheSize(), 8u);
+    // existing items are handled by the new policy
+    cache.Put(3, 4);
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(2));
+    ASSERT_TRUE(cache.Exists(3));
+    cache.SetMaxCacheSize(5);
+    ASSERT_FALSE(cache.Exists(3));
+    ASSERT_EQ(cache.GetCacheSize(), 4u);
+}
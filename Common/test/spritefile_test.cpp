@@ -0,0 +1,273 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/gamestructdefines.h"
+#include "ac/spritecache.h"
+#include "ac/spritefile.h"
+#include "gfx/bitmap.h"
+#include "util/file.h"
+#include "util/mappedfile.h"
+
+using namespace AGS::Common;
+
+#if (AGS_PLATFORM_TEST_FILE_IO)
+
+static const char *SpriteTestFile = "sprites.dat";
+static const char *SpriteTestFile2 = "sprites2.dat";
+
+class SpriteFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        File::DeleteFile(SpriteTestFile);
+        File::DeleteFile(SpriteTestFile2);
+    }
+
+    void TearDown() override {
+        File::DeleteFile(SpriteTestFile);
+        File::DeleteFile(SpriteTestFile2);
+    }
+};
+
+// Creates a bitmap filled with a pattern, which depends on the seed
+static std::unique_ptr<Bitmap> CreateTestSprite(int width, int height, int color_depth, int seed)
+{
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(width, height, color_depth));
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *line = bmp->GetScanLineForWriting(y);
+        for (int x = 0; x < width * bmp->GetBPP(); ++x)
+            line[x] = static_cast<uint8_t>(seed + x * 3 + y * 7);
+    }
+    return bmp;
+}
+
+static void AssertSameBitmaps(const Bitmap *bmp1, const Bitmap *bmp2)
+{
+    ASSERT_NE(bmp1, nullptr);
+    ASSERT_NE(bmp2, nullptr);
+    ASSERT_EQ(bmp1->GetWidth(), bmp2->GetWidth());
+    ASSERT_EQ(bmp1->GetHeight(), bmp2->GetHeight());
+    ASSERT_EQ(bmp1->GetColorDepth(), bmp2->GetColorDepth());
+    for (int y = 0; y < bmp1->GetHeight(); ++y)
+        ASSERT_EQ(memcmp(bmp1->GetScanLine(y), bmp2->GetScanLine(y), bmp1->GetLineLength()), 0);
+}
+
+// Test sprite set: 32-bit and 8-bit sprites, and an empty slot in between;
+// the sizes are chosen so that every 32-bit sprite's pixels are aligned in
+// file, and may be referenced in place (an empty slot takes 2 bytes, which
+// the next 8-bit sprite compensates)
+static std::vector<std::unique_ptr<Bitmap>> CreateTestSpriteSet()
+{
+    std::vector<std::unique_ptr<Bitmap>> sprites;
+    sprites.push_back(CreateTestSprite(10, 7, 32, 1));
+    sprites.push_back(CreateTestSprite(4, 3, 8, 2));
+    sprites.push_back(nullptr);
+    sprites.push_back(CreateTestSprite(5, 2, 8, 3));
+    sprites.push_back(CreateTestSprite(33, 20, 32, 4));
+    return sprites;
+}
+
+static void WriteTestSpriteSet(const std::vector<std::unique_ptr<Bitmap>> &images,
+    SpriteCompression compress, int threads = 0, int store_flags = 0,
+    const char *filename = SpriteTestFile)
+{
+    std::vector<std::pair<bool, Bitmap*>> sprites;
+    for (const auto &image : images)
+        sprites.push_back(std::make_pair(image != nullptr, image.get()));
+    SpriteFileIndex index;
+    ASSERT_EQ(SaveSpriteFile(filename, sprites, nullptr, store_flags, compress, index, threads), 0);
+}
+
+static std::vector<uint8_t> ReadFileData(const char *filename)
+{
+    std::vector<uint8_t> data(static_cast<size_t>(File::GetFileSize(filename)));
+    auto in = File::OpenFileRead(filename);
+    if (!in || in->Read(data.data(), data.size()) != data.size())
+        return {};
+    return data;
+}
+
+static void OpenAndMapSpriteFile(SpriteFile &file, bool expect_mapped)
+{
+    std::vector<Size> metrics;
+    ASSERT_TRUE(file.OpenFile(File::OpenFileRead(SpriteTestFile), nullptr, metrics));
+    ASSERT_EQ(file.MapFile(SpriteTestFile, 0, File::GetFileSize(SpriteTestFile)), expect_mapped);
+}
+
+TEST_F(SpriteFileTest, LoadMappedSprite_Uncompressed) {
+    if (!MappedFile::IsSupported())
+        return;
+
+    const auto images = CreateTestSpriteSet();
+    WriteTestSpriteSet(images, kSprCompress_None);
+    SpriteFile file;
+    OpenAndMapSpriteFile(file, true);
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        Bitmap *sprite = nullptr;
+        ASSERT_TRUE(file.LoadMappedSprite(i, sprite));
+        std::unique_ptr<Bitmap> sprite_ptr(sprite);
+        if (!images[i])
+        {
+            ASSERT_EQ(sprite, nullptr); // empty slot
+            continue;
+        }
+        AssertSameBitmaps(sprite, images[i].get());
+        // Pixels are referenced in the mapped file, and must not be modified
+        ASSERT_TRUE(sprite->IsReadOnly());
+        const uint8_t *map_begin = file.GetMapping()->GetData();
+        const uint8_t *map_end = map_begin + file.GetMapping()->GetSize();
+        ASSERT_GE(sprite->GetScanLine(0), map_begin);
+        ASSERT_LE(sprite->GetScanLine(sprite->GetHeight() - 1) + sprite->GetLineLength(), map_end);
+        // A copy is a regular bitmap
+        std::unique_ptr<Bitmap> copy(BitmapHelper::CreateBitmapCopy(sprite));
+        ASSERT_FALSE(copy->IsReadOnly());
+        AssertSameBitmaps(copy.get(), images[i].get());
+    }
+
+    // Invalid indexes
+    Bitmap *sprite = nullptr;
+    ASSERT_FALSE(file.LoadMappedSprite(-1, sprite));
+    ASSERT_FALSE(file.LoadMappedSprite(images.size(), sprite));
+    ASSERT_EQ(sprite, nullptr);
+    file.Close();
+}
+
+TEST_F(SpriteFileTest, LoadMappedSprite_LZ4) {
+    if (!MappedFile::IsSupported())
+        return;
+
+    const auto images = CreateTestSpriteSet();
+    WriteTestSpriteSet(images, kSprCompress_LZ4);
+    SpriteFile file;
+    OpenAndMapSpriteFile(file, true);
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        Bitmap *sprite = nullptr;
+        ASSERT_TRUE(file.LoadMappedSprite(i, sprite));
+        std::unique_ptr<Bitmap> sprite_ptr(sprite);
+        if (!images[i])
+        {
+            ASSERT_EQ(sprite, nullptr); // empty slot
+            continue;
+        }
+        // Decompressed into a new bitmap
+        AssertSameBitmaps(sprite, images[i].get());
+        ASSERT_FALSE(sprite->IsReadOnly());
+    }
+    file.Close();
+}
+
+TEST_F(SpriteFileTest, LoadMappedSprite_NotMapped) {
+    const auto images = CreateTestSpriteSet();
+    // Files using other compression types are not mapped
+    const SpriteCompression compress[] = { kSprCompress_RLE, kSprCompress_LZW };
+    for (const auto c : compress)
+    {
+        WriteTestSpriteSet(images, c);
+        SpriteFile file;
+        OpenAndMapSpriteFile(file, false);
+        Bitmap *sprite = nullptr;
+        ASSERT_FALSE(file.LoadMappedSprite(0, sprite));
+        ASSERT_EQ(sprite, nullptr);
+        // Regular loading is still working
+        ASSERT_TRUE(file.LoadSprite(0, sprite));
+        std::unique_ptr<Bitmap> sprite_ptr(sprite);
+        AssertSameBitmaps(sprite, images[0].get());
+        file.Close();
+    }
+}
+
+TEST_F(SpriteFileTest, MappedSpriteForWriting) {
+    if (!MappedFile::IsSupported())
+        return;
+
+    const auto images = CreateTestSpriteSet();
+    WriteTestSpriteSet(images, kSprCompress_None);
+    std::vector<SpriteInfo> infos;
+    SpriteCache cache(infos, SpriteCache::Callbacks());
+    ASSERT_TRUE(cache.InitFile(File::OpenFileRead(SpriteTestFile), nullptr));
+    ASSERT_TRUE(cache.MapFile(SpriteTestFile, 0, File::GetFileSize(SpriteTestFile)));
+
+    // Sprite 0 is always locked in cache, others are not
+    const sprkey_t mapped[] = { 0, 1, 4 };
+    for (const auto index : mapped)
+    {
+        ASSERT_TRUE(cache[index]->IsReadOnly());
+        const size_t cache_size = cache.GetCacheSize();
+        const size_t locked_size = cache.GetLockedSize();
+        // A sprite requested for writing (as given to plugins) is a copy
+        // in cache, which replaces the mapped one
+        Bitmap *sprite = cache.GetSpriteForWriting(index);
+        ASSERT_FALSE(sprite->IsReadOnly());
+        AssertSameBitmaps(sprite, images[index].get());
+        ASSERT_EQ(cache[index], sprite);
+        ASSERT_EQ(cache.GetSpriteForWriting(index), sprite);
+        ASSERT_EQ(cache.GetCacheSize(), cache_size);
+        ASSERT_EQ(cache.GetLockedSize(), locked_size);
+        // The copy may be modified
+        sprite->PutPixel(0, 0, 0x5A);
+        ASSERT_EQ(sprite->GetPixel(0, 0), 0x5A);
+    }
+    // Sprites that do not reference the file are returned as is
+    ASSERT_TRUE(cache.SetSprite(6, CreateTestSprite(3, 3, 32, 5)));
+    Bitmap *sprite = cache[6];
+    ASSERT_FALSE(sprite->IsReadOnly());
+    ASSERT_EQ(cache.GetSpriteForWriting(6), sprite);
+}
+
+TEST_F(SpriteFileTest, WriteWithThreads) {
+    // A larger set of sprites of various formats, so that the worker threads
+    // have to finish the jobs in an order different from the sprite order
+    std::vector<std::unique_ptr<Bitmap>> images;
+    const int color_depths[] = { 8, 16, 32 };
+    for (int i = 0; i < 40; ++i)
+    {
+        if (i % 7 == 3)
+            images.push_back(nullptr);
+        else
+            images.push_back(CreateTestSprite(1 + (i * 13) % 50, 1 + (i * 7) % 30,
+                color_depths[i % 3], i));
+    }
+
+    // The file written by the worker threads must be exactly the same as
+    // the one written on the calling thread
+    const SpriteCompression compress[] = { kSprCompress_RLE, kSprCompress_LZW, kSprCompress_LZ4,
+        kSprCompress_Deflate };
+    const int store_flags[] = { 0, kSprStore_OptimizeForSize };
+    for (const auto c : compress)
+    {
+        for (const auto flags : store_flags)
+        {
+            WriteTestSpriteSet(images, c, 0, flags, SpriteTestFile);
+            WriteTestSpriteSet(images, c, 4, flags, SpriteTestFile2);
+            std::vector<uint8_t> data1 = ReadFileData(SpriteTestFile);
+            std::vector<uint8_t> data2 = ReadFileData(SpriteTestFile2);
+            ASSERT_GT(data1.size(), 0u);
+            ASSERT_EQ(data1.size(), data2.size());
+            // Skip the file ID, which is generated from the current time
+            const size_t id_offset = 16; // after version, signature and compression type
+            std::fill(data1.begin() + id_offset, data1.begin() + id_offset + 4, 0);
+            std::fill(data2.begin() + id_offset, data2.begin() + id_offset + 4, 0);
+            ASSERT_TRUE(data1 == data2) << "compression " << c << ", flags " << flags;
+        }
+    }
+}
+
+#endif // AGS_PLATFORM_TEST_FILE_IO
@@ -20,6 +20,7 @@
 #include "util/deflatestream.h"
 #include "util/file.h"
 #include "util/filestream.h"
+#include "util/mappedfile.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 #include "util/string_utils.h"
@@ -742,4 +743,41 @@ TEST_F(FileBasedTest, BufferedSectionStream) {
     File::DeleteFile(DummyFile);
 }
 
+TEST_F(FileBasedTest, MappedFile) {
+    if (!MappedFile::IsSupported())
+        return;
+
+    //-------------------------------------------------------------------------
+    // Write data into the temp file
+    const size_t file_size = 3 * BufferedStream::BufferSize + 7;
+    std::vector<uint8_t> data(file_size);
+    for (size_t i = 0; i < file_size; ++i)
+        data[i] = static_cast<uint8_t>(i * 7 + i / 256);
+    Stream out(std::make_unique<FileStream>(DummyFile, kFile_CreateAlways, kStream_Write));
+    out.Write(data.data(), data.size());
+    out.Close();
+
+    //-------------------------------------------------------------------------
+    // Map whole file
+    MappedFile map;
+    ASSERT_FALSE(map.IsOpen());
+    ASSERT_TRUE(map.Open(DummyFile));
+    ASSERT_TRUE(map.IsOpen());
+    ASSERT_EQ(map.GetSize(), file_size);
+    ASSERT_EQ(memcmp(map.GetData(), data.data(), file_size), 0);
+    // Map a section at unaligned offset; size is limited by the file's end
+    const soff_t section_start = BufferedStream::BufferSize + 3;
+    ASSERT_TRUE(map.Open(DummyFile, section_start, file_size));
+    ASSERT_EQ(map.GetSize(), file_size - section_start);
+    ASSERT_EQ(memcmp(map.GetData(), data.data() + section_start, map.GetSize()), 0);
+    map.Close();
+    ASSERT_FALSE(map.IsOpen());
+    ASSERT_EQ(map.GetData(), nullptr);
+    // Invalid requests
+    ASSERT_FALSE(map.Open(DummyFile, file_size + 1));
+    ASSERT_FALSE(map.Open("nonexistent.dat"));
+
+    File::DeleteFile(DummyFile);
+}
+
 #endif // AGS_PLATFORM_TEST_FILE_IO
@@ -0,0 +1,54 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+
+TEST(ThreadPool, Run) {
+    ThreadPool pool;
+    ASSERT_EQ(pool.GetThreadCount(), 0u);
+    const size_t thread_counts[] = { 0u, 1u, 3u, 0u };
+    for (size_t threads : thread_counts)
+    {
+        pool.SetThreadCount(threads);
+        for (size_t count = 0; count < 20; ++count)
+        {
+            std::vector<int> done(count, 0);
+            pool.Run(count, [&done](size_t index) { done[index]++; });
+            ASSERT_EQ(done, std::vector<int>(count, 1));
+        }
+    }
+}
+
+TEST(ThreadPool, Exception) {
+    ThreadPool pool;
+    pool.SetThreadCount(2);
+    std::atomic<int> done(0);
+    ASSERT_THROW(pool.Run(10, [&done](size_t index)
+        {
+            if (index == 5)
+                throw std::runtime_error("task failed");
+            done++;
+        }), std::runtime_error);
+    // all the other tasks are still run
+    ASSERT_EQ(done, 9);
+    // the pool may be used again
+    done = 0;
+    pool.Run(10, [&done](size_t) { done++; });
+    ASSERT_EQ(done, 10);
+}
@@ -0,0 +1,331 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// BTreeMap and BTreeSet are sorted containers, made as a B+ tree of a fixed
+// height: a sorted index of leaf nodes, where each leaf keeps a sorted array
+// of up to MaxLeafSize entries. The index keeps a copy of each leaf's last key
+// in a contiguous array. Lookups do a binary search over the index and then
+// inside a leaf, which touches much fewer memory locations than the
+// red-black tree of std::map, and entries take no per-entry allocations.
+// A full leaf is split in two; a leaf that became too small after erasing is
+// merged with its neighbour.
+//
+// The key operations are defined by TKeyTraits, which may accept a lookup
+// type different from the stored key type (e.g. a plain C-string for the
+// string keys). TKeyTraits must provide following static functions:
+//   int Compare(const TKey &stored, const TLookup &key); // as strcmp
+//   TKey MakeKey(const TLookup &key);
+//
+// NOTE: unlike std::map, inserting or erasing an entry invalidates all
+// iterators and references to the entries.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__BTREE_H
+#define __AGS_CN_UTIL__BTREE_H
+
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace BTreeDetail
+{
+    // Gets a key from the tree entry; for maps the key is pair's first
+    template <typename TKey>
+    inline const TKey &EntryKey(const TKey &entry) { return entry; }
+    template <typename TKey, typename TValue>
+    inline const TKey &EntryKey(const std::pair<TKey, TValue> &entry) { return entry.first; }
+    // Assigns a key to the tree entry
+    template <typename TKey>
+    inline void SetEntryKey(TKey &entry, TKey &&key) { entry = std::move(key); }
+    template <typename TKey, typename TValue>
+    inline void SetEntryKey(std::pair<TKey, TValue> &entry, TKey &&key) { entry.first = std::move(key); }
+} // namespace BTreeDetail
+
+
+template <typename TKey, typename TEntry, typename TKeyTraits>
+class BTreeTable
+{
+    typedef std::vector<TEntry> Leaf;
+
+    template <typename TTable, typename TItem>
+    class IteratorT
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef TItem value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef TItem* pointer;
+        typedef TItem& reference;
+
+        IteratorT() = default;
+        IteratorT(TTable *table, size_t leaf, size_t index)
+            : _table(table), _leaf(leaf), _index(index) {}
+        // Allows converting iterator to const_iterator
+        template <typename TOtherTable, typename TOtherItem>
+        IteratorT(const IteratorT<TOtherTable, TOtherItem> &it)
+            : _table(it._table), _leaf(it._leaf), _index(it._index) {}
+
+        TItem &operator *() const { return _table->_leaves[_leaf][_index]; }
+        TItem *operator ->() const { return &_table->_leaves[_leaf][_index]; }
+        IteratorT &operator ++()
+        {
+            if (++_index == _table->_leaves[_leaf].size())
+            {
+                _leaf++;
+                _index = 0u;
+            }
+            return *this;
+        }
+        IteratorT operator ++(int)
+        {
+            IteratorT it = *this;
+            ++(*this);
+            return it;
+        }
+        bool operator ==(const IteratorT &it) const { return _leaf == it._leaf && _index == it._index; }
+        bool operator !=(const IteratorT &it) const { return !(*this == it); }
+
+    private:
+        template <typename, typename> friend class IteratorT;
+        friend class BTreeTable;
+
+        TTable *_table = nullptr;
+        size_t  _leaf = 0u;
+        size_t  _index = 0u;
+    };
+
+public:
+    typedef TKey key_type;
+    typedef TEntry value_type;
+    typedef IteratorT<BTreeTable, TEntry> iterator;
+    typedef IteratorT<const BTreeTable, const TEntry> const_iterator;
+
+    // Max number of entries in a leaf
+    static const size_t MaxLeafSize = 64u;
+
+    BTreeTable() = default;
+
+    iterator begin() { return iterator(this, 0u, 0u); }
+    iterator end() { return iterator(this, _leaves.size(), 0u); }
+    const_iterator begin() const { return const_iterator(this, 0u, 0u); }
+    const_iterator end() const { return const_iterator(this, _leaves.size(), 0u); }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0u; }
+
+    void clear()
+    {
+        _leaves.clear();
+        _lastKeys.clear();
+        _count = 0u;
+    }
+
+    template <typename TLookup>
+    iterator find(const TLookup &key)
+    {
+        const auto pos = FindPos(key);
+        return pos.second ? iterator(this, pos.first.first, pos.first.second) : end();
+    }
+
+    template <typename TLookup>
+    const_iterator find(const TLookup &key) const
+    {
+        const auto pos = FindPos(key);
+        return pos.second ? const_iterator(this, pos.first.first, pos.first.second) : end();
+    }
+
+    template <typename TLookup>
+    size_t count(const TLookup &key) const
+    {
+        return FindPos(key).second ? 1u : 0u;
+    }
+
+    void erase(const_iterator it)
+    {
+        Leaf &leaf = _leaves[it._leaf];
+        leaf.erase(leaf.begin() + it._index);
+        _count--;
+        if (leaf.empty())
+        {
+            _leaves.erase(_leaves.begin() + it._leaf);
+            _lastKeys.erase(_lastKeys.begin() + it._leaf);
+            return;
+        }
+        if (it._index == leaf.size())
+            UpdateLastKey(it._leaf);
+        if (leaf.size() < MaxLeafSize / 4)
+        {
+            if (it._leaf + 1 < _leaves.size())
+                TryMerge(it._leaf);
+            else if (it._leaf > 0u)
+                TryMerge(it._leaf - 1);
+        }
+    }
+
+protected:
+    // Finds a position for the key, adds a new entry if there's no such key;
+    // returns the entry's position and whether a new entry was added
+    template <typename TLookup>
+    std::pair<iterator, bool> FindOrAdd(const TLookup &key)
+    {
+        auto pos = FindPos(key);
+        if (pos.second)
+            return std::make_pair(iterator(this, pos.first.first, pos.first.second), false);
+
+        if (_leaves.empty())
+        {
+            _leaves.push_back(Leaf());
+            _leaves.back().reserve(MaxLeafSize);
+            _lastKeys.push_back(TKey());
+        }
+        // If the key is greater than all the others, add to the last leaf
+        size_t leaf_index = pos.first.first, index = pos.first.second;
+        if (leaf_index == _leaves.size())
+        {
+            leaf_index = _leaves.size() - 1;
+            index = _leaves[leaf_index].size();
+        }
+        if (_leaves[leaf_index].size() == MaxLeafSize)
+        {
+            // Split the full leaf in two halves
+            const size_t half = MaxLeafSize / 2;
+            Leaf right;
+            right.reserve(MaxLeafSize);
+            Leaf &left = _leaves[leaf_index];
+            for (size_t i = half; i < left.size(); ++i)
+                right.push_back(std::move(left[i]));
+            left.resize(half);
+            _leaves.insert(_leaves.begin() + leaf_index + 1, std::move(right));
+            _lastKeys.insert(_lastKeys.begin() + leaf_index + 1, TKey());
+            UpdateLastKey(leaf_index);
+            UpdateLastKey(leaf_index + 1);
+            if (index > half)
+            {
+                leaf_index++;
+                index -= half;
+            }
+        }
+        Leaf &leaf = _leaves[leaf_index];
+        leaf.insert(leaf.begin() + index, TEntry());
+        BTreeDetail::SetEntryKey<TKey>(leaf[index], TKeyTraits::MakeKey(key));
+        if (index + 1 == leaf.size())
+            UpdateLastKey(leaf_index);
+        _count++;
+        return std::make_pair(iterator(this, leaf_index, index), true);
+    }
+
+private:
+    template <typename TLookup>
+    static int CompareEntry(const TEntry &entry, const TLookup &key)
+    {
+        return TKeyTraits::Compare(BTreeDetail::EntryKey<TKey>(entry), key);
+    }
+
+    // Finds the first entry which is not less than the key; returns its
+    // (leaf, index) position, and whether it's equal to the key
+    template <typename TLookup>
+    std::pair<std::pair<size_t, size_t>, bool> FindPos(const TLookup &key) const
+    {
+        // Find the first leaf which last entry is not less than the key
+        size_t lo = 0u, hi = _lastKeys.size();
+        while (lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            if (TKeyTraits::Compare(_lastKeys[mid], key) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == _leaves.size())
+            return std::make_pair(std::make_pair(lo, size_t(0u)), false);
+        // Find the first entry in this leaf which is not less than the key
+        const Leaf &leaf = _leaves[lo];
+        size_t first = 0u, last = leaf.size();
+        while (first < last)
+        {
+            const size_t mid = (first + last) / 2;
+            if (CompareEntry(leaf[mid], key) < 0)
+                first = mid + 1;
+            else
+                last = mid;
+        }
+        return std::make_pair(std::make_pair(lo, first), CompareEntry(leaf[first], key) == 0);
+    }
+
+    // Merges the leaf with the next one, if their entries fit in a half-full
+    // leaf, which leaves space for the new entries
+    void TryMerge(size_t leaf_index)
+    {
+        Leaf &left = _leaves[leaf_index];
+        Leaf &right = _leaves[leaf_index + 1];
+        if (left.size() + right.size() > MaxLeafSize / 2)
+            return;
+        for (auto &entry : right)
+            left.push_back(std::move(entry));
+        _leaves.erase(_leaves.begin() + leaf_index + 1);
+        _lastKeys.erase(_lastKeys.begin() + leaf_index);
+    }
+
+    void UpdateLastKey(size_t leaf_index)
+    {
+        _lastKeys[leaf_index] = BTreeDetail::EntryKey<TKey>(_leaves[leaf_index].back());
+    }
+
+    std::vector<Leaf> _leaves;
+    std::vector<TKey> _lastKeys; // last key of each leaf
+    size_t _count = 0u;
+};
+
+
+template <typename TKey, typename TValue, typename TKeyTraits>
+class BTreeMap : public BTreeTable<TKey, std::pair<TKey, TValue>, TKeyTraits>
+{
+    typedef BTreeTable<TKey, std::pair<TKey, TValue>, TKeyTraits> BaseTable;
+public:
+    typedef TValue mapped_type;
+
+    // Returns the value for the given key, adds a default value if the key
+    // is not in the map yet
+    template <typename TLookup>
+    TValue &operator [](const TLookup &key)
+    {
+        return BaseTable::FindOrAdd(key).first->second;
+    }
+};
+
+
+template <typename TKey, typename TKeyTraits>
+class BTreeSet : public BTreeTable<TKey, TKey, TKeyTraits>
+{
+    typedef BTreeTable<TKey, TKey, TKeyTraits> BaseTable;
+public:
+    // Adds the key to the set; returns the key's position and whether
+    // it was added (false if it was in the set already)
+    template <typename TLookup>
+    std::pair<typename BaseTable::iterator, bool> insert(const TLookup &key)
+    {
+        return BaseTable::FindOrAdd(key);
+    }
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__BTREE_H
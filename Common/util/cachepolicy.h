@@ -0,0 +1,332 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Eviction policies for the ResourceCache. A policy tracks the items which
+// may be disposed to free cache space, and decides which one goes first.
+// Locked and external items are never passed to the policy.
+//
+// Available policies:
+//  - LRU: disposes the least recently used item.
+//  - LRU-2: disposes the item whose second-to-last use was longest ago,
+//    and the items used only once before any others. This protects the
+//    items used regularly from being pushed out by a series of items used
+//    once (e.g. a sequence of large room backgrounds). The history of the
+//    disposed items is remembered for some time, so that an item which is
+//    loaded again soon after disposal is recognized as a frequent one.
+//  - GreedyDual: a size-aware policy (GreedyDual-Size with Frequency).
+//    Each item gets a priority of L + uses / size, where L is the "age" of
+//    the cache, which is raised to the priority of each disposed item.
+//    Large items get disposed before small ones, unless used much more
+//    often, while L lets the items which were not used for long to age out.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__CACHEPOLICY_H
+#define __AGS_CN_UTIL__CACHEPOLICY_H
+
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+enum CachePolicyType
+{
+    kCachePolicy_LRU,
+    kCachePolicy_LRU2,
+    kCachePolicy_GreedyDual,
+    kNumCachePolicies
+};
+
+template <typename TKey, typename TSize, typename HashFn = std::hash<TKey>>
+class CachePolicy
+{
+public:
+    virtual ~CachePolicy() = default;
+
+    // Starts tracking the item, which may be disposed from now on
+    virtual void Add(const TKey &key, TSize size) = 0;
+    // Registers a use of the tracked item
+    virtual void Touch(const TKey &key) = 0;
+    // Stops tracking the item, e.g. when it's removed from cache or locked
+    virtual void Remove(const TKey &key) = 0;
+    // Chooses the item to dispose, and stops tracking it;
+    // returns false if there are no tracked items
+    virtual bool Evict(TKey &key) = 0;
+    // Forgets all the items and the history
+    virtual void Clear() = 0;
+    // Tells whether there are any tracked items
+    virtual bool IsEmpty() const = 0;
+};
+
+
+template <typename TKey, typename TSize, typename HashFn = std::hash<TKey>>
+class LRUCachePolicy : public CachePolicy<TKey, TSize, HashFn>
+{
+public:
+    void Add(const TKey &key, TSize /*size*/) override
+    {
+        _index[key] = _list.insert(_list.begin(), key);
+    }
+
+    void Touch(const TKey &key) override
+    {
+        auto it = _index.find(key);
+        if (it != _index.end())
+            _list.splice(_list.begin(), _list, it->second);
+    }
+
+    void Remove(const TKey &key) override
+    {
+        auto it = _index.find(key);
+        if (it == _index.end())
+            return;
+        _list.erase(it->second);
+        _index.erase(it);
+    }
+
+    bool Evict(TKey &key) override
+    {
+        if (_list.empty())
+            return false;
+        key = _list.back();
+        _index.erase(key);
+        _list.pop_back();
+        return true;
+    }
+
+    void Clear() override
+    {
+        _list.clear();
+        _index.clear();
+    }
+
+    bool IsEmpty() const override { return _list.empty(); }
+
+private:
+    // Items ordered by the last use, most recent first
+    std::list<TKey> _list;
+    std::unordered_map<TKey, typename std::list<TKey>::iterator, HashFn> _index;
+};
+
+
+template <typename TKey, typename TSize, typename HashFn = std::hash<TKey>>
+class LRU2CachePolicy : public CachePolicy<TKey, TSize, HashFn>
+{
+public:
+    void Add(const TKey &key, TSize /*size*/) override
+    {
+        TItem item;
+        // If the item was used not long ago, then continue its history
+        auto hist = _history.find(key);
+        if (hist != _history.end())
+        {
+            item.Prev = hist->second;
+            _history.erase(hist);
+        }
+        item.Last = ++_tick;
+        item.OrderIt = _order.insert(std::make_pair(std::make_pair(item.Prev, item.Last), key)).first;
+        _items[key] = item;
+    }
+
+    void Touch(const TKey &key) override
+    {
+        auto it = _items.find(key);
+        if (it == _items.end())
+            return;
+        TItem &item = it->second;
+        ++_tick;
+        // Uses in quick succession are counted as one
+        if (_tick - item.Last > CorrelatedPeriod)
+            item.Prev = item.Last;
+        item.Last = _tick;
+        _order.erase(item.OrderIt);
+        item.OrderIt = _order.insert(std::make_pair(std::make_pair(item.Prev, item.Last), key)).first;
+    }
+
+    void Remove(const TKey &key) override
+    {
+        auto it = _items.find(key);
+        if (it == _items.end())
+            return;
+        RemoveImpl(it);
+    }
+
+    bool Evict(TKey &key) override
+    {
+        if (_order.empty())
+            return false;
+        key = _order.begin()->second;
+        RemoveImpl(_items.find(key));
+        return true;
+    }
+
+    void Clear() override
+    {
+        _order.clear();
+        _items.clear();
+        _history.clear();
+        _historyQueue.clear();
+    }
+
+    bool IsEmpty() const override { return _order.empty(); }
+
+private:
+    // Time is counted in uses of any item
+    typedef uint64_t TTick;
+    // Order key: the second-to-last and the last use
+    typedef std::map<std::pair<TTick, TTick>, TKey> TOrder;
+
+    struct TItem
+    {
+        TTick Prev = 0u; // second-to-last use, 0 if was used once
+        TTick Last = 0u; // last use
+        typename TOrder::iterator OrderIt;
+    };
+
+    // Max distance between uses which are counted as one
+    static const TTick CorrelatedPeriod = 16u;
+    // Max number of the removed items to remember
+    static const size_t MaxHistory = 4096u;
+
+    void RemoveImpl(typename std::unordered_map<TKey, TItem, HashFn>::iterator it)
+    {
+        // Remember when the item was last used
+        _history[it->first] = it->second.Last;
+        _historyQueue.push_back(std::make_pair(it->first, it->second.Last));
+        if (_historyQueue.size() > MaxHistory)
+        {
+            const auto &oldest = _historyQueue.front();
+            auto hist = _history.find(oldest.first);
+            // the record could have been replaced by the newer one
+            if (hist != _history.end() && hist->second == oldest.second)
+                _history.erase(hist);
+            _historyQueue.pop_front();
+        }
+        _order.erase(it->second.OrderIt);
+        _items.erase(it);
+    }
+
+    TTick _tick = 0u;
+    // Tracked items, ordered by the eviction priority
+    TOrder _order;
+    std::unordered_map<TKey, TItem, HashFn> _items;
+    // The last use of the recently removed items
+    std::unordered_map<TKey, TTick, HashFn> _history;
+    // History records in the order of addition, for trimming the history
+    std::deque<std::pair<TKey, TTick>> _historyQueue;
+};
+
+
+template <typename TKey, typename TSize, typename HashFn = std::hash<TKey>>
+class GreedyDualCachePolicy : public CachePolicy<TKey, TSize, HashFn>
+{
+public:
+    void Add(const TKey &key, TSize size) override
+    {
+        TItem item;
+        item.Size = size > 0u ? static_cast<double>(size) : 1.0;
+        item.OrderIt = _order.insert(std::make_pair(GetPriority(item), key));
+        _items[key] = item;
+    }
+
+    void Touch(const TKey &key) override
+    {
+        auto it = _items.find(key);
+        if (it == _items.end())
+            return;
+        TItem &item = it->second;
+        item.Uses++;
+        _order.erase(item.OrderIt);
+        item.OrderIt = _order.insert(std::make_pair(GetPriority(item), key));
+    }
+
+    void Remove(const TKey &key) override
+    {
+        auto it = _items.find(key);
+        if (it == _items.end())
+            return;
+        _order.erase(it->second.OrderIt);
+        _items.erase(it);
+    }
+
+    bool Evict(TKey &key) override
+    {
+        if (_order.empty())
+            return false;
+        auto first = _order.begin();
+        _age = first->first; // age the rest of the items
+        key = first->second;
+        _items.erase(key);
+        _order.erase(first);
+        return true;
+    }
+
+    void Clear() override
+    {
+        _order.clear();
+        _items.clear();
+        _age = 0.0;
+    }
+
+    bool IsEmpty() const override { return _order.empty(); }
+
+private:
+    typedef std::multimap<double, TKey> TOrder;
+
+    struct TItem
+    {
+        double   Size = 1.0;
+        uint32_t Uses = 1u;
+        typename TOrder::iterator OrderIt;
+    };
+
+    double GetPriority(const TItem &item) const
+    {
+        return _age + item.Uses / item.Size;
+    }
+
+    // Cache's "age", the priority of the last disposed item
+    double _age = 0.0;
+    // Tracked items, ordered by the eviction priority, lowest first
+    TOrder _order;
+    std::unordered_map<TKey, TItem, HashFn> _items;
+};
+
+
+// Creates the eviction policy of the given type
+template <typename TKey, typename TSize, typename HashFn = std::hash<TKey>>
+std::unique_ptr<CachePolicy<TKey, TSize, HashFn>> CreateCachePolicy(CachePolicyType type)
+{
+    switch (type)
+    {
+    case kCachePolicy_LRU2:
+        return std::unique_ptr<CachePolicy<TKey, TSize, HashFn>>(new LRU2CachePolicy<TKey, TSize, HashFn>());
+    case kCachePolicy_GreedyDual:
+        return std::unique_ptr<CachePolicy<TKey, TSize, HashFn>>(new GreedyDualCachePolicy<TKey, TSize, HashFn>());
+    default:
+        return std::unique_ptr<CachePolicy<TKey, TSize, HashFn>>(new LRUCachePolicy<TKey, TSize, HashFn>());
+    }
+}
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__CACHEPOLICY_H
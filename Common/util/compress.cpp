@@ -14,10 +14,14 @@
 #include "util/compress.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
 #include <vector>
 #include <miniz.h>
 #include "ac/common.h"	// quit, update_polled_stuff
 #include "gfx/bitmap.h"
+#include "util/lz4.h"
 #include "util/lzw.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
@@ -345,6 +349,9 @@ bool lzw_compress(const uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream
         out->Write(data, data_sz);
         return true;
     }
+    // lzwcompress uses global state, so may not run on several threads at once
+    static std::mutex lzw_mutex;
+    std::lock_guard<std::mutex> lk(lzw_mutex);
     Stream mem_in(std::make_unique<MemoryStream>(data, data_sz));
     return lzwcompress(&mem_in, out);
 }
@@ -525,3 +532,71 @@ bool inflate_decompress(uint8_t* data, size_t data_sz, int /*image_bpp*/, Stream
     in->Read(in_buf.data(), in_sz);
     return z_inflate(in_buf.data(), in_sz, data, data_sz);
 }
+
+//-----------------------------------------------------------------------------
+// LZ4
+//-----------------------------------------------------------------------------
+
+// The data is split into blocks compressed independently, so that the
+// compressor's and decompressor's working set stays within a CPU cache.
+// For images, blocks contain whole rows.
+// Format: raw block size (int32), followed by the sequence of blocks, each
+// is the compressed size (int32) and LZ4 block data.
+static const size_t LZ4BlockSize = 64 * 1024;
+
+static size_t lz4_read_size(const uint8_t *ptr)
+{
+    int32_t val;
+    memcpy(&val, ptr, sizeof(val));
+    return static_cast<uint32_t>(BBOp::Int32FromLE(val));
+}
+
+bool lz4_compress(const uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *out, size_t row_sz)
+{
+    const size_t block_sz = (row_sz > 0) ?
+        std::max<size_t>(1, LZ4BlockSize / row_sz) * row_sz : LZ4BlockSize;
+    out->WriteInt32(block_sz);
+    std::vector<uint8_t> out_buf(lz4_compress_bound(std::min(data_sz, block_sz)));
+    for (size_t pos = 0; pos < data_sz; pos += block_sz)
+    {
+        const size_t in_sz = std::min(data_sz - pos, block_sz);
+        const size_t comp_sz = lz4_compress_block(data + pos, in_sz, out_buf.data(), out_buf.size());
+        if (comp_sz == 0)
+            return false;
+        out->WriteInt32(comp_sz);
+        out->Write(out_buf.data(), comp_sz);
+    }
+    return true;
+}
+
+bool lz4_decompress(uint8_t *data, size_t data_sz, const uint8_t *in_buf, size_t in_sz)
+{
+    if (in_sz < sizeof(uint32_t))
+        return false;
+    const size_t block_sz = lz4_read_size(in_buf);
+    if (block_sz == 0)
+        return false;
+    const uint8_t *in_ptr = in_buf + sizeof(uint32_t);
+    const uint8_t *in_end = in_buf + in_sz;
+    for (size_t pos = 0; pos < data_sz; pos += block_sz)
+    {
+        if (static_cast<size_t>(in_end - in_ptr) < sizeof(uint32_t))
+            return false;
+        const size_t comp_sz = lz4_read_size(in_ptr);
+        in_ptr += sizeof(uint32_t);
+        if (comp_sz > static_cast<size_t>(in_end - in_ptr))
+            return false;
+        if (!lz4_decompress_block(in_ptr, comp_sz, data + pos, std::min(data_sz - pos, block_sz)))
+            return false;
+        in_ptr += comp_sz;
+    }
+    return true;
+}
+
+bool lz4_decompress(uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *in, size_t in_sz)
+{
+    std::vector<uint8_t> in_buf(in_sz);
+    if (in->Read(in_buf.data(), in_sz) != in_sz)
+        return false;
+    return lz4_decompress(data, data_sz, in_buf.data(), in_sz);
+}
@@ -45,4 +45,12 @@ std::unique_ptr<Common::Bitmap> load_lzw(Common::Stream *in, int dst_bpp, RGB (*
 bool deflate_compress(const uint8_t* data, size_t data_sz, int image_bpp, Common::Stream* out);
 bool inflate_decompress(uint8_t* data, size_t data_sz, int image_bpp, Common::Stream* in, size_t in_sz);
 
+// LZ4 compression
+// Compresses data in blocks of whole rows, if the row size is given, so that
+// every block may be decompressed independently into its own scanlines
+bool lz4_compress(const uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *out, size_t row_sz = 0);
+bool lz4_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *in, size_t in_sz);
+// Decompresses LZ4 data from the memory buffer
+bool lz4_decompress(uint8_t *data, size_t data_sz, const uint8_t *in_buf, size_t in_sz);
+
 #endif // __AC_COMPRESS_H
@@ -0,0 +1,271 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// FlatHashMap and FlatHashSet are open-addressing hash tables with linear
+// probing. The entries are stored densely in a single array, without
+// per-entry allocations; the table of slots only keeps 32-bit hashes and
+// entry indexes. Probing scans the slots, and only compares the keys when
+// hashes match. The hashes are also reused when the table grows, so the keys
+// are never hashed again. Erasing an entry shifts the following slots of
+// the same probe sequence back, so the table does not accumulate tombstones,
+// and moves the last entry in place of the erased one.
+//
+// The key operations are defined by TKeyTraits, which may accept a lookup
+// type different from the stored key type (e.g. a plain C-string for the
+// string keys). TKeyTraits must provide following static functions:
+//   uint32_t Hash(const TLookup &key);
+//   bool Equals(const TKey &stored, const TLookup &key);
+//   TKey MakeKey(const TLookup &key);
+//
+// NOTE: unlike std::unordered_map, inserting or erasing an entry invalidates
+// all iterators and references to the entries.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__FLATHASH_H
+#define __AGS_CN_UTIL__FLATHASH_H
+
+#include <utility>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace FlatHashDetail
+{
+    // Gets a key from the table entry; for maps the key is pair's first
+    template <typename TKey>
+    inline const TKey &EntryKey(const TKey &entry) { return entry; }
+    template <typename TKey, typename TValue>
+    inline const TKey &EntryKey(const std::pair<TKey, TValue> &entry) { return entry.first; }
+    // Assigns a key to the table entry
+    template <typename TKey>
+    inline void SetEntryKey(TKey &entry, TKey &&key) { entry = std::move(key); }
+    template <typename TKey, typename TValue>
+    inline void SetEntryKey(std::pair<TKey, TValue> &entry, TKey &&key) { entry.first = std::move(key); }
+} // namespace FlatHashDetail
+
+
+template <typename TKey, typename TEntry, typename TKeyTraits>
+class FlatHashTable
+{
+public:
+    typedef TKey key_type;
+    typedef TEntry value_type;
+    // Entries are stored without gaps, so they may be iterated directly
+    typedef typename std::vector<TEntry>::iterator iterator;
+    typedef typename std::vector<TEntry>::const_iterator const_iterator;
+
+    FlatHashTable() = default;
+
+    iterator begin() { return _entries.begin(); }
+    iterator end() { return _entries.end(); }
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+
+    size_t size() const { return _entries.size(); }
+    bool empty() const { return _entries.empty(); }
+
+    void clear()
+    {
+        _slots.clear();
+        _entries.clear();
+        _hashes.clear();
+    }
+
+    // Prepares the table for storing the given number of entries
+    void reserve(size_t count)
+    {
+        size_t capacity = MinCapacity;
+        while (count > capacity / 4 * 3)
+            capacity *= 2;
+        if (capacity > _slots.size())
+            Rehash(capacity);
+        _entries.reserve(count);
+        _hashes.reserve(count);
+    }
+
+    template <typename TLookup>
+    iterator find(const TLookup &key)
+    {
+        return _entries.begin() + FindIndex(key);
+    }
+
+    template <typename TLookup>
+    const_iterator find(const TLookup &key) const
+    {
+        return _entries.begin() + FindIndex(key);
+    }
+
+    template <typename TLookup>
+    size_t count(const TLookup &key) const
+    {
+        return FindIndex(key) != _entries.size() ? 1u : 0u;
+    }
+
+    void erase(const_iterator it)
+    {
+        EraseAt(static_cast<uint32_t>(it - _entries.begin()));
+    }
+
+protected:
+    // Finds an entry for the key, adds a new entry if there's no such key;
+    // returns the entry's position and whether a new entry was added
+    template <typename TLookup>
+    std::pair<iterator, bool> FindOrAdd(const TLookup &key)
+    {
+        if (_entries.size() + 1 > _slots.size() / 4 * 3)
+            Rehash(_slots.empty() ? MinCapacity : _slots.size() * 2);
+        const uint32_t hash = NormalizeHash(TKeyTraits::Hash(key));
+        const size_t mask = _slots.size() - 1;
+        size_t pos = hash & mask;
+        for (; _slots[pos].Hash != 0u; pos = (pos + 1) & mask)
+        {
+            const Slot &slot = _slots[pos];
+            if (slot.Hash == hash &&
+                TKeyTraits::Equals(FlatHashDetail::EntryKey<TKey>(_entries[slot.Index]), key))
+                return std::make_pair(_entries.begin() + slot.Index, false);
+        }
+        const uint32_t index = static_cast<uint32_t>(_entries.size());
+        _slots[pos].Hash = hash;
+        _slots[pos].Index = index;
+        _entries.push_back(TEntry());
+        _hashes.push_back(hash);
+        FlatHashDetail::SetEntryKey<TKey>(_entries.back(), TKeyTraits::MakeKey(key));
+        return std::make_pair(_entries.begin() + index, true);
+    }
+
+private:
+    struct Slot
+    {
+        uint32_t Hash = 0u;  // entry's hash, 0 marks an empty slot
+        uint32_t Index = 0u; // entry's index
+    };
+
+    static const size_t MinCapacity = 16u; // must be a power of 2
+
+    // Zero hash is reserved for the empty slots
+    static uint32_t NormalizeHash(uint32_t hash) { return hash != 0u ? hash : 1u; }
+
+    // Returns the entry's index, or the number of entries if not found
+    template <typename TLookup>
+    size_t FindIndex(const TLookup &key) const
+    {
+        if (_entries.empty())
+            return _entries.size();
+        const uint32_t hash = NormalizeHash(TKeyTraits::Hash(key));
+        const size_t mask = _slots.size() - 1;
+        for (size_t pos = hash & mask; _slots[pos].Hash != 0u; pos = (pos + 1) & mask)
+        {
+            const Slot &slot = _slots[pos];
+            if (slot.Hash == hash &&
+                TKeyTraits::Equals(FlatHashDetail::EntryKey<TKey>(_entries[slot.Index]), key))
+                return slot.Index;
+        }
+        return _entries.size();
+    }
+
+    // Finds the slot which references the entry of the given index
+    size_t FindSlot(uint32_t index) const
+    {
+        const size_t mask = _slots.size() - 1;
+        size_t pos = _hashes[index] & mask;
+        for (; _slots[pos].Index != index || _slots[pos].Hash == 0u; pos = (pos + 1) & mask);
+        return pos;
+    }
+
+    void EraseAt(uint32_t index)
+    {
+        // Shift back the following slots, which may be found from
+        // the freed slot's position, until the end of probe sequence
+        const size_t mask = _slots.size() - 1;
+        size_t hole = FindSlot(index);
+        for (size_t next = (hole + 1) & mask; _slots[next].Hash != 0u; next = (next + 1) & mask)
+        {
+            const size_t home = _slots[next].Hash & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                _slots[hole] = _slots[next];
+                hole = next;
+            }
+        }
+        _slots[hole] = Slot();
+        // Move the last entry in place of the erased one
+        const uint32_t last = static_cast<uint32_t>(_entries.size() - 1);
+        if (index != last)
+        {
+            _slots[FindSlot(last)].Index = index;
+            _entries[index] = std::move(_entries[last]);
+            _hashes[index] = _hashes[last];
+        }
+        _entries.pop_back();
+        _hashes.pop_back();
+    }
+
+    void Rehash(size_t capacity)
+    {
+        _slots.assign(capacity, Slot());
+        const size_t mask = capacity - 1;
+        for (uint32_t i = 0; i < _hashes.size(); ++i)
+        {
+            size_t pos = _hashes[i] & mask;
+            for (; _slots[pos].Hash != 0u; pos = (pos + 1) & mask);
+            _slots[pos].Hash = _hashes[i];
+            _slots[pos].Index = i;
+        }
+    }
+
+    std::vector<Slot> _slots;
+    std::vector<TEntry> _entries;
+    std::vector<uint32_t> _hashes; // hashes of the entries
+};
+
+
+template <typename TKey, typename TValue, typename TKeyTraits>
+class FlatHashMap : public FlatHashTable<TKey, std::pair<TKey, TValue>, TKeyTraits>
+{
+    typedef FlatHashTable<TKey, std::pair<TKey, TValue>, TKeyTraits> BaseTable;
+public:
+    typedef TValue mapped_type;
+
+    // Returns the value for the given key, adds a default value if the key
+    // is not in the map yet
+    template <typename TLookup>
+    TValue &operator [](const TLookup &key)
+    {
+        return BaseTable::FindOrAdd(key).first->second;
+    }
+};
+
+
+template <typename TKey, typename TKeyTraits>
+class FlatHashSet : public FlatHashTable<TKey, TKey, TKeyTraits>
+{
+    typedef FlatHashTable<TKey, TKey, TKeyTraits> BaseTable;
+public:
+    // Adds the key to the set; returns the key's position and whether
+    // it was added (false if it was in the set already)
+    template <typename TLookup>
+    std::pair<typename BaseTable::iterator, bool> insert(const TLookup &key)
+    {
+        return BaseTable::FindOrAdd(key);
+    }
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__FLATHASH_H
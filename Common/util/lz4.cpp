@@ -0,0 +1,204 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// LZ4 block format: a sequence of (literals, match) pairs, each starting
+// with a token byte. Token's high 4 bits is the literals length, the low
+// 4 bits is the match length minus MinMatch; value 15 means that the length
+// continues in the following bytes, each added to it, until a byte < 255.
+// Literals follow, then a 16-bit little-endian match offset, then the match
+// length continuation. The last sequence contains only literals.
+//
+//=============================================================================
+#include "util/lz4.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+const size_t MinMatch     = 4;
+// The last bytes are always literals, and the last match must start at
+// least this far from the end of input
+const size_t LastLiterals = 5;
+const size_t MatchFLimit  = 12;
+const size_t MaxOffset    = 65535;
+const int    HashLog      = 14;
+
+inline uint32_t Read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t Hash(uint32_t seq)
+{
+    return (seq * 2654435761u) >> (32 - HashLog);
+}
+
+inline uint8_t *WriteLength(uint8_t *op, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = static_cast<uint8_t>(len);
+    return op;
+}
+
+// Writes literals and the optional match; match_len == 0 means no match
+inline uint8_t *WriteSequence(uint8_t *op, const uint8_t *lit, size_t lit_len,
+    size_t offset, size_t match_len)
+{
+    uint8_t *token = op++;
+    *token = static_cast<uint8_t>(std::min<size_t>(lit_len, 15) << 4);
+    if (lit_len >= 15)
+        op = WriteLength(op, lit_len - 15);
+    if (lit_len > 0)
+        memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (match_len == 0)
+        return op;
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    match_len -= MinMatch;
+    *token |= static_cast<uint8_t>(std::min<size_t>(match_len, 15));
+    if (match_len >= 15)
+        op = WriteLength(op, match_len - 15);
+    return op;
+}
+
+// Reads the length continuation; returns false if ran out of input
+inline bool ReadLength(const uint8_t *&ip, const uint8_t *end, size_t &len)
+{
+    uint8_t b;
+    do
+    {
+        if (ip >= end)
+            return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+
+size_t lz4_compress_bound(size_t src_sz)
+{
+    return src_sz + src_sz / 255 + 16;
+}
+
+size_t lz4_compress_block(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
+{
+    if (dst_sz < lz4_compress_bound(src_sz))
+        return 0;
+
+    uint8_t *op = dst;
+    size_t anchor = 0; // start of the pending literals
+    if (src_sz > MatchFLimit)
+    {
+        // Last positions seen for each hash, stored +1, so that 0 means none
+        std::vector<uint32_t> table(1 << HashLog);
+        const size_t match_start_limit = src_sz - MatchFLimit;
+        const size_t match_end_limit = src_sz - LastLiterals;
+        for (size_t ip = 0; ip <= match_start_limit;)
+        {
+            const uint32_t seq = Read32(src + ip);
+            const uint32_t h = Hash(seq);
+            size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip + 1);
+            if (ref == 0 || (ip - (--ref) > MaxOffset) || (Read32(src + ref) != seq))
+            {
+                // Skip faster through the data which does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // Extend the match backwards, then forwards
+            while ((ip > anchor) && (ref > 0) && (src[ip - 1] == src[ref - 1]))
+            {
+                ip--;
+                ref--;
+            }
+            size_t len = MinMatch;
+            while ((ip + len < match_end_limit) && (src[ref + len] == src[ip + len]))
+                len++;
+
+            op = WriteSequence(op, src + anchor, ip - anchor, ip - ref, len);
+            ip += len;
+            anchor = ip;
+            // Remember a position inside the match, helps finding the next one
+            if (ip <= match_start_limit)
+                table[Hash(Read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2 + 1);
+        }
+    }
+    op = WriteSequence(op, src + anchor, src_sz - anchor, 0, 0);
+    return op - dst;
+}
+
+bool lz4_decompress_block(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
+{
+    const uint8_t *ip = src;
+    const uint8_t *const ip_end = src + src_sz;
+    uint8_t *op = dst;
+    uint8_t *const op_end = dst + dst_sz;
+    while (ip < ip_end)
+    {
+        const uint8_t token = *ip++;
+        // Literals
+        size_t lit_len = token >> 4;
+        if ((lit_len == 15) && !ReadLength(ip, ip_end, lit_len))
+            return false;
+        if ((lit_len > static_cast<size_t>(ip_end - ip)) || (lit_len > static_cast<size_t>(op_end - op)))
+            return false;
+        if (lit_len > 0)
+            memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == ip_end)
+            break; // last sequence has no match
+
+        // Match
+        if (ip_end - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 0xF;
+        if ((match_len == 15) && !ReadLength(ip, ip_end, match_len))
+            return false;
+        match_len += MinMatch;
+        if ((offset == 0) || (offset > static_cast<size_t>(op - dst)) ||
+            (match_len > static_cast<size_t>(op_end - op)))
+            return false;
+        const uint8_t *match = op - offset;
+        if (offset >= match_len)
+        {
+            memcpy(op, match, match_len);
+            op += match_len;
+        }
+        else
+        {
+            // Overlapping match repeats the last offset bytes; copy in chunks,
+            // each twice as long as the previous, as the pattern grows
+            for (uint8_t *end = op + match_len; op < end;)
+            {
+                const size_t chunk = std::min<size_t>(end - op, op - match);
+                memcpy(op, match, chunk);
+                op += chunk;
+            }
+        }
+    }
+    return op == op_end;
+}
@@ -0,0 +1,36 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// LZ4 block (un)compression functions.
+//
+// The compressed data follows the LZ4 block format, and is compatible with
+// the reference LZ4 implementation. LZ4 trades compression ratio for the
+// speed: decompression is a sequence of plain memory copies.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__LZ4_H
+#define __AGS_CN_UTIL__LZ4_H
+
+#include "core/types.h"
+
+// Returns the max size of the compressed data, for the input of the given size
+size_t lz4_compress_bound(size_t src_sz);
+// Compresses src into a single LZ4 block; the dst buffer must be at least
+// lz4_compress_bound(src_sz) large. Returns the size of the compressed data.
+size_t lz4_compress_block(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz);
+// Decompresses a single LZ4 block from src to dst. Returns false if the
+// compressed data is malformed, or does not unpack into exactly dst_sz bytes.
+bool lz4_decompress_block(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz);
+
+#endif // __AGS_CN_UTIL__LZ4_H
@@ -192,14 +192,16 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
 {
   int bits, ch, i, j, len, mask;
+  // use a local buffer, so that expanding is safe to run in parallel
+  uint8_t *expbuf;
   uint8_t *dst_ptr = dst;
   const uint8_t *src_ptr = src;
 
   if (dst_sz == 0)
     return false; // nowhere to expand to
 
-  lzbuffer = (uint8_t *)malloc(N);
-  if (lzbuffer == nullptr) {
+  expbuf = (uint8_t *)malloc(N);
+  if (expbuf == nullptr) {
     return false; // not enough memory
   }
   i = N - F;
@@ -225,13 +227,13 @@ bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
           break; // not enough dest buffer
 
         while (len--) {
-          *(dst_ptr++) = (lzbuffer[i] = lzbuffer[j]);
+          *(dst_ptr++) = (expbuf[i] = expbuf[j]);
           j = (j + 1) & (N - 1);
           i = (i + 1) & (N - 1);
         }
       } else {
         ch = *(src_ptr++);
-        *(dst_ptr++) = (lzbuffer[i] = static_cast<uint8_t>(ch));
+        *(dst_ptr++) = (expbuf[i] = static_cast<uint8_t>(ch));
         i = (i + 1) & (N - 1);
       }
 
@@ -242,6 +244,6 @@ bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
     } // end for mask
   }
 
-  free(lzbuffer);
+  free(expbuf);
   return (src_ptr - src) == src_sz;
 }
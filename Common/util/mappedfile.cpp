@@ -0,0 +1,183 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "core/platform.h"
+#include "util/mappedfile.h"
+#include "util/stdio_compat.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#include "platform/windows/windows.h"
+#elif !AGS_PLATFORM_OS_EMSCRIPTEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define AGS_MAPPEDFILE_POSIX (1)
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::IsSupported()
+{
+#if AGS_PLATFORM_OS_WINDOWS || defined(AGS_MAPPEDFILE_POSIX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if AGS_PLATFORM_OS_WINDOWS
+
+bool MappedFile::Open(const String &filename, soff_t offset, soff_t size)
+{
+    Close();
+    if (offset < 0)
+        return false;
+
+    WCHAR wpath[MAX_PATH_SZ];
+    MultiByteToWideChar(CP_UTF8, 0, filename.GetCStr(), -1, wpath, MAX_PATH_SZ);
+    HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || offset > file_size.QuadPart)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    if (size < 0 || offset + size > file_size.QuadPart)
+        size = file_size.QuadPart - offset;
+    if (size == 0 || (uint64_t)size > SIZE_MAX)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    // The mapping object keeps its own reference to the file
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    // View's offset must be aligned to the allocation granularity
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    const uint64_t map_offset = offset - (offset % si.dwAllocationGranularity);
+    const size_t map_size = static_cast<size_t>(offset - map_offset + size);
+    void *base = MapViewOfFile(mapping, FILE_MAP_READ,
+        static_cast<DWORD>(map_offset >> 32), static_cast<DWORD>(map_offset & 0xFFFFFFFF), map_size);
+    if (!base)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    _filename = filename;
+    _mapHandle = mapping;
+    _mapBase = base;
+    _mapSize = map_size;
+    _data = static_cast<const uint8_t*>(base) + (offset - map_offset);
+    _size = static_cast<size_t>(size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (_mapBase)
+        UnmapViewOfFile(_mapBase);
+    if (_mapHandle)
+        CloseHandle(static_cast<HANDLE>(_mapHandle));
+    _filename = "";
+    _data = nullptr;
+    _size = 0u;
+    _mapBase = nullptr;
+    _mapSize = 0u;
+    _mapHandle = nullptr;
+}
+
+#elif defined(AGS_MAPPEDFILE_POSIX)
+
+bool MappedFile::Open(const String &filename, soff_t offset, soff_t size)
+{
+    Close();
+    if (offset < 0)
+        return false;
+
+    int fd = open(filename.GetCStr(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || offset > st.st_size)
+    {
+        ::close(fd);
+        return false;
+    }
+    if (size < 0 || offset + size > st.st_size)
+        size = st.st_size - offset;
+    if (size == 0 || (uint64_t)size > SIZE_MAX)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // Mapping's offset must be aligned to the page size
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const soff_t map_offset = offset - (offset % page_size);
+    const size_t map_size = static_cast<size_t>(offset - map_offset + size);
+    // The mapping stays valid after closing the file descriptor
+    void *base = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, map_offset);
+    ::close(fd);
+    if (base == MAP_FAILED)
+        return false;
+
+    _filename = filename;
+    _mapBase = base;
+    _mapSize = map_size;
+    _data = static_cast<const uint8_t*>(base) + (offset - map_offset);
+    _size = static_cast<size_t>(size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (_mapBase)
+        munmap(_mapBase, _mapSize);
+    _filename = "";
+    _data = nullptr;
+    _size = 0u;
+    _mapBase = nullptr;
+    _mapSize = 0u;
+}
+
+#else // no memory mapping
+
+bool MappedFile::Open(const String &/*filename*/, soff_t /*offset*/, soff_t /*size*/)
+{
+    return false;
+}
+
+void MappedFile::Close()
+{
+}
+
+#endif
+
+} // namespace Common
+} // namespace AGS
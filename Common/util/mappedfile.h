@@ -0,0 +1,74 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// MappedFile maps a region of a file into memory, letting to access file
+// contents directly, without copying them into the user buffers. The pages
+// are loaded by the system on demand, and shared with the system's file
+// cache, so the mapped data does not count as process's own memory.
+//
+// The mapping is read-only: any attempt to write into the mapped data
+// results in an access violation. The data which has to be modified must
+// be copied into a separate buffer first.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MAPPEDFILE_H
+#define __AGS_CN_UTIL__MAPPEDFILE_H
+
+#include "core/types.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Tells if memory mapping is supported on this platform
+    static bool IsSupported();
+
+    // Maps the region of the file, starting at the offset and of the given
+    // size; size -1 means up to the end of file. Returns false on failure.
+    bool Open(const String &filename, soff_t offset = 0, soff_t size = -1);
+    // Unmaps the file. WARNING: all pointers to the data become invalid!
+    void Close();
+
+    bool IsOpen() const { return _data != nullptr; }
+    // Returns the name of the mapped file
+    const String &GetFilename() const { return _filename; }
+    // Returns the beginning of the mapped region
+    const uint8_t *GetData() const { return _data; }
+    // Returns the size of the mapped region, in bytes
+    size_t GetSize() const { return _size; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator =(const MappedFile&) = delete;
+
+    String   _filename;
+    const uint8_t *_data = nullptr; // requested region
+    size_t   _size = 0u;
+    void    *_mapBase = nullptr; // actual mapping, aligned to the system page
+    size_t   _mapSize = 0u;
+    void    *_mapHandle = nullptr; // file mapping object, where required
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MAPPEDFILE_H
@@ -12,14 +12,18 @@
 //
 //=============================================================================
 //
-// ResourceCache is an abstract storage that tracks use history with MRU list.
+// ResourceCache is an abstract storage that tracks the use of its items.
 // Cache is limited to a certain size, in bytes.
 // When a total size of items reaches the limit, and more items are put into,
-// the Cache uses MRU list to find the least used items and disposes them
-// one by one until the necessary space is freed.
+// the Cache asks its eviction policy which items to dispose, and disposes
+// them one by one until the necessary space is freed. The policy may be
+// chosen at runtime, see CachePolicyType; the default one is LRU.
 // ResourceCache's implementations must provide a method for calculating an
 // item's size.
 //
+// The cache counts hits, misses and evictions, which may be used to judge
+// how well the cache size and policy fit the resource use pattern.
+//
 // Supports copyable and movable items, have 2 variants of Put function for
 // each of them. This lets it store both std::shared_ptr and std::unique_ptr.
 //
@@ -48,8 +52,9 @@
 #ifndef __AGS_CN_UTIL__RESOURCECACHE_H
 #define __AGS_CN_UTIL__RESOURCECACHE_H
 
-#include <list>
+#include <memory>
 #include <unordered_map>
+#include "util/cachepolicy.h"
 #include "util/string.h"
 
 namespace AGS
@@ -57,6 +62,15 @@ namespace AGS
 namespace Common
 {
 
+// Cache usage statistics
+struct ResourceCacheStats
+{
+    uint64_t Hits = 0u;        // requests of the cached items
+    uint64_t Misses = 0u;      // requests of the missing items
+    uint64_t Evictions = 0u;   // items disposed to free the cache space
+    uint64_t EvictedSize = 0u; // summed size of the disposed items
+};
+
 template <typename TKey, typename TValue,
           typename TSize = size_t, typename HashFn = std::hash<TKey>>
 class ResourceCache
@@ -77,25 +91,48 @@ public:
 
     ResourceCache(TSize max_size = 0u)
         : _maxSize(max_size)
-        , _sectionLocked(_mru.end())
+        , _policyType(kCachePolicy_LRU)
+        , _policy(CreateCachePolicy<TKey, TSize, HashFn>(kCachePolicy_LRU))
     {}
+    virtual ~ResourceCache() = default;
 
-    // Get the MRU cache size limit
+    // Get the cache size limit
     inline size_t GetMaxCacheSize() const { return _maxSize; }
-    // Get the current total MRU cache size
+    // Get the current total cache size
     inline size_t GetCacheSize() const { return _cacheSize; }
     // Get the summed size of locked items (included in total cache size)
     inline size_t GetLockedSize() const { return _lockedSize; }
     // Get the summed size of external items (excluded from total cache size)
     inline size_t GetExternalSize() const { return _externalSize; }
+    // Get the eviction policy type
+    inline CachePolicyType GetPolicy() const { return _policyType; }
+    // Get the usage statistics
+    inline const ResourceCacheStats &GetStats() const { return _stats; }
+    // Reset the usage statistics
+    inline void ResetStats() { _stats = ResourceCacheStats(); }
 
-    // Set the MRU cache size limit
+    // Set the cache size limit
     void SetMaxCacheSize(TSize size)
     {
         _maxSize = size;
         FreeMem(0u); // makes sure it does not exceed max size
     }
 
+    // Set the eviction policy; the items which are already in the cache
+    // are passed to the new policy, but their use history is lost
+    void SetPolicy(CachePolicyType type)
+    {
+        if (type == _policyType)
+            return;
+        _policyType = type;
+        _policy = CreateCachePolicy<TKey, TSize, HashFn>(type);
+        for (const auto &item : _storage)
+        {
+            if ((item.second.Flags & (kCacheItem_Locked | kCacheItem_External)) == 0)
+                _policy->Add(item.first, item.second.Size);
+        }
+    }
+
     // Tells if particular key is in the cache
     bool Exists(const TKey &key) const
     {
@@ -103,22 +140,36 @@ public:
     }
 
     // Gets the item with the given key if it exists;
-    // reorders the item as recently used.
+    // registers a use of the item.
     const TValue &Get(const TKey &key)
     {
         auto it = _storage.find(key);
         if (it == _storage.end())
+        {
+            _stats.Misses++;
             return _dummy; // no such key
+        }
 
-        // Unless locked, move the item ref to the beginning of the MRU list
+        _stats.Hits++;
+        // Unless locked, let the policy know that the item is in use
         const auto &item = it->second;
         if ((item.Flags & kCacheItem_Locked) == 0)
-            _mru.splice(_mru.begin(), _mru, item.MruIt);
+            _policy->Touch(key);
         return item.Value;
     }
 
+    // Gets the item with the given key if it exists;
+    // does not register a use, and does not count in statistics.
+    const TValue &Peek(const TKey &key) const
+    {
+        auto it = _storage.find(key);
+        if (it == _storage.end())
+            return _dummy; // no such key
+        return it->second.Value;
+    }
+
     // Add particular item into the cache, disposes existing item if such key is already taken.
-    // If a new item will exceed the cache size limit, cache will remove oldest items
+    // If a new item will exceed the cache size limit, cache will dispose other items
     // in order to free mem.
     void Put(const TKey &key, const TValue &value, uint32_t flags = 0u)
     {
@@ -147,7 +198,7 @@ public:
     }
 
     // Locks the item with the given key,
-    // temporarily excluding it from MRU disposal rules
+    // temporarily excluding it from disposal
     void Lock(const TKey &key)
     {
         auto it = _storage.find(key);
@@ -157,15 +208,13 @@ public:
         if ((item.Flags & kCacheItem_Locked) != 0)
             return; // already locked
 
-        // Lock item and move to the locked section
         item.Flags |= kCacheItem_Locked;
-        _mru.splice(_sectionLocked, _mru, item.MruIt); // CHECKME: TEST!!
-        _sectionLocked = item.MruIt;
+        _policy->Remove(key);
         _lockedSize += item.Size;
     }
 
     // Releases (unlocks) the item with the given key,
-    // adds it back to MRU disposal rules
+    // lets it be disposed again
     void Release(const TKey &key)
     {
         auto it = _storage.find(key);
@@ -178,11 +227,9 @@ public:
         if ((item.Flags & kCacheItem_Locked) == 0)
             return; // not locked
 
-        // Unlock, and move the item to the beginning of the MRU list
+        // Unlock, and treat the item as recently used
         item.Flags &= ~kCacheItem_Locked;
-        if (_sectionLocked == item.MruIt)
-            _sectionLocked = std::next(item.MruIt);
-        _mru.splice(_mru.begin(), _mru, item.MruIt); // CHECKME: TEST!!
+        _policy->Add(key, item.Size);
         _lockedSize -= item.Size;
     }
 
@@ -209,23 +256,26 @@ public:
     // Disposes all items that are not locked or external
     void DisposeFreeItems()
     {
-        for (auto mru_it = _sectionLocked; mru_it != _mru.end(); ++mru_it)
+        for (auto it = _storage.begin(); it != _storage.end();)
         {
-            auto it = _storage.find(*mru_it);
-            assert(it != _storage.end());
-            auto &item = it->second;
-            _cacheSize -= item.Size;
-            _storage.erase(it);
-            _mru.erase(mru_it);
+            if ((it->second.Flags & (kCacheItem_Locked | kCacheItem_External)) == 0)
+            {
+                _cacheSize -= it->second.Size;
+                it = _storage.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
+        _policy->Clear();
     }
 
     // Clear the cache, dispose all items
     void Clear()
     {
         _storage.clear();
-        _mru.clear();
-        _sectionLocked = _mru.end();
+        _policy->Clear();
         _cacheSize = 0u;
         _lockedSize = 0u;
         _externalSize = 0u;
@@ -233,16 +283,11 @@ public:
 
 protected:
     struct TItem;
-    // MRU list type
-    typedef std::list<TKey> TMruList;
-    // MRU list reference type
-    typedef typename TMruList::iterator TMruIt;
     // Storage type
     typedef std::unordered_map<TKey, TItem, HashFn> TStorage;
 
     struct TItem
     {
-        TMruIt       MruIt; // MRU list reference
         TValue       Value;
         TSize        Size = 0u;
         uint32_t     Flags = 0u; // flags determine management rules for this item
@@ -250,10 +295,10 @@ protected:
         TItem() = default;
         TItem(const TItem &item) = default;
         TItem(TItem &&item) = default;
-        TItem(const TMruIt &mru_it, const TValue &value, const TSize size, uint32_t flags)
-            : MruIt(mru_it), Value(value), Size(size), Flags(flags) {}
-        TItem(const TMruIt &mru_it, TValue &&value, const TSize size, uint32_t flags)
-            : MruIt(mru_it), Value(std::move(value)), Size(size), Flags(flags) {}
+        TItem(const TValue &value, const TSize size, uint32_t flags)
+            : Value(value), Size(size), Flags(flags) {}
+        TItem(TValue &&value, const TSize size, uint32_t flags)
+            : Value(std::move(value)), Size(size), Flags(flags) {}
         TItem &operator =(const TItem &item) = default;
         TItem &operator =(TItem &&item) = default;
     };
@@ -263,8 +308,11 @@ protected:
     virtual TSize CalcSize(const TValue &item) = 0;
 
 private:
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache &operator =(const ResourceCache&) = delete;
+
     // Add particular item into the cache.
-    // If a new item will exceed the cache size limit, cache will remove oldest items
+    // If a new item will exceed the cache size limit, cache will dispose other items
     // in order to free mem.
     void PutImpl(const TKey &key, TValue &&value, uint32_t flags)
     {
@@ -280,6 +328,11 @@ private:
             if (_cacheSize + size > _maxSize)
                 FreeMem(size);
             _cacheSize += size;
+            // only normal unlocked items may be disposed
+            if ((flags & kCacheItem_Locked) == 0)
+                _policy->Add(key, size);
+            else
+                _lockedSize += size;
         }
         else
         {
@@ -287,42 +340,20 @@ private:
             flags |= kCacheItem_Locked;
             _externalSize += size;
         }
-
-        // Prepare a MRU slot, then add an item
-        TMruIt mru_it = _mru.end();
-        // only normal items are added to MRU at all
-        if ((flags & kCacheItem_External) == 0)
-        {
-            if ((flags & kCacheItem_Locked) == 0)
-            {
-                // normal item, add to the list
-                mru_it = _mru.insert(_mru.begin(), key);
-            }
-            else
-            {
-                // locked item, add to the dedicated list section
-                mru_it = _mru.insert(_sectionLocked, key);
-                _sectionLocked = mru_it;
-                _lockedSize += size;
-            }
-        }
-        TItem item = TItem(mru_it, std::move(value), size, flags);
-        _storage[key] = std::move(item);
+        _storage[key] = TItem(std::move(value), size, flags);
     }
     // Removes the item from the container
     void RemoveImpl(typename TStorage::iterator it)
     {
         auto &item = it->second;
-        // normal items are removed from MRU, and discounted from cache size
+        // normal items are discounted from cache size
         if ((item.Flags & kCacheItem_External) == 0)
         {
-            TMruIt mru_it = item.MruIt;
-            if (_sectionLocked == mru_it)
-                _sectionLocked = std::next(mru_it);
             _cacheSize -= item.Size;
             if ((item.Flags & kCacheItem_Locked) != 0)
                 _lockedSize -= item.Size;
-            _mru.erase(mru_it);
+            else
+                _policy->Remove(it->first);
         }
         else
         {
@@ -330,31 +361,28 @@ private:
         }
         _storage.erase(it);
     }
-    // Remove the oldest (least recently used) item in cache
-    void DisposeOldest()
+    // Remove the item chosen by the eviction policy
+    bool DisposeNext()
     {
-        assert(_mru.begin() != _sectionLocked);
-        if (_mru.begin() == _sectionLocked)
-            return;
-        // Remove from the storage and mru list
-        auto mru_it = std::prev(_sectionLocked);
-        auto it = _storage.find(*mru_it);
+        TKey key;
+        if (!_policy->Evict(key))
+            return false;
+        auto it = _storage.find(key);
         assert(it != _storage.end());
         auto &item = it->second;
         assert((item.Flags & (kCacheItem_Locked | kCacheItem_External)) == 0);
         _cacheSize -= item.Size;
+        _stats.Evictions++;
+        _stats.EvictedSize += item.Size;
         _storage.erase(it);
-        _mru.erase(mru_it);
+        return true;
     }
-    // Keep disposing oldest elements until cache has at least the given free space
+    // Keep disposing items until cache has at least the given free space
     void FreeMem(size_t space)
     {
         // TODO: consider sprite cache's behavior where it would just clear
         // whole cache in case disposing one by one were taking too much iterations
-        while ((_mru.begin() != _sectionLocked) && (_cacheSize + space > _maxSize))
-        {
-            DisposeOldest();
-        }
+        while ((_cacheSize + space > _maxSize) && DisposeNext());
     }
 
 
@@ -370,20 +398,19 @@ private:
     TSize _externalSize = 0u;
     // Maximal size of tracked data.
     // When the inserted item increases the cache size past this limit,
-    // the cache will try to free the space by removing oldest items.
+    // the cache will try to free the space by disposing other items.
     // "External" data does not count towards this limit.
     TSize _maxSize = 0u;
-    // MRU list: the way to track which items were used recently.
-    // When clearing up space for new items, cache first deletes the items
-    // that were last time used long ago.
-    TMruList _mru;
-    // A locked section border iterator, points to the *last* locked item
-    // starting from the end of the list, or equals _mru.end() if there's none.
-    TMruIt   _sectionLocked;
-    // Key-to-mru lookup map
+    // Eviction policy: tracks the use of the items which may be disposed,
+    // and chooses which of them are disposed first when clearing up space.
+    CachePolicyType _policyType;
+    std::unique_ptr<CachePolicy<TKey, TSize, HashFn>> _policy;
+    // Key-to-item lookup map
     TStorage _storage;
+    // Usage statistics
+    ResourceCacheStats _stats;
     // Dummy value, return in case of a missing key
-    TValue  _dummy;
+    TValue  _dummy{};
 };
 
 } // namespace Common
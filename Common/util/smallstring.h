@@ -0,0 +1,140 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SmallString is a compact immutable string, meant for storing large numbers
+// of mostly short texts in containers. Unlike String it does not share its
+// buffer: texts up to InlineCapacity chars are kept right inside the object,
+// and longer ones are allocated a buffer of the exact size.
+//
+// SmallString has a size of 24 bytes and 4-byte alignment.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__SMALLSTRING_H
+#define __AGS_CN_UTIL__SMALLSTRING_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class SmallString
+{
+public:
+    // Max length of a text stored inside the object, excluding null-terminator
+    static const size_t InlineCapacity = 19;
+
+    SmallString()
+    {
+        _buf[0] = 0;
+        _len = 0u;
+    }
+
+    SmallString(const char *cstr, size_t length)
+    {
+        _len = static_cast<uint32_t>(length);
+        char *text = _buf;
+        if (length > InlineCapacity)
+        {
+            text = static_cast<char*>(malloc(length + 1));
+            SetHeapPtr(text);
+        }
+        memcpy(text, cstr, length);
+        text[length] = 0;
+    }
+
+    SmallString(const SmallString &str)
+        : SmallString(str.GetCStr(), str._len) {}
+
+    SmallString(SmallString &&str)
+    {
+        memcpy(_buf, str._buf, sizeof(_buf));
+        _len = str._len;
+        str._buf[0] = 0;
+        str._len = 0u;
+    }
+
+    ~SmallString()
+    {
+        if (IsAllocated())
+            free(GetHeapPtr());
+    }
+
+    inline const char *GetCStr() const
+    {
+        return IsAllocated() ? GetHeapPtr() : _buf;
+    }
+
+    inline size_t GetLength() const
+    {
+        return _len;
+    }
+
+    inline bool IsEmpty() const
+    {
+        return _len == 0u;
+    }
+
+    SmallString &operator =(const SmallString &str)
+    {
+        if (this != &str)
+            *this = SmallString(str);
+        return *this;
+    }
+
+    SmallString &operator =(SmallString &&str)
+    {
+        if (this != &str)
+        {
+            if (IsAllocated())
+                free(GetHeapPtr());
+            memcpy(_buf, str._buf, sizeof(_buf));
+            _len = str._len;
+            str._buf[0] = 0;
+            str._len = 0u;
+        }
+        return *this;
+    }
+
+private:
+    inline bool IsAllocated() const
+    {
+        return _len > InlineCapacity;
+    }
+
+    // The heap buffer's pointer is stored in the inline buffer's place;
+    // it is copied byte-wise, because the buffer is not aligned for a pointer
+    inline char *GetHeapPtr() const
+    {
+        char *ptr;
+        memcpy(&ptr, _buf, sizeof(ptr));
+        return ptr;
+    }
+
+    inline void SetHeapPtr(char *ptr)
+    {
+        memcpy(_buf, &ptr, sizeof(ptr));
+    }
+
+    char     _buf[InlineCapacity + 1];
+    uint32_t _len;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__SMALLSTRING_H
@@ -0,0 +1,145 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/threadpool.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AGS
+{
+namespace Common
+{
+
+struct ThreadPool::Workers
+{
+    std::vector<std::thread> Threads;
+    std::mutex Mutex;
+    std::condition_variable WorkCV; // signals new job or stop to the workers
+    std::condition_variable DoneCV; // signals finished tasks to the caller
+    bool Stop = false;
+    // Current job
+    const std::function<void(size_t)> *Task = nullptr;
+    size_t Count = 0u; // number of tasks in job
+    size_t Next = 0u; // next task to run
+    size_t Running = 0u; // number of tasks being run right now
+    std::exception_ptr Error; // first exception thrown by a task
+
+    // Runs the pending tasks of the current job, until there are none left;
+    // expects the lock to be held, and releases it while running a task
+    void RunTasks(std::unique_lock<std::mutex> &lk)
+    {
+        while (Task && (Next < Count))
+        {
+            const auto *task = Task;
+            const size_t index = Next++;
+            Running++;
+            lk.unlock();
+            std::exception_ptr err;
+            try
+            {
+                (*task)(index);
+            }
+            catch (...)
+            {
+                err = std::current_exception();
+            }
+            lk.lock();
+            if (err && !Error)
+                Error = err;
+            if ((--Running == 0u) && (Next >= Count))
+                DoneCV.notify_all();
+        }
+    }
+};
+
+ThreadPool::ThreadPool()
+    : _workers(new Workers())
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    StopThreads();
+}
+
+size_t ThreadPool::GetThreadCount() const
+{
+    return _workers->Threads.size();
+}
+
+void ThreadPool::SetThreadCount(size_t count)
+{
+#if defined(AGS_DISABLE_THREADS)
+    count = 0u;
+#endif
+    if (count == _workers->Threads.size())
+        return;
+
+    StopThreads();
+    _workers->Stop = false;
+    for (size_t i = 0; i < count; ++i)
+        _workers->Threads.emplace_back(&ThreadPool::WorkerThread, this);
+}
+
+void ThreadPool::Run(size_t count, const std::function<void(size_t)> &task)
+{
+    if (count == 0u)
+        return;
+
+    std::unique_lock<std::mutex> lk(_workers->Mutex);
+    _workers->Task = &task;
+    _workers->Count = count;
+    _workers->Next = 0u;
+    _workers->Error = nullptr;
+    if (count > 1u)
+        _workers->WorkCV.notify_all();
+    _workers->RunTasks(lk);
+    _workers->DoneCV.wait(lk, [this]() { return _workers->Running == 0u; });
+    _workers->Task = nullptr;
+    std::exception_ptr err = _workers->Error;
+    _workers->Error = nullptr;
+    lk.unlock();
+    if (err)
+        std::rethrow_exception(err);
+}
+
+void ThreadPool::StopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lk(_workers->Mutex);
+        _workers->Stop = true;
+    }
+    _workers->WorkCV.notify_all();
+    for (auto &thread : _workers->Threads)
+        thread.join();
+    _workers->Threads.clear();
+}
+
+void ThreadPool::WorkerThread()
+{
+    std::unique_lock<std::mutex> lk(_workers->Mutex);
+    for (;;)
+    {
+        _workers->WorkCV.wait(lk, [this]()
+            { return _workers->Stop || (_workers->Task && (_workers->Next < _workers->Count)); });
+        if (_workers->Stop)
+            return;
+        _workers->RunTasks(lk);
+    }
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,68 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ThreadPool runs a number of independent tasks on a set of worker threads,
+// and waits for all of them to finish. Meant for splitting a large piece of
+// work, such as drawing a big bitmap, into parts, which don't depend on
+// each other and may be processed in any order.
+//
+// The calling thread takes part in the work too, so a pool with N threads
+// runs up to N + 1 tasks at once. A pool without threads runs all the tasks
+// on the calling thread, one by one.
+//
+// NOTE: threading headers are kept out of this header, because it may be
+// included by the code built as managed, where these are not allowed.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__THREADPOOL_H
+#define __AGS_CN_UTIL__THREADPOOL_H
+
+#include <functional>
+#include <memory>
+
+namespace AGS
+{
+namespace Common
+{
+
+class ThreadPool
+{
+public:
+    ThreadPool();
+    ~ThreadPool();
+
+    // Returns the number of the worker threads
+    size_t GetThreadCount() const;
+    // Stops the current worker threads, and starts the given number of new ones;
+    // zero means that the tasks will be run on the calling thread only
+    void SetThreadCount(size_t count);
+    // Runs the task for each index in [0, count), and returns when all of
+    // them are complete. If any task throws, the first caught exception
+    // is rethrown here, after the rest of the tasks are finished.
+    // NOTE: must not be called from within the task.
+    void Run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    struct Workers;
+
+    void StopThreads();
+    void WorkerThread();
+
+    std::unique_ptr<Workers> _workers;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__THREADPOOL_H
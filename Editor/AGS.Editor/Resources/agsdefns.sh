@@ -2522,6 +2522,16 @@ enum EngineValueID {
   ENGINE_VALUE_I_TEXCACHE_NORMAL,
   ENGINE_VALUE_I_FPS_MAX,
   ENGINE_VALUE_I_FPS,
+#ifdef SCRIPT_API_v363
+  ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_HITS,
+  ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_MISSES,
+  ENGINE_VALUE_I_SPRCACHE_HITS,
+  ENGINE_VALUE_I_SPRCACHE_MISSES,
+  ENGINE_VALUE_I_SPRCACHE_EVICTIONS,
+  ENGINE_VALUE_I_TEXCACHE_HITS,
+  ENGINE_VALUE_I_TEXCACHE_MISSES,
+  ENGINE_VALUE_I_TEXCACHE_EVICTIONS,
+#endif // SCRIPT_API_v363
   ENGINE_VALUE_LAST                      // in case user wants to iterate them
 };
 #endif // SCRIPT_API_v362
@@ -1946,7 +1946,9 @@ void SaveTempSpritefile(int store_flags, AGS::Common::SpriteCompression compress
     AGSString n_temp_spritefile = TextHelper::ConvertUTF8(temp_spritefile);
     AGSString n_temp_indexfile = TextHelper::ConvertUTF8(temp_indexfile);
     AGS::Common::SpriteFileIndex index;
-    if (spriteset.SaveToFile(n_temp_spritefile, store_flags, compressSprites, index) != 0)
+    // Sprites are compressed on all the available cores; this does not affect the result
+    if (spriteset.SaveToFile(n_temp_spritefile, store_flags, compressSprites, index,
+            Environment::ProcessorCount) != 0)
         throw gcnew AGSEditorException(String::Format("Unable to save the sprites. An error occurred whilst writing the sprite file.{0}Temp path: {1}",
             Environment::NewLine, temp_spritefile));
     saved_spritefile = n_temp_spritefile;
@@ -761,6 +761,7 @@ void Character_RemoveTint(CharacterInfo *chaa) {
     if (chaa->flags & (CHF_HASTINT | CHF_HASLIGHT)) {
         debug_script_log("Un-tint %s", chaa->scrname);
         chaa->flags &= ~(CHF_HASTINT | CHF_HASLIGHT);
+        mark_character_gfx_dirty(chaa->index_id, kObjGfx_Tint);
     }
     else {
         debug_script_warn("Character.RemoveTint called but character was not tinted");
@@ -890,6 +891,7 @@ void Character_SetLightLevel(CharacterInfo *chaa, int light_level)
     charextra[chaa->index_id].tint_light = light_level;
     chaa->flags &= ~CHF_HASTINT;
     chaa->flags |= CHF_HASLIGHT;
+    mark_character_gfx_dirty(chaa->index_id, kObjGfx_Tint);
 }
 
 int Character_GetTintRed(CharacterInfo *ch)
@@ -1035,6 +1037,7 @@ void Character_Tint(CharacterInfo *chaa, int red, int green, int blue, int opaci
     charextra[chaa->index_id].tint_light = (luminance * 25) / 10;
     chaa->flags &= ~CHF_HASLIGHT;
     chaa->flags |= CHF_HASTINT;
+    mark_character_gfx_dirty(chaa->index_id, kObjGfx_Tint);
 }
 
 void Character_Think(CharacterInfo *chaa, const char *text) {
@@ -1576,6 +1579,7 @@ void Character_SetScaling(CharacterInfo *chaa, int zoomlevel) {
                         (int)(INT16_MAX), zoomlevel);
 
     charextra[chaa->index_id].zoom = zoom_fixed;
+    mark_character_gfx_dirty(chaa->index_id, kObjGfx_Transform);
 }
 
 int Character_GetSolid(CharacterInfo *chaa) {
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <algorithm>
 #include <cmath>
+#include <thread>
 #include "aastr.h"
 #include "core/platform.h"
 #include "ac/common.h"
@@ -35,6 +36,7 @@
 #include "ac/mouse.h"
 #include "ac/movelist.h"
 #include "ac/overlay.h"
+#include "ac/region.h"
 #include "ac/sys_events.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
@@ -49,6 +51,7 @@
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/frametimer.h"
 #include "font/fonts.h"
 #include "gui/guimain.h"
 #include "gui/guiobject.h"
@@ -61,6 +64,7 @@
 #include "gfx/blender.h"
 #include "main/game_run.h"
 #include "media/audio/audio_system.h"
+#include "util/threadpool.h"
 #include "util/wgt2allg.h"
 
 using namespace AGS::Common;
@@ -95,6 +99,8 @@ struct DrawState
     bool FullFrameRedraw = false;
     // Walk-behinds representation
     WalkBehindMethodEnum WalkBehindMethod = DrawAsSeparateSprite;
+    // Whether the renderer supports hiding sprites behind the walk-behind mask
+    bool WalkBehindMaskSupported = false;
     // Whether there are currently remnants of a on-screen effect
     bool ScreenIsDirty = false;
 
@@ -118,6 +124,10 @@ struct DrawState
     // kinds of renderers, thus saving on 1 extra notification mechanism.
     std::unordered_map<sprkey_t, std::shared_ptr<uint32_t>>
         SpriteNotifyMap;
+
+    // Worker threads, which scale and flip the sprites of room objects
+    // and characters in software mode
+    ThreadPool PrepareThreads;
 };
 
 DrawState drawstate;
@@ -195,7 +205,15 @@ struct ObjTexture
 // if active sprite / texture should be reconstructed
 struct ObjectCache
 {
+    // final image, with all the transformations and effects applied
     std::unique_ptr<Bitmap> image;
+    // scaled and flipped sprite, before applying tint or light;
+    // null if the sprite did not require any transformation
+    std::unique_ptr<Bitmap> transformed;
+    // ObjectGfxStage flags, telling which stages must be redone
+    int   dirty = kObjGfx_None;
+    // the transformed image was prepared ahead for the current frame
+    bool  transform_ready = false;
     bool  in_use = false; // CHECKME: possibly may be removed
     int   sppic = 0;
     // TODO: pickout tint settings, maybe even share with Char/Obj structs,
@@ -464,6 +482,8 @@ Bitmap *CreateCompatBitmap(int width, int height, int col_depth)
 // * keep_mask - tells whether to keep mask pixels when converting from another
 //   color depth. May be useful to disable mask when the source is a 8-bit
 //   palette-based image and the opaque sprite is intended.
+// A read-only bitmap (e.g. referencing a mapped sprite file) is returned as-is
+// if it does not need any pixel fixups, and copied otherwise.
 Bitmap *PrepareSpriteForUseImpl(Bitmap* bitmap, bool has_alpha, bool keep_mask)
 {
     // sprite must be converted to game's color depth;
@@ -472,6 +492,20 @@ Bitmap *PrepareSpriteForUseImpl(Bitmap* bitmap, bool has_alpha, bool keep_mask)
     const int bmp_col_depth = bitmap->GetColorDepth();
     const int game_col_depth = game.GetColorDepth();
 
+    // Test if any of the in-place alpha fixups below will change the read-only bitmap
+    Bitmap *const src_bitmap = bitmap;
+    if (bitmap->IsReadOnly() && (bmp_col_depth == 32))
+    {
+        bool need_fixup = false;
+        if (conv_to_gamedepth && (game_col_depth != 32))
+            need_fixup = has_alpha && BitmapHelper::NeedsReplaceAlphaWithRGBMask(bitmap, 127);
+        else if (game_col_depth == 32)
+            need_fixup = has_alpha ? BitmapHelper::NeedsReplaceAlphaWithRGBMask(bitmap, 0) :
+                BitmapHelper::NeedsMakeOpaqueSkipMask(bitmap);
+        if (need_fixup)
+            bitmap = BitmapHelper::CreateBitmapCopy(bitmap);
+    }
+
     // Palette must be selected if we convert a 8-bit bitmap for a 32-bit game
     const bool must_switch_palette = conv_to_gamedepth && (bitmap->GetColorDepth() == 8) && (game_col_depth > 8);
     if (must_switch_palette)
@@ -486,7 +520,7 @@ Bitmap *PrepareSpriteForUseImpl(Bitmap* bitmap, bool has_alpha, bool keep_mask)
     {
         // Prior to downgrading a 32-bit sprite with valid alpha channel,
         // replace its alpha channel to a regular transparency mask.
-        if ((bmp_col_depth == 32) && has_alpha)
+        if ((bmp_col_depth == 32) && has_alpha && !bitmap->IsReadOnly())
         {
             BitmapHelper::ReplaceHalfAlphaWithRGBMask(bitmap);
         }
@@ -502,7 +536,7 @@ Bitmap *PrepareSpriteForUseImpl(Bitmap* bitmap, bool has_alpha, bool keep_mask)
     // * Else this is either a 32-bit sprite with ignored alpha channel or
     // it was converted from another color depth, then make a fully-opaque
     // alpha channel, except for the existing MASK_COLOR pixels.
-    if ((game_col_depth == 32) && (new_bitmap->GetColorDepth() == 32))
+    if ((game_col_depth == 32) && (new_bitmap->GetColorDepth() == 32) && !new_bitmap->IsReadOnly())
     {
         if (has_alpha)
             BitmapHelper::ReplaceZeroAlphaWithRGBMask(new_bitmap);
@@ -517,6 +551,9 @@ Bitmap *PrepareSpriteForUseImpl(Bitmap* bitmap, bool has_alpha, bool keep_mask)
     if (must_switch_palette)
         unselect_palette();
 
+    // Dispose the intermediate copy of a read-only bitmap, if it was converted further
+    if ((bitmap != src_bitmap) && (new_bitmap != bitmap))
+        delete bitmap;
     return new_bitmap;
 }
 
@@ -707,10 +744,17 @@ void init_draw_method()
     if (drawstate.SoftwareRender)
     {
         drawstate.WalkBehindMethod = DrawOverCharSprite;
+        // The game thread prepares sprites too, so leave a core for it
+        size_t thread_count = usetup.SoftwarePrepareThreads;
+        const size_t cores = std::thread::hardware_concurrency();
+        if (cores > 0u)
+            thread_count = std::min(thread_count, cores - 1);
+        drawstate.PrepareThreads.SetThreadCount(thread_count);
     }
     else
     {
         drawstate.WalkBehindMethod = DrawAsSeparateSprite;
+        drawstate.WalkBehindMaskSupported = usetup.WalkBehindShader && gfxDriver->SupportsWalkBehindMask();
         create_blank_image(game.GetColorDepth());
         size_t tx_cache_size = usetup.TextureCacheSize * 1024;
         // If graphics driver can report available texture memory,
@@ -719,6 +763,7 @@ void init_draw_method()
         if (avail_tx_mem > 0)
             tx_cache_size = std::min<size_t>(SIZE_MAX, std::min<uint64_t>(tx_cache_size, avail_tx_mem * 0.66));
         texturecache.SetMaxCacheSize(tx_cache_size);
+        texturecache.SetPolicy(usetup.TextureCachePolicy);
         Debug::Printf("Texture cache set: %zu KB", tx_cache_size / 1024);
     }
 
@@ -730,6 +775,7 @@ void init_draw_method()
 
 void dispose_draw_method()
 {
+    drawstate.PrepareThreads.SetThreadCount(0);
     dispose_room_drawdata();
     dispose_invalid_regions(false);
     destroy_blank_image();
@@ -797,6 +843,8 @@ static void dispose_debug_room_drawdata()
 
 void dispose_room_drawdata()
 {
+    if (drawstate.WalkBehindMethod == DrawByMaskInShader)
+        gfxDriver->SetWalkBehindMask(nullptr);
     CameraDrawData.clear();
     dispose_invalid_regions(true);
 }
@@ -924,6 +972,12 @@ void init_room_drawdata()
     // Must realloc, because the ObjTextures are cleared on room change
     alloc_fixed_drawindexes();
 
+    // Pass the walk-behind mask to the renderer if it supports one,
+    // otherwise (or if it fails to use this mask) draw them as sprites
+    if (drawstate.WalkBehindMaskSupported)
+    {
+        drawstate.WalkBehindMethod = walkbehinds_set_mask() ? DrawByMaskInShader : DrawAsSeparateSprite;
+    }
     if (drawstate.WalkBehindMethod == DrawAsSeparateSprite)
     {
         walkbehinds_generate_sprites();
@@ -1031,6 +1085,25 @@ void mark_object_changed(int objid)
     objcache[objid].y = -9999;
 }
 
+void mark_object_gfx_dirty(int objid, int stages)
+{
+    objcache[objid].dirty |= stages;
+}
+
+void mark_character_gfx_dirty(int charid, int stages)
+{
+    if (static_cast<size_t>(charid) < charcache.size())
+        charcache[charid].dirty |= stages;
+}
+
+void mark_all_gfx_dirty(int stages)
+{
+    for (auto &cc : charcache)
+        cc.dirty |= stages;
+    for (auto &oc : objcache)
+        oc.dirty |= stages;
+}
+
 void reset_drawobj_dynamic_index()
 {
     drawstate.NextDrawIndex = drawstate.FixedDrawIndexBase;
@@ -1085,6 +1158,11 @@ size_t texturecache_get_size()
     return texturecache.GetCacheSize();
 }
 
+const ResourceCacheStats &texturecache_get_stats()
+{
+    return texturecache.GetStats();
+}
+
 void texturecache_clear()
 {
     texturecache.Clear();
@@ -1197,6 +1275,7 @@ extern volatile bool want_exit, abort_engine;
 
 void render_to_screen()
 {
+    FrameStageScope stage_scope(kFrameStage_Render);
     // Stage: final plugin callback (still drawn on game screen)
     if (pl_any_want_hook(kPluginEvt_FinalScreenDraw))
     {
@@ -1283,8 +1362,11 @@ void draw_sprite_support_alpha(Bitmap *ds, bool ds_has_alpha, int xpos, int ypos
     // Backwards-compatible drawing
     else if (src_has_alpha && alpha == 0xFF)
     {
-        set_alpha_blender();
-        ds->TransBlendBlt(image, xpos, ypos);
+        if (!GfxUtil::DrawSpriteBlender(ds, image, xpos, ypos, _blender_alpha32, 0))
+        {
+            set_alpha_blender();
+            ds->TransBlendBlt(image, xpos, ypos);
+        }
     }
     else
     {
@@ -1481,11 +1563,15 @@ void draw_gui_sprite(Bitmap *ds, bool use_alpha, int x, int y, Bitmap *sprite, b
     // Backwards-compatible drawing
     else if (use_alpha && ds_has_alpha && (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_AdditiveAlpha) && (alpha == 0xFF))
     {
-        if (src_has_alpha)
-            set_additive_alpha_blender();
-        else
-            set_opaque_alpha_blender();
-        ds->TransBlendBlt(sprite, x, y);
+        if (!GfxUtil::DrawSpriteBlender(ds, sprite, x, y,
+                src_has_alpha ? _additive_alpha_copysrc_blender : _opaque_alpha_blender, 0))
+        {
+            if (src_has_alpha)
+                set_additive_alpha_blender();
+            else
+                set_opaque_alpha_blender();
+            ds->TransBlendBlt(sprite, x, y);
+        }
     }
     else
     {
@@ -1537,7 +1623,7 @@ void get_local_tint(int xpp, int ypp, bool use_region_tint,
                     int *tint_b, int *tint_lit,
                     int *light_lev) {
 
-    int tint_level = 0, light_level = 0;
+    int light_level = 0;
     int tint_amount = 0;
     int tint_red = 0;
     int tint_green = 0;
@@ -1563,26 +1649,14 @@ void get_local_tint(int xpp, int ypp, bool use_region_tint,
             }
         }
 
-        if ((onRegion > 0) && (onRegion < MAX_ROOM_REGIONS)) {
-            light_level = thisroom.Regions[onRegion].Light;
-            tint_level = thisroom.Regions[onRegion].Tint;
-        }
-        else if (onRegion <= 0) {
-            light_level = thisroom.Regions[0].Light;
-            tint_level = thisroom.Regions[0].Tint;
-        }
-
-        int tint_sat = (tint_level >> 24) & 0xFF;
-        if ((game.color_depth == 1) || ((tint_level & 0x00ffffff) == 0) ||
-            (tint_sat == 0))
-            tint_level = 0;
-
-        if (tint_level) {
-            tint_red = (unsigned char)(tint_level & 0x000ff);
-            tint_green = (unsigned char)((tint_level >> 8) & 0x000ff);
-            tint_blue = (unsigned char)((tint_level >> 16) & 0x000ff);
-            tint_amount = tint_sat;
-            tint_light = light_level;
+        const RegionTint &rt = get_region_tint(std::max(0, onRegion));
+        light_level = rt.LightLevel;
+        if (rt.Amount > 0) {
+            tint_red = rt.Red;
+            tint_green = rt.Green;
+            tint_blue = rt.Blue;
+            tint_amount = rt.Amount;
+            tint_light = rt.Luminance;
         }
 
         if (play.rtint_enabled)
@@ -1619,8 +1693,9 @@ void get_local_tint(int xpp, int ypp, bool use_region_tint,
 
 
 // Applies the specified RGB Tint or Light Level to the ObjTexture 'actsp'.
+// Returns false if the effect is not supported and nothing was drawn.
 // Used for software render mode only.
-static void apply_tint_or_light(ObjTexture &actsp, int light_level,
+static bool apply_tint_or_light(ObjTexture &actsp, int light_level,
                          int tint_amount, int tint_red, int tint_green,
                          int tint_blue, int tint_light, int coldept,
                          Bitmap *blitFrom) {
@@ -1629,7 +1704,7 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
  // (but we can do darkening, if light_level < 0)
  if (game.color_depth == 1) {
      if ((light_level > 0) || (tint_amount != 0))
-         return;
+         return false;
  }
 
  // we can only do tint/light if the colour depths match
@@ -1684,7 +1759,7 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
      Bitmap *active_spr = actsp.Bmp.get();
      active_spr->Blit(blitFrom, 0, 0, 0, 0, active_spr->GetWidth(), active_spr->GetHeight());
  }
-
+ return true;
 }
 
 // Generates a transformed sprite, using src image and parameters;
@@ -1739,18 +1814,24 @@ static Bitmap *transform_sprite(std::unique_ptr<Bitmap> &dst, Bitmap *src, bool
     return dst.get(); // return transformed result
 }
 
-// Draws the specified 'sppic' sprite onto ObjTexture 'actsp' at the specified
-// width and height, and flips the sprite if necessary.
-// If any transformation was necessary, then writes the result into ObjTexture.
-// Returns if any transformation was done.
-// Used for software render mode only.
-static bool transform_sprite(ObjTexture &actsp, int sppic,
-    const Size &dst_sz, GraphicFlip flip = Common::kFlip_None)
+// Tells if the sprite is drawn mirrored, according to the view frame
+static inline bool is_sprite_mirrored(const ViewFrame *vf, int pic)
+{
+    return vf && (vf->pic == pic) && ((vf->flags & VFLG_FLIPSPRITE) != 0);
+}
+
+// Tells if the object's sprite has to be scaled and flipped again,
+// judging by the image cached in ObjectCache 'objsav'
+static bool is_object_transform_dirty(const ObjectCache &objsav, const ObjTexture &actsp,
+    int specialpic, int zoom, bool is_mirrored)
 {
-    Bitmap *src = spriteset[sppic];
-    Bitmap *result = transform_sprite(actsp.Bmp, src, (game.SpriteInfos[sppic].Flags & SPF_ALPHACHANNEL) != 0,
-        dst_sz, flip);
-    return result != src;
+    return ((objsav.dirty & kObjGfx_Transform) != 0) ||
+        (objsav.image == nullptr) ||
+        (objsav.sppic != specialpic) ||
+        // a dynamic sprite, which was modified lately
+        (actsp.IsChangeNotified()) ||
+        (objsav.zoom != zoom) ||
+        (objsav.mirrored != is_mirrored);
 }
 
 // Prepares the ObjTexture 'actsp' for an arbitrary room entity.
@@ -1800,13 +1881,8 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
     }
 
     // check whether the image should be flipped
-    bool is_mirrored = false;
-    int specialpic = pic;
-    if (vf && (vf->pic == pic) && ((vf->flags & VFLG_FLIPSPRITE) != 0))
-    {
-        is_mirrored = true;
-        specialpic = -pic;
-    }
+    const bool is_mirrored = is_sprite_mirrored(vf, pic);
+    const int specialpic = is_mirrored ? -pic : pic;
 
     actsp.SpriteID = pic; // for texture sharing
 
@@ -1825,6 +1901,8 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
         objsav.lightlev = light_level;
         objsav.zoom = objsrc.zoom;
         objsav.mirrored = is_mirrored;
+        objsav.dirty = kObjGfx_None;
+        objsav.transform_ready = false;
         return is_texture_intact;
     }
 
@@ -1837,19 +1915,24 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
         objsav.sppic = INT32_MIN;
     }
 
+    // Find out which stages of the cached image are outdated
+    int dirty = objsav.dirty;
+    if (is_object_transform_dirty(objsav, actsp, specialpic, objsrc.zoom, is_mirrored))
+    {
+        dirty |= kObjGfx_Transform;
+    }
+    if ((objsav.tintamnt != tint_level) ||
+        (objsav.tintlight != tint_light) ||
+        (objsav.tintr != tint_red) ||
+        (objsav.tintg != tint_green) ||
+        (objsav.tintb != tint_blue) ||
+        (objsav.lightlev != light_level))
+    {
+        dirty |= kObjGfx_Tint;
+    }
+
     // If we have the image cached, use it
-    if ((objsav.image != nullptr) &&
-        (objsav.sppic == specialpic) &&
-        // not a dynamic sprite, or not sprite modified lately
-        (!actsp.IsChangeNotified()) &&
-        (objsav.tintamnt == tint_level) &&
-        (objsav.tintlight == tint_light) &&
-        (objsav.tintr == tint_red) &&
-        (objsav.tintg == tint_green) &&
-        (objsav.tintb == tint_blue) &&
-        (objsav.lightlev == light_level) &&
-        (objsav.zoom == objsrc.zoom) &&
-        (objsav.mirrored == is_mirrored))
+    if (dirty == kObjGfx_None)
     {
         // If the image is the same, we can use it cached
         if ((drawstate.WalkBehindMethod != DrawOverCharSprite) &&
@@ -1872,36 +1955,31 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
         return false; // image was modified
     }
 
-    // Not cached, so draw the image
+    // Not cached, so draw the image; the scaled and flipped sprite is kept
+    // separately, so that changing only tint or light does not redo these
     Bitmap *sprite = spriteset[pic];
-    const int coldept = sprite->GetColorDepth();
-    const int src_sprwidth = sprite->GetWidth();
-    const int src_sprheight = sprite->GetHeight();
-    bool actsps_used = false;
-    // draw the base sprite, scaled and flipped as appropriate
-    actsps_used = transform_sprite(actsp, pic, scale_size, is_mirrored ? kFlip_Horizontal : kFlip_None);
-    if (!actsps_used)
+    if ((dirty & kObjGfx_Transform) && !objsav.transform_ready)
     {
-        // ensure actsps exists // CHECKME: why do we need this in hardware accel mode too?
-        recycle_bitmap(actsp.Bmp, coldept, src_sprwidth, src_sprheight);
+        Bitmap *result = transform_sprite(objsav.transformed, sprite,
+            (game.SpriteInfos[pic].Flags & SPF_ALPHACHANNEL) != 0,
+            scale_size, is_mirrored ? kFlip_Horizontal : kFlip_None);
+        if (result == sprite)
+            objsav.transformed.reset();
     }
+    Bitmap *base_img = objsav.transformed ? objsav.transformed.get() : sprite;
+    recycle_bitmap(actsp.Bmp, base_img->GetColorDepth(), base_img->GetWidth(), base_img->GetHeight());
 
-    // apply tints or lightenings where appropriate, else just copy the source bitmap
+    // apply tints or lightenings where appropriate, else just copy the base image
+    bool is_tinted = false;
     if ((tint_level > 0) || (light_level != 0))
     {
-        // direct read from source bitmap, where possible
-        Bitmap *blit_from = nullptr;
-        if (!actsps_used)
-            blit_from = sprite;
-
-        apply_tint_or_light(actsp, light_level, tint_level, tint_red,
-            tint_green, tint_blue, tint_light, coldept,
-            blit_from);
+        is_tinted = apply_tint_or_light(actsp, light_level, tint_level, tint_red,
+            tint_green, tint_blue, tint_light, base_img->GetColorDepth(),
+            base_img);
     }
-    else if (!actsps_used)
+    if (!is_tinted)
     {
-        // no scaling, flipping or tinting was done, so just blit it normally
-        actsp.Bmp->Blit(sprite, 0, 0);
+        actsp.Bmp->Blit(base_img, 0, 0);
     }
 
     // Create the cached image and store it
@@ -1919,9 +1997,96 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
     objsav.mirrored = is_mirrored;
     objsav.x = objsrc.x;
     objsav.y = objsrc.y;
+    objsav.dirty = kObjGfx_None;
+    objsav.transform_ready = false;
     return false; // image was modified
 }
 
+void run_sprite_transform_jobs(std::vector<SpriteTransformJob> &jobs, ThreadPool &pool)
+{
+    pool.Run(jobs.size(), [&jobs](size_t index)
+    {
+        SpriteTransformJob &job = jobs[index];
+        if (!job.Sprite)
+            return;
+        transform_sprite(job.Result, job.Sprite, job.HasAlpha, job.DstSize, job.Flip);
+        job.Done = true;
+    });
+}
+
+// The object's sprite transformation, which is done ahead, before
+// the rest of the object's image is prepared
+struct ObjTransformJob
+{
+    ObjectCache *Cache = nullptr;
+    int Pic = 0;
+};
+
+std::vector<ObjTransformJob> objTransformJobs;
+std::vector<SpriteTransformJob> spriteTransformJobs;
+
+// Adds a job for transforming the object's sprite, if the cached image
+// is outdated, and the transformation may be done on a worker thread.
+// Used for software render mode only.
+static void add_object_transform_job(const ViewFrame *vf, int pic,
+    const Size &scale_size, int zoom, ObjectCache &objsav, const ObjTexture &actsp)
+{
+    const bool is_mirrored = is_sprite_mirrored(vf, pic);
+    if (!is_object_transform_dirty(objsav, actsp, is_mirrored ? -pic : pic, zoom, is_mirrored))
+        return;
+
+    Bitmap *sprite = spriteset[pic];
+    const bool is_scaled = sprite->GetSize() != scale_size;
+    if (!is_scaled && !is_mirrored)
+        return; // nothing to transform
+    // antialiased scaling uses a global state, so must be done on the game thread
+    if (is_scaled && play.ShouldAASprites())
+        return;
+
+    ObjTransformJob job;
+    job.Cache = &objsav;
+    job.Pic = pic;
+    objTransformJobs.push_back(job);
+    SpriteTransformJob tx_job;
+    tx_job.HasAlpha = (game.SpriteInfos[pic].Flags & SPF_ALPHACHANNEL) != 0;
+    tx_job.DstSize = scale_size;
+    tx_job.Flip = is_mirrored ? kFlip_Horizontal : kFlip_None;
+    spriteTransformJobs.push_back(std::move(tx_job));
+}
+
+// Runs the added transformation jobs on the worker threads, and waits for
+// them to finish; the results are used by the following construct_object_gfx.
+// Used for software render mode only.
+static void run_object_transform_jobs()
+{
+    if (objTransformJobs.empty())
+        return;
+
+    // Get the sprites again, without loading, as loading the later sprites
+    // could have removed the earlier ones from the cache; those, which
+    // are not in the cache now, are transformed on the game thread later.
+    // The jobs write into the objects' cached images, reusing them.
+    for (size_t i = 0; i < objTransformJobs.size(); ++i)
+    {
+        const ObjTransformJob &job = objTransformJobs[i];
+        SpriteTransformJob &tx_job = spriteTransformJobs[i];
+        tx_job.Sprite = spriteset.IsSpriteLoaded(job.Pic) ? spriteset[job.Pic] : nullptr;
+        tx_job.Result = std::move(job.Cache->transformed);
+    }
+
+    run_sprite_transform_jobs(spriteTransformJobs, drawstate.PrepareThreads);
+
+    for (size_t i = 0; i < objTransformJobs.size(); ++i)
+    {
+        ObjectCache &objsav = *objTransformJobs[i].Cache;
+        SpriteTransformJob &tx_job = spriteTransformJobs[i];
+        objsav.transformed = std::move(tx_job.Result);
+        objsav.transform_ready = tx_job.Done;
+    }
+    objTransformJobs.clear();
+    spriteTransformJobs.clear();
+}
+
 // Do last time setup to the ObjTexture 'actsp', prepare the final texture.
 // Applies walk-behinds to an object's raw bitmap if necessary (software mode);
 // update the object's texture from the sprite if necessary,
@@ -1986,6 +2151,8 @@ void prepare_and_add_object_gfx(
     }
 
     actsp.Ddb->SetAlpha(GfxDef::LegacyTrans255ToAlpha255(transparency));
+    if (drawstate.WalkBehindMethod == DrawByMaskInShader)
+        actsp.Ddb->SetWalkBehindBaseline(use_walkbehinds ? usebasel : kNoWalkBehindBaseline);
 }
 
 // Prepares a actsps element for RoomObject; updates object cache.
@@ -2012,6 +2179,27 @@ bool construct_object_gfx(int objid, bool force_software)
         force_software);
 }
 
+// Adds a job for transforming the RoomObject's sprite on a worker thread
+static void add_object_transform_job(int objid)
+{
+    const RoomObject &obj = objs[objid];
+    const int sprite_id = spriteset.DoesSpriteExist(obj.num) ? obj.num : 0;
+    add_object_transform_job(
+        (obj.view != UINT16_MAX) ? &views[obj.view].loops[obj.loop].frames[obj.frame] : nullptr,
+        sprite_id,
+        Size(obj.last_width, obj.last_height),
+        obj.zoom,
+        objcache[objid],
+        actsps[objid]);
+}
+
+// Tells if the RoomObject should be drawn this frame
+static bool is_object_drawn(const RoomObject &obj)
+{
+    return (obj.on == 1) && // WARNING: 'on' may have other values than 0 and 1 !!
+        (obj.x < thisroom.Width) && (obj.y >= 1); // not offscreen
+}
+
 void prepare_objects_for_drawing()
 {
     set_our_eip(32);
@@ -2021,10 +2209,8 @@ void prepare_objects_for_drawing()
     for (uint32_t objid = 0; objid < croom->numobj; ++objid)
     {
         const RoomObject &obj = objs[objid];
-        if (obj.on != 1) // WARNING: 'on' may have other values than 0 and 1 !!
-            continue; // disabled
-        if ((obj.x >= thisroom.Width) || (obj.y < 1))
-            continue; // offscreen
+        if (!is_object_drawn(obj))
+            continue; // disabled or offscreen
 
         eip_guinum = objid;
         const ObjectCache &objsav = objcache[objid];
@@ -2063,15 +2249,23 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
     // For performance reasons, we have a seperate blender for
     // when light is being adjusted and when it is not.
     // If luminance >= 250, then normal brightness, otherwise darken
+    PfnBlender blender32;
     if (luminance >= 250)
+    {
         set_blender_mode (_myblender_color15, _myblender_color16, _myblender_color32, red, grn, blu, 0);
+        blender32 = _myblender_color32;
+    }
     else
+    {
         set_blender_mode (_myblender_color15_light, _myblender_color16_light, _myblender_color32_light, red, grn, blu, 0);
+        blender32 = _myblender_color32_light;
+    }
 
     if (light_level >= 100) {
         // fully colourised
         ds->FillTransparent();
-        ds->LitBlendBlt(srcimg, 0, 0, luminance);
+        if (!GfxUtil::DrawSpriteTinted(ds, srcimg, 0, 0, blender32, red, grn, blu, luminance))
+            ds->LitBlendBlt(srcimg, 0, 0, luminance);
     }
     else {
         // light_level is between -100 and 100 normally; 0-100 in
@@ -2083,11 +2277,15 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
         Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
-        finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
+        if (!GfxUtil::DrawSpriteTinted(finaltarget, srcimg, 0, 0, blender32, red, grn, blu, luminance))
+            finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
 
         // customized trans blender to preserve alpha channel
-        set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        if (!GfxUtil::DrawSpriteBlender(ds, finaltarget, 0, 0, _myblender_alpha_trans24, light_level))
+        {
+            set_my_trans_blender (0, 0, 0, light_level);
+            ds->TransBlendBlt (finaltarget, 0, 0);
+        }
         delete finaltarget;
     }
 }
@@ -2119,6 +2317,28 @@ bool construct_char_gfx(int charid, bool force_software)
         force_software);
 }
 
+// Adds a job for transforming the Character's sprite on a worker thread
+static void add_char_transform_job(int charid)
+{
+    const CharacterInfo &chin = game.chars[charid];
+    const CharacterExtras &chex = charextra[charid];
+    const ViewFrame *vf = &views[chin.view].loops[chin.loop].frames[chin.frame];
+    const int pic = spriteset.DoesSpriteExist(vf->pic) ? vf->pic : 0;
+    add_object_transform_job(
+        vf,
+        pic,
+        Size(chex.width, chex.height),
+        chex.zoom,
+        charcache[charid],
+        actsps[charid + ACTSP_OBJSOFF]);
+}
+
+// Tells if the Character should be drawn this frame
+static bool is_char_drawn(const CharacterInfo &chin)
+{
+    return (chin.on != 0) && (chin.room == displayed_room);
+}
+
 void prepare_characters_for_drawing()
 {
     set_our_eip(33);
@@ -2128,10 +2348,8 @@ void prepare_characters_for_drawing()
     for (int charid = 0; charid < game.numcharacters; ++charid)
     {
         const CharacterInfo &chin = game.chars[charid];
-        if (chin.on == 0)
-            continue; // disabled
-        if (chin.room != displayed_room)
-            continue; // in another room
+        if (!is_char_drawn(chin))
+            continue; // disabled or in another room
 
         eip_guinum = charid;
         const CharacterExtras &chex = charextra[charid];
@@ -2154,6 +2372,28 @@ void prepare_characters_for_drawing()
     }
 }
 
+// Scales and flips the sprites of the room objects and characters, which
+// are going to be drawn, on the worker threads, all at once; the rest of
+// their images is prepared on the game thread in their usual order.
+// Used for software render mode only.
+void prepare_transforms_for_drawing()
+{
+    if (!drawstate.SoftwareRender || (drawstate.PrepareThreads.GetThreadCount() == 0u))
+        return;
+
+    for (uint32_t objid = 0; objid < croom->numobj; ++objid)
+    {
+        if (is_object_drawn(objs[objid]))
+            add_object_transform_job(objid);
+    }
+    for (int charid = 0; charid < game.numcharacters; ++charid)
+    {
+        if (is_char_drawn(game.chars[charid]))
+            add_char_transform_job(charid);
+    }
+    run_object_transform_jobs();
+}
+
 Bitmap *get_cached_character_image(int charid)
 {
     return actsps[charid + ACTSP_OBJSOFF].Bmp.get();
@@ -2201,6 +2441,15 @@ void prepare_room_sprites()
     }
     if (drawstate.FullFrameRedraw)
     {
+        if (drawstate.WalkBehindMethod == DrawByMaskInShader)
+        {
+            if (walkBehindMaskChanged && !walkbehinds_set_mask())
+                drawstate.WalkBehindMethod = DrawAsSeparateSprite;
+            // Baselines are only compared when rendering, so are updated each frame
+            int baselines[MAX_WALK_BEHINDS];
+            std::copy(croom->walkbehind_base, croom->walkbehind_base + MAX_WALK_BEHINDS, baselines);
+            gfxDriver->SetWalkBehindBaselines(baselines, MAX_WALK_BEHINDS);
+        }
         if (current_background_is_dirty || walkBehindsCachedForBgNum != play.bg_frame)
         {
             if (drawstate.WalkBehindMethod == DrawAsSeparateSprite)
@@ -2216,6 +2465,7 @@ void prepare_room_sprites()
 
     if ((debug_flags & DBG_NOOBJECTS) == 0)
     {
+        prepare_transforms_for_drawing();
         prepare_objects_for_drawing();
         prepare_characters_for_drawing();
         add_roomovers_for_drawing();
@@ -2314,6 +2564,13 @@ struct DrawFPS
     int font = -1; // in case normal font changes at runtime
 } gl_DrawFPS;
 
+struct DrawFrameGraph
+{
+    IDriverDependantBitmap* ddb = nullptr;
+    std::unique_ptr<Bitmap> bmp;
+    std::vector<FrameTimes> frames;
+} gl_DrawFrameGraph;
+
 void dispose_engine_overlay()
 {
     gl_DrawFPS.bmp.reset();
@@ -2321,6 +2578,11 @@ void dispose_engine_overlay()
         gfxDriver->DestroyDDB(gl_DrawFPS.ddb);
     gl_DrawFPS.ddb = nullptr;
     gl_DrawFPS.font = -1;
+    gl_DrawFrameGraph.bmp.reset();
+    if (gl_DrawFrameGraph.ddb)
+        gfxDriver->DestroyDDB(gl_DrawFrameGraph.ddb);
+    gl_DrawFrameGraph.ddb = nullptr;
+    gl_DrawFrameGraph.frames.clear();
 }
 
 void draw_fps(const Rect &viewport)
@@ -2372,6 +2634,60 @@ void draw_fps(const Rect &viewport)
     invalidate_sprite_glob(1, yp, gl_DrawFPS.ddb);
 }
 
+// Draws the recent frame times as a graph of stacked columns, one per frame,
+// where each stage has its own color; the time spent waiting for the next
+// frame is not drawn. The horizontal line marks the frame time budget,
+// and the graph's height is twice the budget.
+void draw_frame_graph(const Rect &viewport)
+{
+    // Palette colors for each frame stage
+    const int stage_colors[kNumFrameStages] = { 8, 12, 10, 11, 13, 9, 14, 6, 0 };
+    const int font = FONT_NORMAL;
+    const int legend_height = get_font_surface_height(font) + get_fixed_pixel_size(2);
+    const int graph_width = std::min<int>(viewport.GetWidth(), FrameTimerHistorySize);
+    const int graph_height = viewport.GetHeight() / 4;
+    auto &graph = gl_DrawFrameGraph.bmp;
+    recycle_bitmap(graph, game.GetColorDepth(), graph_width, legend_height + graph_height);
+    graph->ClearTransparent();
+
+    // Legend
+    int text_off = get_font_surface_extent(font).first;
+    for (int i = 0, x = 1; i < kNumFrameStages - 1 && x < graph_width; ++i)
+    {
+        const char *name = frametimer_get_stage_name(static_cast<FrameStage>(i));
+        wouttext_outline(graph.get(), x, 1 - text_off, font, graph->GetCompatibleColor(stage_colors[i]), name);
+        x += get_text_width_outlined(name, font) + get_fixed_pixel_size(4);
+    }
+
+    // Frame columns, with the latest frame on the right
+    auto &frames = gl_DrawFrameGraph.frames;
+    frames.resize(graph_width);
+    frames.resize(frametimer_get_history(frames.data(), frames.size()));
+    const float budget_us = 1000000.f / std::max(1, frames_per_second);
+    const float px_per_us = graph_height / (budget_us * 2.f);
+    const int bottom = legend_height + graph_height - 1;
+    int x = graph_width - static_cast<int>(frames.size());
+    for (const auto &ft : frames)
+    {
+        float top = static_cast<float>(bottom + 1);
+        for (int i = 0; i < kNumFrameStages - 1 && top > legend_height; ++i)
+        {
+            const float next_top = std::max<float>(top - ft.Stages[i] * px_per_us, legend_height);
+            if (static_cast<int>(next_top) < static_cast<int>(top))
+                graph->DrawLine(Line(x, static_cast<int>(next_top), x, static_cast<int>(top) - 1),
+                    graph->GetCompatibleColor(stage_colors[i]));
+            top = next_top;
+        }
+        x++;
+    }
+    const int budget_y = bottom - graph_height / 2;
+    graph->DrawLine(Line(0, budget_y, graph_width - 1, budget_y), graph->GetCompatibleColor(15));
+
+    gl_DrawFrameGraph.ddb = recycle_ddb_bitmap(gl_DrawFrameGraph.ddb, graph.get());
+    gfxDriver->DrawSprite(0, 0, gl_DrawFrameGraph.ddb);
+    invalidate_sprite_glob(0, 0, gl_DrawFrameGraph.ddb);
+}
+
 // Draw GUI controls as separate sprites, each on their own texture
 static void construct_guictrl_tex(GUIMain &gui)
 {
@@ -2603,6 +2919,7 @@ void GfxDriverOnInitCallback(void *data)
 // Schedule room rendering: background, objects, characters
 static void construct_room_view()
 {
+    FrameStageScope stage_scope(kFrameStage_SpritePrep);
     draw_preroom_background();
     prepare_room_sprites();
     // reset the Baselines Changed flag now that we've drawn stuff
@@ -2673,6 +2990,7 @@ static void construct_room_view()
 // Schedule ui rendering
 static void construct_ui_view()
 {
+    FrameStageScope stage_scope(kFrameStage_GUI);
     gfxDriver->BeginSpriteBatch(play.GetUIViewport(), SpriteTransform(), RENDER_BATCH_UI_LAYER);
     draw_gui_and_overlays();
     gfxDriver->EndSpriteBatch();
@@ -2683,6 +3001,7 @@ static void construct_ui_view()
 // but does not put them on screen yet - that's done in respective construct_*_view functions
 static void construct_overlays()
 {
+    FrameStageScope stage_scope(kFrameStage_GUI);
     const bool is_software_mode = drawstate.SoftwareRender;
     const bool crop_walkbehinds = (drawstate.WalkBehindMethod == DrawOverCharSprite);
 
@@ -2751,6 +3070,8 @@ static void construct_overlays()
         if (!overtx.Ddb) continue;
         overtx.Ddb->SetStretch(over.scaleWidth, over.scaleHeight);
         overtx.Ddb->SetAlpha(GfxDef::LegacyTrans255ToAlpha255(over.transparency));
+        if (drawstate.WalkBehindMethod == DrawByMaskInShader)
+            overtx.Ddb->SetWalkBehindBaseline(over.IsRoomLayer() ? over.zorder : kNoWalkBehindBaseline);
     }
 }
 
@@ -2811,6 +3132,7 @@ void construct_game_scene(bool full_redraw)
 
 void construct_game_screen_overlay(bool draw_mouse)
 {
+    FrameStageScope stage_scope(kFrameStage_GUI);
     gfxDriver->BeginSpriteBatch(play.GetMainViewport(),
             play.GetGlobalTransform(drawstate.FullFrameRedraw),
             (GraphicFlip)play.screen_flipped);
@@ -2871,6 +3193,8 @@ void construct_engine_overlay()
 
     if (display_fps != kFPS_Hide)
         draw_fps(viewport);
+    if (display_frame_graph)
+        draw_frame_graph(viewport);
 
     gfxDriver->EndSpriteBatch();
 }
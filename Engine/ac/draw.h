@@ -15,6 +15,7 @@
 #define __AGS_EE_AC__DRAW_H
 
 #include <memory>
+#include <vector>
 #include "core/types.h"
 #include "ac/common_defines.h"
 #include "ac/runtime_defines.h"
@@ -27,6 +28,8 @@ namespace AGS
     namespace Common
     {
         typedef std::shared_ptr<Common::Bitmap> PBitmap;
+        struct ResourceCacheStats;
+        class ThreadPool;
     }
     namespace Engine { class IDriverDependantBitmap; }
 }
@@ -80,6 +83,21 @@ void detect_roomviewport_overlaps(size_t z_index);
 void on_roomcamera_changed(Camera *cam);
 // Marks particular object as need to update the texture
 void mark_object_changed(int objid);
+// Stages of generating a room object's or character's image in software mode;
+// used to tell which of them have to be redone after the object's change
+enum ObjectGfxStage
+{
+    kObjGfx_None      = 0x00,
+    kObjGfx_Transform = 0x01, // scaling and flipping
+    kObjGfx_Tint      = 0x02, // tint or light level
+    kObjGfx_All       = kObjGfx_Transform | kObjGfx_Tint
+};
+// Marks the given stages of the room object's image as outdated
+void mark_object_gfx_dirty(int objid, int stages);
+// Marks the given stages of the character's image as outdated
+void mark_character_gfx_dirty(int charid, int stages);
+// Marks the given stages of all the objects and characters images as outdated
+void mark_all_gfx_dirty(int stages);
 // TODO: write a generic drawable/objcache system where each object
 // allocates a drawable for itself, and disposes one if being removed.
 // Resets drawing index for dynamic objects
@@ -95,6 +113,8 @@ void notify_sprite_changed(int sprnum, bool deleted);
 void texturecache_get_state(size_t &max_size, size_t &cur_size, size_t &locked_size, size_t &ext_size);
 // Returns current cache size
 size_t texturecache_get_size();
+// Get texture cache's hit, miss and eviction statistics
+const Common::ResourceCacheStats &texturecache_get_stats();
 // Completely resets texture cache
 void texturecache_clear();
 // Update shared and cached texture from the sprite's pixels
@@ -121,6 +141,21 @@ void mark_current_background_dirty();
 // Avoid freeing and reallocating the memory if possible
 Common::Bitmap *recycle_bitmap(Common::Bitmap *bimp, int coldep, int wid, int hit, bool make_transparent = false);
 void recycle_bitmap(std::unique_ptr<Common::Bitmap> &bimp, int coldep, int wid, int hit, bool make_transparent = false);
+// A scaling and flipping of the sprite, which may be done on a worker thread.
+// Used for software render mode only.
+struct SpriteTransformJob
+{
+    Common::Bitmap *Sprite = nullptr; // source image, the job is skipped if null
+    bool HasAlpha = false;
+    Size DstSize;
+    Common::GraphicFlip Flip = Common::kFlip_None;
+    // transformed image; an existing bitmap is reused if possible
+    std::unique_ptr<Common::Bitmap> Result;
+    bool Done = false;
+};
+// Runs the transformation jobs on the thread pool, and waits for them to finish;
+// the jobs must not require antialiased scaling, which uses a global state
+void run_sprite_transform_jobs(std::vector<SpriteTransformJob> &jobs, Common::ThreadPool &pool);
 Engine::IDriverDependantBitmap* recycle_ddb_bitmap(Engine::IDriverDependantBitmap *ddb, Common::Bitmap *source, bool has_alpha = false, bool opaque = false);
 Engine::IDriverDependantBitmap* recycle_ddb_sprite(Engine::IDriverDependantBitmap *ddb, uint32_t sprite_id,
     Common::Bitmap *source, bool has_alpha = false, bool opaque = false);
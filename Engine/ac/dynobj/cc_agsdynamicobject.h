@@ -68,6 +68,9 @@ public:
     void WriteInt16(void *address, intptr_t offset, int16_t val) override;
     void WriteInt32(void *address, intptr_t offset, int32_t val) override;
     void WriteFloat(void *address, intptr_t offset, float val) override;
+
+    // The objects are not allocated by the ManagedHeap by default
+    bool HasManagedHeader() override { return false; }
 };
 
 
@@ -48,7 +48,7 @@ int CCDynamicArray::Dispose(void *address, bool force)
         }
     }
 
-    delete[] (static_cast<uint8_t*>(address) - MemHeaderSz);
+    ManagedHeap::Free(address, MemHeaderSz);
     return 1;
 }
 
@@ -68,12 +68,12 @@ void CCDynamicArray::Serialize(const void *address, Stream *out)
 
 void CCDynamicArray::Unserialize(int index, Stream *in, size_t data_sz)
 {
-    uint8_t *new_arr = new uint8_t[(data_sz - FileHeaderSz) + MemHeaderSz];
-    Header &hdr = reinterpret_cast<Header&>(*new_arr);
+    void *obj_ptr = ManagedHeap::Allocate(MemHeaderSz, data_sz - FileHeaderSz);
+    Header &hdr = GetHeader(obj_ptr);
     hdr.ElemCount = in->ReadInt32();
     hdr.TotalSize = in->ReadInt32();
-    in->Read(new_arr + MemHeaderSz, data_sz - FileHeaderSz);
-    ccRegisterUnserializedObject(index, &new_arr[MemHeaderSz], this);
+    in->Read(obj_ptr, data_sz - FileHeaderSz);
+    ccRegisterUnserializedObject(index, obj_ptr, this);
 }
 
 /* static */ DynObjectRef CCDynamicArray::Create(uint32_t elem_count, uint32_t elem_size, bool is_managed)
@@ -83,16 +83,14 @@ void CCDynamicArray::Unserialize(int index, Stream *in, size_t data_sz)
     if (elem_count > INT32_MAX || (is_managed && elem_size != sizeof(int32_t)))
         return {};
 
-    uint8_t *new_arr = new uint8_t[elem_count * elem_size + MemHeaderSz];
-    memset(new_arr, 0, elem_count * elem_size + MemHeaderSz);
-    Header &hdr = reinterpret_cast<Header&>(*new_arr);
+    void *obj_ptr = ManagedHeap::Allocate(MemHeaderSz, elem_count * elem_size, true);
+    Header &hdr = GetHeader(obj_ptr);
     hdr.ElemCount = elem_count | (ARRAY_MANAGED_TYPE_FLAG * is_managed);
     hdr.TotalSize = elem_size * elem_count;
-    void *obj_ptr = &new_arr[MemHeaderSz];
     int32_t handle = ccRegisterManagedObject(obj_ptr, &globalDynamicArray);
     if (handle == 0)
     {
-        delete[] new_arr;
+        ManagedHeap::Free(obj_ptr, MemHeaderSz);
         return {};
     }
     return DynObjectRef(handle, obj_ptr, &globalDynamicArray);
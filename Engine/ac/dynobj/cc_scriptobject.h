@@ -94,6 +94,10 @@ struct IScriptObject
     virtual void    WriteInt32(void *address, intptr_t offset, int32_t val)   = 0;
     virtual void    WriteFloat(void *address, intptr_t offset, float val)     = 0;
 
+    // Tells whether the objects of this type are allocated by the ManagedHeap
+    // and keep their managed handle in the memory header (see managedheap.h).
+    virtual bool    HasManagedHeader()                                        = 0;
+
 protected:
     IScriptObject() = default;
     ~IScriptObject() = default;
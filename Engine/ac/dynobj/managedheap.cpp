@@ -0,0 +1,213 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/dynobj/managedheap.h"
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+#include <assert.h>
+#include <string.h>
+
+namespace ManagedHeap
+{
+
+// Size class of the blocks allocated from the general heap
+const uint32_t LargeBlock = UINT32_MAX;
+// Slab block sizes are multiples of this value
+const size_t SlabGranularity = 16u;
+// Size classes: step 16 up to 128 bytes, then 4 classes per each power of 2
+const size_t SizeClasses[] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256,
+    320, 384, 448, 512,
+    640, 768, 896, 1024,
+    1280, 1536, 1792, 2048
+};
+const size_t NumSizeClasses = sizeof(SizeClasses) / sizeof(SizeClasses[0]);
+const size_t MaxSlabBlockSize = SizeClasses[NumSizeClasses - 1];
+// Minimal size of a chunk of memory allocated for a slab, and minimal number
+// of blocks in such chunk
+const size_t MinChunkSize = 16 * 1024;
+const size_t MinChunkBlocks = 16u;
+
+struct Chunk
+{
+    uint8_t *Mem = nullptr;
+    size_t Size = 0u;
+    uint32_t SizeClass = 0u;
+};
+
+struct SlabClass
+{
+    void *FreeList = nullptr; // free blocks, linked through their first bytes
+    size_t UsedCount = 0u;    // number of blocks currently in use
+};
+
+struct SlabHeap
+{
+    // size class index per (block size / SlabGranularity), rounded up
+    uint8_t ClassLookup[MaxSlabBlockSize / SlabGranularity + 1];
+    SlabClass Classes[NumSizeClasses];
+    // All the allocated chunks, sorted by their address
+    std::vector<Chunk> Chunks;
+
+    SlabHeap()
+    {
+        for (size_t i = 0, sc = 0; i <= MaxSlabBlockSize / SlabGranularity; ++i)
+        {
+            if (i * SlabGranularity > SizeClasses[sc])
+                sc++;
+            ClassLookup[i] = static_cast<uint8_t>(sc);
+        }
+    }
+
+    ~SlabHeap()
+    {
+        for (auto &chunk : Chunks)
+            delete[] chunk.Mem;
+    }
+
+    void AddChunk(uint32_t size_class)
+    {
+        const size_t block_sz = SizeClasses[size_class];
+        const size_t block_count = std::max(MinChunkBlocks, MinChunkSize / block_sz);
+        Chunk chunk;
+        chunk.Mem = new uint8_t[block_sz * block_count];
+        chunk.Size = block_sz * block_count;
+        chunk.SizeClass = size_class;
+        // Link all the new blocks into the free list
+        auto &sc = Classes[size_class];
+        for (size_t i = block_count; i > 0; --i)
+        {
+            void *block = chunk.Mem + (i - 1) * block_sz;
+            *static_cast<void**>(block) = sc.FreeList;
+            sc.FreeList = block;
+        }
+        Chunks.insert(std::upper_bound(Chunks.begin(), Chunks.end(), chunk,
+            [](const Chunk &a, const Chunk &b) { return a.Mem < b.Mem; }), chunk);
+    }
+
+    uint8_t *AllocBlock(uint32_t size_class)
+    {
+        auto &sc = Classes[size_class];
+        if (!sc.FreeList)
+            AddChunk(size_class);
+        void *block = sc.FreeList;
+        sc.FreeList = *static_cast<void**>(block);
+        sc.UsedCount++;
+        return static_cast<uint8_t*>(block);
+    }
+
+    void FreeBlock(uint8_t *block, uint32_t size_class)
+    {
+        auto &sc = Classes[size_class];
+        assert(sc.UsedCount > 0);
+        *reinterpret_cast<void**>(block) = sc.FreeList;
+        sc.FreeList = block;
+        sc.UsedCount--;
+    }
+
+    const Chunk *FindChunk(const void *address) const
+    {
+        const uint8_t *ptr = static_cast<const uint8_t*>(address);
+        auto it = std::upper_bound(Chunks.begin(), Chunks.end(), ptr,
+            [](const uint8_t *p, const Chunk &c) { return p < c.Mem; });
+        if (it == Chunks.begin())
+            return nullptr;
+        --it;
+        return (ptr < it->Mem + it->Size) ? &*it : nullptr;
+    }
+
+    void ReleaseUnused()
+    {
+        bool unused[NumSizeClasses];
+        for (size_t i = 0; i < NumSizeClasses; ++i)
+        {
+            unused[i] = Classes[i].UsedCount == 0u;
+            if (unused[i])
+                Classes[i].FreeList = nullptr;
+        }
+        auto it_end = std::remove_if(Chunks.begin(), Chunks.end(),
+            [&unused](const Chunk &c)
+            {
+                if (!unused[c.SizeClass])
+                    return false;
+                delete[] c.Mem;
+                return true;
+            });
+        Chunks.erase(it_end, Chunks.end());
+    }
+};
+
+static SlabHeap slabs;
+// Data addresses of the large blocks
+static std::unordered_set<const void*> largeBlocks;
+
+
+void *Allocate(size_t header_sz, size_t data_sz, bool zero_fill)
+{
+    assert(header_sz >= BlockHeaderSz);
+    const size_t block_sz = header_sz + data_sz;
+    uint8_t *block;
+    uint32_t size_class;
+    if (block_sz <= MaxSlabBlockSize)
+    {
+        size_class = slabs.ClassLookup[(block_sz + SlabGranularity - 1) / SlabGranularity];
+        block = slabs.AllocBlock(size_class);
+    }
+    else
+    {
+        size_class = LargeBlock;
+        block = new uint8_t[block_sz];
+        largeBlocks.insert(block + header_sz);
+    }
+
+    if (zero_fill)
+        memset(block, 0, block_sz);
+    void *address = block + header_sz;
+    BlockHeader &bh = GetBlockHeader(address);
+    bh.Handle = 0;
+    bh.SizeClass = size_class;
+    return address;
+}
+
+void Free(void *address, size_t header_sz)
+{
+    if (!address)
+        return;
+    const uint32_t size_class = GetBlockHeader(address).SizeClass;
+    uint8_t *block = static_cast<uint8_t*>(address) - header_sz;
+    if (size_class == LargeBlock)
+    {
+        largeBlocks.erase(address);
+        delete[] block;
+    }
+    else
+        slabs.FreeBlock(block, size_class);
+}
+
+bool IsHeapBlock(const void *address)
+{
+    // The block header must be within the same chunk
+    const Chunk *chunk = slabs.FindChunk(address);
+    if (chunk)
+        return static_cast<const uint8_t*>(address) >= chunk->Mem + BlockHeaderSz;
+    return largeBlocks.count(address) > 0;
+}
+
+void ReleaseUnusedMemory()
+{
+    slabs.ReleaseUnused();
+}
+
+} // namespace ManagedHeap
@@ -0,0 +1,82 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ManagedHeap is a memory allocator for the managed objects which keep
+// their memory header and data in a single buffer: dynamic structs, dynamic
+// arrays and strings.
+//
+// Small blocks are allocated from the size-class slabs: each size class has
+// a list of free blocks, which is refilled by allocating a larger chunk of
+// memory at once. Freed blocks are returned to their class's list and reused.
+// Large blocks are allocated from the general heap, and their addresses are
+// kept in a hash set, so that any block of this heap may be told by address.
+//
+// Every object's memory header ends with a BlockHeader, which is placed right
+// before the object's data. It keeps a block's size class, and the object's
+// managed handle, which lets the managed pool find the handle by the object's
+// address with a pointer arithmetic.
+// The pool may be asked about an arbitrary address though (e.g. a pointer to
+// a string literal), whose header cannot be read safely; so IsHeapBlock()
+// has to confirm the block first: it is a binary search among the slab chunks
+// (there are few of them, as each holds many blocks), and a hash lookup
+// among the large blocks only if the address is not in any chunk.
+//
+// NOTE: ManagedHeap is not thread-safe, and is meant to be used only
+// on the game update thread (same as the managed pool).
+//
+//=============================================================================
+#ifndef __AGS_EE_DYNOBJ__MANAGEDHEAP_H
+#define __AGS_EE_DYNOBJ__MANAGEDHEAP_H
+
+#include "core/types.h"
+
+namespace ManagedHeap
+{
+    // The trailing part of the object's memory header
+    struct BlockHeader
+    {
+        int32_t  Handle = 0;     // managed object's handle, 0 if not registered
+        uint32_t SizeClass = 0u; // index of the slab size class
+    };
+
+    // The size of the BlockHeader; must be counted in the object's header size
+    const size_t BlockHeaderSz = sizeof(BlockHeader);
+
+    // Allocates a memory block for the object which has a memory header of
+    // header_sz bytes (including BlockHeader) and data of data_sz bytes;
+    // returns a pointer to the beginning of the object's data.
+    void *Allocate(size_t header_sz, size_t data_sz, bool zero_fill = false);
+    // Frees the object's memory block, header_sz must match the one passed
+    // to Allocate() when this object was created.
+    void  Free(void *address, size_t header_sz);
+    // Tells whether the given address belongs to a small (slab) or large block;
+    // this may be used to test the arbitrary address before accessing its header.
+    // Costs O(log N) of the number of slab chunks, plus a hash lookup for
+    // the addresses outside of slabs.
+    bool  IsHeapBlock(const void *address);
+    // Frees the slab memory of the size classes which don't have any used blocks
+    void  ReleaseUnusedMemory();
+
+    inline BlockHeader &GetBlockHeader(void *address)
+    {
+        return *reinterpret_cast<BlockHeader*>(static_cast<uint8_t*>(address) - BlockHeaderSz);
+    }
+
+    inline const BlockHeader &GetBlockHeader(const void *address)
+    {
+        return *reinterpret_cast<const BlockHeader*>(static_cast<const uint8_t*>(address) - BlockHeaderSz);
+    }
+} // namespace ManagedHeap
+
+#endif // __AGS_EE_DYNOBJ__MANAGEDHEAP_H
@@ -14,6 +14,7 @@
 #include <vector>
 #include <string.h>
 #include "ac/dynobj/managedobjectpool.h"
+#include "ac/dynobj/managedheap.h"
 #include "debug/out.h"
 #include "util/string_utils.h"               // fputstring, etc
 #include "script/cc_common.h"
@@ -32,12 +33,19 @@ int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
         return 0;
 
     available_ids.push(o.handle);
-    handleByAddress.erase(o.addr);
+    if (!o.inHeader)
+        extHandleByAddress.erase(o.addr);
     ManagedObjectLog("Line %d Disposed managed object handle=%d", currentline, o.handle);
     o = ManagedObject();
     return 1;
 }
 
+void ManagedObjectPool::AddGCCandidate(ManagedObject &o) {
+    if (o.gcCandidate) { return; }
+    o.gcCandidate = true;
+    gcCandidates.push_back(o.handle);
+}
+
 int32_t ManagedObjectPool::AddRef(int32_t handle) {
     if (handle < 1 || (size_t)handle >= objects.size())
         return 0;
@@ -55,7 +63,9 @@ int ManagedObjectPool::CheckDispose(int32_t handle) {
     auto & o = objects[handle];
     if (!o.isUsed()) { return 1; }
     if (o.refCount >= 1) { return 0; }
-    return Remove(o);
+    if (Remove(o)) { return 1; }
+    AddGCCandidate(o);
+    return 0;
 }
 
 int32_t ManagedObjectPool::SubRef(int32_t handle) {
@@ -66,19 +76,36 @@ int32_t ManagedObjectPool::SubRef(int32_t handle) {
     o.refCount--;
     const auto newRefCount = o.refCount;
     const auto canBeDisposed = (o.addr != disableDisposeForObject);
-    if (canBeDisposed && o.refCount <= 0) {
-        Remove(o);
+    if (o.refCount <= 0) {
+        if (!canBeDisposed || !Remove(o))
+            AddGCCandidate(o);
     }
     // object could be removed at this point, don't use any values.
     ManagedObjectLog("Line %d SubRef: handle=%d new refcount=%d canBeDisposed=%d", currentline, handle, newRefCount, canBeDisposed);
     return newRefCount;
 }
 
-int32_t ManagedObjectPool::AddressToHandle(void *addr) {
+int32_t ManagedObjectPool::HeaderToHandle(void *addr) {
+    // the header may be stale or belong to an unregistered object, so verify
+    const int32_t handle = ManagedHeap::GetBlockHeader(addr).Handle;
+    if (handle < 1 || (size_t)handle >= objects.size()) { return 0; }
+    const auto &o = objects[handle];
+    return (o.isUsed() && o.addr == addr) ? handle : 0;
+}
+
+// this function is called often (whenever a pointer is assigned)
+int32_t ManagedObjectPool::AddressToHandle(void *addr, IScriptObject *manager) {
     if (addr == nullptr) { return 0; }
-    auto it = handleByAddress.find(addr);
-    if (it == handleByAddress.end()) { return 0; }
-    return it->second;
+    // This may be an object allocated by the ManagedHeap; but its header may be
+    // safely accessed only if it's a known memory block, as the manager's pointer
+    // may also refer to a non-managed buffer (e.g. a string literal).
+    // Only the objects which don't have a managed header (engine's own structs)
+    // are looked up in the hash map.
+    if ((!manager || manager->HasManagedHeader()) && ManagedHeap::IsHeapBlock(addr)) {
+        return HeaderToHandle(addr);
+    }
+    auto it = extHandleByAddress.find(addr);
+    return (it != extHandleByAddress.end()) ? it->second : 0;
 }
 
 // this function is called often (whenever a pointer is used)
@@ -104,11 +131,10 @@ ScriptValueType ManagedObjectPool::HandleToAddressAndManager(int32_t handle, voi
 }
 
 int ManagedObjectPool::RemoveObject(void *address) {
-    if (address == nullptr) { return 0; }
-    auto it = handleByAddress.find(address);
-    if (it == handleByAddress.end()) { return 0; }
+    const int32_t handle = AddressToHandle(address);
+    if (handle == 0) { return 0; }
 
-    auto & o = objects[it->second];
+    auto & o = objects[handle];
     return Remove(o, true);
 }
 
@@ -121,13 +147,24 @@ void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
 
 void ManagedObjectPool::RunGarbageCollection()
 {
-    for (int i = 1; i < nextHandle; i++) {
-        auto & o = objects[i];
-        if (!o.isUsed()) { continue; }
-        if (o.refCount < 1) {
-            Remove(o);
+    // Disposing objects may add new candidates (e.g. the ones that refused
+    // to be disposed), these will be checked on the next run
+    std::vector<int32_t> candidates;
+    std::swap(candidates, gcCandidates);
+    for (const auto handle : candidates) {
+        auto & o = objects[handle];
+        if (!o.gcCandidate) { continue; } // duplicate or stale entry
+        o.gcCandidate = false;
+        if (!o.isUsed() || (o.refCount >= 1)) { continue; }
+        if (!Remove(o)) {
+            AddGCCandidate(o);
         }
     }
+    // Reuse the allocated buffer, if nothing was added meanwhile
+    if (gcCandidates.empty()) {
+        candidates.clear();
+        std::swap(candidates, gcCandidates);
+    }
     ManagedObjectLog("Ran garbage collection");
 }
 
@@ -136,9 +173,14 @@ int ManagedObjectPool::Add(int handle, void *address, IScriptObject *callback, S
     auto &o = objects[handle];
     assert(!o.isUsed());
 
-    o = ManagedObject(obj_type, handle, address, callback);
+    o = ManagedObject(obj_type, handle, address, callback, callback->HasManagedHeader());
+    // new object has no references yet
+    AddGCCandidate(o);
 
-    handleByAddress.insert({address, handle});
+    if (o.inHeader)
+        ManagedHeap::GetBlockHeader(address).Handle = handle;
+    else
+        extHandleByAddress.insert({address, handle});
     ManagedObjectLog("Allocated managed object type=%s, handle=%d, addr=%08X", callback->GetType(), handle, address);
     return handle;
 }
@@ -285,9 +327,16 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
             nextHandle = o.handle + 1;
         }
     }
+    // re-collect garbage collection candidates, as the reference counts were restored
+    for (auto &handle : gcCandidates) {
+        objects[handle].gcCandidate = false;
+    }
+    gcCandidates.clear();
     for (int i = 1; i < nextHandle; i++) {
         if (!objects[i].isUsed()) {
             available_ids.push(i);
+        } else if (objects[i].refCount < 1) {
+            AddGCCandidate(objects[i]);
         }
     }
 
@@ -302,7 +351,10 @@ void ManagedObjectPool::reset() {
         Remove(o, true);
     }
     available_ids = std::queue<int32_t>();
+    gcCandidates.clear();
     nextHandle = 1;
+    // all the script-allocated objects are freed now, let the memory go too
+    ManagedHeap::ReleaseUnusedMemory();
 }
 
 void ManagedObjectPool::TraverseManagedObjects(const String &type, PfnProcessObject proc)
@@ -316,8 +368,9 @@ void ManagedObjectPool::TraverseManagedObjects(const String &type, PfnProcessObj
     }
 }
 
-ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextHandle(1), available_ids(), objects(RESERVED_SIZE, ManagedObject()), handleByAddress() {
-    handleByAddress.reserve(RESERVED_SIZE);
+ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextHandle(1), available_ids(), objects(RESERVED_SIZE, ManagedObject()), extHandleByAddress() {
+    extHandleByAddress.reserve(RESERVED_SIZE);
+    gcCandidates.reserve(GARBAGE_COLLECTION_INTERVAL * 2);
 }
 
 ManagedObjectPool pool;
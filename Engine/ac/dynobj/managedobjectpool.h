@@ -36,13 +36,15 @@ private:
         void *addr;
         IScriptObject *callback;
         int refCount;
+        bool gcCandidate; // is in the garbage collection candidates list
+        bool inHeader; // the handle is stored in the object's memory header
 
         bool isUsed() const { return obj_type != kScValUndefined; }
 
         ManagedObject() 
-            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0) {}
-        ManagedObject(ScriptValueType obj_type, int32_t handle, void *addr, IScriptObject * callback) 
-            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0) {}
+            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0), gcCandidate(false), inHeader(false) {}
+        ManagedObject(ScriptValueType obj_type, int32_t handle, void *addr, IScriptObject * callback, bool in_header)
+            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0), gcCandidate(false), inHeader(in_header) {}
     };
 
     int objectCreationCounter;  // used to do garbage collection every so often
@@ -50,18 +52,29 @@ private:
     int32_t nextHandle {}; // TODO: manage nextHandle's going over INT32_MAX !
     std::queue<int32_t> available_ids;
     std::vector<ManagedObject> objects;
-    std::unordered_map<void*, int32_t> handleByAddress;
+    // Handles of the objects which are not allocated by the ManagedHeap,
+    // and so cannot store their handle in the memory header
+    std::unordered_map<void*, int32_t> extHandleByAddress;
+    // Handles of objects which were left with zero references without being
+    // disposed: newly created ones, and those which could not be disposed at once;
+    // garbage collection only checks these instead of scanning the whole pool.
+    // May contain duplicate or stale handles, these are skipped by the GC.
+    std::vector<int32_t> gcCandidates;
 
     int  Add(int handle, void *address, IScriptObject *callback, ScriptValueType obj_type);
     int  Remove(ManagedObject &o, bool force = false);
+    void AddGCCandidate(ManagedObject &o);
     void RunGarbageCollection();
+    int32_t HeaderToHandle(void *addr);
 
 public:
 
     int32_t AddRef(int32_t handle);
     int CheckDispose(int32_t handle);
     int32_t SubRef(int32_t handle);
-    int32_t AddressToHandle(void *addr);
+    // Finds the handle of an object by its address; the object's manager
+    // is optional, but lets find the handle faster
+    int32_t AddressToHandle(void *addr, IScriptObject *manager = nullptr);
     void* HandleToAddress(int32_t handle);
     ScriptValueType HandleToAddressAndManager(int32_t handle, void *&object, IScriptObject *&manager);
     int RemoveObject(void *address);
@@ -14,6 +14,11 @@
 #ifndef __AC_SCRIPTCONTAINERS_H
 #define __AC_SCRIPTCONTAINERS_H
 
+#include <string.h>
+#include "util/smallstring.h"
+#include "util/string_compat.h"
+#include "util/string_types.h"
+
 class ScriptDictBase;
 class ScriptSetBase;
 
@@ -26,4 +31,67 @@ ScriptSetBase *Set_Create(bool sorted, bool case_sensitive);
 // Unserialize set from the memory stream
 ScriptSetBase *Set_Unserialize(int index, AGS::Common::Stream *in, size_t data_sz);
 
+
+// Key passed to the script container's lookups: the key's text, and its
+// case-sensitive hash if it's known in advance (e.g. cached by a script
+// string), or 0 if it's unknown. Null text is treated as an empty string.
+struct ScriptContainerKey
+{
+    const char *Text = nullptr;
+    size_t      Length = 0u;
+    uint32_t    Hash = 0u;
+
+    ScriptContainerKey(const char *text, uint32_t hash)
+        : Text(text ? text : ""), Length(text ? strlen(text) : 0u), Hash(hash) {}
+    ScriptContainerKey(const char *text, size_t length, uint32_t hash)
+        : Text(text), Length(length), Hash(hash) {}
+};
+
+// Key operations for the script containers, which store the keys as
+// SmallStrings and look them up by ScriptContainerKey.
+template <bool is_casesensitive>
+struct ScriptContainerKeyTraits;
+
+template <>
+struct ScriptContainerKeyTraits<true>
+{
+    static uint32_t Hash(const ScriptContainerKey &key)
+    {
+        return key.Hash != 0u ? key.Hash : static_cast<uint32_t>(FNV::Hash(key.Text, key.Length));
+    }
+    static bool Equals(const AGS::Common::SmallString &stored, const ScriptContainerKey &key)
+    {
+        return stored.GetLength() == key.Length && memcmp(stored.GetCStr(), key.Text, key.Length) == 0;
+    }
+    static int Compare(const AGS::Common::SmallString &stored, const ScriptContainerKey &key)
+    {
+        return strcmp(stored.GetCStr(), key.Text);
+    }
+    static AGS::Common::SmallString MakeKey(const ScriptContainerKey &key)
+    {
+        return AGS::Common::SmallString(key.Text, key.Length);
+    }
+};
+
+template <>
+struct ScriptContainerKeyTraits<false>
+{
+    static uint32_t Hash(const ScriptContainerKey &key)
+    {
+        return static_cast<uint32_t>(FNV::Hash_LowerCase(key.Text, key.Length));
+    }
+    static bool Equals(const AGS::Common::SmallString &stored, const ScriptContainerKey &key)
+    {
+        return stored.GetLength() == key.Length && ags_strnicmp(stored.GetCStr(), key.Text, key.Length) == 0;
+    }
+    static int Compare(const AGS::Common::SmallString &stored, const ScriptContainerKey &key)
+    {
+        return ags_stricmp(stored.GetCStr(), key.Text);
+    }
+    static AGS::Common::SmallString MakeKey(const ScriptContainerKey &key)
+    {
+        return AGS::Common::SmallString(key.Text, key.Length);
+    }
+};
+
 #endif // __AC_SCRIPTCONTAINERS_H
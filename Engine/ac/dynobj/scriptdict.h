@@ -12,26 +12,26 @@
 //
 //=============================================================================
 //
-// Managed script object wrapping std::map<String, String> and
-// unordered_map<String, String>.
+// Managed script object wrapping a sorted BTreeMap or an unsorted
+// FlatHashMap of strings. Keys and values are stored as SmallStrings, and
+// looked up by the plain text, without making a copy of it. Hash dictionaries
+// take a key's hash from the script string's header when it's available.
 //
 // TODO: support wrapping non-owned Dictionary, passed by the reference, -
 // that would let expose internal engine's dicts using same interface.
-// TODO: maybe optimize key lookup operations further by not creating a String
-// object from const char*. It seems, C++14 standard allows to use convertible
-// types as keys; need to research what performance impact that would make.
 //
 //=============================================================================
 #ifndef __AC_SCRIPTDICT_H
 #define __AC_SCRIPTDICT_H
 
-#include <map>
-#include <unordered_map>
 #include <string.h>
 #include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/scriptcontainers.h"
+#include "util/btree.h"
+#include "util/flathash.h"
+#include "util/smallstring.h"
 #include "util/stream.h"
 #include "util/string.h"
-#include "util/string_types.h"
 
 using namespace AGS::Common;
 
@@ -45,11 +45,13 @@ public:
     virtual bool IsCaseSensitive() const = 0;
     virtual bool IsSorted() const = 0;
 
+    // NOTE: key_hash is the key's precalculated case-sensitive hash,
+    // or 0 if it's not known
     virtual void Clear() = 0;
-    virtual bool Contains(const char *key) = 0;
-    virtual const char *Get(const char *key) = 0;
-    virtual bool Remove(const char *key) = 0;
-    virtual bool Set(const char *key, const char *value) = 0;
+    virtual bool Contains(const char *key, uint32_t key_hash) = 0;
+    virtual const char *Get(const char *key, uint32_t key_hash) = 0;
+    virtual bool Remove(const char *key, uint32_t key_hash) = 0;
+    virtual bool Set(const char *key, uint32_t key_hash, const char *value) = 0;
     virtual int GetItemCount() = 0;
     virtual void GetKeys(std::vector<const char*> &buf) const = 0;
     virtual void GetValues(std::vector<const char*> &buf) const = 0;
@@ -83,30 +85,33 @@ public:
             DeleteItem(it);
         _dic.clear();
     }
-    bool Contains(const char *key) override { return _dic.count(String::Wrapper(key)) != 0; }
-    const char *Get(const char *key) override
+    bool Contains(const char *key, uint32_t key_hash) override
     {
-        auto it = _dic.find(String::Wrapper(key));
+        return _dic.count(ScriptContainerKey(key, key_hash)) != 0;
+    }
+    const char *Get(const char *key, uint32_t key_hash) override
+    {
+        auto it = _dic.find(ScriptContainerKey(key, key_hash));
         if (it == _dic.end()) return nullptr;
         return it->second.GetCStr();
     }
-    bool Remove(const char *key) override
+    bool Remove(const char *key, uint32_t key_hash) override
     {
-        auto it = _dic.find(String::Wrapper(key));
+        auto it = _dic.find(ScriptContainerKey(key, key_hash));
         if (it == _dic.end()) return false;
         DeleteItem(it);
         _dic.erase(it);
         return true;
     }
-    bool Set(const char *key, const char *value) override
+    bool Set(const char *key, uint32_t key_hash, const char *value) override
     {
         if (!key) return false;
         if (!value)
         { // remove keys with null value
-            Remove(key);
+            Remove(key, key_hash);
             return true;
         }
-        return TryAddItem(String(key), String(value));
+        return TryAddItem(ScriptContainerKey(key, key_hash), value, strlen(value));
     }
     int GetItemCount() override { return _dic.size(); }
     void GetKeys(std::vector<const char*> &buf) const override
@@ -121,9 +126,9 @@ public:
     }
 
 private:
-    bool TryAddItem(const String &key, const String &value)
+    bool TryAddItem(const ScriptContainerKey &key, const char *value, size_t value_len)
     {
-        _dic[key] = value;
+        _dic[key] = SmallString(value, value_len);
         return true;
     }
     void DeleteItem(ConstIterator /*it*/) { /* do nothing */ }
@@ -164,7 +169,7 @@ private:
             if (value_len != (size_t)-1) // do not restore keys with null value (old format)
             {
                 String value = String::FromStreamCount(in, value_len);
-                TryAddItem(key, value);
+                TryAddItem(ScriptContainerKey(key.GetCStr(), key.GetLength(), 0u), value.GetCStr(), value.GetLength());
             }
         }
     }
@@ -172,9 +177,9 @@ private:
     TDict _dic;
 };
 
-typedef ScriptDictImpl< std::map<String, String>, true, true > ScriptDict;
-typedef ScriptDictImpl< std::map<String, String, StrLessNoCase>, true, false > ScriptDictCI;
-typedef ScriptDictImpl< std::unordered_map<String, String>, false, true > ScriptHashDict;
-typedef ScriptDictImpl< std::unordered_map<String, String, HashStrNoCase, StrEqNoCase>, false, false > ScriptHashDictCI;
+typedef ScriptDictImpl< BTreeMap<SmallString, SmallString, ScriptContainerKeyTraits<true>>, true, true > ScriptDict;
+typedef ScriptDictImpl< BTreeMap<SmallString, SmallString, ScriptContainerKeyTraits<false>>, true, false > ScriptDictCI;
+typedef ScriptDictImpl< FlatHashMap<SmallString, SmallString, ScriptContainerKeyTraits<true>>, false, true > ScriptHashDict;
+typedef ScriptDictImpl< FlatHashMap<SmallString, SmallString, ScriptContainerKeyTraits<false>>, false, false > ScriptHashDictCI;
 
 #endif // __AC_SCRIPTDICT_H
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "ac/dynobj/scriptgame.h"
+#include "ac/draw.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
@@ -192,7 +193,11 @@ void CCScriptGame::WriteInt32(void *address, intptr_t offset, int32_t val)
     case 94:  play.ambient_sounds_persist = val; break;
     case 95:  play.lipsync_speed = val; break;
     case 96:  play.close_mouth_speech_time = val; break;
-    case 97:  play.disable_antialiasing = val; break;
+    case 97:
+        if (play.disable_antialiasing != val)
+            mark_all_gfx_dirty(kObjGfx_Transform); // sprites are scaled differently
+        play.disable_antialiasing = val;
+        break;
     case 98:  play.text_speed_modifier = val; break;
     case 99:  play.text_align = ReadScriptAlignment(val); break;
     case 100:  play.speech_bubble_width = val; break;
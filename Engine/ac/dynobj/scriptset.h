@@ -12,25 +12,26 @@
 //
 //=============================================================================
 //
-// Managed script object wrapping std::set<String> and unordered_set<String>.
+// Managed script object wrapping a sorted BTreeSet or an unsorted
+// FlatHashSet of strings. Items are stored as SmallStrings, and looked up
+// by the plain text, without making a copy of it. Hash sets take an item's
+// hash from the script string's header when it's available.
 //
 // TODO: support wrapping non-owned Set, passed by the reference, -
 // that would let expose internal engine's sets using same interface.
-// TODO: maybe optimize key lookup operations further by not creating a String
-// object from const char*. It seems, C++14 standard allows to use convertible
-// types as keys; need to research what performance impact that would make.
 //
 //=============================================================================
 #ifndef __AC_SCRIPTSET_H
 #define __AC_SCRIPTSET_H
 
-#include <set>
-#include <unordered_set>
 #include <string.h>
 #include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/scriptcontainers.h"
+#include "util/btree.h"
+#include "util/flathash.h"
+#include "util/smallstring.h"
 #include "util/stream.h"
 #include "util/string.h"
-#include "util/string_types.h"
 
 using namespace AGS::Common;
 
@@ -44,10 +45,12 @@ public:
     virtual bool IsCaseSensitive() const = 0;
     virtual bool IsSorted() const = 0;
 
-    virtual bool Add(const char *item) = 0;
+    // NOTE: item_hash is the item's precalculated case-sensitive hash,
+    // or 0 if it's not known
+    virtual bool Add(const char *item, uint32_t item_hash) = 0;
     virtual void Clear() = 0;
-    virtual bool Contains(const char *item) const = 0;
-    virtual bool Remove(const char *item) = 0;
+    virtual bool Contains(const char *item, uint32_t item_hash) const = 0;
+    virtual bool Remove(const char *item, uint32_t item_hash) = 0;
     virtual int GetItemCount() const = 0;
     virtual void GetItems(std::vector<const char*> &buf) const = 0;
 
@@ -74,10 +77,10 @@ public:
     bool IsCaseSensitive() const override { return is_casesensitive; }
     bool IsSorted() const override { return is_sorted; }
 
-    bool Add(const char *item) override
+    bool Add(const char *item, uint32_t item_hash) override
     {
         if (!item) return false;
-        return TryAddItem(String(item));
+        return TryAddItem(ScriptContainerKey(item, item_hash));
     }
     void Clear() override
     {
@@ -85,10 +88,13 @@ public:
             DeleteItem(it);
         _set.clear();
     }
-    bool Contains(const char *item) const override { return _set.count(String::Wrapper(item)) != 0; }
-    bool Remove(const char *item) override
+    bool Contains(const char *item, uint32_t item_hash) const override
     {
-        auto it = _set.find(String::Wrapper(item));
+        return _set.count(ScriptContainerKey(item, item_hash)) != 0;
+    }
+    bool Remove(const char *item, uint32_t item_hash) override
+    {
+        auto it = _set.find(ScriptContainerKey(item, item_hash));
         if (it == _set.end()) return false;
         DeleteItem(it);
         _set.erase(it);
@@ -102,9 +108,9 @@ public:
     }
 
 private:
-    bool TryAddItem(const String &s)
+    bool TryAddItem(const ScriptContainerKey &item)
     {
-        return _set.insert(s).second;
+        return _set.insert(item).second;
     }
     void DeleteItem(ConstIterator /*it*/) { /* do nothing */ }
 
@@ -135,16 +141,16 @@ private:
         {
             size_t len = in->ReadInt32();
             String item = String::FromStreamCount(in, len);
-            TryAddItem(item);
+            TryAddItem(ScriptContainerKey(item.GetCStr(), item.GetLength(), 0u));
         }
     }
 
     TSet _set;
 };
 
-typedef ScriptSetImpl< std::set<String>, true, true > ScriptSet;
-typedef ScriptSetImpl< std::set<String, StrLessNoCase>, true, false > ScriptSetCI;
-typedef ScriptSetImpl< std::unordered_set<String>, false, true > ScriptHashSet;
-typedef ScriptSetImpl< std::unordered_set<String, HashStrNoCase, StrEqNoCase>, false, false > ScriptHashSetCI;
+typedef ScriptSetImpl< BTreeSet<SmallString, ScriptContainerKeyTraits<true>>, true, true > ScriptSet;
+typedef ScriptSetImpl< BTreeSet<SmallString, ScriptContainerKeyTraits<false>>, true, false > ScriptSetCI;
+typedef ScriptSetImpl< FlatHashSet<SmallString, ScriptContainerKeyTraits<true>>, false, true > ScriptHashSet;
+typedef ScriptSetImpl< FlatHashSet<SmallString, ScriptContainerKeyTraits<false>>, false, false > ScriptHashSetCI;
 
 #endif // __AC_SCRIPTSET_H
@@ -14,23 +14,135 @@
 #include "ac/dynobj/scriptstring.h"
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <vector>
 #include <allegro.h>
 #include "ac/string.h"
 #include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/managedobjectpool.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 
 using namespace AGS::Common;
 
 ScriptString myScriptStringImpl;
 
+// Table of the interned script strings: an open-addressing hash set of
+// the string objects, which uses hashes and lengths from their headers.
+class ScriptStringInternTable
+{
+public:
+    // Finds an interned string with the given contents
+    const char *Find(const char *text, size_t len, uint32_t hash) const
+    {
+        if (_slots.empty())
+            return nullptr;
+        const size_t mask = _slots.size() - 1;
+        for (size_t i = hash & mask; _slots[i]; i = (i + 1) & mask)
+        {
+            const ScriptString::Header &hdr = ScriptString::GetHeader(_slots[i]);
+            if ((hdr.Hash == hash) && (hdr.Length == len) && (memcmp(_slots[i], text, len) == 0))
+                return _slots[i];
+        }
+        return nullptr;
+    }
+
+    // Adds a string object, which contents must not be in the table yet
+    void Insert(const char *str)
+    {
+        if ((_count + 1) * 2 > _slots.size())
+            Grow();
+        const size_t mask = _slots.size() - 1;
+        size_t i = ScriptString::GetHeader(str).Hash & mask;
+        for (; _slots[i]; i = (i + 1) & mask);
+        _slots[i] = str;
+        _count++;
+    }
+
+    // Removes a string object, if it's the one interned
+    void Erase(const char *str)
+    {
+        if (_slots.empty())
+            return;
+        const size_t mask = _slots.size() - 1;
+        size_t i = ScriptString::GetHeader(str).Hash & mask;
+        for (; _slots[i] && (_slots[i] != str); i = (i + 1) & mask);
+        if (!_slots[i])
+            return;
+        // Shift back the following entries which were displaced by this one
+        for (size_t j = (i + 1) & mask; _slots[j]; j = (j + 1) & mask)
+        {
+            const size_t want = ScriptString::GetHeader(_slots[j]).Hash & mask;
+            // move if the wanted position is not within (i, j] cyclic range
+            if (((j - want) & mask) >= ((j - i) & mask))
+            {
+                _slots[i] = _slots[j];
+                i = j;
+            }
+        }
+        _slots[i] = nullptr;
+        _count--;
+    }
+
+private:
+    void Grow()
+    {
+        std::vector<const char*> old_slots(std::max<size_t>(256u, _slots.size() * 2), nullptr);
+        std::swap(old_slots, _slots);
+        _count = 0u;
+        for (const char *str : old_slots)
+        {
+            if (str)
+                Insert(str);
+        }
+    }
+
+    std::vector<const char*> _slots;
+    size_t _count = 0u;
+};
+
+static ScriptStringInternTable internTable;
+
 const char *ScriptString::GetType()
 {
     return "String";
 }
 
+ScriptString::Buffer::~Buffer()
+{
+    ManagedHeap::Free(_text, MemHeaderSz);
+}
+
+ScriptString::Buffer::Buffer(Buffer &&buf)
+    : _text(buf._text), _sz(buf._sz)
+{
+    buf._text = nullptr;
+    buf._sz = 0u;
+}
+
+ScriptString::Buffer &ScriptString::Buffer::operator =(Buffer &&buf)
+{
+    if (this != &buf)
+    {
+        ManagedHeap::Free(_text, MemHeaderSz);
+        _text = buf.Release();
+        _sz = buf._sz;
+        buf._sz = 0u;
+    }
+    return *this;
+}
+
+char *ScriptString::Buffer::Release()
+{
+    char *text = _text;
+    _text = nullptr;
+    return text;
+}
+
 int ScriptString::Dispose(void *address, bool /*force*/)
 {
-    delete[] (static_cast<uint8_t*>(address) - MemHeaderSz);
+    internTable.Erase(static_cast<const char*>(address));
+    ManagedHeap::Free(address, MemHeaderSz);
     return 1;
 }
 
@@ -50,40 +162,78 @@ void ScriptString::Serialize(const void* address, Stream *out)
 void ScriptString::Unserialize(int index, Stream *in, size_t /*data_sz*/)
 {
     size_t len = in->ReadInt32();
-    uint8_t *buf = new uint8_t[len + 1 + MemHeaderSz];
-    char *text_ptr = reinterpret_cast<char*>(buf + MemHeaderSz);
+    char *text_ptr = static_cast<char*>(ManagedHeap::Allocate(MemHeaderSz, len + 1));
     in->Read(text_ptr, len + 1); // it was writing trailing 0 for some reason
     text_ptr[len] = 0; // for safety
-    Header &hdr = reinterpret_cast<Header&>(*buf);
+    Header &hdr = GetHeader(text_ptr);
     hdr.Length = len;
     hdr.ULength = ustrlen(text_ptr);
     hdr.LastCharIdx = 0u;
     hdr.LastCharOff = 0u;
+    hdr.Hash = CalcHash(text_ptr, len);
+    // Restored objects may have same contents, only intern the first one
+    if (!internTable.Find(text_ptr, len, hdr.Hash))
+        internTable.Insert(text_ptr);
     ccRegisterUnserializedObject(index, text_ptr, this);
 }
 
-DynObjectRef ScriptString::CreateObject(uint8_t *buf)
+uint32_t ScriptString::CalcHash(const char *text, size_t len)
+{
+    return static_cast<uint32_t>(FNV::Hash(text, len));
+}
+
+bool ScriptString::IsScriptString(const RuntimeScriptValue &rval)
+{
+    return (rval.Type == kScValScriptObject) && (rval.ObjMgr == &myScriptStringImpl)
+        && (pool.AddressToHandle(rval.Ptr, &myScriptStringImpl) > 0);
+}
+
+DynObjectRef ScriptString::FindInterned(const char *text, size_t len, uint32_t hash)
+{
+    const char *str = internTable.Find(text, len, hash);
+    if (!str)
+        return DynObjectRef();
+    // The handle is stored in the object's memory header
+    const int32_t handle = ManagedHeap::GetBlockHeader(str).Handle;
+    return DynObjectRef(handle, const_cast<char*>(str), &myScriptStringImpl);
+}
+
+DynObjectRef ScriptString::CreateObject(char *text_ptr)
+{
+    Header &header = GetHeader(text_ptr);
+    header.Hash = CalcHash(text_ptr, header.Length);
+    DynObjectRef ref = FindInterned(text_ptr, header.Length, header.Hash);
+    if (ref)
+    {
+        ManagedHeap::Free(text_ptr, MemHeaderSz);
+        return ref;
+    }
+    return RegisterObject(text_ptr);
+}
+
+DynObjectRef ScriptString::RegisterObject(char *text_ptr)
 {
-    char *text_ptr = reinterpret_cast<char*>(buf + MemHeaderSz);
     int32_t handle = ccRegisterManagedObject(text_ptr, &myScriptStringImpl);
     if (handle == 0)
     {
-        delete[] buf;
+        ManagedHeap::Free(text_ptr, MemHeaderSz);
         return DynObjectRef();
     }
+    internTable.Insert(text_ptr);
     return DynObjectRef(handle, text_ptr, &myScriptStringImpl);
 }
 
 ScriptString::Buffer ScriptString::CreateBuffer(size_t len, size_t ulen)
 {
     assert(ulen <= len);
-    std::unique_ptr<uint8_t[]> buf(new uint8_t[len + 1 + MemHeaderSz]);
-    auto *header = reinterpret_cast<Header*>(buf.get());
-    header->Length = len;
-    header->ULength = ulen;
-    header->LastCharIdx = 0;
-    header->LastCharOff = 0;
-    return Buffer(std::move(buf), len + 1 + MemHeaderSz);
+    char *text_ptr = static_cast<char*>(ManagedHeap::Allocate(MemHeaderSz, len + 1));
+    Header &header = GetHeader(text_ptr);
+    header.Length = len;
+    header.ULength = ulen;
+    header.LastCharIdx = 0;
+    header.LastCharOff = 0;
+    header.Hash = 0u;
+    return Buffer(text_ptr, len + 1);
 }
 
 DynObjectRef ScriptString::Create(const char *text)
@@ -93,25 +243,31 @@ DynObjectRef ScriptString::Create(const char *text)
 
     int len, ulen;
     ustrlen2(text, &len, &ulen);
+    // Try the interned strings first, this saves allocating a new buffer
+    const uint32_t hash = CalcHash(text, len);
+    DynObjectRef ref = FindInterned(text, len, hash);
+    if (ref)
+        return ref;
+
     auto buf = CreateBuffer(len, ulen);
     memcpy(buf.Get(), text, len + 1);
-    return CreateObject(buf._buf.release());
+    GetHeader(buf.Get()).Hash = hash;
+    return RegisterObject(buf.Release());
 }
 
 DynObjectRef ScriptString::Create(Buffer &&strbuf)
 {
-    uint8_t *buf = strbuf._buf.release();
-    auto *header = reinterpret_cast<Header*>(buf);
-    char *text_ptr = reinterpret_cast<char*>(buf + MemHeaderSz);
-    text_ptr[header->Length] = 0; // fixup in case buffer did not have one added
-    if ((header->Length > 0) && (header->ULength == 0u))
+    char *text_ptr = strbuf.Release();
+    Header &header = GetHeader(text_ptr);
+    text_ptr[header.Length] = 0; // fixup in case buffer did not have one added
+    if ((header.Length > 0) && (header.ULength == 0u))
     {
         // NOTE: we use this as an opportunity to recalc Length too, as this
         // costs us no extra time, but lets fixup in case there's a '0' in the middle
         int len, ulen;
         ustrlen2(text_ptr, &len, &ulen);
-        header->Length = len;
-        header->ULength = ulen;
+        header.Length = len;
+        header.ULength = ulen;
     }
-    return CreateObject(buf);
+    return CreateObject(text_ptr);
 }
@@ -15,8 +15,18 @@
 #define __AC_SCRIPTSTRING_H
 
 #include <memory>
+#include <string.h>
 #include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/managedheap.h"
 
+struct RuntimeScriptValue;
+
+// ScriptString is an immutable managed string.
+// Script strings are interned: creating a string which contents match an
+// existing string's returns that existing object instead of allocating
+// a new one. There still may be several objects with same contents,
+// e.g. after restoring a saved game, so comparing pointers is not enough
+// to tell that strings are different, but hash and length are.
 struct ScriptString final : AGSCCDynamicObject
 {
 public:
@@ -30,6 +40,8 @@ public:
         // NOTE: intentionally limited to 64k chars/bytes to save bit of mem.
         uint16_t LastCharIdx = 0u;
         uint16_t LastCharOff = 0u;
+        // Hash of the string contents, calculated when the object is created
+        uint32_t Hash = 0u;
     };
 
     struct Buffer
@@ -37,19 +49,24 @@ public:
         friend ScriptString;
     public:
         Buffer() = default;
-        ~Buffer() = default;
-        Buffer(Buffer &&buf) = default;
+        ~Buffer();
+        Buffer(Buffer &&buf);
+        Buffer &operator =(Buffer &&buf);
         // Returns a pointer to the beginning of a text buffer
-        char *Get() { return reinterpret_cast<char*>(_buf.get() + MemHeaderSz); }
+        char *Get() { return _text; }
         // Returns size allocated for a text content (includes null pointer)
-        size_t GetSize() const { return _sz - MemHeaderSz; }
+        size_t GetSize() const { return _sz; }
 
     private:
-        Buffer(std::unique_ptr<uint8_t[]> &&buf, size_t buf_sz)
-            : _buf(std::move(buf)), _sz(buf_sz) {}
-
-        std::unique_ptr<uint8_t[]> _buf;
-        size_t _sz;
+        Buffer(char *text, size_t text_sz)
+            : _text(text), _sz(text_sz) {}
+        Buffer(const Buffer&) = delete;
+        Buffer &operator =(const Buffer&) = delete;
+        // Releases the ownership over the text buffer
+        char *Release();
+
+        char *_text = nullptr;
+        size_t _sz = 0u;
     };
 
 
@@ -77,18 +94,43 @@ public:
     // passed buffer variable becomes invalid after this call.
     static DynObjectRef Create(Buffer &&strbuf);
 
+    // Calculates a hash of the string contents, same as stored in the header
+    static uint32_t CalcHash(const char *text, size_t len);
+    // Tells whether the runtime value refers to a registered script string
+    // object; a value returned from the script API may be marked as a string
+    // object, yet point to some other text buffer (e.g. a translation)
+    static bool IsScriptString(const RuntimeScriptValue &rval);
+    // Compares two script strings, using their cached hashes and lengths
+    inline static bool Equals(const char *s1, const char *s2)
+    {
+        if (s1 == s2)
+            return true;
+        const Header &h1 = GetHeader(s1);
+        const Header &h2 = GetHeader(s2);
+        return (h1.Hash == h2.Hash) && (h1.Length == h2.Length)
+            && (memcmp(s1, s2, h1.Length) == 0);
+    }
+
     const char *GetType() override;
     int Dispose(void *address, bool force) override;
+    bool HasManagedHeader() override { return true; }
     void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
 
 private:
     friend ScriptString::Buffer;
-    // The size of the array's header in memory, prepended to the element data
-    static const size_t MemHeaderSz = sizeof(Header);
+    // The size of the array's header in memory, prepended to the element data;
+    // followed by the ManagedHeap's block header
+    static const size_t MemHeaderSz = sizeof(Header) + ManagedHeap::BlockHeaderSz;
     // The size of the serialized header
     static const size_t FileHeaderSz = sizeof(uint32_t);
 
-    static DynObjectRef CreateObject(uint8_t *buf);
+    // Returns an interned object with same contents as the given text, if one exists
+    static DynObjectRef FindInterned(const char *text, size_t len, uint32_t hash);
+    // Returns an interned object with same contents as the new string's buffer,
+    // freeing the buffer; otherwise registers and interns a new object
+    static DynObjectRef CreateObject(char *text_ptr);
+    // Registers and interns a new object, which hash is already calculated
+    static DynObjectRef RegisterObject(char *text_ptr);
 
     // Savegame serialization
     // Calculate and return required space for serialization, in bytes
@@ -28,15 +28,13 @@ const char *ScriptUserObject::GetType()
 
 /* static */ DynObjectRef ScriptUserObject::Create(size_t size)
 {
-    uint8_t *new_data = new uint8_t[size + MemHeaderSz];
-    memset(new_data, 0, size + MemHeaderSz);
-    Header &hdr = reinterpret_cast<Header&>(*new_data);
+    void *obj_ptr = ManagedHeap::Allocate(MemHeaderSz, size, true);
+    Header &hdr = GetHeader(obj_ptr);
     hdr.Size = size;
-    void *obj_ptr = &new_data[MemHeaderSz];
     int32_t handle = ccRegisterManagedObject(obj_ptr, &globalDynamicStruct);
     if (handle == 0)
     {
-        delete[] new_data;
+        ManagedHeap::Free(obj_ptr, MemHeaderSz);
         return DynObjectRef();
     }
     return DynObjectRef(handle, obj_ptr, &globalDynamicStruct);
@@ -44,7 +42,7 @@ const char *ScriptUserObject::GetType()
 
 int ScriptUserObject::Dispose(void *address, bool /*force*/)
 {
-    delete[] (static_cast<uint8_t*>(address) - MemHeaderSz);
+    ManagedHeap::Free(address, MemHeaderSz);
     return 1;
 }
 
@@ -63,11 +61,11 @@ void ScriptUserObject::Serialize(const void *address, AGS::Common::Stream *out)
 
 void ScriptUserObject::Unserialize(int index, Stream *in, size_t data_sz)
 {
-    uint8_t *new_data = new uint8_t[(data_sz - FileHeaderSz) + MemHeaderSz];
-    Header &hdr = reinterpret_cast<Header&>(*new_data);
+    void *obj_ptr = ManagedHeap::Allocate(MemHeaderSz, data_sz - FileHeaderSz);
+    Header &hdr = GetHeader(obj_ptr);
     hdr.Size = data_sz - FileHeaderSz;
-    in->Read(new_data + MemHeaderSz, data_sz - FileHeaderSz);
-    ccRegisterUnserializedObject(index, &new_data[MemHeaderSz], this);
+    in->Read(obj_ptr, data_sz - FileHeaderSz);
+    ccRegisterUnserializedObject(index, obj_ptr, this);
 }
 
 ScriptUserObject globalDynamicStruct;
@@ -19,6 +19,7 @@
 #define __AGS_EE_DYNOBJ__SCRIPTUSERSTRUCT_H
 
 #include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/managedheap.h"
 #include "util/stream.h"
 
 
@@ -46,17 +47,24 @@ public:
         return reinterpret_cast<const Header&>(*(static_cast<const uint8_t*>(address) - MemHeaderSz));
     }
 
+    inline static Header &GetHeader(void *address)
+    {
+        return reinterpret_cast<Header&>(*(static_cast<uint8_t*>(address) - MemHeaderSz));
+    }
+
     // Create managed struct object and return a pointer to the beginning of a buffer
     static DynObjectRef Create(size_t size);
 
     // return the type name of the object
     const char *GetType() override;
     int Dispose(void *address, bool force) override;
+    bool HasManagedHeader() override { return true; }
     void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
 
 private:
-    // The size of the array's header in memory, prepended to the element data
-    static const size_t MemHeaderSz = sizeof(Header);
+    // The size of the array's header in memory, prepended to the element data;
+    // followed by the ManagedHeap's block header
+    static const size_t MemHeaderSz = sizeof(Header) + ManagedHeap::BlockHeaderSz;
     // The size of the serialized header
     static const size_t FileHeaderSz = sizeof(uint32_t) * 0; // no header serialized
 
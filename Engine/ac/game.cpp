@@ -982,7 +982,7 @@ void Game_ScanSaveSlots(void *dest_arr, int min_slot, int max_slot, int save_sor
     can_run_delayed_command();
     if (inside_script)
     {
-        int handle = ccGetObjectHandleFromAddress(dest_arr);
+        int handle = ccGetObjectHandleFromAddress(dest_arr, &globalDynamicArray);
         ccAddObjectReference(handle); // add internal handle to prevent disposal
         curscript->QueueAction(PostScriptAction(ePSAScanSaves, handle, min_slot, max_slot, save_sort, sort_dir, user_param, "ScanSaveSlots"));
         return;
@@ -19,6 +19,7 @@
 #include "ac/speech.h"
 #include "ac/sys_events.h"
 #include "main/graphics_mode.h"
+#include "util/cachepolicy.h"
 #include "util/string.h"
 
 
@@ -84,16 +85,23 @@ struct GameConfig
     static const size_t DefSpriteCacheSize  = (128 * 1024); // 128 MB
 #endif
     static const size_t DefTexCacheSize     = (128 * 1024); // 128 MB
+    static const size_t DefSpriteLoadThreads = 0;
+    static const size_t DefSoftwareRenderThreads = 0;
+    static const size_t DefSoftwarePrepareThreads = 0;
+    static const int    DefSpritePrefetch   = 0;
     static const size_t DefSoundLoadAtOnce  = 1024; // 1 MB
     static const size_t DefSoundCache       = 1024u * 32; // 32 MB
 
     // Display configuration
     DisplayModeSetup Display;
     String  SoftwareRenderDriver;      // Driver for the final output when using Software renderer
+    size_t  SoftwareRenderThreads = DefSoftwareRenderThreads; // threads helping Software renderer draw sprites
+    size_t  SoftwarePrepareThreads = DefSoftwarePrepareThreads; // threads transforming object sprites in software mode
 
     // Graphic options (additional)
     bool    RenderAtScreenRes    = false; // render sprites at screen resolution, as opposed to native one
     bool    AntialiasSprites     = false;  // apply AA (linear) scaling to game sprites, regardless of final filter
+    bool    WalkBehindShader     = false;  // hide sprites behind walk-behinds by the mask in shader, if supported
 
     // For mobile devices
     ScreenRotation Rotation      = kScreenRotation_Unlocked; // how to display the game on mobile screen
@@ -112,7 +120,12 @@ struct GameConfig
 
     // Cache options
     size_t  SpriteCacheSize      = DefSpriteCacheSize; // in KB
+    AGS::Common::CachePolicyType SpriteCachePolicy = AGS::Common::kCachePolicy_LRU;
+    size_t  SpriteLoadThreads    = DefSpriteLoadThreads; // threads loading sprites in background
+    bool    SpriteFileMapping    = false; // memory-map uncompressed sprite file
+    int     SpritePrefetch       = DefSpritePrefetch; // max predicted sprite requests per frame
     size_t  TextureCacheSize     = DefTexCacheSize; // in KB
+    AGS::Common::CachePolicyType TextureCachePolicy = AGS::Common::kCachePolicy_LRU;
     size_t  SoundCacheSize       = DefSoundCache; // sound cache limit, in KB
     size_t  SoundLoadAtOnceSize  = DefSoundLoadAtOnce; // threshold for loading sounds immediately, in KB
 
@@ -131,6 +144,10 @@ struct GameConfig
     bool    ClearCacheOnRoomChange = false; // for low-end devices: clear resource caches on room change
     bool    RunInBackground      = false; // whether run on background, when game is switched out
     bool    ShowFps              = false;
+    bool    ShowFrameGraph       = false; // display the graph of frame times per update stage
+    bool    ExportFrameTimes     = false; // write the recent frame times on exit
+    bool    ScriptPredecode      = false; // run scripts from the pre-decoded instruction stream
+    bool    ScriptProfile        = false; // profile scripts and write the report on exit
 
     // Accessibility options
     AccessibilityGameConfig Access;
@@ -65,12 +65,16 @@ String GetRuntimeInfo()
     size_t max_txcached, total_txcached, total_txlocked, total_txext;
     texturecache_get_state(max_txcached, total_txcached, total_txlocked, total_txext);
     const unsigned tx_filled = max_txcached > 0 ? (uint64_t)total_txcached * 100 / max_txcached : 0;
+    const ResourceCacheStats &spr_stats = spriteset.GetCacheStats();
+    const ResourceCacheStats &tx_stats = texturecache_get_stats();
     String runtimeInfo = String::FromFormat(
         "%s\nEngine version %s\n"
         "Game resolution %d x %d (%d-bit)\n"
         "Running %d x %d at %d-bit%s\nGFX: %s; %s\nDraw frame %d x %d\n"
         "Sprite cache KB: %zu / %zu (%u%%), locked: %zu, ext: %zu\n"
-        "Texture cache KB: %zu / %zu (%u%%)",
+        "Sprite cache hits: %llu, misses: %llu, evicted: %llu\n"
+        "Texture cache KB: %zu / %zu (%u%%)\n"
+        "Texture cache hits: %llu, misses: %llu, evicted: %llu",
         get_engine_name(),
         get_engine_version_and_build().GetCStr(),
         game.GetGameRes().Width, game.GetGameRes().Height, game.GetColorDepth(),
@@ -79,7 +83,9 @@ String GetRuntimeInfo()
         gfxDriver->GetDriverName(), filter->GetInfo().Name.GetCStr(),
         render_frame.GetWidth(), render_frame.GetHeight(),
         total_normspr / 1024, max_normspr / 1024, norm_spr_filled, total_lockspr / 1024, total_extspr / 1024,
-        total_txcached / 1024, max_txcached / 1024, tx_filled);
+        (unsigned long long)spr_stats.Hits, (unsigned long long)spr_stats.Misses, (unsigned long long)spr_stats.Evictions,
+        total_txcached / 1024, max_txcached / 1024, tx_filled,
+        (unsigned long long)tx_stats.Hits, (unsigned long long)tx_stats.Misses, (unsigned long long)tx_stats.Evictions);
     if (play.separate_music_lib)
         runtimeInfo.Append("[AUDIO.VOX enabled");
     if (play.voice_avail)
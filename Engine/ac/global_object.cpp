@@ -122,6 +122,7 @@ void SetObjectTint(int obj, int red, int green, int blue, int opacity, int lumin
     objs[obj].tint_light = (luminance * 25) / 10;
     objs[obj].flags &= ~OBJF_HASLIGHT;
     objs[obj].flags |= OBJF_HASTINT;
+    mark_object_gfx_dirty(obj, kObjGfx_Tint);
 }
 
 void RemoveObjectTint(int obj) {
@@ -131,6 +132,7 @@ void RemoveObjectTint(int obj) {
     if (objs[obj].flags & (OBJF_HASTINT | OBJF_HASLIGHT)) {
         debug_script_log("Un-tint object %d", obj);
         objs[obj].flags &= ~(OBJF_HASTINT | OBJF_HASLIGHT);
+        mark_object_gfx_dirty(obj, kObjGfx_Tint);
     }
     else {
         debug_script_warn("RemoveObjectTint called but object was not tinted");
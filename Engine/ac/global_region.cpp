@@ -39,6 +39,7 @@ int GetRegionIDAtRoom(int xxx, int yyy) {
     xxx = room_to_mask_coord(xxx);
     yyy = room_to_mask_coord(yyy);
 
+    int hsthere;
     if (loaded_game_file_version >= kGameVersion_262) // Version 2.6.2+
     {
         if (xxx >= thisroom.RegionMask->GetWidth())
@@ -49,9 +50,13 @@ int GetRegionIDAtRoom(int xxx, int yyy) {
             xxx = 0;
         if (yyy < 0)
             yyy = 0;
+        // coordinates are clamped, so may read the mask directly
+        hsthere = thisroom.RegionMask->GetScanLine(yyy)[xxx];
+    }
+    else
+    {
+        hsthere = thisroom.RegionMask->GetPixel(xxx, yyy);
     }
-
-    int hsthere = thisroom.RegionMask->GetPixel (xxx, yyy);
     if (hsthere <= 0 || hsthere >= MAX_ROOM_REGIONS) return 0;
     if (croom->region_enabled[hsthere] == 0) return 0;
     return hsthere;
@@ -65,6 +70,7 @@ void SetAreaLightLevel(int area, int brightness) {
     thisroom.Regions[area].Light = brightness;
     // disable RGB tint for this area
     thisroom.Regions[area].Tint  = 0;
+    invalidate_region_tints();
     debug_script_log("Region %d light level set to %d", area, brightness);
 }
 
@@ -99,6 +105,7 @@ void SetRegionTint (int area, int red, int green, int blue, int amount, int lumi
                                    ((blue & 0XFF) << 16) |
                                    ((amount & 0xFF) << 24);
     thisroom.Regions[area].Light = (luminance * 25) / 10;
+    invalidate_region_tints();
 }
 
 void DisableRegion(int hsnum) {
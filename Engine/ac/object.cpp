@@ -240,6 +240,7 @@ void Object_SetLightLevel(ScriptObject *objj, int light_level)
     objs[obj].tint_light = light_level;
     objs[obj].flags &= ~OBJF_HASTINT;
     objs[obj].flags |= OBJF_HASLIGHT;
+    mark_object_gfx_dirty(obj, kObjGfx_Tint);
 }
 
 int Object_GetTintRed(ScriptObject *obj)
@@ -395,6 +396,7 @@ void Object_SetScaling(ScriptObject *objj, int zoomlevel) {
         debug_script_warn("Object.Scaling: scaling level must be between 1 and %d%%, asked for: %d",
                         (int)(INT16_MAX), zoomlevel);
     objs[objj->id].zoom = zoom_fixed;
+    mark_object_gfx_dirty(objj->id, kObjGfx_Transform);
 }
 
 void Object_SetSolid(ScriptObject *objj, int solid) {
@@ -34,6 +34,10 @@ extern COLOR_MAP maincoltable;
 extern RGB palette[256];
 extern CCRegion ccDynamicRegion;
 
+// Light and tint of each region, calculated from the region settings
+RegionTint regionTints[MAX_ROOM_REGIONS];
+bool regionTintsValid = false;
+
 
 ScriptRegion *GetRegionAtRoom(int xx, int yy) {
     return &scrRegion[GetRegionIDAtRoom(xx, yy)];
@@ -126,6 +130,41 @@ void generate_light_table()
     }
 }
 
+const RegionTint &get_region_tint(int region)
+{
+    static const RegionTint no_tint;
+    if ((region < 0) || (region >= MAX_ROOM_REGIONS))
+        return no_tint;
+
+    if (!regionTintsValid)
+    {
+        for (int i = 0; i < MAX_ROOM_REGIONS; ++i)
+        {
+            RegionTint &rt = regionTints[i];
+            rt = RegionTint();
+            const int tint_level = thisroom.Regions[i].Tint;
+            const int tint_sat = (tint_level >> 24) & 0xFF;
+            rt.LightLevel = thisroom.Regions[i].Light;
+            // Tint is not supported in 8-bit games
+            if ((game.color_depth != 1) && ((tint_level & 0x00ffffff) != 0) && (tint_sat != 0))
+            {
+                rt.Red = tint_level & 0xFF;
+                rt.Green = (tint_level >> 8) & 0xFF;
+                rt.Blue = (tint_level >> 16) & 0xFF;
+                rt.Amount = tint_sat;
+                rt.Luminance = rt.LightLevel;
+            }
+        }
+        regionTintsValid = true;
+    }
+    return regionTints[region];
+}
+
+void invalidate_region_tints()
+{
+    regionTintsValid = false;
+}
+
 //=============================================================================
 //
 // Script API Functions
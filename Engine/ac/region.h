@@ -37,4 +37,23 @@ void	Region_RunInteraction(ScriptRegion *ssr, int mood);
 
 void    generate_light_table();
 
+// Light and tint of a room region, which are applied to the characters
+// and objects standing on it
+struct RegionTint
+{
+    int Red = 0;
+    int Green = 0;
+    int Blue = 0;
+    int Amount = 0; // tint saturation, 0 means no tint
+    int Luminance = 255; // tint luminance
+    int LightLevel = 0;
+};
+
+// Gets the light and tint of the given region; these are calculated
+// from the region settings once, and cached until invalidated
+const RegionTint &get_region_tint(int region);
+// Marks the cached regions light and tint as outdated; must be called
+// whenever the region settings change, or a new room is loaded
+void    invalidate_region_tints();
+
 #endif // __AGS_EE_AC__REGION_H
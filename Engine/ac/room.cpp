@@ -41,6 +41,7 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/screen.h"
+#include "ac/spriteprefetch.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "ac/walkablearea.h"
@@ -916,6 +917,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
 
     set_our_eip(209);
     generate_light_table();
+    invalidate_region_tints();
     update_music_volume();
 
     // If we are not restoring a save, update cameras to accomodate for this
@@ -937,6 +939,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
         if (objs[cc].on == 2)
             MergeObject(cc);
     }
+    prefetch_room_sprites();
     new_room_flags=0;
     play.gscript_timer=-1;  // avoid screw-ups with changing screens
     play.player_on_region = 0;
@@ -27,6 +27,13 @@
 #include "script/script_runtime.h"
 #include "util/bbop.h"
 
+// Returns the precalculated hash of the script string passed as a container's
+// key or item, or 0 if the parameter is not a script string
+static uint32_t GetKeyHash(const RuntimeScriptValue &param)
+{
+    return ScriptString::IsScriptString(param) ? ScriptString::GetHeader(param.Ptr).Hash : 0u;
+}
+
 //=============================================================================
 //
 // Dictionary of strings script API.
@@ -79,23 +86,23 @@ void Dict_Clear(ScriptDictBase *dic)
 
 bool Dict_Contains(ScriptDictBase *dic, const char *key)
 {
-    return dic->Contains(key);
+    return dic->Contains(key, 0u);
 }
 
 const char *Dict_Get(ScriptDictBase *dic, const char *key)
 {
-    auto *str = dic->Get(key);
+    auto *str = dic->Get(key, 0u);
     return str ? CreateNewScriptString(str) : nullptr;
 }
 
 bool Dict_Remove(ScriptDictBase *dic, const char *key)
 {
-    return dic->Remove(key);
+    return dic->Remove(key, 0u);
 }
 
 bool Dict_Set(ScriptDictBase *dic, const char *key, const char *value)
 {
-    return dic->Set(key, value);
+    return dic->Set(key, 0u, value);
 }
 
 int Dict_GetCompareStyle(ScriptDictBase *dic)
@@ -145,22 +152,31 @@ RuntimeScriptValue Sc_Dict_Clear(void *self, const RuntimeScriptValue *params, i
 
 RuntimeScriptValue Sc_Dict_Contains(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_BOOL_POBJ(ScriptDictBase, Dict_Contains, const char);
+    ASSERT_OBJ_PARAM_COUNT(Dict_Contains, 1);
+    return RuntimeScriptValue().SetInt32AsBool(
+        ((ScriptDictBase*)self)->Contains((const char*)params[0].Ptr, GetKeyHash(params[0])));
 }
 
 RuntimeScriptValue Sc_Dict_Get(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ_POBJ(ScriptDictBase, const char, myScriptStringImpl, Dict_Get, const char);
+    ASSERT_OBJ_PARAM_COUNT(Dict_Get, 1);
+    const char *value = ((ScriptDictBase*)self)->Get((const char*)params[0].Ptr, GetKeyHash(params[0]));
+    const char *ret = value ? CreateNewScriptString(value) : nullptr;
+    return RuntimeScriptValue().SetScriptObject((void*)ret, &myScriptStringImpl);
 }
 
 RuntimeScriptValue Sc_Dict_Remove(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_BOOL_POBJ(ScriptDictBase, Dict_Remove, const char);
+    ASSERT_OBJ_PARAM_COUNT(Dict_Remove, 1);
+    return RuntimeScriptValue().SetInt32AsBool(
+        ((ScriptDictBase*)self)->Remove((const char*)params[0].Ptr, GetKeyHash(params[0])));
 }
 
 RuntimeScriptValue Sc_Dict_Set(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_BOOL_POBJ2(ScriptDictBase, Dict_Set, const char, const char);
+    ASSERT_OBJ_PARAM_COUNT(Dict_Set, 2);
+    return RuntimeScriptValue().SetInt32AsBool(
+        ((ScriptDictBase*)self)->Set((const char*)params[0].Ptr, GetKeyHash(params[0]), (const char*)params[1].Ptr));
 }
 
 RuntimeScriptValue Sc_Dict_GetCompareStyle(void *self, const RuntimeScriptValue *params, int32_t param_count)
@@ -235,7 +251,7 @@ ScriptSetBase *Set_Unserialize(int index, AGS::Common::Stream *in, size_t data_s
 
 bool Set_Add(ScriptSetBase *set, const char *item)
 {
-    return set->Add(item);
+    return set->Add(item, 0u);
 }
 
 void Set_Clear(ScriptSetBase *set)
@@ -245,12 +261,12 @@ void Set_Clear(ScriptSetBase *set)
 
 bool Set_Contains(ScriptSetBase *set, const char *item)
 {
-    return set->Contains(item);
+    return set->Contains(item, 0u);
 }
 
 bool Set_Remove(ScriptSetBase *set, const char *item)
 {
-    return set->Remove(item);
+    return set->Remove(item, 0u);
 }
 
 int Set_GetCompareStyle(ScriptSetBase *set)
@@ -285,7 +301,9 @@ RuntimeScriptValue Sc_Set_Create(const RuntimeScriptValue *params, int32_t param
 
 RuntimeScriptValue Sc_Set_Add(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_BOOL_POBJ(ScriptSetBase, Set_Add, const char);
+    ASSERT_OBJ_PARAM_COUNT(Set_Add, 1);
+    return RuntimeScriptValue().SetInt32AsBool(
+        ((ScriptSetBase*)self)->Add((const char*)params[0].Ptr, GetKeyHash(params[0])));
 }
 
 RuntimeScriptValue Sc_Set_Clear(void *self, const RuntimeScriptValue *params, int32_t param_count)
@@ -295,12 +313,16 @@ RuntimeScriptValue Sc_Set_Clear(void *self, const RuntimeScriptValue *params, in
 
 RuntimeScriptValue Sc_Set_Contains(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_BOOL_POBJ(ScriptSetBase, Set_Contains, const char);
+    ASSERT_OBJ_PARAM_COUNT(Set_Contains, 1);
+    return RuntimeScriptValue().SetInt32AsBool(
+        ((ScriptSetBase*)self)->Contains((const char*)params[0].Ptr, GetKeyHash(params[0])));
 }
 
 RuntimeScriptValue Sc_Set_Remove(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_BOOL_POBJ(ScriptSetBase, Set_Remove, const char);
+    ASSERT_OBJ_PARAM_COUNT(Set_Remove, 1);
+    return RuntimeScriptValue().SetInt32AsBool(
+        ((ScriptSetBase*)self)->Remove((const char*)params[0].Ptr, GetKeyHash(params[0])));
 }
 
 RuntimeScriptValue Sc_Set_GetCompareStyle(void *self, const RuntimeScriptValue *params, int32_t param_count)
@@ -68,6 +68,14 @@ Bitmap *initialize_sprite(sprkey_t index, Bitmap *image, uint32_t &sprite_flags)
 
     const bool has_alpha = (sprite_flags & SPF_ALPHACHANNEL) != 0;
     use_bmp = PrepareSpriteForUse(use_bmp, has_alpha);
+    // Plugins are allowed to modify the loaded sprite in place,
+    // so they must not receive a bitmap referencing read-only data
+    if (use_bmp->IsReadOnly() && pl_any_want_hook(kPluginEvt_SpriteLoad))
+    {
+        Bitmap *copy_bmp = BitmapHelper::CreateBitmapCopy(use_bmp);
+        delete use_bmp;
+        use_bmp = copy_bmp;
+    }
     // For non-32 bit games, strip SPF_ALPHACHANNEL flag, but add SPF_HADALPHACHANNEL
     // in order to record the fact that the asset on disk has alpha channel.
     if (has_alpha && (game.GetColorDepth() < 32))
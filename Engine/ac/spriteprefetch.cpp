@@ -0,0 +1,219 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/spriteprefetch.h"
+#include <deque>
+#include <vector>
+#include "ac/characterinfo.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/roomobject.h"
+#include "ac/roomstatus.h"
+#include "ac/spritecache.h"
+#include "ac/view.h"
+
+using namespace AGS::Common;
+
+extern GameSetupStruct game;
+extern SpriteCache spriteset;
+extern RoomStatus *croom;
+extern RoomObject *objs;
+extern std::vector<ViewStruct> views;
+extern int displayed_room;
+
+namespace
+{
+
+// How many upcoming frames of a running animation to request
+const int AnimLookahead = 3;
+// Max number of queued predictions to test per frame, per budget unit;
+// most of them are normally loaded already, and skipped
+const int QueueScanFactor = 8;
+// Low priority predictions are not requested if the cache is filled above
+// this percentage, so that they do not push out the sprites in use
+const size_t QueueMaxCacheFill = 90;
+// Max number of queued predictions; the older low priority ones are dropped
+const size_t QueueMaxSize = 1024;
+
+struct SpritePrefetchState
+{
+    int Budget = 0;
+    // Low priority predictions, which are requested as the budget allows
+    std::deque<sprkey_t> Queue;
+    // Which characters were moving at the last update
+    std::vector<bool> CharWasMoving;
+} Prefetch;
+
+// Returns the number of loops in the view, or 0 if the view is invalid
+int get_view_loop_count(int view)
+{
+    if (view < 0 || static_cast<size_t>(view) >= views.size())
+        return 0;
+    return views[view].numLoops;
+}
+
+// Returns the sprite of the given view frame, or -1 if the frame is invalid
+sprkey_t get_view_frame_sprite(int view, int loop, int frame)
+{
+    if (loop < 0 || loop >= get_view_loop_count(view))
+        return -1;
+    const ViewLoopNew &vloop = views[view].loops[loop];
+    if (frame < 0 || frame >= vloop.numFrames)
+        return -1;
+    return vloop.frames[frame].pic;
+}
+
+// Requests the sprite, and spends the budget if the new load was started
+void request_sprite(sprkey_t sprnum, int &budget)
+{
+    if (sprnum >= 0 && spriteset.PrecacheSpriteAsync(sprnum))
+        budget--;
+}
+
+// Requests the next frames of the running animation, in its direction
+void request_next_frames(int view, int loop, int frame, bool forwards, int &budget)
+{
+    if (get_view_frame_sprite(view, loop, frame) < 0)
+        return;
+    const int num_frames = views[view].loops[loop].numFrames;
+    for (int i = 1; (i <= AnimLookahead) && (i < num_frames) && (budget > 0); ++i)
+    {
+        const int next = forwards ? (frame + i) % num_frames : (frame - i + num_frames) % num_frames;
+        request_sprite(views[view].loops[loop].frames[next].pic, budget);
+    }
+}
+
+// Queues all frames of the loop
+void queue_loop(int view, int loop, bool to_front)
+{
+    if (get_view_frame_sprite(view, loop, 0) < 0)
+        return;
+    const ViewLoopNew &vloop = views[view].loops[loop];
+    if (to_front)
+    {
+        for (int i = vloop.numFrames - 1; i >= 0; --i)
+            Prefetch.Queue.push_front(vloop.frames[i].pic);
+    }
+    else
+    {
+        for (int i = 0; i < vloop.numFrames; ++i)
+            Prefetch.Queue.push_back(vloop.frames[i].pic);
+    }
+}
+
+// Queues the first frames of every loop in the view
+void queue_view_first_frames(int view)
+{
+    for (int loop = 0; loop < get_view_loop_count(view); ++loop)
+    {
+        sprkey_t sprnum = get_view_frame_sprite(view, loop, 0);
+        if (sprnum >= 0)
+            Prefetch.Queue.push_back(sprnum);
+    }
+}
+
+} // namespace
+
+
+void init_sprite_prefetch(int budget)
+{
+    Prefetch.Budget = budget;
+    reset_sprite_prefetch();
+}
+
+void reset_sprite_prefetch()
+{
+    Prefetch.Queue.clear();
+    Prefetch.CharWasMoving.clear();
+}
+
+void prefetch_room_sprites()
+{
+    reset_sprite_prefetch();
+    if (Prefetch.Budget <= 0 || displayed_room < 0)
+        return;
+
+    // The sprites shown right away are going to be loaded anyway,
+    // so request them all regardless of the budget
+    int no_budget = 0;
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        const RoomObject &obj = objs[i];
+        if (!obj.on)
+            continue;
+        request_sprite(obj.num, no_budget);
+        if (obj.view != RoomObject::NoView)
+            queue_view_first_frames(obj.view);
+    }
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const CharacterInfo &chi = game.chars[i];
+        if (chi.room != displayed_room || !chi.on)
+            continue;
+        request_sprite(get_view_frame_sprite(chi.view, chi.loop, chi.frame), no_budget);
+        queue_view_first_frames(chi.view);
+    }
+}
+
+void update_sprite_prefetch()
+{
+    if (Prefetch.Budget <= 0 || displayed_room < 0)
+        return;
+
+    int budget = Prefetch.Budget;
+    // Running animations and walks: the next frames are needed soonest
+    Prefetch.CharWasMoving.resize(game.numcharacters);
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const CharacterInfo &chi = game.chars[i];
+        const bool is_walking = chi.is_moving() && chi.is_moving_walkanim();
+        const bool just_started = is_walking && !Prefetch.CharWasMoving[i];
+        Prefetch.CharWasMoving[i] = is_walking;
+        if (chi.room != displayed_room || !chi.on)
+            continue;
+        if (is_walking || chi.is_animating())
+        {
+            const bool forwards = is_walking || chi.get_anim_forwards();
+            request_next_frames(chi.view, chi.loop, chi.frame, forwards, budget);
+        }
+        // The character may turn during the walk, so have the rest of the
+        // walking loops ready too, after the current one
+        if (just_started)
+        {
+            queue_loop(chi.view, chi.loop, true);
+            for (int loop = 0; loop < get_view_loop_count(chi.view); ++loop)
+            {
+                if (loop != chi.loop)
+                    queue_loop(chi.view, loop, false);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        const RoomObject &obj = objs[i];
+        if (obj.on && obj.is_animating() && obj.view != RoomObject::NoView)
+            request_next_frames(obj.view, obj.loop, obj.frame, obj.get_anim_forwards(), budget);
+    }
+
+    // Queued predictions, as long as there's budget and cache space left
+    if (Prefetch.Queue.size() > QueueMaxSize)
+        Prefetch.Queue.resize(QueueMaxSize);
+    if (spriteset.GetCacheSize() > spriteset.GetMaxCacheSize() / 100 * QueueMaxCacheFill)
+        return;
+    for (int scan = Prefetch.Budget * QueueScanFactor;
+         (budget > 0) && (scan > 0) && !Prefetch.Queue.empty(); --scan)
+    {
+        const sprkey_t sprnum = Prefetch.Queue.front();
+        Prefetch.Queue.pop_front();
+        request_sprite(sprnum, budget);
+    }
+}
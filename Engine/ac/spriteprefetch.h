@@ -0,0 +1,45 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Sprite prefetcher predicts which sprites are going to be displayed soon,
+// judging by the animation state of the room characters and objects, and
+// requests them from the sprite cache ahead of time, letting them load in
+// background (see SpriteCache::PrecacheSpriteAsync).
+//
+// The predictions are, by priority:
+//  - the next few frames of each running animation and walk;
+//  - whole loops which characters have just started walking in;
+//  - the first frames of all loops of the views used in the room, queued
+//    when the room is loaded.
+// The number of new load requests per game frame is limited by a budget,
+// so that the prefetching does not compete with the sprites which are
+// required right now. Those predictions which did not fit into the budget
+// are kept queued for the next frames.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__SPRITEPREFETCH_H
+#define __AGS_EE_AC__SPRITEPREFETCH_H
+
+// Sets the max number of sprite load requests per game frame; 0 disables prefetching
+void init_sprite_prefetch(int budget);
+// Clears all pending predictions
+void reset_sprite_prefetch();
+// Requests the sprites currently displayed in the new room, and queues
+// the first frames of the room characters' and objects' views
+void prefetch_room_sprites();
+// Requests the sprites predicted from the current animation state;
+// should be called once per game frame, after the game update
+void update_sprite_prefetch();
+
+#endif // __AGS_EE_AC__SPRITEPREFETCH_H
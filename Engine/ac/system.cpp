@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <SDL.h>
 #include "ac/common.h"
 #include "ac/draw.h"
@@ -38,6 +39,7 @@
 #include "main/main.h"
 #include "media/audio/audio_core.h"
 #include "media/audio/audio_system.h"
+#include "script/script_runtime.h"
 #include "util/string_compat.h"
 
 using namespace AGS::Common;
@@ -271,6 +273,35 @@ bool GetEngineInteger(int &value, EngineValueID value_id, int index)
         value = std::isnan(fps) ? -1 : static_cast<int>(std::round(fps));
         return true;
     }
+    case ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_HITS: /* fall-through */
+    case ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_MISSES:
+    {
+        uint32_t hits, misses;
+        ccGetScriptImportCacheStats(hits, misses);
+        const uint32_t count = (value_id == ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_HITS) ? hits : misses;
+        value = static_cast<int>(std::min<uint32_t>(count, INT32_MAX));
+        return true;
+    }
+    case ENGINE_VALUE_I_SPRCACHE_HITS: /* fall-through */
+    case ENGINE_VALUE_I_SPRCACHE_MISSES: /* fall-through */
+    case ENGINE_VALUE_I_SPRCACHE_EVICTIONS: /* fall-through */
+    case ENGINE_VALUE_I_TEXCACHE_HITS: /* fall-through */
+    case ENGINE_VALUE_I_TEXCACHE_MISSES: /* fall-through */
+    case ENGINE_VALUE_I_TEXCACHE_EVICTIONS:
+    {
+        const bool is_sprcache = value_id <= ENGINE_VALUE_I_SPRCACHE_EVICTIONS;
+        const ResourceCacheStats &stats = is_sprcache ?
+            spriteset.GetCacheStats() : texturecache_get_stats();
+        uint64_t count;
+        switch (value_id)
+        {
+        case ENGINE_VALUE_I_SPRCACHE_HITS: case ENGINE_VALUE_I_TEXCACHE_HITS: count = stats.Hits; break;
+        case ENGINE_VALUE_I_SPRCACHE_MISSES: case ENGINE_VALUE_I_TEXCACHE_MISSES: count = stats.Misses; break;
+        default: count = stats.Evictions; break;
+        }
+        value = static_cast<int>(std::min<uint64_t>(count, INT32_MAX));
+        return true;
+    }
     default: return false;
     }
 }
@@ -335,6 +366,14 @@ String GetEngineValueName(EngineValueID value_id)
     case ENGINE_VALUE_I_TEXCACHE_NORMAL: return "Texture cache: normal size (KB)";
     case ENGINE_VALUE_I_FPS_MAX: return "FPS cap";
     case ENGINE_VALUE_I_FPS: return "FPS real";
+    case ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_HITS: return "Script import cache: hits";
+    case ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_MISSES: return "Script import cache: misses";
+    case ENGINE_VALUE_I_SPRCACHE_HITS: return "Sprite cache: hits";
+    case ENGINE_VALUE_I_SPRCACHE_MISSES: return "Sprite cache: misses";
+    case ENGINE_VALUE_I_SPRCACHE_EVICTIONS: return "Sprite cache: evictions";
+    case ENGINE_VALUE_I_TEXCACHE_HITS: return "Texture cache: hits";
+    case ENGINE_VALUE_I_TEXCACHE_MISSES: return "Texture cache: misses";
+    case ENGINE_VALUE_I_TEXCACHE_EVICTIONS: return "Texture cache: evictions";
     default: return "";
     }
 }
@@ -67,6 +67,14 @@ enum EngineValueID
     ENGINE_VALUE_I_TEXCACHE_NORMAL,
     ENGINE_VALUE_I_FPS_MAX,
     ENGINE_VALUE_I_FPS,
+    ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_HITS,
+    ENGINE_VALUE_I_SCRIPT_IMPORTCACHE_MISSES,
+    ENGINE_VALUE_I_SPRCACHE_HITS,
+    ENGINE_VALUE_I_SPRCACHE_MISSES,
+    ENGINE_VALUE_I_SPRCACHE_EVICTIONS,
+    ENGINE_VALUE_I_TEXCACHE_HITS,
+    ENGINE_VALUE_I_TEXCACHE_MISSES,
+    ENGINE_VALUE_I_TEXCACHE_EVICTIONS,
     ENGINE_VALUE_LAST                      // in case user wants to iterate them
 };
 
@@ -15,6 +15,7 @@
 #include "core/platform.h"
 #include <thread>
 #include "ac/sys_events.h"
+#include "debug/frametimer.h"
 #include "platform/base/agsplatformdriver.h"
 #if defined(AGS_DISABLE_THREADS)
 #include "media/audio/audio_core.h"
@@ -68,7 +69,8 @@ bool isTimerFpsMaxed()
     return framerate_maxed;
 }
 
-void WaitForNextFrame()
+// Sleeps until the next frame's time
+static void WaitForNextFrameTime()
 {
     // Do the last polls on this frame, if necessary
 #if defined(AGS_DISABLE_THREADS)
@@ -116,6 +118,16 @@ void WaitForNextFrame()
     }
 }
 
+void WaitForNextFrame()
+{
+    {
+        FrameStageScope stage_scope(kFrameStage_Wait);
+        WaitForNextFrameTime();
+    }
+    // The frame ends when the wait is over
+    frametimer_next_frame();
+}
+
 void skipMissedTicks()
 {
     last_tick_time = Clock::now();
@@ -13,6 +13,7 @@
 //=============================================================================
 #include "ac/walkbehind.h"
 #include <algorithm>
+#include <string.h>
 #include "ac/draw.h"
 #include "ac/gamestate.h"
 #include "ac/roomstatus.h"
@@ -27,62 +28,47 @@ extern RoomStruct thisroom;
 extern IGraphicsDriver *gfxDriver;
 extern RoomStatus *croom;
 
-// An info on vertical column of walk-behind mask, which may contain WB area
-struct WalkBehindColumn
-{
-    bool Exists = false; // whether any WB area is in this column
-    int Y1 = 0, Y2 = 0; // WB top and bottom Y coords
-};
-
-std::vector<WalkBehindColumn> walkBehindCols; // precalculated WB positions
-Rect walkBehindAABB[MAX_WALK_BEHINDS]; // WB bounding box
+WalkBehindSpanIndex walkBehindIndex; // WB mask spans and areas' bounding boxes
 int walkBehindsCachedForBgNum = -1; // WB textures are for this background
 bool noWalkBehindsAtAll = false; // quick report that no WBs in this room
 bool walk_behind_baselines_changed = false;
+bool walkBehindMaskChanged = true; // WB mask has to be passed to renderer
+
 
+void walkbehinds_copy_area(const WalkBehindSpanIndex &index, int wb, const Bitmap *bg, Bitmap *dst)
+{
+    const Rect pos = index.AABB[wb];
+    const int bpp = bg->GetBPP();
+    // Copy over all spans belonging to this WB area
+    for (int y = pos.Top; y <= pos.Bottom; ++y)
+    {
+        const uint8_t *src_line = bg->GetScanLine(y);
+        uint8_t *dst_line = dst->GetScanLineForWriting(y - pos.Top);
+        for (size_t i = index.Rows[y]; i < index.Rows[y + 1]; ++i)
+        {
+            const auto &span = index.Spans[i];
+            if (span.Area != wb) continue;
+            memcpy(dst_line + (span.X1 - pos.Left) * bpp, src_line + span.X1 * bpp,
+                (span.X2 - span.X1) * bpp);
+        }
+    }
+}
 
 // Generates walk-behinds as separate sprites
 void walkbehinds_generate_sprites()
 {
-    const Bitmap *mask = thisroom.WalkBehindMask.get();
     const Bitmap *bg = thisroom.BgFrames[play.bg_frame].Graphic.get();
-    
+
     const int coldepth = bg->GetColorDepth();
     Bitmap wbbmp; // temp buffer
     // Iterate through walk-behinds and generate a texture for each of them
     for (int wb = 1 /* 0 is "no area" */; wb < MAX_WALK_BEHINDS; ++wb)
     {
-        const Rect pos = walkBehindAABB[wb];
+        const Rect pos = walkBehindIndex.AABB[wb];
         if (pos.Right > 0)
         {
             wbbmp.CreateTransparent(pos.GetWidth(), pos.GetHeight(), coldepth);
-            // Copy over all solid pixels belonging to this WB area
-            const int sx = pos.Left, ex = pos.Right, sy = pos.Top, ey = pos.Bottom;
-            for (int y = sy; y <= ey; ++y)
-            {
-                const uint8_t *check_line = mask->GetScanLine(y);
-                const uint8_t *src_line = bg->GetScanLine(y);
-                uint8_t *dst_line = wbbmp.GetScanLineForWriting(y - sy);
-                for (int x = sx; x <= ex; ++x)
-                {
-                    if (check_line[x] != wb) continue;
-                    switch (coldepth)
-                    {
-                    case 8:
-                        dst_line[(x - sx)] = src_line[x];
-                        break;
-                    case 16:
-                        reinterpret_cast<uint16_t*>(dst_line)[(x - sx)] =
-                            reinterpret_cast<const uint16_t*>(src_line)[x];
-                        break;
-                    case 32:
-                        reinterpret_cast<uint32_t*>(dst_line)[(x - sx)] =
-                            reinterpret_cast<const uint32_t*>(src_line)[x];
-                        break;
-                    default: assert(0); break;
-                    }
-                }
-            }
+            walkbehinds_copy_area(walkBehindIndex, wb, bg, &wbbmp);
             // Add to walk-behinds image list
             add_walkbehind_image(wb, &wbbmp, pos.Left, pos.Top);
         }
@@ -91,50 +77,51 @@ void walkbehinds_generate_sprites()
     walkBehindsCachedForBgNum = play.bg_frame;
 }
 
-// Edits the given game object's sprite, cutting out pixels covered by walk-behinds;
-// returns whether any pixels were updated;
-bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
+// Passes the walk-behind mask to the renderer
+bool walkbehinds_set_mask()
 {
-    if (noWalkBehindsAtAll)
-        return false;
+    walkBehindMaskChanged = false;
+    return gfxDriver->SetWalkBehindMask(noWalkBehindsAtAll ? nullptr : thisroom.WalkBehindMask.get());
+}
 
+bool walkbehinds_cropout(const WalkBehindSpanIndex &index, const short *baselines,
+    Bitmap *sprit, int sprx, int spry, int basel)
+{
     const int maskcol = sprit->GetMaskColor();
     const int spcoldep = sprit->GetColorDepth();
 
     bool pixels_changed = false;
-    // pass along the sprite's pixels, but skip those that lie outside the mask
-    for (int x = std::max(0, 0 - sprx);
-        (x < sprit->GetWidth()) && (x + sprx < thisroom.WalkBehindMask->GetWidth()); ++x)
+    // pass along the mask rows covered by sprite, and cut out the sprite's
+    // pixels covered by the spans of the areas with a higher baseline
+    const int sprx2 = sprx + sprit->GetWidth();
+    const int y1 = std::max(0, spry);
+    const int y2 = std::min(spry + sprit->GetHeight(), static_cast<int>(index.Rows.size()) - 1);
+    for (int y = y1; y < y2; ++y)
     {
-        // select the WB column at this x
-        const auto &wbcol = walkBehindCols[x + sprx];
-        // skip if no area, or sprite lies outside of all areas in this column
-        if ((!wbcol.Exists) ||
-            (wbcol.Y2 <= spry) ||
-            (wbcol.Y1 > spry + sprit->GetHeight()))
-            continue;
-
-        // ensure we only check within the valid areas (between Y1 and Y2)
-        // we assume that Y1 and Y2 are always within the mask
-        for (int y = std::max(0, wbcol.Y1 - spry);
-            (y < sprit->GetHeight()) && (y + spry < wbcol.Y2); ++y)
+        const auto row_end = index.Spans.begin() + index.Rows[y + 1];
+        // find the first span which ends past the sprite's left edge
+        auto span = std::upper_bound(index.Spans.begin() + index.Rows[y], row_end, sprx,
+            [](int x, const WalkBehindSpan &sp) { return x < sp.X2; });
+        for (; (span != row_end) && (span->X1 < sprx2); ++span)
         {
-            const int wb = thisroom.WalkBehindMask->GetScanLine(y + spry)[x + sprx];
-            if (wb < 1) continue; // "no area"
-            if (croom->walkbehind_base[wb] <= basel) continue;
+            if (baselines[span->Area] <= basel) continue;
 
             pixels_changed = true;
-            uint8_t *dst_line = sprit->GetScanLineForWriting(y);
+            uint8_t *dst_line = sprit->GetScanLineForWriting(y - spry);
+            const int x1 = std::max(span->X1, sprx) - sprx;
+            const int x2 = std::min(span->X2, sprx2) - sprx;
             switch (spcoldep)
             {
             case 8:
-                dst_line[x] = maskcol;
+                memset(dst_line + x1, maskcol, x2 - x1);
                 break;
             case 16:
-                reinterpret_cast<uint16_t*>(dst_line)[x] = maskcol;
+                std::fill(reinterpret_cast<uint16_t*>(dst_line) + x1,
+                    reinterpret_cast<uint16_t*>(dst_line) + x2, static_cast<uint16_t>(maskcol));
                 break;
             case 32:
-                reinterpret_cast<uint32_t*>(dst_line)[x] = maskcol;
+                std::fill(reinterpret_cast<uint32_t*>(dst_line) + x1,
+                    reinterpret_cast<uint32_t*>(dst_line) + x2, static_cast<uint32_t>(maskcol));
                 break;
             default:
                 assert(0);
@@ -145,43 +132,56 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
     return pixels_changed;
 }
 
-void walkbehinds_recalc()
+// Edits the given game object's sprite, cutting out pixels covered by walk-behinds;
+// returns whether any pixels were updated;
+bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
+{
+    if (noWalkBehindsAtAll)
+        return false;
+    return walkbehinds_cropout(walkBehindIndex, croom->walkbehind_base, sprit, sprx, spry, basel);
+}
+
+bool walkbehinds_make_spans(const Bitmap *mask, WalkBehindSpanIndex &index)
 {
     // Reset all data
-    walkBehindCols.clear();
+    index.Spans.clear();
+    index.Rows.clear();
     for (int wb = 0; wb < MAX_WALK_BEHINDS; ++wb)
     {
-        walkBehindAABB[wb] = Rect(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
+        index.AABB[wb] = Rect(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
     }
-    noWalkBehindsAtAll = true;
 
     // Recalculate everything; note that mask is always 8-bit
-    const Bitmap *mask = thisroom.WalkBehindMask.get();
-    walkBehindCols.resize(mask->GetWidth());
-    for (int col = 0; col < mask->GetWidth(); ++col)
+    const int width = mask->GetWidth();
+    index.Rows.resize(mask->GetHeight() + 1);
+    for (int y = 0; y < mask->GetHeight(); ++y)
     {
-        auto &wbcol = walkBehindCols[col];
-        for (int y = 0; y < mask->GetHeight(); ++y)
+        index.Rows[y] = index.Spans.size();
+        const uint8_t *line = mask->GetScanLine(y);
+        for (int x = 0; x < width;)
         {
-            int wb = mask->GetScanLine(y)[col];
+            const int wb = line[x];
+            const int x1 = x;
+            for (++x; (x < width) && (line[x] == wb); ++x);
             // Valid areas start with index 1, 0 = no area
-            if ((wb >= 1) && (wb < MAX_WALK_BEHINDS))
-            {
-                if (!wbcol.Exists)
-                {
-                    wbcol.Y1 = y;
-                    wbcol.Exists = true;
-                    noWalkBehindsAtAll = false;
-                }
-                wbcol.Y2 = y + 1; // +1 to allow bottom line of screen to work (CHECKME??)
-                // resize the bounding rect
-                walkBehindAABB[wb].Left = std::min(col, walkBehindAABB[wb].Left);
-                walkBehindAABB[wb].Top = std::min(y, walkBehindAABB[wb].Top);
-                walkBehindAABB[wb].Right = std::max(col, walkBehindAABB[wb].Right);
-                walkBehindAABB[wb].Bottom = std::max(y, walkBehindAABB[wb].Bottom);
-            }
+            if ((wb < 1) || (wb >= MAX_WALK_BEHINDS))
+                continue;
+
+            index.Spans.emplace_back(x1, x, wb);
+            // resize the bounding rect
+            index.AABB[wb].Left = std::min(x1, index.AABB[wb].Left);
+            index.AABB[wb].Top = std::min(y, index.AABB[wb].Top);
+            index.AABB[wb].Right = std::max(x - 1, index.AABB[wb].Right);
+            index.AABB[wb].Bottom = std::max(y, index.AABB[wb].Bottom);
         }
     }
+    index.Rows.back() = index.Spans.size();
+    return !index.Spans.empty();
+}
 
+void walkbehinds_recalc()
+{
+    noWalkBehindsAtAll = !walkbehinds_make_spans(thisroom.WalkBehindMask.get(), walkBehindIndex);
     walkBehindsCachedForBgNum = -1;
+    walkBehindMaskChanged = true;
 }
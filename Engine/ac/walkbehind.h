@@ -18,6 +18,8 @@
 #ifndef __AGS_EE_AC__WALKBEHIND_H
 #define __AGS_EE_AC__WALKBEHIND_H
 
+#include <vector>
+#include "game/roomstruct.h"
 #include "util/geometry.h"
 
 // A method of rendering walkbehinds on screen:
@@ -27,19 +29,56 @@
 //     transparent when they are covered by walkbehind (walkbehind itself
 //     is not drawn separately in this case);
 //     this method is optimized for software render.
+// DrawByMaskInShader - passes walkbehind mask to the renderer, which hides
+//     parts of the sprites when drawing them, comparing their baselines
+//     with the walkbehinds' ones; for renderers which support this.
 enum WalkBehindMethodEnum
 {
     DrawAsSeparateSprite,
     DrawOverCharSprite,
+    DrawByMaskInShader,
 };
 
 namespace AGS { namespace Common { class Bitmap; } }
 using namespace AGS; // FIXME later
 
+// A horizontal run of walk-behind mask pixels belonging to the same area
+struct WalkBehindSpan
+{
+    int X1 = 0, X2 = 0; // first and past-the-last X coords
+    int Area = 0; // WB area index
+
+    WalkBehindSpan() = default;
+    WalkBehindSpan(int x1, int x2, int area) : X1(x1), X2(x2), Area(area) {}
+};
+
+// Walk-behind mask, indexed as spans of each row
+struct WalkBehindSpanIndex
+{
+    std::vector<WalkBehindSpan> Spans; // WB mask spans, ordered by row, then X
+    std::vector<size_t> Rows; // first span of each mask row, plus the end
+    Rect AABB[MAX_WALK_BEHINDS]; // WB bounding box
+};
+
+// Builds the span index of the walk-behind mask;
+// returns false if there are no walk-behind areas in the mask
+bool walkbehinds_make_spans(const Common::Bitmap *mask, WalkBehindSpanIndex &index);
+// Copies the background pixels covered by the walk-behind area into the bitmap,
+// which is positioned at the area's bounding box, and must be transparent
+void walkbehinds_copy_area(const WalkBehindSpanIndex &index, int wb,
+    const Common::Bitmap *bg, Common::Bitmap *dst);
+// Edits the sprite, cutting out pixels covered by the walk-behind areas
+// with a higher baseline; returns whether any pixels were updated
+bool walkbehinds_cropout(const WalkBehindSpanIndex &index, const short *baselines,
+    Common::Bitmap *sprit, int sprx, int spry, int basel);
+
 // Recalculates walk-behind positions
 void walkbehinds_recalc();
 // Generates walk-behinds as separate sprites
 void walkbehinds_generate_sprites();
+// Passes the walk-behind mask to the renderer;
+// returns false if the renderer cannot use it
+bool walkbehinds_set_mask();
 // Edits the given game object's sprite, cutting out pixels covered by walk-behinds;
 // returns whether any pixels were updated
 bool walkbehinds_cropout(Common::Bitmap *sprit, int sprx, int spry, int basel);
@@ -47,5 +86,6 @@ bool walkbehinds_cropout(Common::Bitmap *sprit, int sprx, int spry, int basel);
 extern bool noWalkBehindsAtAll;
 extern int walkBehindsCachedForBgNum;
 extern bool walk_behind_baselines_changed;
+extern bool walkBehindMaskChanged;
 
 #endif // __AGS_EE_AC__WALKBEHIND_H
@@ -84,6 +84,7 @@ IAGSEditorDebugger *GetEditorDebugger(const char* /*instanceToken*/)
 int debug_flags=0;
 
 FPSDisplayMode display_fps = kFPS_Hide;
+bool display_frame_graph = false;
 
 void send_message_to_debugger(IAGSEditorDebugger *ide_debugger,
     const std::vector<std::pair<String, String>>& tag_values, const String& command)
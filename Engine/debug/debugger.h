@@ -53,6 +53,7 @@ enum FPSDisplayMode
 };
 
 extern FPSDisplayMode display_fps;
+extern bool display_frame_graph;
 extern int debug_flags;
 
 #endif // __AC_DEBUGGER_H
@@ -0,0 +1,172 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "debug/frametimer.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "util/file.h"
+#include "util/textstreamwriter.h"
+#include "util/time_util.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+namespace
+{
+
+const char *StageNames[kNumFrameStages] =
+{
+    "Other", "Script", "Movement", "Animation", "SpritePrep", "GUI", "Render", "Present", "Wait"
+};
+
+static_assert((FrameTimerHistorySize & (FrameTimerHistorySize - 1)) == 0,
+    "FrameTimerHistorySize must be a power of 2");
+
+// Current frame's state, only accessed by the game thread
+struct FrameTimerState
+{
+    bool Started = false;
+    FrameStage Stage = kFrameStage_Other;
+    Clock::time_point TimerStart;
+    Clock::time_point FrameStart;
+    Clock::time_point StageStart;
+    Clock::duration StageTimes[kNumFrameStages]{};
+} Timer;
+
+// History ring; FramesWritten is the total number of frames ever written,
+// and the next frame's position in the ring (wrapped)
+FrameTimes History[FrameTimerHistorySize];
+std::atomic<uint32_t> FramesWritten(0u);
+
+uint32_t ToMicroseconds(Clock::duration dur)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(dur).count());
+}
+
+} // namespace
+
+
+const char *frametimer_get_stage_name(FrameStage stage)
+{
+    return (stage >= 0 && stage < kNumFrameStages) ? StageNames[stage] : "";
+}
+
+FrameStage frametimer_set_stage(FrameStage stage)
+{
+    const FrameStage prev_stage = Timer.Stage;
+    if (stage == prev_stage)
+        return prev_stage;
+    const auto now = Clock::now();
+    Timer.StageTimes[prev_stage] += now - Timer.StageStart;
+    Timer.StageStart = now;
+    Timer.Stage = stage;
+    return prev_stage;
+}
+
+void frametimer_next_frame()
+{
+    const auto now = Clock::now();
+    if (!Timer.Started)
+    {
+        Timer.Started = true;
+        Timer.TimerStart = now;
+    }
+    else
+    {
+        Timer.StageTimes[Timer.Stage] += now - Timer.StageStart;
+        const uint32_t index = FramesWritten.load(std::memory_order_relaxed);
+        FrameTimes &ft = History[index & (FrameTimerHistorySize - 1)];
+        ft.Frame = index;
+        ft.Start = std::chrono::duration_cast<std::chrono::microseconds>(Timer.FrameStart - Timer.TimerStart).count();
+        ft.Total = ToMicroseconds(now - Timer.FrameStart);
+        for (int i = 0; i < kNumFrameStages; ++i)
+            ft.Stages[i] = ToMicroseconds(Timer.StageTimes[i]);
+        // Publish the record for the readers
+        FramesWritten.store(index + 1, std::memory_order_release);
+    }
+
+    // The current stage is kept, as the new frame may begin in the middle
+    // of a stage, e.g. when the script runs a blocking action
+    Timer.FrameStart = now;
+    Timer.StageStart = now;
+    for (auto &t : Timer.StageTimes)
+        t = Clock::duration::zero();
+}
+
+size_t frametimer_get_history(FrameTimes *buf, size_t max_count)
+{
+    const uint32_t end = FramesWritten.load(std::memory_order_acquire);
+    const uint32_t count = static_cast<uint32_t>(std::min<size_t>(
+        std::min<size_t>(end, FrameTimerHistorySize), max_count));
+    const uint32_t first = end - count;
+    for (uint32_t i = 0; i < count; ++i)
+        buf[i] = History[(first + i) & (FrameTimerHistorySize - 1)];
+
+    // The writer could have overwritten the oldest records while we were
+    // copying them. Record N is only overwritten when the record
+    // N + HistorySize is written, and the writer may be in the middle of
+    // writing the one past the last published; so the copied records
+    // which are too close to the new end are dropped.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint32_t new_end = FramesWritten.load(std::memory_order_relaxed);
+    const uint32_t valid_from = (new_end + 1 > FrameTimerHistorySize) ?
+        (new_end + 1 - FrameTimerHistorySize) : 0u;
+    if (first >= valid_from)
+        return count;
+    const uint32_t drop = std::min(valid_from - first, count);
+    std::copy(buf + drop, buf + count, buf);
+    return count - drop;
+}
+
+bool frametimer_write_history(const String &csv_path, const String &trace_path)
+{
+    std::vector<FrameTimes> frames(FrameTimerHistorySize);
+    frames.resize(frametimer_get_history(frames.data(), frames.size()));
+
+    auto csv_out = File::CreateFile(csv_path);
+    auto trace_out = File::CreateFile(trace_path);
+    if (!csv_out || !trace_out)
+        return false;
+
+    TextStreamWriter csv(std::move(csv_out));
+    csv.WriteString("frame,start_ms,total_ms");
+    for (int i = 0; i < kNumFrameStages; ++i)
+        csv.WriteFormat(",%s_ms", StageNames[i]);
+    csv.WriteLineBreak();
+    for (const auto &ft : frames)
+    {
+        csv.WriteFormat("%u,%.3f,%.3f", ft.Frame, ft.Start * 0.001, ft.Total * 0.001);
+        for (int i = 0; i < kNumFrameStages; ++i)
+            csv.WriteFormat(",%.3f", ft.Stages[i] * 0.001);
+        csv.WriteLineBreak();
+    }
+
+    // Each frame is written as a complete event, and the stage times
+    // as a counter event, which is displayed as a stacked chart
+    TextStreamWriter trace(std::move(trace_out));
+    trace.WriteLine("{\"traceEvents\":[");
+    for (size_t f = 0; f < frames.size(); ++f)
+    {
+        const auto &ft = frames[f];
+        trace.WriteFormat("{\"name\":\"Frame %u\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lld,\"dur\":%u},\n",
+            ft.Frame, static_cast<long long>(ft.Start), ft.Total);
+        trace.WriteFormat("{\"name\":\"Stages\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{",
+            static_cast<long long>(ft.Start));
+        for (int i = 0; i < kNumFrameStages; ++i)
+            trace.WriteFormat("%s\"%s\":%.3f", (i > 0) ? "," : "", StageNames[i], ft.Stages[i] * 0.001);
+        trace.WriteLine((f + 1 < frames.size()) ? "}}," : "}}");
+    }
+    trace.WriteLine("],\"displayTimeUnit\":\"ms\"}");
+    return true;
+}
@@ -0,0 +1,90 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Frame timer measures how much time each game frame spends in the major
+// update and render stages. The engine marks the stage it enters, either
+// by calling frametimer_set_stage() or with a FrameStageScope; the time is
+// accounted exclusively, so that nested stages are not counted twice.
+// Switching a stage costs a single clock read, which lets the timer stay
+// enabled in release builds.
+//
+// Finished frames are stored in a fixed-size ring buffer, which keeps the
+// history of the last frames. The ring is written only by the game thread,
+// but may be read from any thread without locking: see
+// frametimer_get_history().
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__FRAMETIMER_H
+#define __AGS_EE_DEBUG__FRAMETIMER_H
+
+#include "core/types.h"
+#include "util/string.h"
+
+enum FrameStage
+{
+    kFrameStage_Other = 0,  // anything not covered by the other stages
+    kFrameStage_Script,     // script callbacks and event handlers
+    kFrameStage_Movement,   // character movement (and their view animation)
+    kFrameStage_Animation,  // object, overlay, speech and GUI animation
+    kFrameStage_SpritePrep, // preparing room sprites for drawing
+    kFrameStage_GUI,        // preparing overlays and GUI for drawing
+    kFrameStage_Render,     // driver's render
+    kFrameStage_Present,    // driver's present (buffer swap)
+    kFrameStage_Wait,       // waiting for the next frame
+    kNumFrameStages
+};
+
+// Time measurements of a single game frame
+struct FrameTimes
+{
+    uint32_t Frame = 0u;    // sequential frame number
+    int64_t  Start = 0;     // frame start, in microseconds since the first frame
+    uint32_t Total = 0u;    // total frame duration, in microseconds
+    uint32_t Stages[kNumFrameStages] = {}; // time per stage, in microseconds
+};
+
+// Max number of frames kept in history
+const size_t FrameTimerHistorySize = 2048u;
+
+// Gets the printable stage name
+const char *frametimer_get_stage_name(FrameStage stage);
+// Switches to the new frame stage; returns the previous one
+FrameStage frametimer_set_stage(FrameStage stage);
+// Finishes the current frame, stores its times in history and starts a new one
+void frametimer_next_frame();
+// Copies up to max_count last finished frames into the buffer, in the
+// chronological order; returns the number of copied frames
+size_t frametimer_get_history(FrameTimes *buf, size_t max_count);
+// Writes the frame history as a CSV table and as a Chrome trace
+// (JSON Trace Event format); returns false if failed to open either file
+bool frametimer_write_history(const AGS::Common::String &csv_path,
+                              const AGS::Common::String &trace_path);
+
+// FrameStageScope switches to the given stage for the lifetime of this
+// object, and restores the previous stage when destroyed
+class FrameStageScope
+{
+public:
+    explicit FrameStageScope(FrameStage stage)
+        : _prevStage(frametimer_set_stage(stage)) {}
+    ~FrameStageScope() { frametimer_set_stage(_prevStage); }
+
+private:
+    FrameStageScope(const FrameStageScope&) = delete;
+    FrameStageScope &operator =(const FrameStageScope&) = delete;
+
+    const FrameStage _prevStage;
+};
+
+#endif // __AGS_EE_DEBUG__FRAMETIMER_H
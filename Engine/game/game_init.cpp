@@ -559,6 +559,8 @@ HGameInitError InitGameState(const LoadedGameEntities &ents, GameDataVersion dat
     // require access to script API at initialization time.
     //
     ccSetScriptAliveTimer(1000 / 60u, 1000u, 150000u);
+    ccSetScriptPredecode(usetup.ScriptPredecode);
+    ccSetScriptProfiling(usetup.ScriptProfile);
     setup_script_exports(base_api, compat_api);
 
     //
@@ -859,6 +859,7 @@ HSaveError DoAfterRestore(const PreservedParams &pp, RestoredData &r_data, SaveC
             thisroom.Regions[i].Tint = r_data.RoomTintLevels[i];
         }
         generate_light_table();
+        invalidate_region_tints();
 
         for (size_t i = 0; i < MAX_WALK_AREAS; ++i)
         {
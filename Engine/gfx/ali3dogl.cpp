@@ -16,10 +16,13 @@
 #if AGS_HAS_OPENGL
 #include "gfx/ali3dogl.h"
 #include <algorithm>
+#include <cstddef>
 #include <stack>
+#include <string.h>
 #include <SDL.h>
 #include "ac/sys_events.h"
 #include "ac/timer.h"
+#include "debug/frametimer.h"
 #include "debug/out.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/gfx_def.h"
@@ -71,12 +74,88 @@ Rect TopDownRect(const Rect &rect, int surface_height)
 }
 
 
+// Size of the atlas pages
+const int AtlasPageSize = 1024;
+// Max size of texture which may be put into atlas
+const int AtlasMaxTextureSize = 256;
+// Max number of quads in a batch, limited by 16-bit vertex indices
+const size_t MaxBatchQuads = 4096;
+
+
+OGLTextureAtlas::OGLTextureAtlas(int page_size)
+    : _atlas(page_size, page_size)
+{
+}
+
+OGLTextureAtlas::~OGLTextureAtlas()
+{
+    for (auto tex : _pageTextures)
+    {
+        if (tex)
+            glDeleteTextures(1, &tex);
+    }
+}
+
+bool OGLTextureAtlas::Allocate(OGLTextureTile &tile, size_t &page)
+{
+    Rect rc;
+    bool new_page;
+    if (!_atlas.Allocate(tile.allocWidth, tile.allocHeight, page, rc, new_page))
+        return false;
+
+    if (new_page)
+    {
+        if (_pageTextures.size() <= page)
+            _pageTextures.resize(page + 1);
+        glGenTextures(1, &_pageTextures[page]);
+        glBindTexture(GL_TEXTURE_2D, _pageTextures[page]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _atlas.GetPageWidth(), _atlas.GetPageHeight(),
+            0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    tile.texture = _pageTextures[page];
+    tile.texX = rc.Left;
+    tile.texY = rc.Top;
+    return true;
+}
+
+void OGLTextureAtlas::Free(const OGLTextureTile &tile, size_t page)
+{
+    if (!_atlas.Free(page, RectWH(tile.texX, tile.texY, tile.allocWidth, tile.allocHeight)))
+        return;
+    // Keep one empty page in reserve, for the case when the sprites are
+    // released and created again in succession
+    for (size_t i = 0; i < _atlas.GetPageCount(); ++i)
+    {
+        if ((i != page) && _atlas.IsPageEmpty(i))
+        {
+            glDeleteTextures(1, &_pageTextures[page]);
+            _pageTextures[page] = 0;
+            _atlas.RemovePage(page);
+            return;
+        }
+    }
+}
+
+
 OGLTexture::~OGLTexture()
 {
     if (_tiles)
     {
-        for (size_t i = 0; i < _numTiles; ++i)
-            glDeleteTextures(1, &(_tiles[i].texture));
+        if (_atlas)
+        {
+            for (size_t i = 0; i < _numTiles; ++i)
+                _atlas->Free(_tiles[i], _atlasPage);
+        }
+        else
+        {
+            for (size_t i = 0; i < _numTiles; ++i)
+                glDeleteTextures(1, &(_tiles[i].texture));
+        }
         delete[] _tiles;
     }
     if (_vertex)
@@ -413,6 +492,9 @@ bool OGLGraphicsDriver::CreateShaders()
   shaders_created &= CreateTransparencyShader(_transparencyShader);
   shaders_created &= CreateTintShader(_tintShader);
   shaders_created &= CreateLightShader(_lightShader);
+  // Batch shader is optional, sprites are rendered one by one without it
+  if (shaders_created && CreateBatchShader(_batchShader))
+    CreateBatchBuffers();
   return shaders_created;
 }
 
@@ -425,20 +507,63 @@ static const auto default_vertex_shader_src =  ""
 #endif
 R"EOS(
 uniform mat4 uMVPMatrix;
+uniform mat4 uWBMatrix;
 
 attribute vec2 a_Position;
 attribute vec2 a_TexCoord;
 
 varying vec2 v_TexCoord;
+varying vec2 v_WBCoord;
 
 void main() {
     v_TexCoord = a_TexCoord;
+    v_WBCoord = (uWBMatrix * vec4(a_Position.xy, 0.0, 1.0)).xy;
     gl_Position = uMVPMatrix * vec4(a_Position.xy, 0.0, 1.0);
 }
 
 )EOS";
 
 
+// Walk-behind test, shared by the built-in fragment shaders: tells if the
+// pixel is covered by a walk-behind area, which hides the sprite.
+// Walk-behind mask is an 8-bit texture with area indexes. The areas which
+// hide the sprite are passed as bit flags, stored in two numbers: for the
+// areas 0-7 and 8-15; bits are tested using float math, for GLSL 1.00.
+// The mask coordinate must be precise to a texel of a large room mask,
+// so it's declared with high precision where the GLES device supports one.
+
+// Uniforms:
+// wbMask - walk-behind mask texture index (always 1).
+
+#define WALKBEHIND_FRAGMENT_SHADER_SRC \
+"#if defined(GL_ES) && defined(GL_FRAGMENT_PRECISION_HIGH)\n" \
+"#define WB_HIGHP highp\n" \
+"#else\n" \
+"#define WB_HIGHP\n" \
+"#endif\n" \
+"uniform sampler2D wbMask;\n" \
+"\n" \
+"bool isBehindWalkBehind(WB_HIGHP vec2 coord, vec2 occlusion)\n" \
+"{\n" \
+"    occlusion = floor(occlusion + 0.5);\n" \
+"    if ((occlusion.x + occlusion.y == 0.0) ||\n" \
+"        any(lessThan(coord, vec2(0.0))) || any(greaterThanEqual(coord, vec2(1.0))))\n" \
+"        return false;\n" \
+"    float area = floor(texture2D(wbMask, coord).x * 255.0 + 0.5);\n" \
+"    if (area >= 16.0)\n" \
+"        return false;\n" \
+"    float flags = (area < 8.0) ? occlusion.x : occlusion.y;\n" \
+"    float bit = mod(area, 8.0);\n" \
+"    for (int i = 0; i < 8; ++i)\n" \
+"    {\n" \
+"        if (float(i) >= bit)\n" \
+"            break;\n" \
+"        flags = floor(flags * 0.5);\n" \
+"    }\n" \
+"    return mod(flags, 2.0) >= 1.0;\n" \
+"}\n"
+
+
 static const auto transparency_fragment_shader_src = ""
 #if AGS_OPENGL_ES2
 "#version 100 \n"
@@ -446,14 +571,19 @@ static const auto transparency_fragment_shader_src = ""
 #else
 "#version 120 \n"
 #endif
+WALKBEHIND_FRAGMENT_SHADER_SRC
 R"EOS(
 uniform sampler2D textID;
 uniform float alpha;
+uniform vec2 wbOcclusion;
 
 varying vec2 v_TexCoord;
+varying WB_HIGHP vec2 v_WBCoord;
 
 void main()
 {
+    if (isBehindWalkBehind(v_WBCoord, wbOcclusion))
+        discard;
     vec4 src_col = texture2D(textID, v_TexCoord);
     gl_FragColor = vec4(src_col.xyz, src_col.w * alpha);
 }
@@ -478,14 +608,17 @@ static const auto tint_fragment_shader_src = ""
 #else
 "#version 120 \n"
 #endif
+WALKBEHIND_FRAGMENT_SHADER_SRC
 R"EOS(
 uniform sampler2D textID;
 uniform vec3 tintHSV;
 uniform float tintAmount;
 uniform float tintLuminance;
 uniform float alpha;
+uniform vec2 wbOcclusion;
 
 varying vec2 v_TexCoord;
+varying WB_HIGHP vec2 v_WBCoord;
 
 vec3 rgb2hsv(vec3 c)
 {
@@ -514,6 +647,8 @@ float getValue(vec3 color)
 
 void main()
 {
+    if (isBehindWalkBehind(v_WBCoord, wbOcclusion))
+        discard;
     vec4 src_col = texture2D(textID, v_TexCoord);
 
     float lum = getValue(src_col.xyz);
@@ -541,15 +676,20 @@ static const auto light_fragment_shader_src = ""
 #else
 "#version 120 \n"
 #endif
+WALKBEHIND_FRAGMENT_SHADER_SRC
 R"EOS(
 uniform sampler2D textID;
 uniform float light;
 uniform float alpha;
+uniform vec2 wbOcclusion;
 
 varying vec2 v_TexCoord;
+varying WB_HIGHP vec2 v_WBCoord;
 
 void main()
 {
+    if (isBehindWalkBehind(v_WBCoord, wbOcclusion))
+        discard;
     vec4 src_col = texture2D(textID, v_TexCoord);
 
    if (light >= 0.0)
@@ -560,6 +700,95 @@ void main()
 )EOS";
 
 
+// Batch shader renders a number of sprites at once: vertices are already
+// transformed, and each has the sprite's alpha and tint parameters.
+// Tinting is same as in the tint_fragment_shader_src.
+
+static const auto batch_vertex_shader_src =  ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+attribute vec2 a_Position;
+attribute vec2 a_TexCoord;
+attribute float a_Alpha;
+attribute vec4 a_Tint;
+attribute vec4 a_WalkBehind;
+
+varying vec2 v_TexCoord;
+varying float v_Alpha;
+varying vec4 v_Tint;
+varying vec4 v_WalkBehind;
+
+void main() {
+    v_TexCoord = a_TexCoord;
+    v_Alpha = a_Alpha;
+    v_Tint = a_Tint;
+    v_WalkBehind = a_WalkBehind;
+    gl_Position = vec4(a_Position.xy, 0.0, 1.0);
+}
+
+)EOS";
+
+// Attributes:
+// a_Alpha - sprite's alpha,
+// a_Tint - tint parameters: hue, saturation, amount, luminance;
+//          amount 0 means no tint;
+// a_WalkBehind - position in the walk-behind mask, and walk-behind occlusion flags.
+
+static const auto batch_fragment_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+"precision mediump float; \n"
+#else
+"#version 120 \n"
+#endif
+WALKBEHIND_FRAGMENT_SHADER_SRC
+R"EOS(
+uniform sampler2D textID;
+
+varying vec2 v_TexCoord;
+varying float v_Alpha;
+varying vec4 v_Tint;
+varying WB_HIGHP vec4 v_WalkBehind;
+
+vec3 hsv2rgb(vec3 c)
+{
+    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    vec3 p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+    return c.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), c.y);
+}
+
+float getValue(vec3 color)
+{
+    float colorMax = max (color[0], color[1]);
+    colorMax = max (colorMax, color[2]);
+    return colorMax;
+}
+
+void main()
+{
+    if (isBehindWalkBehind(v_WalkBehind.xy, v_WalkBehind.zw))
+        discard;
+    vec4 src_col = texture2D(textID, v_TexCoord);
+
+    if (v_Tint.z > 0.0)
+    {
+        float lum = getValue(src_col.xyz);
+        lum = max(lum - (1.0 - v_Tint.w), 0.0);
+        vec3 new_col = (hsv2rgb(vec3(v_Tint.x, v_Tint.y, lum)) * v_Tint.z + src_col.xyz * (1.0 - v_Tint.z));
+        gl_FragColor = vec4(new_col, src_col.w * v_Alpha);
+    }
+    else
+    {
+        gl_FragColor = vec4(src_col.xyz, src_col.w * v_Alpha);
+    }
+}
+)EOS";
+
+
 bool OGLGraphicsDriver::CreateTransparencyShader(ShaderProgram &prg)
 {
     if(!CreateShaderProgram(prg, "Transparency", default_vertex_shader_src, transparency_fragment_shader_src))
@@ -589,6 +818,53 @@ bool OGLGraphicsDriver::CreateLightShader(ShaderProgram &prg)
 }
 
 
+bool OGLGraphicsDriver::CreateBatchShader(ShaderProgram &prg)
+{
+    if(!CreateShaderProgram(prg, "Batch", batch_vertex_shader_src, batch_fragment_shader_src))
+        return false;
+    // NOTE: not using AssignBaseShaderArgs, because the attribute arrays
+    // are only enabled when rendering a batch
+    prg.A_Position = glGetAttribLocation(prg.Program, "a_Position");
+    prg.A_TexCoord = glGetAttribLocation(prg.Program, "a_TexCoord");
+    prg.A_Alpha = glGetAttribLocation(prg.Program, "a_Alpha");
+    prg.A_Tint = glGetAttribLocation(prg.Program, "a_Tint");
+    prg.A_WalkBehind = glGetAttribLocation(prg.Program, "a_WalkBehind");
+    prg.TextureId = glGetUniformLocation(prg.Program, "textID");
+    prg.WBMask = glGetUniformLocation(prg.Program, "wbMask");
+    return true;
+}
+
+void OGLGraphicsDriver::CreateBatchBuffers()
+{
+    // Quads are made of two triangles, the vertices are in the same order
+    // as in the triangle strips used for individual sprites
+    std::vector<GLushort> indices(MaxBatchQuads * 6);
+    for (size_t i = 0; i < MaxBatchQuads; ++i)
+    {
+        const GLushort v = static_cast<GLushort>(i * 4);
+        GLushort *quad = &indices[i * 6];
+        quad[0] = v; quad[1] = v + 1; quad[2] = v + 2;
+        quad[3] = v + 2; quad[4] = v + 1; quad[5] = v + 3;
+    }
+    glGenBuffers(1, &_batchIbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _batchIbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &_batchVbo);
+    _batchVertices.reserve(MaxBatchQuads * 4);
+}
+
+void OGLGraphicsDriver::DeleteBatchBuffers()
+{
+    if (_batchVbo)
+        glDeleteBuffers(1, &_batchVbo);
+    if (_batchIbo)
+        glDeleteBuffers(1, &_batchIbo);
+    _batchVbo = 0u;
+    _batchIbo = 0u;
+    _batchVertices.clear();
+}
+
 bool OGLGraphicsDriver::CreateShaderProgram(ShaderProgram &prg, const String &name, const char *vertex_shader_src, const char *fragment_shader_src)
 {
     GLint result;
@@ -653,6 +929,9 @@ void OGLGraphicsDriver::AssignBaseShaderArgs(ShaderProgram &prg)
     prg.MVPMatrix = glGetUniformLocation(prg.Program, "uMVPMatrix");
     prg.TextureId = glGetUniformLocation(prg.Program, "textID");
     prg.Alpha = glGetUniformLocation(prg.Program, "alpha");
+    prg.WBMatrix = glGetUniformLocation(prg.Program, "uWBMatrix");
+    prg.WBMask = glGetUniformLocation(prg.Program, "wbMask");
+    prg.WBOcclusion = glGetUniformLocation(prg.Program, "wbOcclusion");
     glEnableVertexAttribArray(prg.A_Position);
     glEnableVertexAttribArray(prg.A_TexCoord);
 }
@@ -851,6 +1130,12 @@ void OGLGraphicsDriver::UnInit()
   DeleteShaderProgram(_transparencyShader);
   DeleteShaderProgram(_tintShader);
   DeleteShaderProgram(_lightShader);
+  DeleteShaderProgram(_batchShader);
+  DeleteBatchBuffers();
+  DeleteWalkBehindMask();
+
+  // NOTE: the pages are deleted when the last texture is released
+  _textureAtlas = nullptr;
 
   DeleteWindowAndGlContext();
   sys_window_destroy();
@@ -987,7 +1272,273 @@ void OGLGraphicsDriver::RenderSprite(const OGLDrawListEntry *drawListEntry,
     const glm::mat4 &projection, const glm::mat4 &matGlobal,
     const SpriteColorTransform &color, const Size &rend_sz)
 {
-    RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
+    if (CanBatchTexture(drawListEntry->ddb))
+    {
+        AddTextureToBatch(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
+    }
+    else
+    {
+        FlushTextureBatch();
+        RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
+    }
+}
+
+void OGLGraphicsDriver::GetTileRect(const OGLBitmap *bmpToDraw, const OGLTextureTile &tile,
+    int draw_x, int draw_y, float &x, float &y, float &width, float &height)
+{
+  const float xProportion = (float)bmpToDraw->GetWidthToRender() / (float)bmpToDraw->GetWidth();
+  const float yProportion = (float)bmpToDraw->GetHeightToRender() / (float)bmpToDraw->GetHeight();
+  const float tileWidth = tile.width * xProportion;
+  const float tileHeight = tile.height * yProportion;
+  float xOffs, yOffs;
+  if ((bmpToDraw->GetFlip() & kFlip_Horizontal) != 0)
+    xOffs = (bmpToDraw->GetWidth() - (tile.x + tile.width)) * xProportion;
+  else
+    xOffs = tile.x * xProportion;
+  if ((bmpToDraw->GetFlip() & kFlip_Vertical) != 0)
+    yOffs = (bmpToDraw->GetHeight() - (tile.y + tile.height)) * yProportion;
+  else
+    yOffs = tile.y * yProportion;
+  x = draw_x + xOffs;
+  y = draw_y + yOffs;
+
+  // Setup translation and scaling
+  width = tileWidth;
+  height = tileHeight;
+  if ((bmpToDraw->GetFlip() & kFlip_Horizontal) != 0)
+  {
+    // The usual transform changes 0..1 into 0..width
+    // So first negate it (which changes 0..w into -w..0)
+    width = -width;
+    // and now shift it over to make it 0..w again
+    x += tileWidth;
+  }
+  if ((bmpToDraw->GetFlip() & kFlip_Vertical) != 0)
+  {
+    height = -height;
+    y += tileHeight;
+  }
+}
+
+glm::mat4 OGLGraphicsDriver::GetTileTransform(const OGLBitmap *bmpToDraw, const OGLTextureTile &tile,
+    int draw_x, int draw_y, const glm::mat4 &projection, const glm::mat4 &matGlobal, const Size &rend_sz)
+{
+  float thisX, thisY, widthToScale, heightToScale;
+  GetTileRect(bmpToDraw, tile, draw_x, draw_y, thisX, thisY, widthToScale, heightToScale);
+  // Center inside a rendering rect
+  // FIXME: this should be a part of a projection matrix, afaik
+  thisX = (-(rend_sz.Width / 2.0f)) + thisX;
+  thisY = (rend_sz.Height / 2.0f) - thisY; // inverse axis
+
+  //
+  // IMPORTANT: in OpenGL order of transformation is REVERSE to the order of commands!
+  //
+  glm::mat4 transform = projection;
+  // Origin is at the middle of the surface
+  transform = glmex::translate(transform, rend_sz.Width / 2.0f, rend_sz.Height / 2.0f);
+
+  // Global batch transform
+  transform = transform * matGlobal;
+  // Self sprite transform (first scale, then rotate and then translate, reversed)
+  transform = glmex::transform2d(transform, thisX, thisY, widthToScale, heightToScale, 0.f);
+  return transform;
+}
+
+glm::mat4 OGLGraphicsDriver::GetWalkBehindTransform(const OGLBitmap *bmpToDraw, const OGLTextureTile &tile,
+    int draw_x, int draw_y)
+{
+  float x, y, width, height;
+  GetTileRect(bmpToDraw, tile, draw_x, draw_y, x, y, width, height);
+  // Vertices are in 0..1 range along X and 0..-1 along Y, as Y axis is inverted
+  // in the render space; scale the result into the mask's texture coordinates
+  glm::mat4 transform = glmex::scale(1.f / _wbMaskTexSize.Width, 1.f / _wbMaskTexSize.Height);
+  transform = glmex::transform2d(transform, x, y, width, -height, 0.f);
+  return transform;
+}
+
+bool OGLGraphicsDriver::GetWalkBehindOcclusion(const OGLBitmap *bmpToDraw, float occlusion[2]) const
+{
+  occlusion[0] = occlusion[1] = 0.f;
+  const int baseline = bmpToDraw->GetWalkBehindBaseline();
+  if ((_wbMaskTexture == 0u) || (baseline == kNoWalkBehindBaseline))
+    return false;
+  // The sprite is hidden by the areas with a higher baseline; 0 is "no area"
+  int flags = 0;
+  for (int wb = 1; wb < MaxWalkBehindAreas; ++wb)
+  {
+    if (_wbBaselines[wb] > baseline)
+      flags |= (1 << wb);
+  }
+  occlusion[0] = static_cast<float>(flags & 0xFF);
+  occlusion[1] = static_cast<float>(flags >> 8);
+  return flags != 0;
+}
+
+void OGLGraphicsDriver::GetTextureParams(const OGLBitmap *bmpToDraw, GLint &filter, GLint &clamp)
+{
+  if ((_smoothScaling) && bmpToDraw->GetUseResampler()
+      && (bmpToDraw->GetSizeToRender() != bmpToDraw->GetSize()))
+  {
+    filter = GL_LINEAR;
+    clamp = GL_CLAMP_TO_EDGE;
+  }
+  else
+  {
+    filter = _currentBackbuffer->Filter;
+    clamp = _currentBackbuffer->TxClamp;
+  }
+}
+
+void OGLGraphicsDriver::BindTexture(GLuint texture, GLint filter, GLint clamp)
+{
+  // Consecutive sprites from the same atlas page share the texture,
+  // so only change the texture state when it's different
+  glActiveTexture(GL_TEXTURE0);
+  if ((texture == _boundTexture) && (filter == _boundTexFilter) && (clamp == _boundTexClamp))
+    return;
+  if (texture != _boundTexture)
+    glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp);
+  _boundTexture = texture;
+  _boundTexFilter = filter;
+  _boundTexClamp = clamp;
+}
+
+bool OGLGraphicsDriver::CanBatchTexture(const OGLBitmap *bmpToDraw) const
+{
+  if (_batchShader.Program == 0)
+    return false;
+  // Special blending modes require changing render state
+  if (bmpToDraw->GetRenderHint() != kTxHint_Normal)
+    return false;
+  // Light level is not supported by the batch shader
+  int tint_r, tint_g, tint_b, tint_sat;
+  bmpToDraw->GetTint(tint_r, tint_g, tint_b, tint_sat);
+  return !((tint_sat == 0) && (bmpToDraw->GetLightLevel() > 0) && (_lightShader.Program > 0));
+}
+
+void OGLGraphicsDriver::AddTextureToBatch(const OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    const SpriteColorTransform &color, const Size &rend_sz)
+{
+  const float alpha = ((color.Alpha * bmpToDraw->GetAlpha()) / 255) / 255.0f;
+  // Tint parameters, same as passed to the tinting shader:
+  // hue, saturation, tint amount and luminance; zero amount means no tint
+  float tint[4] = { 0.f, 0.f, 0.f, 0.f };
+  int tint_r, tint_g, tint_b, tint_sat;
+  bmpToDraw->GetTint(tint_r, tint_g, tint_b, tint_sat);
+  if ((tint_sat > 0) && (_tintShader.Program > 0))
+  {
+    float tint_v;
+    rgb_to_hsv(tint_r, tint_g, tint_b, &tint[0], &tint[1], &tint_v);
+    tint[0] /= 360.0; // In HSV, Hue is 0-360
+    tint[2] = (float)tint_sat / 255.0;
+    const int light_lev = bmpToDraw->GetLightLevel();
+    tint[3] = (light_lev > 0) ? (float)light_lev / 255.0 : 1.0f;
+  }
+
+  float wb_occlusion[2];
+  const bool do_walkbehinds = GetWalkBehindOcclusion(bmpToDraw, wb_occlusion);
+
+  GLint tex_filter, tex_clamp;
+  GetTextureParams(bmpToDraw, tex_filter, tex_clamp);
+  const auto *txdata = bmpToDraw->GetTexture();
+  for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
+  {
+    const OGLTextureTile &tile = txdata->_tiles[ti];
+    if ((tile.texture != _batchTexture) || (tex_filter != _batchTexFilter) ||
+        (tex_clamp != _batchTexClamp) || (_batchVertices.size() >= MaxBatchQuads * 4))
+    {
+      FlushTextureBatch();
+      _batchTexture = tile.texture;
+      _batchTexFilter = tex_filter;
+      _batchTexClamp = tex_clamp;
+    }
+
+    // The vertices are transformed here, as each quad has its own transform;
+    // projection is orthographic, so the result's "w" is always 1
+    const glm::mat4 transform = GetTileTransform(bmpToDraw, tile, draw_x, draw_y, projection, matGlobal, rend_sz);
+    const glm::mat4 wb_transform = do_walkbehinds ?
+        GetWalkBehindTransform(bmpToDraw, tile, draw_x, draw_y) : glmex::identity();
+    const OGLCUSTOMVERTEX *vertices = (txdata->_vertex != nullptr) ? &txdata->_vertex[ti * 4] : defaultVertices;
+    for (int i = 0; i < 4; ++i)
+    {
+      const glm::vec4 pos = transform * glm::vec4(vertices[i].position.x, vertices[i].position.y, 0.f, 1.f);
+      OGLBATCHVERTEX vertex;
+      vertex.position.x = pos.x;
+      vertex.position.y = pos.y;
+      vertex.tu = vertices[i].tu;
+      vertex.tv = vertices[i].tv;
+      vertex.alpha = alpha;
+      std::copy(tint, tint + 4, vertex.tint);
+      if (do_walkbehinds)
+      {
+        const glm::vec4 wb_pos = wb_transform * glm::vec4(vertices[i].position.x, vertices[i].position.y, 0.f, 1.f);
+        vertex.walkbehind[0] = wb_pos.x;
+        vertex.walkbehind[1] = wb_pos.y;
+        vertex.walkbehind[2] = wb_occlusion[0];
+        vertex.walkbehind[3] = wb_occlusion[1];
+      }
+      _batchVertices.push_back(vertex);
+    }
+  }
+}
+
+void OGLGraphicsDriver::FlushTextureBatch()
+{
+  if (_batchVertices.empty())
+    return;
+
+  const ShaderProgram &program = _batchShader;
+  glUseProgram(program.Program);
+  glUniform1i(program.TextureId, 0);
+  glUniform1i(program.WBMask, 1);
+  BindTexture(_batchTexture, _batchTexFilter, _batchTexClamp);
+
+  // Upload to the new buffer storage, so that the driver does not have to
+  // wait until the previous draw call using this buffer is finished
+  glBindBuffer(GL_ARRAY_BUFFER, _batchVbo);
+  glBufferData(GL_ARRAY_BUFFER, _batchVertices.size() * sizeof(OGLBATCHVERTEX), _batchVertices.data(), GL_STREAM_DRAW);
+  glEnableVertexAttribArray(program.A_Position);
+  glEnableVertexAttribArray(program.A_TexCoord);
+  glEnableVertexAttribArray(program.A_Alpha);
+  glEnableVertexAttribArray(program.A_Tint);
+  glEnableVertexAttribArray(program.A_WalkBehind);
+  glVertexAttribPointer(program.A_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLBATCHVERTEX),
+      reinterpret_cast<const void*>(offsetof(OGLBATCHVERTEX, position)));
+  glVertexAttribPointer(program.A_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLBATCHVERTEX),
+      reinterpret_cast<const void*>(offsetof(OGLBATCHVERTEX, tu)));
+  glVertexAttribPointer(program.A_Alpha, 1, GL_FLOAT, GL_FALSE, sizeof(OGLBATCHVERTEX),
+      reinterpret_cast<const void*>(offsetof(OGLBATCHVERTEX, alpha)));
+  glVertexAttribPointer(program.A_Tint, 4, GL_FLOAT, GL_FALSE, sizeof(OGLBATCHVERTEX),
+      reinterpret_cast<const void*>(offsetof(OGLBATCHVERTEX, tint)));
+  glVertexAttribPointer(program.A_WalkBehind, 4, GL_FLOAT, GL_FALSE, sizeof(OGLBATCHVERTEX),
+      reinterpret_cast<const void*>(offsetof(OGLBATCHVERTEX, walkbehind)));
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _batchIbo);
+  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_batchVertices.size() / 4 * 6), GL_UNSIGNED_SHORT, nullptr);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Vertex attribute arrays are enabled globally, so restore the ones
+  // which the other shaders expect, as these read the client memory
+  glDisableVertexAttribArray(program.A_Position);
+  glDisableVertexAttribArray(program.A_TexCoord);
+  glDisableVertexAttribArray(program.A_Alpha);
+  glDisableVertexAttribArray(program.A_Tint);
+  glDisableVertexAttribArray(program.A_WalkBehind);
+  for (const ShaderProgram *prg : { &_transparencyShader, &_tintShader, &_lightShader })
+  {
+    if (prg->Program == 0)
+      continue;
+    glEnableVertexAttribArray(prg->A_Position);
+    glEnableVertexAttribArray(prg->A_TexCoord);
+  }
+  glUseProgram(0);
+  _batchVertices.clear();
 }
 
 void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
@@ -1060,82 +1611,27 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
   glUniform1i(program.TextureId, 0);
   glUniform1f(program.Alpha, alpha / 255.0f);
 
-  float width = bmpToDraw->GetWidthToRender();
-  float height = bmpToDraw->GetHeightToRender();
-  float xProportion = width / (float)bmpToDraw->GetWidth();
-  float yProportion = height / (float)bmpToDraw->GetHeight();
+  float wb_occlusion[2];
+  const bool do_walkbehinds = GetWalkBehindOcclusion(bmpToDraw, wb_occlusion);
+  glUniform1i(program.WBMask, 1);
+  glUniform2f(program.WBOcclusion, wb_occlusion[0], wb_occlusion[1]);
 
   const auto *txdata = bmpToDraw->GetTexture();
   for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
   {
-    width = txdata->_tiles[ti].width * xProportion;
-    height = txdata->_tiles[ti].height * yProportion;
-    float xOffs, yOffs;
-    if ((bmpToDraw->GetFlip() & kFlip_Horizontal) != 0)
-      xOffs = (bmpToDraw->GetWidth() - (txdata->_tiles[ti].x + txdata->_tiles[ti].width)) * xProportion;
-    else
-      xOffs = txdata->_tiles[ti].x * xProportion;
-    if ((bmpToDraw->GetFlip() & kFlip_Vertical) != 0)
-      yOffs = (bmpToDraw->GetHeight() - (txdata->_tiles[ti].y + txdata->_tiles[ti].height)) * yProportion;
-    else
-      yOffs = txdata->_tiles[ti].y * yProportion;
-    float thisX = draw_x + xOffs;
-    float thisY = draw_y + yOffs;
-
-    // Setup translation and scaling matrices
-    float widthToScale = width;
-    float heightToScale = height;
-    if ((bmpToDraw->GetFlip() & kFlip_Horizontal) != 0)
-    {
-      // The usual transform changes 0..1 into 0..width
-      // So first negate it (which changes 0..w into -w..0)
-      widthToScale = -widthToScale;
-      // and now shift it over to make it 0..w again
-      thisX += width;
-    }
-    if ((bmpToDraw->GetFlip() & kFlip_Vertical) != 0)
-    {
-      heightToScale = -heightToScale;
-      thisY += height;
-    }
-    // Center inside a rendering rect
-    // FIXME: this should be a part of a projection matrix, afaik
-    thisX = (-(rend_sz.Width / 2.0f)) + thisX;
-    thisY = (rend_sz.Height / 2.0f) - thisY; // inverse axis
-
-    //
-    // IMPORTANT: in OpenGL order of transformation is REVERSE to the order of commands!
-    //
-    glm::mat4 transform = projection;
-    // Origin is at the middle of the surface
-    transform = glmex::translate(transform, rend_sz.Width / 2.0f, rend_sz.Height / 2.0f);
-
-    // Global batch transform
-    transform = transform * matGlobal;
-    // Self sprite transform (first scale, then rotate and then translate, reversed)
-    transform = glmex::transform2d(transform, thisX, thisY, widthToScale, heightToScale, 0.f);
-
+    const glm::mat4 transform = GetTileTransform(bmpToDraw, txdata->_tiles[ti],
+        draw_x, draw_y, projection, matGlobal, rend_sz);
     glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(transform));
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, txdata->_tiles[ti].texture);
-
-    if ((_smoothScaling) && bmpToDraw->GetUseResampler()
-        && (bmpToDraw->GetSizeToRender() != bmpToDraw->GetSize()))
-    {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    }
-    else
+    if (do_walkbehinds)
     {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _currentBackbuffer->Filter);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _currentBackbuffer->Filter);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _currentBackbuffer->TxClamp);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _currentBackbuffer->TxClamp);
+      const glm::mat4 wb_transform = GetWalkBehindTransform(bmpToDraw, txdata->_tiles[ti], draw_x, draw_y);
+      glUniformMatrix4fv(program.WBMatrix, 1, GL_FALSE, glm::value_ptr(wb_transform));
     }
 
+    GLint tex_filter, tex_clamp;
+    GetTextureParams(bmpToDraw, tex_filter, tex_clamp);
+    BindTexture(txdata->_tiles[ti].texture, tex_filter, tex_clamp);
+
     if (txdata->_vertex != nullptr)
     {
         glVertexAttribPointer(program.A_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(txdata->_vertex[ti * 4].position));
@@ -1168,6 +1664,7 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
 void OGLGraphicsDriver::RenderAndPresent(bool clearDrawListAfterwards)
 {
     RenderImpl(clearDrawListAfterwards);
+    FrameStageScope stage_scope(kFrameStage_Present);
     SDL_GL_SwapWindow(_sdlWindow);
 }
 
@@ -1291,6 +1788,7 @@ void OGLGraphicsDriver::RenderSpriteBatches()
     {
         return; // no batches - no render
     }
+    _boundTexture = 0u;
 
     // TODO: following algorithm is repeated for both Direct3D and OpenGL renderer
     // classes. The problem is that some data has different types and contents
@@ -1394,19 +1892,26 @@ size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t
         switch (reinterpret_cast<uintptr_t>(e.ddb))
         {
         case DRAWENTRY_STAGECALLBACK:
-            // raw-draw plugin support
+        {
+            // raw-draw plugin support; plugin may render on its own,
+            // and change the texture state
+            FlushTextureBatch();
             int sx, sy;
-            if (auto *ddb = DoSpriteEvtCallback(e.x, 0, sx, sy))
+            auto *ddb = DoSpriteEvtCallback(e.x, 0, sx, sy);
+            _boundTexture = 0u;
+            if (ddb)
             {
                 auto stageEntry = OGLDrawListEntry((OGLBitmap*)ddb, batch.ID, sx, sy);
                 RenderSprite(&stageEntry, projection, batch.Matrix, batch.Color, surface_size);
             }
             break;
+        }
         default:
             RenderSprite(&e, projection, batch.Matrix, batch.Color, surface_size);
             break;
         }
     }
+    FlushTextureBatch();
     return from;
 }
 
@@ -1540,6 +2045,60 @@ void OGLGraphicsDriver::RedrawLastFrame(uint32_t skip_filter)
     FilterSpriteBatches(skip_filter);
 }
 
+bool OGLGraphicsDriver::SetWalkBehindMask(const Bitmap *mask)
+{
+  DeleteWalkBehindMask();
+  if (!mask)
+    return true;
+
+  assert(mask->GetColorDepth() == 8);
+  int tex_width = mask->GetWidth();
+  int tex_height = mask->GetHeight();
+  AdjustSizeToNearestSupportedByCard(&tex_width, &tex_height);
+  GLint max_size = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+  if ((tex_width > max_size) || (tex_height > max_size))
+  {
+    Debug::Printf(kDbgMsg_Warn, "OGL: walk-behind mask of size %d x %d exceeds max texture size %d",
+      mask->GetWidth(), mask->GetHeight(), max_size);
+    return false;
+  }
+
+  // The texture may be larger than the mask, the rest is filled with "no area"
+  std::vector<uint8_t> pixels(tex_width * tex_height);
+  for (int y = 0; y < mask->GetHeight(); ++y)
+    memcpy(&pixels[y * tex_width], mask->GetScanLine(y), mask->GetWidth());
+
+  // The mask is kept bound to the texture unit 1, other textures use unit 0
+  glActiveTexture(GL_TEXTURE1);
+  glGenTextures(1, &_wbMaskTexture);
+  glBindTexture(GL_TEXTURE_2D, _wbMaskTexture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, tex_width, tex_height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, pixels.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glActiveTexture(GL_TEXTURE0);
+  _wbMaskTexSize = Size(tex_width, tex_height);
+  return true;
+}
+
+void OGLGraphicsDriver::SetWalkBehindBaselines(const int *baselines, size_t count)
+{
+  std::fill(_wbBaselines, _wbBaselines + MaxWalkBehindAreas, 0);
+  std::copy(baselines, baselines + std::min<size_t>(count, MaxWalkBehindAreas), _wbBaselines);
+}
+
+void OGLGraphicsDriver::DeleteWalkBehindMask()
+{
+  if (_wbMaskTexture != 0u)
+    glDeleteTextures(1, &_wbMaskTexture);
+  _wbMaskTexture = 0u;
+  _wbMaskTexSize = Size();
+}
+
 void OGLGraphicsDriver::DrawSprite(int x, int y, IDriverDependantBitmap* ddb)
 {
     assert(_actSpriteBatch != UINT32_MAX);
@@ -1653,7 +2212,8 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *
   }
 
   glBindTexture(GL_TEXTURE_2D, tile->texture);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, tile->texX, tile->texY, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  _boundTexture = 0u;
 
   delete []origPtr;
 }
@@ -1728,7 +2288,6 @@ void OGLGraphicsDriver::AdjustSizeToNearestSupportedByCard(int *width, int *heig
 {
     int allocatedWidth = *width, allocatedHeight = *height;
 
-    // NOTE: we might consider texture atlases in the future, for greater optimization
     if (!_glCapsNonPowerOfTwo)
     {
         int pow2;
@@ -1791,14 +2350,65 @@ std::shared_ptr<Texture> OGLGraphicsDriver::GetTexture(IDriverDependantBitmap *d
     return std::static_pointer_cast<Texture>((reinterpret_cast<OGLBitmap*>(ddb))->GetSharedTexture());
 }
 
+OGLTexture *OGLGraphicsDriver::CreateAtlasTexture(int width, int height, int color_depth)
+{
+  if (!_textureAtlas)
+  {
+    int max_size = AtlasPageSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    _textureAtlas.reset(new OGLTextureAtlas(std::min(max_size, AtlasPageSize)));
+  }
+
+  // Reserve 1 pixel around the image, which is filled by UpdateTextureRegion
+  // to mimic the texture clamping, and separates it from the neighbours
+  OGLTextureTile tile;
+  tile.width = width;
+  tile.height = height;
+  tile.allocWidth = width + 2;
+  tile.allocHeight = height + 2;
+  size_t page;
+  if (!_textureAtlas->Allocate(tile, page))
+    return nullptr;
+
+  auto *txdata = new OGLTexture(GraphicResolution(width, height, color_depth), false);
+  txdata->_atlas = _textureAtlas;
+  txdata->_atlasPage = page;
+  txdata->_tiles = new OGLTextureTile[1];
+  txdata->_tiles[0] = tile;
+  txdata->_numTiles = 1;
+  // Map the vertices to the image's region in the page
+  const float page_width = static_cast<float>(_textureAtlas->GetPageWidth());
+  const float page_height = static_cast<float>(_textureAtlas->GetPageHeight());
+  txdata->_vertex = new OGLCUSTOMVERTEX[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    OGLCUSTOMVERTEX &vertex = txdata->_vertex[i];
+    vertex = defaultVertices[i];
+    vertex.tu = (tile.texX + 1 + (vertex.tu > 0.f ? width : 0)) / page_width;
+    vertex.tv = (tile.texY + 1 + (vertex.tv > 0.f ? height : 0)) / page_height;
+  }
+  return txdata;
+}
+
 Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth, int txflags)
 {
   assert(width > 0);
   assert(height > 0);
+  const bool as_render_target = (txflags & kTxFlags_RenderTarget) != 0;
+  // Texture creation changes the bound texture
+  _boundTexture = 0u;
+
+  // Small textures are packed into the shared atlas pages
+  if (!as_render_target && (width <= AtlasMaxTextureSize) && (height <= AtlasMaxTextureSize))
+  {
+    OGLTexture *txdata = CreateAtlasTexture(width, height, color_depth);
+    if (txdata)
+      return txdata;
+  }
+
   int allocatedWidth = width;
   int allocatedHeight = height;
   AdjustSizeToNearestSupportedByCard(&allocatedWidth, &allocatedHeight);
-  const bool as_render_target = (txflags & kTxFlags_RenderTarget) != 0;
 
   // Calculate how many textures will be necessary to
   // store this image
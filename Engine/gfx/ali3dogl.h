@@ -27,6 +27,7 @@
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
+#include "gfx/textureatlas.h"
 #include "util/string.h"
 #include "util/version.h"
 
@@ -57,9 +58,47 @@ struct OGLCUSTOMVERTEX
     float tv = 0.f;
 };
 
+// Number of the walk-behind areas which may be tested by the shaders
+const int MaxWalkBehindAreas = 16;
+
+// Vertex of a batch of sprites, rendered in one draw call
+struct OGLBATCHVERTEX
+{
+    OGLVECTOR2D position; // already transformed
+    float tu = 0.f;
+    float tv = 0.f;
+    float alpha = 1.f;
+    float tint[4] = {}; // hue, saturation, amount, luminance
+    float walkbehind[4] = {}; // position in walk-behind mask, and occlusion flags
+};
+
 struct OGLTextureTile : public TextureTile
 {
     unsigned int texture = 0;
+    // Position of the tile's data in the texture, non-zero if in atlas
+    int texX = 0;
+    int texY = 0;
+};
+
+// Shared textures, where the small textures are packed together;
+// lets to draw many sprites without switching textures
+class OGLTextureAtlas
+{
+public:
+    OGLTextureAtlas(int page_size);
+    ~OGLTextureAtlas();
+
+    int GetPageWidth() const { return _atlas.GetPageWidth(); }
+    int GetPageHeight() const { return _atlas.GetPageHeight(); }
+    // Allocates the tile's region of its allocated size, creating a new page
+    // texture if necessary; assigns the tile's texture and position.
+    bool Allocate(OGLTextureTile &tile, size_t &page);
+    // Frees the tile's region; deletes the page if it's no longer used
+    void Free(const OGLTextureTile &tile, size_t page);
+
+private:
+    TextureAtlas _atlas;
+    std::vector<unsigned int> _pageTextures;
 };
 
 // Full OpenGL texture data
@@ -68,6 +107,9 @@ struct OGLTexture : Texture
     OGLCUSTOMVERTEX *_vertex = nullptr;
     OGLTextureTile *_tiles = nullptr;
     size_t _numTiles = 0;
+    // Atlas, if the texture is packed into one
+    std::shared_ptr<OGLTextureAtlas> _atlas;
+    size_t _atlasPage = 0u;
 
     OGLTexture(const GraphicResolution &res, bool rt)
         : Texture(res, rt) {}
@@ -240,6 +282,7 @@ public:
     void UseSmoothScaling(bool enabled) override { _smoothScaling = enabled; }
     bool SupportsGammaControl() override;
     void SetGamma(int newGamma) override;
+    bool SupportsWalkBehindMask() override { return true; }
 
     ///////////////////////////////////////////////////////
     // Texture management
@@ -275,6 +318,10 @@ public:
     void SetScreenTint(int red, int green, int blue) override;
     // Redraw last draw lists, optionally filtering specific batches
     void RedrawLastFrame(uint32_t batch_skip_filter) override;
+    // Sets the walk-behind mask, which is tested by the shaders
+    bool SetWalkBehindMask(const Bitmap *mask) override;
+    // Sets the baselines of the walk-behind areas
+    void SetWalkBehindBaselines(const int *baselines, size_t count) override;
 
     ///////////////////////////////////////////////////////
     // Rendering and presenting
@@ -335,6 +382,8 @@ private:
     // Texture management: implementation
     //
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
+    // Creates a texture packed into the atlas; returns null if could not allocate
+    OGLTexture *CreateAtlasTexture(int width, int height, int color_depth);
     void UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *bitmap, bool has_alpha, bool opaque);
 
     ///////////////////////////////////////////////////////
@@ -361,11 +410,21 @@ private:
         GLuint TextureId = 0; // main texture (sprite or render target)
         GLuint Alpha = 0;     // requested global alpha
 
+        // Walk-behind test uniforms, for the built-in shaders
+        GLuint WBMatrix = 0;    // sprite to walk-behind mask transformation
+        GLuint WBMask = 0;      // walk-behind mask texture
+        GLuint WBOcclusion = 0; // walk-behind areas which hide the sprite
+
         // Specialized uniforms for built-in shaders
         GLuint TintHSV = 0;
         GLuint TintAmount = 0;
         GLuint TintLuminance = 0;
         GLuint LightingAmount = 0;
+
+        // Specialized attributes for the batch shader
+        GLuint A_Alpha = 0;
+        GLuint A_Tint = 0;
+        GLuint A_WalkBehind = 0;
     };
 
     // Compiles and links shader program, using provided vertex and fragment shaders
@@ -382,6 +441,10 @@ private:
     bool CreateLightShader(ShaderProgram &prg);
     bool CreateDarkenByAlphaShader(ShaderProgram &prg);
     bool CreateLightenByAlphaShader(ShaderProgram &prg);
+    bool CreateBatchShader(ShaderProgram &prg);
+    // Creates vertex and index buffers for the sprite batches
+    void CreateBatchBuffers();
+    void DeleteBatchBuffers();
 
     ///////////////////////////////////////////////////////
     // Preparing a scene: implementation
@@ -446,6 +509,34 @@ private:
     void RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
                        const glm::mat4 &projection, const glm::mat4 &matGlobal,
                        const SpriteColorTransform &color, const Size &rend_sz);
+    // Calculates the position and size of the texture's tile, drawn at the given position,
+    // in the sprite batch coordinates; the size is negative along the flipped axes
+    void GetTileRect(const OGLBitmap *bmpToDraw, const OGLTextureTile &tile,
+                     int draw_x, int draw_y, float &x, float &y, float &width, float &height);
+    // Calculates the transformation of the texture's tile, drawn at the given position
+    glm::mat4 GetTileTransform(const OGLBitmap *bmpToDraw, const OGLTextureTile &tile,
+                               int draw_x, int draw_y, const glm::mat4 &projection,
+                               const glm::mat4 &matGlobal, const Size &rend_sz);
+    // Calculates the transformation of the texture's tile into the walk-behind mask coordinates
+    glm::mat4 GetWalkBehindTransform(const OGLBitmap *bmpToDraw, const OGLTextureTile &tile,
+                                     int draw_x, int draw_y);
+    // Gets the flags of the walk-behind areas which hide the given sprite, packed
+    // into two numbers: bits of the areas 0-7 and 8-15; returns if there are any
+    bool GetWalkBehindOcclusion(const OGLBitmap *bmpToDraw, float occlusion[2]) const;
+    void DeleteWalkBehindMask();
+    // Chooses texture filtering and clamping for drawing the given texture
+    void GetTextureParams(const OGLBitmap *bmpToDraw, GLint &filter, GLint &clamp);
+    // Binds the texture and sets its parameters, unless they are already set
+    void BindTexture(GLuint texture, GLint filter, GLint clamp);
+    // Tells if the texture may be rendered as a part of a batch
+    bool CanBatchTexture(const OGLBitmap *bmpToDraw) const;
+    // Adds the texture to the current batch; the batch is rendered when
+    // the texture state changes, or when FlushTextureBatch is called
+    void AddTextureToBatch(const OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+                           const glm::mat4 &projection, const glm::mat4 &matGlobal,
+                           const SpriteColorTransform &color, const Size &rend_sz);
+    // Renders the textures collected in the current batch
+    void FlushTextureBatch();
 
     // Sets uniform blend settings, same for both RGB and alpha component
     void SetBlendOpUniform(GLenum blend_op, GLenum src_factor, GLenum dst_factor);
@@ -468,6 +559,7 @@ private:
     ShaderProgram _lightShader;
     ShaderProgram _darkenbyAlphaShader;
     ShaderProgram _lightenByAlphaShader;
+    ShaderProgram _batchShader;
     // Custom shaders
     std::vector<ShaderProgram> _shaders;
     std::unordered_map<String, uint32_t> _shaderLookup;
@@ -479,6 +571,26 @@ private:
     GLint _screenFramebuffer = 0u;
     // Capability flags
     bool _glCapsNonPowerOfTwo = false;
+    // Atlas for small textures
+    std::shared_ptr<OGLTextureAtlas> _textureAtlas;
+    // Currently bound texture and its parameters, lets skip redundant
+    // state changes when rendering sprites from the same atlas page
+    GLuint _boundTexture = 0u;
+    GLint _boundTexFilter = 0;
+    GLint _boundTexClamp = 0;
+    // Batch of textures, which have same texture state
+    // and are rendered in a single draw call
+    std::vector<OGLBATCHVERTEX> _batchVertices;
+    GLuint _batchTexture = 0u;
+    GLint _batchTexFilter = 0;
+    GLint _batchTexClamp = 0;
+    GLuint _batchVbo = 0u; // streaming vertex buffer
+    GLuint _batchIbo = 0u; // index buffer, describing quads
+    // Walk-behind mask, an 8-bit texture with area indexes, which is kept
+    // bound to the texture unit 1; and the baselines of the areas
+    GLuint _wbMaskTexture = 0u;
+    Size _wbMaskTexSize;
+    int _wbBaselines[MaxWalkBehindAreas] = {};
     // These two flags define whether driver can, and should (respectively)
     // render sprites to texture, and then texture to screen, as opposed to
     // rendering to screen directly. This is known as supersampling mode
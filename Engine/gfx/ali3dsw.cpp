@@ -16,6 +16,8 @@
 #include <array>
 #include <stack>
 #include "ac/sys_events.h"
+#include "debug/frametimer.h"
+#include "debug/out.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
@@ -33,9 +35,6 @@ namespace ALSW
 
 using namespace Common;
 
-static uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n);
-
-
 // ----------------------------------------------------------------------------
 // SDLRendererGraphicsDriver
 // ----------------------------------------------------------------------------
@@ -315,6 +314,13 @@ void SDLRendererGraphicsDriver::SetGamma(int newGamma)
   SDL_SetWindowGammaRamp(sys_get_window(), gamma_red, gamma_green, gamma_blue);
 }
 
+void SDLRendererGraphicsDriver::SetRenderThreads(size_t count)
+{
+  _renderThreads.SetThreadCount(count);
+  Debug::Printf("Software renderer: drawing sprites with %u additional thread(s)",
+      static_cast<unsigned>(_renderThreads.GetThreadCount()));
+}
+
 int SDLRendererGraphicsDriver::GetCompatibleBitmapFormat(int color_depth)
 {
   return color_depth;
@@ -564,6 +570,44 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
     ClearDrawLists();
 }
 
+// Draws a regular sprite on the surface
+static void draw_sprite_entry(Bitmap *surface, ALSoftwareBitmap *bitmap, int drawAtX, int drawAtY)
+{
+    const int alpha = bitmap->GetAlpha();
+    const bool has_alpha = bitmap->HasAlpha();
+    const bool is_opaque = bitmap->IsOpaque();
+    const Bitmap *native_bmp = bitmap->GetBitmap();
+
+    if (alpha == 0) {} // fully transparent, do nothing
+    else if (is_opaque && (native_bmp == surface) && (alpha == 255)) {}
+    else if (is_opaque)
+    {
+        surface->Blit(native_bmp, 0, 0, drawAtX, drawAtY, native_bmp->GetWidth(), native_bmp->GetHeight());
+        // TODO: we need to also support non-masked translucent blend, but...
+        // Allegro 4 **does not have such function ready** :( (only masked blends, where it skips magenta pixels);
+        // I am leaving this problem for the future, as coincidentally software mode does not need this atm.
+    }
+    else if (has_alpha)
+    {
+      // simple alpha blend if there's no global transparency
+      const PfnBlender blender32 = (alpha == 255) ? _blender_alpha32 : _trans_alpha_blender32;
+      if (!GfxUtil::DrawSpriteBlender(surface, native_bmp, drawAtX, drawAtY, blender32, alpha))
+      {
+        if (alpha == 255)
+          set_alpha_blender();
+        else
+          set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, alpha);
+        surface->TransBlendBlt(native_bmp, drawAtX, drawAtY);
+      }
+    }
+    else
+    {
+      // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
+      GfxUtil::DrawSpriteWithTransparency(surface, native_bmp, drawAtX, drawAtY,
+          alpha);
+    }
+}
+
 size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Bitmap *surface, int surf_offx, int surf_offy)
 {
   for (; (from < _spriteList.size()) && (_spriteList[from].node == batch.ID); ++from)
@@ -586,41 +630,105 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       surface->LitBlendBlt(surface, 0, 0, 128);
       continue;
     }
+    else if ((_renderThreads.GetThreadCount() > 0u) && CanRenderInBands(sprite, surface))
+    {
+      // Draw all the following sprites which allow this in bands;
+      // plugin callbacks and fx entries break the sequence
+      size_t to = from + 1;
+      for (; (to < _spriteList.size()) && (_spriteList[to].node == batch.ID) &&
+             CanRenderInBands(_spriteList[to], surface); ++to);
+      RenderSpritesInBands(from, to, surface, surf_offx, surf_offy);
+      from = to - 1;
+      continue;
+    }
 
-    ALSoftwareBitmap* bitmap = sprite.ddb;
-    int drawAtX = sprite.x + surf_offx;
-    int drawAtY = sprite.y + surf_offy;
-    const int alpha = bitmap->GetAlpha();
-    const bool has_alpha = bitmap->HasAlpha();
-    const bool is_opaque = bitmap->IsOpaque();
-    const Bitmap *native_bmp = bitmap->GetBitmap();
+    draw_sprite_entry(surface, sprite.ddb, sprite.x + surf_offx, sprite.y + surf_offy);
+  }
+  return from;
+}
 
-    if (alpha == 0) {} // fully transparent, do nothing
-    else if (is_opaque && (native_bmp == surface) && (alpha == 255)) {}
-    else if (is_opaque)
+bool SDLRendererGraphicsDriver::CanRenderInBands(const ALDrawListEntry &sprite, Bitmap *surface) const
+{
+    if ((sprite.ddb == nullptr) || (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT)))
+        return false;
+    // Only 32-bit sprites are drawn without using allegro's global blender
+    // state, which cannot be shared among threads. The sprites made from
+    // the surface itself would be read by one band while written by another.
+    const Bitmap *native_bmp = sprite.ddb->GetBitmap();
+    return (surface->GetColorDepth() == 32) && (native_bmp->GetColorDepth() == 32) &&
+        !native_bmp->IsSameBitmap(surface);
+}
+
+void SDLRendererGraphicsDriver::RenderSpritesInBands(size_t from, size_t to, Bitmap *surface, int surf_offx, int surf_offy)
+{
+    // Bands should not be too low, or splitting would cost more than it saves;
+    // there's few bands per thread, letting the threads share the work evenly
+    // when most sprites are gathered in one part of the surface.
+    const int MinBandHeight = 16;
+    const size_t BandsPerThread = 2;
+
+    const Rect clip = surface->GetClip();
+    const int height = clip.GetHeight();
+    const size_t max_bands = (_renderThreads.GetThreadCount() + 1) * BandsPerThread;
+    const int band_height = std::max(MinBandHeight, static_cast<int>((height + max_bands - 1) / max_bands));
+    const size_t band_count = (clip.IsEmpty() || (height <= band_height)) ? 1 : (height + band_height - 1) / band_height;
+    if (band_count == 1u)
     {
-        surface->Blit(native_bmp, 0, 0, drawAtX, drawAtY, native_bmp->GetWidth(), native_bmp->GetHeight());
-        // TODO: we need to also support non-masked translucent blend, but...
-        // Allegro 4 **does not have such function ready** :( (only masked blends, where it skips magenta pixels);
-        // I am leaving this problem for the future, as coincidentally software mode does not need this atm.
+        for (size_t i = from; i < to; ++i)
+        {
+            const auto &sprite = _spriteList[i];
+            draw_sprite_entry(surface, sprite.ddb, sprite.x + surf_offx, sprite.y + surf_offy);
+        }
+        return;
     }
-    else if (has_alpha)
-    {
-      if (alpha == 255) // no global transparency, simple alpha blend
-        set_alpha_blender();
-      else
-        set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, alpha);
 
-      surface->TransBlendBlt(native_bmp, drawAtX, drawAtY);
+    // Bin the sprites by the bands which they intersect, keeping their order
+    if (_bandSprites.size() < band_count)
+        _bandSprites.resize(band_count);
+    for (size_t b = 0; b < band_count; ++b)
+        _bandSprites[b].clear();
+    for (size_t i = from; i < to; ++i)
+    {
+        const auto &sprite = _spriteList[i];
+        const Bitmap *native_bmp = sprite.ddb->GetBitmap();
+        const int x = sprite.x + surf_offx;
+        const int y = sprite.y + surf_offy;
+        if ((sprite.ddb->GetAlpha() == 0) ||
+            (x > clip.Right) || (x + native_bmp->GetWidth() <= clip.Left))
+            continue;
+        const int top = std::max(y, clip.Top) - clip.Top;
+        const int bottom = std::min(y + native_bmp->GetHeight() - 1, clip.Bottom) - clip.Top;
+        for (int b = top / band_height; (top <= bottom) && (b <= bottom / band_height); ++b)
+            _bandSprites[b].push_back(i);
     }
-    else
+
+    // Each band is drawn on its own subbitmap, which clips the sprites to the
+    // band's rows; since every pixel is blended by the same sprites in the same
+    // order, the result is identical to drawing the whole sprites one by one.
+    // NOTE: subbitmaps are created on this thread, as allegro assigns them ids.
+    std::vector<std::unique_ptr<Bitmap>> bands(band_count);
+    for (size_t b = 0; b < band_count; ++b)
     {
-      // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
-      GfxUtil::DrawSpriteWithTransparency(surface, native_bmp, drawAtX, drawAtY,
-          alpha);
+        if (_bandSprites[b].empty())
+            continue;
+        const int band_top = clip.Top + static_cast<int>(b) * band_height;
+        bands[b].reset(BitmapHelper::CreateSubBitmap(surface,
+            RectWH(clip.Left, band_top, clip.GetWidth(), std::min(band_height, clip.Bottom + 1 - band_top))));
     }
-  }
-  return from;
+
+    _renderThreads.Run(band_count, [&](size_t b)
+    {
+        Bitmap *band = bands[b].get();
+        if (!band)
+            return;
+        const int band_top = clip.Top + static_cast<int>(b) * band_height;
+        for (size_t i : _bandSprites[b])
+        {
+            const auto &sprite = _spriteList[i];
+            draw_sprite_entry(band, sprite.ddb,
+                sprite.x + surf_offx - clip.Left, sprite.y + surf_offy - band_top);
+        }
+    });
 }
 
 void SDLRendererGraphicsDriver::BlitToTexture()
@@ -674,6 +782,7 @@ void SDLRendererGraphicsDriver::Present(int xoff, int yoff, GraphicFlip flip)
     dst.h = _dstRect.GetHeight();
     SDL_RenderCopyEx(_renderer, _screenTex, nullptr, &dst, 0.0, nullptr, sdl_flip);
 
+    FrameStageScope stage_scope(kFrameStage_Present);
     SDL_RenderPresent(_renderer);
 }
 
@@ -774,28 +883,6 @@ bool SDLRendererGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination, c
   return true;
 }
 
-// add the alpha values together, used for compositing alpha images
-// TODO: why is this here, move to gfx/blender? check if there's already similar function there
-static uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n)
-{
-   uint32_t res, g;
-
-   n = (n * geta32(x)) / 256;
-
-   if (n)
-      n++;
-
-   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
-   y &= 0xFF00;
-   x &= 0xFF00;
-   g = (x - y) * n / 256 + y;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
-
-   return res | g;
-}
-
 bool SDLRendererGraphicsDriver::SetVsyncImpl(bool enabled, bool &vsync_res)
 {
 #if SDL_VERSION_ATLEAST(2, 0, 18)
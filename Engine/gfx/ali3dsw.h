@@ -30,6 +30,7 @@
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
+#include "util/threadpool.h"
 
 namespace AGS
 {
@@ -157,6 +158,12 @@ public:
     // Gets graphic driver's "friendly name"
     const char *GetDriverName() override { return "SDL 2D Software renderer"; }
 
+    ///////////////////////////////////////////////////////
+    // Miscelaneous setup
+    //
+    // Sets the number of additional threads which draw sprites in bands
+    void SetRenderThreads(size_t count) override;
+
     ///////////////////////////////////////////////////////
     // Attributes
     //
@@ -316,6 +323,11 @@ private:
     //
     // Renders single sprite batch on the precreated surface
     size_t RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Tells if the sprite list entry may be drawn in bands, concurrently with the others
+    bool CanRenderInBands(const ALDrawListEntry &sprite, Common::Bitmap *surface) const;
+    // Renders a range of sprites, splitting the surface into horizontal bands,
+    // and drawing the sprites of each band on the render threads
+    void RenderSpritesInBands(size_t from, size_t to, Common::Bitmap *surface, int surf_offx, int surf_offy);
     // Copy raw screen bitmap pixels to the SDL texture
     void BlitToTexture();
     // Render SDL texture on screen
@@ -355,6 +367,11 @@ private:
     ALSpriteBatches _spriteBatches;
     // List of sprites to render
     std::vector<ALDrawListEntry> _spriteList;
+
+    // Threads which draw sprites in bands
+    Common::ThreadPool _renderThreads;
+    // Sprite list indexes binned per band, reused between the frames
+    std::vector<std::vector<size_t>> _bandSprites;
 };
 
 
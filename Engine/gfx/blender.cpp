@@ -12,8 +12,17 @@
 //
 //=============================================================================
 #include "gfx/blender.h"
+#include <algorithm>
 #include <allegro.h>
 #include "core/types.h"
+#include "debug/out.h"
+#include "gfx/blender_simd.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+using namespace AGS::Common;
 
 extern "C" {
     // Fallback routine for when we don't have anything better to do.
@@ -285,9 +294,153 @@ void set_opaque_alpha_blender()
     set_blender_mode(nullptr, nullptr, _opaque_alpha_blender, 0, 0, 0, 0);
 }
 
+// add the alpha values together, used for compositing alpha images
+uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n)
+{
+   uint32_t res, g;
+
+   n = (n * geta32(x)) / 256;
+
+   if (n)
+      n++;
+
+   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+   y &= 0xFF00;
+   x &= 0xFF00;
+   g = (x - y) * n / 256 + y;
+
+   res &= 0xFF00FF;
+   g &= 0xFF00;
+
+   return res | g;
+}
+
 void set_argb2any_blender()
 {
     set_blender_mode_ex(_blender_black, _blender_black, _blender_black, _argb2argb_blender,
         _blender_alpha15, skiptranspixels_blender_alpha16, _blender_alpha24,
         0, 0, 0, 0xff); // TODO: do we need to support proper 15- and 24-bit here?
 }
+
+
+// Span blender which calls the pixel blender, used when there's no SIMD support
+template <PfnBlender Blender>
+static void blend_span_scalar(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (src[i] != MASK_COLOR_32)
+            dst[i] = Blender(src[i], dst[i], n);
+    }
+}
+
+static const SpanBlenderSet ScalarSpanBlenders = {
+    blend_span_scalar<_argb2argb_blender>, blend_span_scalar<_argb2rgb_blender>,
+    blend_span_scalar<_rgb2argb_blender>, blend_span_scalar<_opaque_alpha_blender>,
+    blend_span_scalar<_additive_alpha_copysrc_blender>, blend_span_scalar<_blender_alpha32>,
+    blend_span_scalar<_blender_trans24>, blend_span_scalar<_myblender_alpha_trans24>,
+    blend_span_scalar<_trans_alpha_blender32>
+};
+
+const SpanBlenderSet *get_span_blenders_scalar()
+{
+    return &ScalarSpanBlenders;
+}
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#if defined(_MSC_VER)
+bool cpu_has_sse2()
+{
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+}
+
+bool cpu_has_avx2()
+{
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    // AVX registers must also be enabled by the OS
+    __cpuid(info, 1);
+    if (((info[2] & (1 << 27)) == 0) || ((info[2] & (1 << 28)) == 0) ||
+        ((_xgetbv(0) & 0x6) != 0x6))
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+#else
+bool cpu_has_sse2() { return __builtin_cpu_supports("sse2") != 0; }
+bool cpu_has_avx2() { return __builtin_cpu_supports("avx2") != 0; }
+#endif
+#else
+bool cpu_has_sse2() { return false; }
+bool cpu_has_avx2() { return false; }
+#endif
+
+// Selects the best span blenders supported by both the build and the CPU
+static const SpanBlenderSet *select_span_blenders()
+{
+    const SpanBlenderSet *set = nullptr;
+    const char *name = nullptr;
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    if (cpu_has_avx2() && (set = get_span_blenders_avx2()))
+        name = "AVX2";
+    else if (cpu_has_sse2() && (set = get_span_blenders_sse2()))
+        name = "SSE2";
+#else
+    if ((set = get_span_blenders_neon()))
+        name = "NEON";
+#endif
+    if (!set)
+    {
+        set = &ScalarSpanBlenders;
+        name = "none";
+    }
+    Debug::Printf(kDbgMsg_Info, "Software blenders SIMD support: %s", name);
+    return set;
+}
+
+PfnSpanBlender get_span_blender(PfnBlender blender)
+{
+    static const SpanBlenderSet *set = select_span_blenders();
+    if (blender == _argb2argb_blender)
+        return set->Argb2Argb;
+    if (blender == _argb2rgb_blender)
+        return set->Argb2Rgb;
+    if (blender == _rgb2argb_blender)
+        return set->Rgb2Argb;
+    if (blender == _opaque_alpha_blender)
+        return set->OpaqueAlpha;
+    if (blender == _additive_alpha_copysrc_blender)
+        return set->AdditiveAlpha;
+    if (blender == _blender_alpha32)
+        return set->Alpha;
+    if (blender == _blender_trans24)
+        return set->Trans;
+    if (blender == _myblender_alpha_trans24)
+        return set->AlphaTrans;
+    if (blender == _trans_alpha_blender32)
+        return set->TransAlpha;
+    return nullptr;
+}
+
+void make_tint_table32(uint32_t table[256], PfnBlender blender, uint32_t color, uint32_t n)
+{
+    // a grey pixel has the value of its components, and no alpha
+    for (int v = 0; v < 256; ++v)
+        table[v] = blender(color, makeacol32(v, v, v, 0), n);
+}
+
+void tint_span32(const uint32_t table[256], const uint32_t *src, uint32_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c == MASK_COLOR_32)
+            continue;
+        const int v = std::max(std::max(getr32(c), getg32(c)), getb32(c));
+        dst[i] = table[v] | (c & 0xFF000000);
+    }
+}
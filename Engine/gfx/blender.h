@@ -31,6 +31,11 @@
 /* Declared in Allegro's color.h:
 void set_alpha_blender();
 */
+// Allegro's 32-bit blenders, set by set_alpha_blender and set_trans_blender
+extern "C" {
+    uint32_t _blender_alpha32(uint32_t x, uint32_t y, uint32_t n);
+    uint32_t _blender_trans24(uint32_t x, uint32_t y, uint32_t n);
+}
 
 uint32_t _myblender_color15(uint32_t x, uint32_t y, uint32_t n);
 uint32_t _myblender_color16(uint32_t x, uint32_t y, uint32_t n);
@@ -41,6 +46,8 @@ uint32_t _myblender_color32_light(uint32_t x, uint32_t y, uint32_t n);
 // Customizable alpha blender that uses the supplied alpha value as src alpha,
 // and preserves destination's alpha channel (if there was one);
 void set_my_trans_blender(int r, int g, int b, int a);
+// The 32-bit blender set by set_my_trans_blender
+uint32_t _myblender_alpha_trans24(uint32_t x, uint32_t y, uint32_t n);
 // Argb2argb alpha blender combines RGBs proportionally to src alpha, but also
 // applies dst alpha factor to the dst RGB used in the merge;
 // The final alpha is calculated by multiplying two translucences (1 - .alpha).
@@ -54,6 +61,11 @@ uint32_t _argb2rgb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alph
 uint32_t _rgb2argb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
 // Sets the alpha channel to opaque. Used when drawing a non-alpha sprite onto an alpha-sprite.
 uint32_t _opaque_alpha_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
+// Plain copies src over, applying a summ of src and dst alpha values.
+uint32_t _additive_alpha_copysrc_blender(uint32_t x, uint32_t y, uint32_t n);
+// Alpha blender which combines RGBs proportionally to src alpha multiplied
+// by the supplied overall alpha; the final alpha is zero.
+uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n);
 
 // Additive alpha blender plain copies src over, applying a summ of src and
 // dst alpha values.
@@ -63,4 +75,28 @@ void set_opaque_alpha_blender();
 // Sets argb2argb for 32-bit mode, and provides appropriate funcs for blending 32-bit onto 15/16/24-bit destination
 void set_argb2any_blender();
 
+
+//
+// Span blenders process a whole row of 32-bit pixels at once, using the SIMD
+// instructions where available. They give exactly the same results as the
+// draw_trans_sprite with a respective 32-bit pixel blender: every src pixel
+// which is not MASK_COLOR_32 is combined with dst pixel as blender(src, dst, n).
+//
+typedef uint32_t (*PfnBlender)(uint32_t x, uint32_t y, uint32_t n);
+typedef void (*PfnSpanBlender)(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n);
+// Returns the span version of the given 32-bit pixel blender, or null if
+// there's none. The implementation is chosen according to the CPU features.
+// Supported are the 32-bit blenders declared in this header, except for
+// the tint blenders (see below).
+PfnSpanBlender get_span_blender(PfnBlender blender);
+
+// Tint blenders (_myblender_color32 and _myblender_color32_light) use hue and
+// saturation of the tint color and the value of the image pixel, which only
+// depends on its brightest component. This fills the table of blender's
+// results for each possible value, letting tint whole spans by a lookup.
+void make_tint_table32(uint32_t table[256], PfnBlender blender, uint32_t color, uint32_t n);
+// Tints a row of 32-bit pixels using the prepared table; same as draw_lit_sprite,
+// src pixels which are MASK_COLOR_32 are skipped.
+void tint_span32(const uint32_t table[256], const uint32_t *src, uint32_t *dst, size_t count);
+
 #endif // __AC_BLENDER_H
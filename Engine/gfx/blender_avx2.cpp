@@ -0,0 +1,69 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// AVX2 span blenders. GCC and Clang require this unit to be built with
+// -mavx2, otherwise it's left empty; MSVC allows to use the intrinsics
+// without changing the target architecture.
+//
+//=============================================================================
+#include "gfx/blender_simd.h"
+
+#if defined(__AVX2__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+
+#include <immintrin.h>
+
+namespace
+{
+
+struct OpsAVX2
+{
+    typedef __m256i V;
+    static const size_t Width = 8;
+
+    static V Load(const uint32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void Store(uint32_t *p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V Set(uint32_t c) { return _mm256_set1_epi32(static_cast<int>(c)); }
+    static V And(V a, V b) { return _mm256_and_si256(a, b); }
+    static V AndNot(V a, V b) { return _mm256_andnot_si256(b, a); }
+    static V Or(V a, V b) { return _mm256_or_si256(a, b); }
+    static V Add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static V Sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+    static V Mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+    static V Shr8(V a) { return _mm256_srli_epi32(a, 8); }
+    static V Shr24(V a) { return _mm256_srli_epi32(a, 24); }
+    static V Shl24(V a) { return _mm256_slli_epi32(a, 24); }
+    static V CmpEq(V a, V b) { return _mm256_cmpeq_epi32(a, b); }
+    static V CmpGt(V a, V b) { return _mm256_cmpgt_epi32(a, b); }
+    static V Select(V m, V a, V b) { return _mm256_blendv_epi8(b, a, m); }
+    static V Div65536(V d)
+    {
+        return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_set1_ps(65536.f), _mm256_cvtepi32_ps(d)));
+    }
+};
+
+} // namespace
+
+const SpanBlenderSet *get_span_blenders_avx2()
+{
+    return SpanBlend::GetSpanBlenders<OpsAVX2>();
+}
+
+#else
+
+const SpanBlenderSet *get_span_blenders_avx2()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,69 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// NEON span blenders. Only built for the 64-bit ARM, where NEON is always
+// present; 32-bit ARM lacks the vector float division, which is required to
+// match the pixel blenders exactly.
+//
+//=============================================================================
+#include "gfx/blender_simd.h"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+
+namespace
+{
+
+struct OpsNEON
+{
+    typedef uint32x4_t V;
+    static const size_t Width = 4;
+
+    static V Load(const uint32_t *p) { return vld1q_u32(p); }
+    static void Store(uint32_t *p, V v) { vst1q_u32(p, v); }
+    static V Set(uint32_t c) { return vdupq_n_u32(c); }
+    static V And(V a, V b) { return vandq_u32(a, b); }
+    static V AndNot(V a, V b) { return vbicq_u32(a, b); }
+    static V Or(V a, V b) { return vorrq_u32(a, b); }
+    static V Add(V a, V b) { return vaddq_u32(a, b); }
+    static V Sub(V a, V b) { return vsubq_u32(a, b); }
+    static V Mul(V a, V b) { return vmulq_u32(a, b); }
+    static V Shr8(V a) { return vshrq_n_u32(a, 8); }
+    static V Shr24(V a) { return vshrq_n_u32(a, 24); }
+    static V Shl24(V a) { return vshlq_n_u32(a, 24); }
+    static V CmpEq(V a, V b) { return vceqq_u32(a, b); }
+    static V CmpGt(V a, V b) { return vcgtq_u32(a, b); }
+    static V Select(V m, V a, V b) { return vbslq_u32(m, a, b); }
+    static V Div65536(V d)
+    {
+        return vcvtq_u32_f32(vdivq_f32(vdupq_n_f32(65536.f), vcvtq_f32_u32(d)));
+    }
+};
+
+} // namespace
+
+const SpanBlenderSet *get_span_blenders_neon()
+{
+    return SpanBlend::GetSpanBlenders<OpsNEON>();
+}
+
+#else
+
+const SpanBlenderSet *get_span_blenders_neon()
+{
+    return nullptr;
+}
+
+#endif
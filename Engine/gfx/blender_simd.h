@@ -0,0 +1,356 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SIMD implementation of the span blenders, shared by all instruction sets.
+//
+// Span blenders are written as templates, parameterized by the "Ops" struct,
+// which wraps the vector type and operations of a particular instruction set.
+// Every instruction set is compiled in its own unit, with the respective
+// compiler options, and is only called if supported by the CPU. For this
+// reason the units must not include any headers which contain inline
+// functions (such as allegro.h), and Ops must be declared in an unnamed
+// namespace: this way no code built for the extended instruction set may be
+// shared with the rest of the program.
+//
+// The vector code repeats the pixel blenders from blender.cpp exactly,
+// operation by operation, on the 32-bit unsigned lanes, including the integer
+// overflows; therefore it gives exactly the same results. The only exception
+// is division, which is done in floats: 0x10000 / d is exact in single
+// precision for all d in [1, 256], which is the only case used here.
+//
+// Ops must provide:
+//   V                   - vector type, containing Width 32-bit pixels;
+//   Load, Store         - unaligned memory access;
+//   Set                 - fills all lanes with the value;
+//   And, AndNot, Or, Add, Sub, Mul - lane-wise ops, AndNot is (a & ~b),
+//                         Mul keeps the low 32 bits of the product;
+//   Shr8, Shr24, Shl24  - logical shifts by the respective number of bits;
+//   CmpEq, CmpGt        - set all the lane's bits if true; CmpGt may be
+//                         signed, only used for the values < 0x80000000;
+//   Select(m, a, b)     - picks a where m is set, b otherwise;
+//   Div65536            - 0x10000 / d, for d in [1, 256].
+//
+//=============================================================================
+#ifndef __AC_BLENDER_SIMD_H
+#define __AC_BLENDER_SIMD_H
+
+#include "gfx/blender.h"
+
+// A set of span blenders implemented by a particular instruction set
+struct SpanBlenderSet
+{
+    PfnSpanBlender Argb2Argb;
+    PfnSpanBlender Argb2Rgb;
+    PfnSpanBlender Rgb2Argb;
+    PfnSpanBlender OpaqueAlpha;
+    PfnSpanBlender AdditiveAlpha;
+    PfnSpanBlender Alpha;
+    PfnSpanBlender Trans;
+    PfnSpanBlender AlphaTrans;
+    PfnSpanBlender TransAlpha;
+};
+
+// Each of these returns null if the instruction set is not available
+// on the target platform, or was not enabled when building the program
+const SpanBlenderSet *get_span_blenders_sse2();
+const SpanBlenderSet *get_span_blenders_avx2();
+const SpanBlenderSet *get_span_blenders_neon();
+// Span blenders which call the pixel blenders, used when there's no SIMD support
+const SpanBlenderSet *get_span_blenders_scalar();
+// Tell if the CPU supports the instruction set; always false on the
+// platforms which do not have one
+bool cpu_has_sse2();
+bool cpu_has_avx2();
+
+namespace SpanBlend
+{
+
+// Same as allegro's MASK_COLOR_32
+const uint32_t MaskColor32 = 0x00FF00FF;
+
+// Blends pixels which could not fill a whole vector, using the pixel blender;
+// NOTE: depends on Ops only to keep the instances separate for each unit
+template <class Ops, uint32_t (*Blender)(uint32_t, uint32_t, uint32_t)>
+inline void BlendTail(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (src[i] != MaskColor32)
+            dst[i] = Blender(src[i], dst[i], n);
+    }
+}
+
+// n ? (n + 1) : 0
+template <class Ops>
+inline typename Ops::V IncNonZero(typename Ops::V n)
+{
+    return Ops::Add(n, Ops::AndNot(Ops::Set(1), Ops::CmpEq(n, Ops::Set(0))));
+}
+
+// Blends rgb proportionally to n, the core of _blender_trans24;
+// alpha is zero in the result
+template <class Ops>
+inline typename Ops::V BlendRgb(typename Ops::V x, typename Ops::V y, typename Ops::V n)
+{
+    typedef typename Ops::V V;
+    const V rb_mask = Ops::Set(0xFF00FF), g_mask = Ops::Set(0xFF00);
+    V res = Ops::Add(Ops::Shr8(Ops::Mul(Ops::Sub(Ops::And(x, rb_mask), Ops::And(y, rb_mask)), n)), y);
+    y = Ops::And(y, g_mask);
+    x = Ops::And(x, g_mask);
+    V g = Ops::Add(Ops::Shr8(Ops::Mul(Ops::Sub(x, y), n)), y);
+    return Ops::Or(Ops::And(res, rb_mask), Ops::And(g, g_mask));
+}
+
+// Same as argb2argb_blend_core
+template <class Ops>
+inline typename Ops::V BlendArgb2Argb(typename Ops::V src_col, typename Ops::V dst_col, typename Ops::V src_alpha)
+{
+    typedef typename Ops::V V;
+    const V rb_mask = Ops::Set(0xFF00FF), g_mask = Ops::Set(0xFF00), v256 = Ops::Set(256);
+    src_alpha = Ops::Add(src_alpha, Ops::Set(1));
+    V dst_alpha = IncNonZero<Ops>(Ops::Shr24(dst_col));
+
+    V dst_g = Ops::Shr8(Ops::Mul(Ops::And(dst_col, g_mask), dst_alpha));
+    dst_col = Ops::Shr8(Ops::Mul(Ops::And(dst_col, rb_mask), dst_alpha));
+
+    dst_g   = Ops::And(Ops::Add(Ops::Shr8(Ops::Mul(
+        Ops::Sub(Ops::And(src_col, g_mask), Ops::And(dst_g, g_mask)), src_alpha)), dst_g), g_mask);
+    dst_col = Ops::And(Ops::Add(Ops::Shr8(Ops::Mul(
+        Ops::Sub(Ops::And(src_col, rb_mask), Ops::And(dst_col, rb_mask)), src_alpha)), dst_col), rb_mask);
+
+    dst_alpha = Ops::Sub(v256, Ops::Shr8(Ops::Mul(Ops::Sub(v256, src_alpha), Ops::Sub(v256, dst_alpha))));
+    src_alpha = Ops::Div65536(dst_alpha);
+
+    dst_g   = Ops::And(Ops::Shr8(Ops::Mul(dst_g, src_alpha)), g_mask);
+    dst_col = Ops::And(Ops::Shr8(Ops::Mul(dst_col, src_alpha)), rb_mask);
+    return Ops::Or(Ops::Or(dst_col, dst_g), Ops::Shl24(Ops::Sub(dst_alpha, Ops::Set(1))));
+}
+
+// Loops over the span, applying Blend to the whole vectors, and the pixel
+// blender to the rest; keeps dst where src has mask color.
+// Blend is a functor, taking (src, dst) vectors and returning the result.
+template <class Ops, uint32_t (*Blender)(uint32_t, uint32_t, uint32_t), class Blend>
+inline void BlendSpan(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n, const Blend &blend)
+{
+    typedef typename Ops::V V;
+    const V mask = Ops::Set(MaskColor32);
+    size_t i = 0;
+    for (; i + Ops::Width <= count; i += Ops::Width)
+    {
+        const V s = Ops::Load(src + i);
+        const V d = Ops::Load(dst + i);
+        Ops::Store(dst + i, Ops::Select(Ops::CmpEq(s, mask), d, blend(s, d)));
+    }
+    BlendTail<Ops, Blender>(src + i, dst + i, count - i, n);
+}
+
+template <class Ops>
+struct Argb2ArgbOp
+{
+    typedef typename Ops::V V;
+    uint32_t Factor; // overall alpha + 1, or 0 if not used
+    V operator()(V s, V d) const
+    {
+        V src_alpha = Ops::Shr24(s);
+        if (Factor > 0)
+            src_alpha = Ops::Shr8(Ops::Mul(src_alpha, Ops::Set(Factor)));
+        const V res = BlendArgb2Argb<Ops>(s, d, src_alpha);
+        return Ops::Select(Ops::CmpEq(src_alpha, Ops::Set(0)), d, res);
+    }
+};
+
+template <class Ops>
+void Argb2Argb(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    Argb2ArgbOp<Ops> op;
+    op.Factor = (n > 0) ? ((n & 0xFF) + 1) : 0;
+    BlendSpan<Ops, _argb2argb_blender>(src, dst, count, n, op);
+}
+
+template <class Ops>
+struct Argb2RgbOp
+{
+    typedef typename Ops::V V;
+    uint32_t Factor; // overall alpha + 1, or 0 if not used
+    V operator()(V s, V d) const
+    {
+        V src_alpha = Ops::Shr24(s);
+        if (Factor > 0)
+            src_alpha = Ops::Shr8(Ops::Mul(src_alpha, Ops::Set(Factor)));
+        return BlendRgb<Ops>(s, d, IncNonZero<Ops>(src_alpha));
+    }
+};
+
+template <class Ops>
+void Argb2Rgb(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    Argb2RgbOp<Ops> op;
+    op.Factor = (n > 0) ? ((n & 0xFF) + 1) : 0;
+    BlendSpan<Ops, _argb2rgb_blender>(src, dst, count, n, op);
+}
+
+template <class Ops>
+struct OpaqueAlphaOp
+{
+    typedef typename Ops::V V;
+    V operator()(V s, V) const
+    {
+        return Ops::Or(s, Ops::Set(0xFF000000));
+    }
+};
+
+template <class Ops>
+struct Rgb2ArgbOp
+{
+    typedef typename Ops::V V;
+    uint32_t Alpha;
+    V operator()(V s, V d) const
+    {
+        return BlendArgb2Argb<Ops>(Ops::Or(s, Ops::Set(0xFF000000)), d, Ops::Set(Alpha));
+    }
+};
+
+template <class Ops>
+void Rgb2Argb(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    if (n == 0 || n == 0xFF)
+    {
+        BlendSpan<Ops, _rgb2argb_blender>(src, dst, count, n, OpaqueAlphaOp<Ops>());
+    }
+    else if (n < 0xFF)
+    {
+        Rgb2ArgbOp<Ops> op;
+        op.Alpha = n;
+        BlendSpan<Ops, _rgb2argb_blender>(src, dst, count, n, op);
+    }
+    else
+    {
+        BlendTail<Ops, _rgb2argb_blender>(src, dst, count, n);
+    }
+}
+
+template <class Ops>
+void OpaqueAlpha(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    BlendSpan<Ops, _opaque_alpha_blender>(src, dst, count, n, OpaqueAlphaOp<Ops>());
+}
+
+template <class Ops>
+struct AdditiveAlphaOp
+{
+    typedef typename Ops::V V;
+    V operator()(V s, V d) const
+    {
+        const V max_alpha = Ops::Set(0xFF);
+        V alpha = Ops::Add(Ops::Shr24(s), Ops::Shr24(d));
+        alpha = Ops::Select(Ops::CmpGt(alpha, max_alpha), max_alpha, alpha);
+        return Ops::Or(Ops::Shl24(alpha), Ops::And(s, Ops::Set(0x00FFFFFF)));
+    }
+};
+
+template <class Ops>
+void AdditiveAlpha(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    BlendSpan<Ops, _additive_alpha_copysrc_blender>(src, dst, count, n, AdditiveAlphaOp<Ops>());
+}
+
+template <class Ops>
+struct AlphaOp
+{
+    typedef typename Ops::V V;
+    V operator()(V s, V d) const
+    {
+        return BlendRgb<Ops>(s, d, IncNonZero<Ops>(Ops::Shr24(s)));
+    }
+};
+
+template <class Ops>
+void Alpha(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    BlendSpan<Ops, _blender_alpha32>(src, dst, count, n, AlphaOp<Ops>());
+}
+
+template <class Ops>
+struct TransOp
+{
+    typedef typename Ops::V V;
+    uint32_t Alpha; // already incremented
+    V operator()(V s, V d) const
+    {
+        return BlendRgb<Ops>(s, d, Ops::Set(Alpha));
+    }
+};
+
+template <class Ops>
+void Trans(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    TransOp<Ops> op;
+    op.Alpha = n ? (n + 1) : 0;
+    BlendSpan<Ops, _blender_trans24>(src, dst, count, n, op);
+}
+
+template <class Ops>
+struct AlphaTransOp
+{
+    typedef typename Ops::V V;
+    uint32_t Alpha; // already incremented
+    V operator()(V s, V d) const
+    {
+        const V alpha_mask = Ops::Set(0xFF000000);
+        return Ops::Or(BlendRgb<Ops>(s, Ops::AndNot(d, alpha_mask), Ops::Set(Alpha)),
+            Ops::And(d, alpha_mask));
+    }
+};
+
+template <class Ops>
+void AlphaTrans(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    AlphaTransOp<Ops> op;
+    op.Alpha = n ? (n + 1) : 0;
+    BlendSpan<Ops, _myblender_alpha_trans24>(src, dst, count, n, op);
+}
+
+template <class Ops>
+struct TransAlphaOp
+{
+    typedef typename Ops::V V;
+    uint32_t Alpha;
+    V operator()(V s, V d) const
+    {
+        const V n = Ops::Shr8(Ops::Mul(Ops::Set(Alpha), Ops::Shr24(s)));
+        return BlendRgb<Ops>(s, d, IncNonZero<Ops>(n));
+    }
+};
+
+template <class Ops>
+void TransAlpha(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    TransAlphaOp<Ops> op;
+    op.Alpha = n;
+    BlendSpan<Ops, _trans_alpha_blender32>(src, dst, count, n, op);
+}
+
+template <class Ops>
+const SpanBlenderSet *GetSpanBlenders()
+{
+    static const SpanBlenderSet set = {
+        Argb2Argb<Ops>, Argb2Rgb<Ops>, Rgb2Argb<Ops>, OpaqueAlpha<Ops>, AdditiveAlpha<Ops>,
+        Alpha<Ops>, Trans<Ops>, AlphaTrans<Ops>, TransAlpha<Ops>
+    };
+    return &set;
+}
+
+} // namespace SpanBlend
+
+#endif // __AC_BLENDER_SIMD_H
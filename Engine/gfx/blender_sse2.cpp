@@ -0,0 +1,75 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SSE2 span blenders. SSE2 is always available on x86-64, but has to be
+// enabled by the compiler options for the 32-bit x86.
+//
+//=============================================================================
+#include "gfx/blender_simd.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+
+#include <emmintrin.h>
+
+namespace
+{
+
+struct OpsSSE2
+{
+    typedef __m128i V;
+    static const size_t Width = 4;
+
+    static V Load(const uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void Store(uint32_t *p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V Set(uint32_t c) { return _mm_set1_epi32(static_cast<int>(c)); }
+    static V And(V a, V b) { return _mm_and_si128(a, b); }
+    static V AndNot(V a, V b) { return _mm_andnot_si128(b, a); }
+    static V Or(V a, V b) { return _mm_or_si128(a, b); }
+    static V Add(V a, V b) { return _mm_add_epi32(a, b); }
+    static V Sub(V a, V b) { return _mm_sub_epi32(a, b); }
+    static V Mul(V a, V b)
+    {
+        // SSE2 only multiplies the even lanes into 64-bit results
+        const V even = _mm_mul_epu32(a, b);
+        const V odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    static V Shr8(V a) { return _mm_srli_epi32(a, 8); }
+    static V Shr24(V a) { return _mm_srli_epi32(a, 24); }
+    static V Shl24(V a) { return _mm_slli_epi32(a, 24); }
+    static V CmpEq(V a, V b) { return _mm_cmpeq_epi32(a, b); }
+    static V CmpGt(V a, V b) { return _mm_cmpgt_epi32(a, b); }
+    static V Select(V m, V a, V b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    static V Div65536(V d)
+    {
+        return _mm_cvttps_epi32(_mm_div_ps(_mm_set1_ps(65536.f), _mm_cvtepi32_ps(d)));
+    }
+};
+
+} // namespace
+
+const SpanBlenderSet *get_span_blenders_sse2()
+{
+    return SpanBlend::GetSpanBlenders<OpsSSE2>();
+}
+
+#else
+
+const SpanBlenderSet *get_span_blenders_sse2()
+{
+    return nullptr;
+}
+
+#endif
@@ -68,6 +68,9 @@ enum TextureFlags
     kTxFlags_HasAlpha       = 0x0004
 };
 
+// Walk-behind baseline of a sprite which is not hidden by walk-behinds
+const int kNoWalkBehindBaseline = INT32_MIN;
+
 // The "texture sprite" object, contains Texture object ref,
 // which may be either shared or exclusive to this sprite.
 // Lets assign various effects and transformations which will be
@@ -102,6 +105,12 @@ public:
     virtual void SetLightLevel(int light_level) = 0;   // 0-255
     virtual void GetTint(int &red, int &green, int &blue, int &tintSaturation) const = 0; // 0-255
     virtual void SetTint(int red, int green, int blue, int tintSaturation) = 0;  // 0-255
+    // Get the baseline which is compared to the walk-behinds' baselines, when the
+    // renderer hides sprites behind walk-behinds itself (see IGraphicsDriver::SetWalkBehindMask)
+    virtual int  GetWalkBehindBaseline() const = 0;
+    // Set the baseline for hiding this sprite behind walk-behinds;
+    // kNoWalkBehindBaseline means that the sprite is drawn over them
+    virtual void SetWalkBehindBaseline(int baseline) = 0;
 
     // Tells if this DDB has an actual render data assigned to it.
     virtual bool IsValid() const = 0;
@@ -14,6 +14,7 @@
 
 #include "core/platform.h"
 #include "gfx/gfx_util.h"
+#include <algorithm>
 #include "gfx/blender.h"
 
 namespace AGS
@@ -64,24 +65,16 @@ static const BlendModeSetter BlendModeSets[kNumBlendModes] =
     // NOTE: add new modes here
 };
 
-bool SetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
+PfnBlenderCb GetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
 {
     if (blend_mode < 0 || blend_mode >= kNumBlendModes)
-        return false;
+        return nullptr;
     const BlendModeSetter &set = BlendModeSets[blend_mode];
-    PfnBlenderCb blender;
     if (dst_has_alpha)
-        blender = src_has_alpha ? set.AllAlpha :
+        return src_has_alpha ? set.AllAlpha :
             (blend_alpha == 0xFF ? set.OpaqueToAlphaNoTrans : set.OpaqueToAlpha);
     else
-        blender = src_has_alpha ? set.AlphaToOpaque : set.AllOpaque;
-
-    if (blender)
-    {
-        set_blender_mode(nullptr, nullptr, blender, 0, 0, 0, blend_alpha);
-        return true;
-    }
-    return false;
+        return src_has_alpha ? set.AlphaToOpaque : set.AllOpaque;
 }
 
 void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, const Bitmap *sprite,
@@ -90,12 +83,16 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, const Bitmap *sprite,
     if (blend_alpha <= 0)
         return; // do not draw 100% transparent image
 
-    if (// support only 32-bit blending at the moment
-        ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32 &&
-        // set blenders if applicable and tell if succeeded
-        SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
+    // support only 32-bit blending at the moment
+    PfnBlenderCb blender = (ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32) ?
+        GetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha) : nullptr;
+    if (blender)
     {
-        ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        if (!DrawSpriteBlender(ds, sprite, ds_at.X, ds_at.Y, blender, blend_alpha))
+        {
+            set_blender_mode(nullptr, nullptr, blender, 0, 0, 0, blend_alpha);
+            ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        }
     }
     else
     {
@@ -103,6 +100,65 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, const Bitmap *sprite,
     }
 }
 
+// Calculates which part of the sprite is drawn within the destination's
+// clipping rectangle, the same way as the allegro's sprite drawing does;
+// returns false if nothing is to be drawn
+static bool ClipSprite(const Bitmap *ds, const Bitmap *sprite, int x, int y, Rect &src_rc, Point &dst_at)
+{
+    const Rect clip = ds->GetClip();
+    const int sx = std::max(0, clip.Left - x);
+    const int sy = std::max(0, clip.Top - y);
+    const int w = std::min(sprite->GetWidth(), clip.Right + 1 - x) - sx;
+    const int h = std::min(sprite->GetHeight(), clip.Bottom + 1 - y) - sy;
+    if ((w <= 0) || (h <= 0))
+        return false;
+    src_rc = RectWH(sx, sy, w, h);
+    dst_at = Point(x + sx, y + sy);
+    return true;
+}
+
+bool DrawSpriteBlender(Bitmap *ds, const Bitmap *sprite, int x, int y, PfnBlender blender, int blend_param)
+{
+    if ((ds->GetColorDepth() != 32) || (sprite->GetColorDepth() != 32))
+        return false;
+    PfnSpanBlender span_blender = get_span_blender(blender);
+    if (!span_blender)
+        return false;
+
+    Rect src_rc;
+    Point dst_at;
+    if (!ClipSprite(ds, sprite, x, y, src_rc, dst_at))
+        return true;
+    for (int i = 0; i < src_rc.GetHeight(); ++i)
+    {
+        const uint32_t *src = reinterpret_cast<const uint32_t*>(sprite->GetScanLine(src_rc.Top + i)) + src_rc.Left;
+        uint32_t *dst = reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(dst_at.Y + i)) + dst_at.X;
+        span_blender(src, dst, src_rc.GetWidth(), blend_param);
+    }
+    return true;
+}
+
+bool DrawSpriteTinted(Bitmap *ds, const Bitmap *sprite, int x, int y, PfnBlender blender,
+    int red, int green, int blue, int light_amount)
+{
+    if ((ds->GetColorDepth() != 32) || (sprite->GetColorDepth() != 32))
+        return false;
+
+    Rect src_rc;
+    Point dst_at;
+    if (!ClipSprite(ds, sprite, x, y, src_rc, dst_at))
+        return true;
+    uint32_t tint_table[256];
+    make_tint_table32(tint_table, blender, makecol32(red, green, blue), light_amount);
+    for (int i = 0; i < src_rc.GetHeight(); ++i)
+    {
+        const uint32_t *src = reinterpret_cast<const uint32_t*>(sprite->GetScanLine(src_rc.Top + i)) + src_rc.Left;
+        uint32_t *dst = reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(dst_at.Y + i)) + dst_at.X;
+        tint_span32(tint_table, src, dst, src_rc.GetWidth());
+    }
+    return true;
+}
+
 void DrawSpriteWithTransparency(Bitmap *ds, const Bitmap *sprite, int x, int y, int alpha)
 {
     if (alpha <= 0)
@@ -126,8 +182,11 @@ void DrawSpriteWithTransparency(Bitmap *ds, const Bitmap *sprite, int x, int y,
 
     if ((alpha < 0xFF) && (surface_depth > 8) && (sprite_depth > 8))
     {
-        set_trans_blender(0, 0, 0, alpha);
-        ds->TransBlendBlt(sprite, x, y);
+        if (!DrawSpriteBlender(ds, sprite, x, y, _blender_trans24, alpha))
+        {
+            set_trans_blender(0, 0, 0, alpha);
+            ds->TransBlendBlt(sprite, x, y);
+        }
     }
     else
     {
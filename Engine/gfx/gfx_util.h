@@ -25,6 +25,7 @@
 #define __AGS_EE_GFX__GFXUTIL_H
 
 #include "gfx/bitmap.h"
+#include "gfx/blender.h"
 #include "gfx/gfx_def.h"
 
 namespace AGS
@@ -49,6 +50,19 @@ namespace GfxUtil
     void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, const Bitmap *sprite,
         Common::BlendMode blend_mode, bool dst_has_alpha = true, bool src_has_alpha = true, int blend_alpha = 0xFF);
 
+    // Draws a bitmap over another one using the given 32-bit pixel blender,
+    // same as setting this blender and calling Bitmap::TransBlendBlt, but
+    // processes whole rows of pixels at once using the span blenders.
+    // Returns false if the bitmaps are not 32-bit, or the blender has no span
+    // version, in which case the caller should fallback to TransBlendBlt.
+    bool DrawSpriteBlender(Bitmap *ds, const Bitmap *sprite, int x, int y, PfnBlender blender, int blend_param);
+    // Draws a bitmap over another one using the given 32-bit tint blender,
+    // same as setting this blender with the tint color and calling
+    // Bitmap::LitBlendBlt, but using a precalculated table of tint results.
+    // Returns false if the bitmaps are not 32-bit.
+    bool DrawSpriteTinted(Bitmap *ds, const Bitmap *sprite, int x, int y, PfnBlender blender,
+        int red, int green, int blue, int light_amount);
+
     // Draws a bitmap over another one with given alpha level (0 - 255),
     // takes account of the bitmap's mask color,
     // ignores image's alpha channel, even if there's one;
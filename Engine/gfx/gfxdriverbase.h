@@ -139,6 +139,10 @@ public:
     bool        SetVsync(bool enabled) override;
     // Tells if the renderer currently has vsync enabled.
     bool        GetVsync() const override;
+    // Sets the number of threads which may be used for drawing sprites.
+    void        SetRenderThreads(size_t /*count*/) override { /* not supported by default */ }
+    // Tells if the walk-behind mask is supported.
+    bool        SupportsWalkBehindMask() override { return false; }
 
     ///////////////////////////////////////////////////////
     // Preparing a scene
@@ -158,6 +162,10 @@ public:
     void        EndSpriteBatch() override;
     // Clears all sprite batches, resets batch counter
     void        ClearDrawLists() override;
+    // Sets the walk-behind mask; returns false, because it's not supported by default.
+    bool        SetWalkBehindMask(const Bitmap * /*mask*/) override { return false; }
+    // Sets the walk-behind areas' baselines.
+    void        SetWalkBehindBaselines(const int * /*baselines*/, size_t /*count*/) override { /* not supported by default */ }
 
 protected:
     // Special internal values, applied to DrawListEntry
@@ -265,6 +273,8 @@ public:
         _blue = blue;
         _tintSaturation = tintSaturation;
     }
+    int  GetWalkBehindBaseline() const override { return _wbBaseline; }
+    void SetWalkBehindBaseline(int baseline) override { _wbBaseline = baseline; }
 
     int  GetTextureFlags() const { return _txFlags; }
     const Size &GetSize() const { return _size; }
@@ -285,6 +295,7 @@ protected:
     int _red = 0, _green = 0, _blue = 0;
     int _tintSaturation = 0;
     int _lightLevel = 0;
+    int _wbBaseline = kNoWalkBehindBaseline;
 };
 
 
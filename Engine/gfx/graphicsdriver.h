@@ -105,6 +105,9 @@ public:
     // Tells if this gfx driver requires releasing render targets
     // in case of display mode change or reset.
     virtual bool ShouldReleaseRenderTargets() = 0;
+    // Tells if this gfx driver can hide the parts of sprites covered by
+    // walk-behinds by itself, using the walk-behind mask (see SetWalkBehindMask)
+    virtual bool SupportsWalkBehindMask() = 0;
 
     ///////////////////////////////////////////////////////
     // Mode initialization
@@ -156,6 +159,9 @@ public:
     virtual bool SetVsync(bool enabled) = 0;
     // Tells if the renderer currently has vsync enabled.
     virtual bool GetVsync() const = 0;
+    // Sets the number of additional threads which the renderer may use for
+    // drawing sprites; only matters for the renderers that draw in software.
+    virtual void SetRenderThreads(size_t count) = 0;
     // Enables or disables rendering mode that draws sprite list directly into
     // the final resolution, as opposed to drawing to native-resolution buffer
     // and scaling to final frame. The effect may be that sprites that are
@@ -239,6 +245,14 @@ public:
     // Stage screens are used to let plugins do raw drawing during render callbacks.
     // TODO: find a better term? note, it's used in several places around renderers.
     virtual void SetStageScreen(const Size &sz, int x = 0, int y = 0) = 0;
+    // Sets the walk-behind mask: an 8-bit bitmap, where each pixel is an index of
+    // a walk-behind area, and 0 means no area; passing null removes the mask.
+    // The mask is placed at the origin of the sprite batch coordinates. The sprites
+    // which have a walk-behind baseline assigned are hidden where they are covered
+    // by an area with a higher baseline. Returns false if the mask cannot be used.
+    virtual bool SetWalkBehindMask(const Bitmap *mask) = 0;
+    // Sets the baselines of the walk-behind areas, indexed by the area number
+    virtual void SetWalkBehindBaselines(const int *baselines, size_t count) = 0;
     // Redraw last draw lists, optionally filtering specific batches
     virtual void RedrawLastFrame(uint32_t batch_skip_filter = 0u) = 0;
     // Clears all sprite batches, resets batch counter
@@ -0,0 +1,207 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/textureatlas.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+namespace AGS
+{
+namespace Engine
+{
+
+ShelfPacker::ShelfPacker(int width, int height)
+    : _width(width)
+    , _height(height)
+{
+}
+
+int ShelfPacker::FindSpan(const Shelf &shelf, int width)
+{
+    // Use the narrowest span, keep the wider ones for the wider regions
+    int best = -1;
+    for (size_t i = 0; i < shelf.Free.size(); ++i)
+    {
+        if ((shelf.Free[i].Width >= width) &&
+            ((best < 0) || (shelf.Free[i].Width < shelf.Free[best].Width)))
+            best = static_cast<int>(i);
+    }
+    return best;
+}
+
+bool ShelfPacker::Allocate(int width, int height, Rect &rc)
+{
+    if ((width <= 0) || (height <= 0) || (width > _width) || (height > _height))
+        return false;
+
+    const int align_height = std::min(((height + ShelfAlign - 1) / ShelfAlign) * ShelfAlign, _height);
+    // Find the shelf which wastes least height
+    int best = -1, best_span = -1, best_waste = INT_MAX;
+    for (size_t i = 0; i < _shelves.size(); ++i)
+    {
+        const Shelf &shelf = _shelves[i];
+        if (shelf.Height < height)
+            continue;
+        // empty shelves are split to the required height
+        const int waste = (shelf.Used == 0u) ?
+            std::min(shelf.Height, align_height) - height : shelf.Height - height;
+        if (waste >= best_waste)
+            continue;
+        const int span = FindSpan(shelf, width);
+        if (span < 0)
+            continue;
+        best = static_cast<int>(i);
+        best_span = span;
+        best_waste = waste;
+    }
+
+    // Open a new shelf if there's no suitable one, or if the found one is
+    // more than twice as high as needed, and there's space left
+    const int top = _shelves.empty() ? 0 : _shelves.back().Y + _shelves.back().Height;
+    const int new_height = std::min(align_height, _height - top);
+    if (((best < 0) || (best_waste > height)) && (new_height >= height))
+    {
+        _shelves.push_back(Shelf(top, new_height, _width));
+        best = static_cast<int>(_shelves.size() - 1);
+        best_span = 0;
+    }
+    else if (best < 0)
+    {
+        return false;
+    }
+    else if ((_shelves[best].Used == 0u) && (_shelves[best].Height > align_height))
+    {
+        // Split the empty shelf, leaving the rest for other regions
+        const Shelf &shelf = _shelves[best];
+        Shelf rest(shelf.Y + align_height, shelf.Height - align_height, _width);
+        _shelves[best].Height = align_height;
+        _shelves.insert(_shelves.begin() + best + 1, rest);
+    }
+
+    Shelf &shelf = _shelves[best];
+    Span &span = shelf.Free[best_span];
+    rc = RectWH(span.X, shelf.Y, width, height);
+    span.X += width;
+    span.Width -= width;
+    if (span.Width == 0)
+        shelf.Free.erase(shelf.Free.begin() + best_span);
+    shelf.Used++;
+    _numRegions++;
+    return true;
+}
+
+void ShelfPacker::Free(const Rect &rc)
+{
+    auto it = std::lower_bound(_shelves.begin(), _shelves.end(), rc.Top,
+        [](const Shelf &shelf, int y) { return shelf.Y < y; });
+    assert((it != _shelves.end()) && (it->Y == rc.Top) && (it->Used > 0u));
+    if ((it == _shelves.end()) || (it->Y != rc.Top) || (it->Used == 0u))
+        return; // not allocated here
+
+    // Return the span, merging with the adjacent free spans
+    std::vector<Span> &free = it->Free;
+    auto sp = std::lower_bound(free.begin(), free.end(), rc.Left,
+        [](const Span &span, int x) { return span.X < x; });
+    sp = free.insert(sp, Span(rc.Left, rc.GetWidth()));
+    auto next = sp + 1;
+    if ((next != free.end()) && (sp->X + sp->Width == next->X))
+    {
+        sp->Width += next->Width;
+        free.erase(next);
+    }
+    if (sp != free.begin())
+    {
+        auto prev = sp - 1;
+        if (prev->X + prev->Width == sp->X)
+        {
+            prev->Width += sp->Width;
+            free.erase(sp);
+        }
+    }
+    it->Used--;
+    _numRegions--;
+    if (it->Used > 0u)
+        return;
+
+    // Merge the empty shelf with the adjacent empty ones
+    size_t index = it - _shelves.begin();
+    if ((index + 1 < _shelves.size()) && (_shelves[index + 1].Used == 0u))
+    {
+        _shelves[index].Height += _shelves[index + 1].Height;
+        _shelves.erase(_shelves.begin() + index + 1);
+    }
+    if ((index > 0) && (_shelves[index - 1].Used == 0u))
+    {
+        _shelves[index - 1].Height += _shelves[index].Height;
+        _shelves.erase(_shelves.begin() + index);
+    }
+    // Empty shelf on top is not needed, its space is free for new shelves
+    if (!_shelves.empty() && (_shelves.back().Used == 0u))
+        _shelves.pop_back();
+}
+
+
+TextureAtlas::TextureAtlas(int page_width, int page_height)
+    : _pageWidth(page_width)
+    , _pageHeight(page_height)
+{
+}
+
+bool TextureAtlas::IsPageEmpty(size_t page) const
+{
+    return (page < _pages.size()) && _pages[page] && _pages[page]->IsEmpty();
+}
+
+bool TextureAtlas::Allocate(int width, int height, size_t &page, Rect &rc, bool &new_page)
+{
+    if ((width > _pageWidth) || (height > _pageHeight))
+        return false;
+
+    for (size_t i = 0; i < _pages.size(); ++i)
+    {
+        if (_pages[i] && _pages[i]->Allocate(width, height, rc))
+        {
+            page = i;
+            new_page = false;
+            return true;
+        }
+    }
+
+    auto free_slot = std::find(_pages.begin(), _pages.end(), nullptr);
+    page = free_slot - _pages.begin();
+    if (free_slot == _pages.end())
+        _pages.emplace_back();
+    _pages[page].reset(new ShelfPacker(_pageWidth, _pageHeight));
+    new_page = true;
+    return _pages[page]->Allocate(width, height, rc);
+}
+
+bool TextureAtlas::Free(size_t page, const Rect &rc)
+{
+    assert((page < _pages.size()) && _pages[page]);
+    if ((page >= _pages.size()) || !_pages[page])
+        return false;
+    _pages[page]->Free(rc);
+    return _pages[page]->IsEmpty();
+}
+
+void TextureAtlas::RemovePage(size_t page)
+{
+    assert(IsPageEmpty(page));
+    if (page < _pages.size())
+        _pages[page].reset();
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,123 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Texture atlas allocator: packs small rectangles into a set of large
+// pages, letting renderers store many small sprites in one shared texture.
+// This class only manages the space, the renderer is responsible for
+// creating actual textures for the pages.
+//
+// Each page is packed using "shelves": horizontal strips, each having the
+// height of the first region placed on it (rounded up). Regions are put on
+// the shelf which height suits them best, or on a new shelf opened at the
+// top of the used space. Freed space is returned to its shelf, and empty
+// shelves are merged and may be reused for regions of any height.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__TEXTUREATLAS_H
+#define __AGS_EE_GFX__TEXTUREATLAS_H
+
+#include <memory>
+#include <vector>
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Packs rectangles into a single page
+class ShelfPacker
+{
+public:
+    ShelfPacker(int width, int height);
+
+    int GetWidth() const { return _width; }
+    int GetHeight() const { return _height; }
+    // Tells if there are no regions allocated on this page
+    bool IsEmpty() const { return _numRegions == 0u; }
+    // Returns the number of allocated regions
+    size_t GetRegionCount() const { return _numRegions; }
+
+    // Allocates a region of the given size; returns false if there's no space
+    bool Allocate(int width, int height, Rect &rc);
+    // Frees a previously allocated region
+    void Free(const Rect &rc);
+
+private:
+    // Shelf heights are aligned to this value, lets the regions of
+    // close sizes share the shelves
+    static const int ShelfAlign = 8;
+
+    struct Span
+    {
+        int X = 0;
+        int Width = 0;
+        Span() = default;
+        Span(int x, int width) : X(x), Width(width) {}
+    };
+
+    struct Shelf
+    {
+        int Y = 0;
+        int Height = 0;
+        std::vector<Span> Free; // free spans, ordered by X
+        size_t Used = 0u; // number of allocated regions
+        Shelf(int y, int height, int width)
+            : Y(y), Height(height), Free(1, Span(0, width)) {}
+    };
+
+    // Finds a span on the shelf fitting the given width; returns -1 if none
+    static int FindSpan(const Shelf &shelf, int width);
+
+    int _width = 0;
+    int _height = 0;
+    // Shelves, ordered by Y, without gaps between them
+    std::vector<Shelf> _shelves;
+    size_t _numRegions = 0u;
+};
+
+
+// Manages a number of pages of the same size
+class TextureAtlas
+{
+public:
+    TextureAtlas(int page_width, int page_height);
+
+    int GetPageWidth() const { return _pageWidth; }
+    int GetPageHeight() const { return _pageHeight; }
+    // Returns the number of page slots, including the removed pages
+    size_t GetPageCount() const { return _pages.size(); }
+    // Tells if the page exists and has no regions allocated
+    bool IsPageEmpty(size_t page) const;
+
+    // Allocates a region of the given size, adding a new page if necessary;
+    // sets the page index and whether this page was just added, in which case
+    // the renderer should create a texture for it.
+    // Returns false if the region is larger than the page.
+    bool Allocate(int width, int height, size_t &page, Rect &rc, bool &new_page);
+    // Frees a previously allocated region; returns true if the page became empty
+    bool Free(size_t page, const Rect &rc);
+    // Removes an empty page; its slot will be reused by the next added page
+    void RemovePage(size_t page);
+
+private:
+    int _pageWidth = 0;
+    int _pageHeight = 0;
+    std::vector<std::unique_ptr<ShelfPacker>> _pages;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__TEXTUREATLAS_H
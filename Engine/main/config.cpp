@@ -110,6 +110,12 @@ SkipSpeechStyle parse_speechskip_style(const String &option, SkipSpeechStyle def
     return StrUtil::ParseEnumOptions<SkipSpeechStyle>(option, skip_speech_arr, def_value);
 }
 
+static CachePolicyType parse_cache_policy(const String &option, CachePolicyType def_value)
+{
+    return StrUtil::ParseEnum<CachePolicyType>(option,
+        CstrArr<kNumCachePolicies>{"lru", "lru2", "greedydual"}, def_value);
+}
+
 static FrameScaleDef parse_legacy_scaling_option(const String &option, int &scale)
 {
     FrameScaleDef frame = parse_scaling_option(option, kFrame_Undefined);
@@ -383,6 +389,9 @@ void load_common_config(const ConfigTree &cfg, GameConfig &setup)
     setup.RenderAtScreenRes = CfgReadBoolInt(cfg, "graphics", "render_at_screenres");
     setup.AntialiasSprites = CfgReadBoolInt(cfg, "graphics", "antialias", setup.AntialiasSprites);
     setup.SoftwareRenderDriver = CfgReadString(cfg, "graphics", "software_driver");
+    setup.SoftwareRenderThreads = CfgReadInt(cfg, "graphics", "software_render_threads", 0, 16, setup.SoftwareRenderThreads);
+    setup.SoftwarePrepareThreads = CfgReadInt(cfg, "graphics", "software_prepare_threads", 0, 16, setup.SoftwarePrepareThreads);
+    setup.WalkBehindShader = CfgReadBoolInt(cfg, "graphics", "walkbehind_shader", setup.WalkBehindShader);
 
     String rotation_str = CfgReadString(cfg, "graphics", "rotation", "unlocked");
     setup.Rotation = StrUtil::ParseEnum<ScreenRotation>(
@@ -416,6 +425,11 @@ void load_common_config(const ConfigTree &cfg, GameConfig &setup)
     // Resource caches and options
     setup.SpriteCacheSize = CfgReadInt(cfg, "graphics", "sprite_cache_size", setup.SpriteCacheSize);
     setup.TextureCacheSize = CfgReadInt(cfg, "graphics", "texture_cache_size", setup.TextureCacheSize);
+    setup.SpriteCachePolicy = parse_cache_policy(CfgReadString(cfg, "graphics", "sprite_cache_policy"), setup.SpriteCachePolicy);
+    setup.TextureCachePolicy = parse_cache_policy(CfgReadString(cfg, "graphics", "texture_cache_policy"), setup.TextureCachePolicy);
+    setup.SpriteLoadThreads = CfgReadInt(cfg, "graphics", "sprite_load_threads", 0, 16, setup.SpriteLoadThreads);
+    setup.SpriteFileMapping = CfgReadBoolInt(cfg, "graphics", "sprite_file_mapping", setup.SpriteFileMapping);
+    setup.SpritePrefetch = CfgReadInt(cfg, "graphics", "sprite_prefetch", 0, 256, setup.SpritePrefetch);
     setup.SoundCacheSize = CfgReadInt(cfg, "sound", "cache_size", setup.SoundCacheSize);
     setup.SoundLoadAtOnceSize = CfgReadInt(cfg, "sound", "stream_threshold", setup.SoundLoadAtOnceSize);
 
@@ -424,6 +438,10 @@ void load_common_config(const ConfigTree &cfg, GameConfig &setup)
     setup.CompressSaves = CfgReadBoolInt(cfg, "misc", "compress_saves", setup.CompressSaves);
     setup.RunInBackground = CfgReadInt(cfg, "misc", "background", 0) != 0;
     setup.ShowFps = CfgReadBoolInt(cfg, "misc", "show_fps");
+    setup.ShowFrameGraph = CfgReadBoolInt(cfg, "misc", "show_frame_graph", setup.ShowFrameGraph);
+    setup.ExportFrameTimes = CfgReadBoolInt(cfg, "misc", "frame_times", setup.ExportFrameTimes);
+    setup.ScriptPredecode = CfgReadBoolInt(cfg, "misc", "script_predecode", setup.ScriptPredecode);
+    setup.ScriptProfile = CfgReadBoolInt(cfg, "misc", "script_profile", setup.ScriptProfile);
     setup.ClearCacheOnRoomChange = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", setup.ClearCacheOnRoomChange);
 
     // Accessibility settings
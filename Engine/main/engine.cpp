@@ -46,6 +46,7 @@
 #include "ac/roomstatus.h"
 #include "ac/speech.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "ac/translation.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/scriptobject.h"
@@ -417,6 +418,7 @@ void engine_init_debug()
 {
     if (usetup.ShowFps)
         display_fps = kFPS_Forced;
+    display_frame_graph = usetup.ShowFrameGraph;
     if ((debug_flags & (~DBG_DEBUGMODE)) >0) {
         platform->DisplayAlert("Engine debugging enabled.\n"
             "\nNOTE: You have selected to enable one or more engine debugging options.\n"
@@ -588,9 +590,19 @@ HError engine_init_sprites()
     {
         return err;
     }
+    if (usetup.SpriteFileMapping)
+    {
+        AssetLocation loc;
+        if (AssetMgr->GetAssetLocation(SpriteFile::DefaultSpriteFileName, loc) &&
+            spriteset.MapFile(loc.FileName, loc.Offset, loc.Size))
+            Debug::Printf("Sprite file is memory-mapped");
+    }
     if (usetup.SpriteCacheSize > 0)
         spriteset.SetMaxCacheSize(usetup.SpriteCacheSize * 1024);
+    spriteset.SetCachePolicy(usetup.SpriteCachePolicy);
     Debug::Printf("Sprite cache set: %zu KB", spriteset.GetMaxCacheSize() / 1024);
+    spriteset.SetAsyncLoadThreads(usetup.SpriteLoadThreads);
+    init_sprite_prefetch(usetup.SpritePrefetch);
     return HError::None();
 }
 
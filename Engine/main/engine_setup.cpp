@@ -11,6 +11,8 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
+#include <thread>
 #include "core/platform.h"
 #include "ac/common.h"
 #include "ac/display.h"
@@ -63,6 +65,12 @@ void engine_adjust_for_rotation_settings()
 void engine_post_gfxmode_driver_setup()
 {
     gfxDriver->SetCallbackOnSpriteEvt(GfxDriverSpriteEvtCallback);
+    // The game thread draws bands too, so leave a core for it
+    size_t render_threads = usetup.SoftwareRenderThreads;
+    const size_t cores = std::thread::hardware_concurrency();
+    if (cores > 0u)
+        render_threads = std::min(render_threads, cores - 1);
+    gfxDriver->SetRenderThreads(render_threads);
 }
 
 // Reset gfx driver callbacks
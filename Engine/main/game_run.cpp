@@ -42,6 +42,7 @@
 #include "ac/object.h"
 #include "ac/overlay.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "ac/sys_events.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
@@ -51,6 +52,7 @@
 #include "ac/walkbehind.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/frametimer.h"
 #include "device/mousew32.h"
 #include "gui/animatingguibutton.h"
 #include "gui/guiinv.h"
@@ -221,6 +223,7 @@ static void game_loop_check_problems_at_start()
 // Runs rep-exec
 static void game_loop_do_early_script_update()
 {
+    FrameStageScope stage_scope(kFrameStage_Script);
     if (in_new_room == 0) {
         // Run the room and game script repeatedly_execute
         run_function_on_non_blocking_thread(&repExecAlways);
@@ -232,6 +235,7 @@ static void game_loop_do_early_script_update()
 // Runs late-rep-exec
 static void game_loop_do_late_script_update()
 {
+    FrameStageScope stage_scope(kFrameStage_Script);
     if (in_new_room == 0)
     {
         // Run the room and game script late_repeatedly_execute
@@ -241,6 +245,7 @@ static void game_loop_do_late_script_update()
 
 static bool game_loop_check_ground_level_interactions()
 {
+    FrameStageScope stage_scope(kFrameStage_Script);
     // If ground interactions are disabled completely, then bail out
     if ((play.ground_level_areas_disabled & GLED_INTERACTION) != 0)
         return true; // continue update
@@ -796,6 +801,7 @@ static void game_loop_do_update()
 
 static void game_loop_update_animated_buttons()
 {
+    FrameStageScope stage_scope(kFrameStage_Animation);
     // update animating GUI buttons
     // this bit isn't in update_stuff because it always needs to
     // happen, even when the game is paused
@@ -916,6 +922,7 @@ static void update_cursor_over_location(int mwasatx, int mwasaty)
 
 static void game_loop_update_events()
 {
+    FrameStageScope stage_scope(kFrameStage_Script);
     new_room_was = in_new_room;
     if (in_new_room>0)
         setevent({ kAGSEvent_FadeIn });
@@ -934,6 +941,7 @@ static void game_loop_update_events()
 
 static void game_loop_update_background_animation()
 {
+    FrameStageScope stage_scope(kFrameStage_Animation);
     if (play.bg_anim_delay > 0) play.bg_anim_delay--;
     else if (play.bg_frame_locked) ;
     else {
@@ -999,8 +1007,15 @@ uint32_t get_loop_counter() {
 }
 
 void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int extraX, int extraY) {
+    // The game update may be nested inside a script stage (during blocking
+    // actions), so reset the stage for the duration of this update
+    FrameStageScope frame_scope(kFrameStage_Other);
+
     sys_evt_process_pending();
 
+    // Add the sprites loaded in background since the last update
+    spriteset.CollectAsyncLoads();
+
     numEventsAtStartOfFunction = events.size();
 
     if (want_exit) {
@@ -1067,7 +1082,11 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     // Only render if we are not skipping a cutscene
     if (!play.fast_forward)
+    {
+        // Request the sprites which are likely to be drawn in the next frames
+        update_sprite_prefetch();
         render_graphics(extraBitmap, extraX, extraY);
+    }
 
     set_our_eip(6);
 
@@ -1083,7 +1102,10 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     // Immediately start the next frame if we are skipping a cutscene
     if (play.fast_forward)
+    {
+        frametimer_next_frame();
         return;
+    }
 
     set_our_eip(72);
 
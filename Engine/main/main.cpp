@@ -117,6 +117,8 @@ void main_print_help() {
 #endif
            "  --display <number>           1-based index of system display to start on.\n"
            "  --fps                        Display fps counter\n"
+           "  --frame-graph                Display the graph of frame times per update stage\n"
+           "  --frame-times                Record frame times, and write them on exit\n"
            "  --fullscreen                 Force display mode to fullscreen\n"
            "  --gfxdriver <id>             Request graphics driver. Available options:\n"
 #if AGS_PLATFORM_OS_WINDOWS
@@ -168,6 +170,8 @@ void main_print_help() {
            "  --novideo                    Don't play game videos\n"
            "  --rotation <MODE>            Screen rotation preferences. MODEs are:\n"
            "                                 unlocked (0), portrait (1), landscape (2)\n"
+           "  --script-profile             Profile game scripts, and write the report on exit\n"
+           "                               next to the log file\n"
            "  --sdl-log=LEVEL              Setup SDL backend logging level\n"
            "                               LEVELs are:\n"
            "                                 verbose (1), debug (2), info (3), warn (4),\n"
@@ -332,6 +336,12 @@ static int main_process_cmdline(ConfigTree &cfg, int argc, char *argv[])
             cfg["override"]["noplugins"] = "1";
         else if (ags_stricmp(arg, "--fps") == 0)
             cfg["misc"]["show_fps"] = "1";
+        else if (ags_stricmp(arg, "--frame-graph") == 0)
+            cfg["misc"]["show_frame_graph"] = "1";
+        else if (ags_stricmp(arg, "--frame-times") == 0)
+            cfg["misc"]["frame_times"] = "1";
+        else if (ags_stricmp(arg, "--script-profile") == 0)
+            cfg["misc"]["script_profile"] = "1";
         else if (ags_stricmp(arg, "--test") == 0) debug_flags |= DBG_DEBUGMODE;
         else if (ags_stricmp(arg, "--noiface") == 0) debug_flags |= DBG_NOIFACE;
         else if (ags_stricmp(arg, "--nosprdisp") == 0) debug_flags |= DBG_NODRAWSPRITES;
@@ -24,6 +24,7 @@
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
+#include "ac/path_helper.h"
 #include "ac/roomstatus.h"
 #include "ac/route_finder.h"
 #include "ac/translation.h"
@@ -31,6 +32,7 @@
 #include "debug/agseditordebugger.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/frametimer.h"
 #include "debug/out.h"
 #include "font/fonts.h"
 #include "main/config.h"
@@ -45,6 +47,7 @@
 #include "platform/base/sys_main.h"
 #include "plugin/plugin_engine.h"
 #include "script/cc_common.h"
+#include "script/script_runtime.h"
 #include "media/audio/audio_system.h"
 #include "media/video/video.h"
 
@@ -100,6 +103,36 @@ void quit_check_dynamic_sprites(QuitReason qreason)
     }
 }
 
+// Writes the script profile, if the script profiling was enabled
+static void quit_write_script_profile()
+{
+    if (!usetup.ScriptProfile)
+        return;
+    const FSLocation fs = platform->GetAppOutputDirectory();
+    const String folded_path = PreparePathForWriting(fs, "script_profile.folded");
+    const String report_path = PreparePathForWriting(fs, "script_profile.txt");
+    if (!folded_path.IsEmpty() && !report_path.IsEmpty() &&
+        ccWriteScriptProfile(folded_path, report_path))
+        Debug::Printf(kDbgMsg_Info, "Script profile written to: %s", report_path.GetCStr());
+    else
+        Debug::Printf(kDbgMsg_Error, "Failed to write script profile");
+}
+
+// Writes the recent frame times, if requested by the user
+static void quit_write_frame_times()
+{
+    if (!usetup.ExportFrameTimes)
+        return;
+    const FSLocation fs = platform->GetAppOutputDirectory();
+    const String csv_path = PreparePathForWriting(fs, "frame_times.csv");
+    const String trace_path = PreparePathForWriting(fs, "frame_times.json");
+    if (!csv_path.IsEmpty() && !trace_path.IsEmpty() &&
+        frametimer_write_history(csv_path, trace_path))
+        Debug::Printf(kDbgMsg_Info, "Frame times written to: %s", csv_path.GetCStr());
+    else
+        Debug::Printf(kDbgMsg_Error, "Failed to write frame times");
+}
+
 void quit_shutdown_audio()
 {
     set_our_eip(9917);
@@ -207,6 +240,8 @@ void quit(const char *quitmsg)
 
     // Release game data and unregister assets
     quit_check_dynamic_sprites(qreason);
+    quit_write_script_profile();
+    quit_write_frame_times();
     shutdown_game_state();
     unload_game();
     AssetMgr.reset();
@@ -36,6 +36,7 @@
 #include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
+#include "debug/frametimer.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
 #include "main/game_run.h"
@@ -564,6 +565,9 @@ void update_stuff() {
 
   update_script_timers();
 
+  // the stages are switched along the update, and restored in the end
+  FrameStageScope stage_scope(kFrameStage_Animation);
+
   update_cycling_views();
 
   set_our_eip(21);
@@ -574,12 +578,17 @@ void update_stuff() {
 
   std::vector<int> followingAsSheep;
 
+  // character view animation is updated along with their movement
+  frametimer_set_stage(kFrameStage_Movement);
+
   update_character_move_and_anim(followingAsSheep);
 
   update_following_exactly_characters(followingAsSheep);
 
   set_our_eip(23);
 
+  frametimer_set_stage(kFrameStage_Animation);
+
   update_overlay_timers();
 
   update_speech_and_messages();
@@ -23,6 +23,7 @@
 #include <glm/ext.hpp>
 #include "ac/sys_events.h"
 #include "ac/timer.h"
+#include "debug/frametimer.h"
 #include "debug/out.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/gfx_def.h"
@@ -1232,6 +1233,7 @@ void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw
 void D3DGraphicsDriver::RenderAndPresent(bool clearDrawListAfterwards)
 {
     RenderImpl(clearDrawListAfterwards);
+    FrameStageScope stage_scope(kFrameStage_Present);
     direct3ddevice->Present(NULL, NULL, NULL, NULL);
 }
 
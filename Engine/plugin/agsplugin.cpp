@@ -449,7 +449,8 @@ void IAGSEngine::FreeBitmap (BITMAP *tofree) {
         destroy_bitmap (tofree);
 }
 BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
-    return (BITMAP*)spriteset[num]->GetAllegroBitmap();
+    // Plugins may draw on the sprite, so it must not reference the mapped file
+    return (BITMAP*)spriteset.GetSpriteForWriting(num)->GetAllegroBitmap();
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
     if (index == MASK_WALKABLE)
@@ -27,6 +27,7 @@
 #include "debug/out.h"
 #include "script/cc_common.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "script/systemimports.h"
 #include "util/bbop.h"
@@ -50,6 +51,7 @@ enum ScriptOpArgIsReg
     kScOpArg3IsReg      = 0x0004,
     kScOpOneArgIsReg    = kScOpArg1IsReg,
     kScOpTwoArgsAreReg  = kScOpArg1IsReg | kScOpArg2IsReg,
+    kScOpArg1And3AreReg = kScOpArg1IsReg | kScOpArg3IsReg,
     kScOpTreeArgsAreReg = kScOpArg1IsReg | kScOpArg2IsReg | kScOpArg3IsReg
 };
 
@@ -148,6 +150,45 @@ const ScriptCommandInfo sccmd_info[CC_NUM_SCCMDS] =
     ScriptCommandInfo( SCMD_NEWUSEROBJECT   , "newuserobject"     , 2, kScOpOneArgIsReg ),
 };
 
+// Superinstructions: internal instructions which replace the frequent
+// instruction sequences in the pre-decoded code, saving on dispatch.
+// These never appear in the script bytecode.
+enum ScriptSuperInstruction
+{
+    SCMDX_LOADSPOFFS_MEMREAD = CC_NUM_SCCMDS, // MAR = SP - arg1; reg2 = m[MAR]
+    SCMDX_LOADSPOFFS_MEMWRITE,  // MAR = SP - arg1; m[MAR] = reg2
+    SCMDX_LITTOREG_ADDREG,      // reg1 = arg2; reg3 += reg1
+    SCMDX_PUSH_LITTOREG_POP,    // push reg1; reg1 = arg2; pop reg3
+    SCMDX_ISEQUAL_JZ,           // reg1 = reg1 == reg2; AX = reg1; if AX == 0 then jump by arg3
+    SCMDX_NOTEQUAL_JZ,          // reg1 = reg1 != reg2; same as above
+    SCMDX_GREATER_JZ,           // reg1 = reg1 > reg2; same as above
+    SCMDX_LESSTHAN_JZ,          // reg1 = reg1 < reg2; same as above
+    SCMDX_GTE_JZ,               // reg1 = reg1 >= reg2; same as above
+    SCMDX_LTE_JZ,               // reg1 = reg1 <= reg2; same as above
+    SCMDX_LITTOREG_IMPORT,      // reg1 = import arg2, resolved through the cache #arg3
+    CC_NUM_EXEC_CMDS
+};
+
+const ScriptCommandInfo scxcmd_info[CC_NUM_EXEC_CMDS - CC_NUM_SCCMDS] =
+{
+    ScriptCommandInfo( SCMDX_LOADSPOFFS_MEMREAD , "loadspoffs+memread"  , 2, kScOpArg2IsReg ),
+    ScriptCommandInfo( SCMDX_LOADSPOFFS_MEMWRITE, "loadspoffs+memwrite" , 2, kScOpArg2IsReg ),
+    ScriptCommandInfo( SCMDX_LITTOREG_ADDREG    , "mov+add"             , 3, kScOpArg1And3AreReg ),
+    ScriptCommandInfo( SCMDX_PUSH_LITTOREG_POP  , "push+mov+pop"        , 3, kScOpArg1And3AreReg ),
+    ScriptCommandInfo( SCMDX_ISEQUAL_JZ         , "cmpeq+jz"            , 3, kScOpTwoArgsAreReg ),
+    ScriptCommandInfo( SCMDX_NOTEQUAL_JZ        , "cmpne+jz"            , 3, kScOpTwoArgsAreReg ),
+    ScriptCommandInfo( SCMDX_GREATER_JZ         , "gt+jz"               , 3, kScOpTwoArgsAreReg ),
+    ScriptCommandInfo( SCMDX_LESSTHAN_JZ        , "lt+jz"               , 3, kScOpTwoArgsAreReg ),
+    ScriptCommandInfo( SCMDX_GTE_JZ             , "gte+jz"              , 3, kScOpTwoArgsAreReg ),
+    ScriptCommandInfo( SCMDX_LTE_JZ             , "lte+jz"              , 3, kScOpTwoArgsAreReg ),
+    ScriptCommandInfo( SCMDX_LITTOREG_IMPORT    , "mov.import"          , 3, kScOpOneArgIsReg ),
+};
+
+inline const ScriptCommandInfo &get_cmd_info(int32_t code)
+{
+    return code < CC_NUM_SCCMDS ? sccmd_info[code] : scxcmd_info[code - CC_NUM_SCCMDS];
+}
+
 const char *regnames[] = { "null", "sp", "mar", "ax", "bx", "cx", "op", "dx" };
 const char *fixupnames[] = { "null", "fix_gldata", "fix_func", "fix_string", "fix_import", "fix_datadata", "fix_stack" };
 
@@ -208,6 +249,11 @@ struct FunctionCallStack
 unsigned ccInstance::_timeoutCheckMs = 60u;
 unsigned ccInstance::_timeoutAbortMs = 0u;
 unsigned ccInstance::_maxWhileLoops = 0u;
+bool ccInstance::_predecode = false;
+bool ccInstance::_useImportCache = true;
+uint32_t ccInstance::_importCacheHits = 0u;
+uint32_t ccInstance::_importCacheMisses = 0u;
+ScriptProfiler *ccInstance::_profiler = nullptr;
 
 
 ccInstance::ResolvedScriptData::ResolvedScriptData()
@@ -249,6 +295,27 @@ void ccInstance::SetExecTimeout(const unsigned sys_poll_ms, const unsigned abort
     _maxWhileLoops = abort_loops;
 }
 
+void ccInstance::SetPredecode(const bool on)
+{
+    _predecode = on;
+}
+
+void ccInstance::SetImportCache(const bool on)
+{
+    _useImportCache = on;
+}
+
+void ccInstance::GetImportCacheStats(uint32_t &hits, uint32_t &misses)
+{
+    hits = _importCacheHits;
+    misses = _importCacheMisses;
+}
+
+void ccInstance::SetProfiler(ScriptProfiler *profiler)
+{
+    _profiler = profiler;
+}
+
 ccInstance::~ccInstance()
 {
     Free();
@@ -437,7 +504,13 @@ ccInstError ccInstance::CallScriptFunction(const String &funcname, int32_t numar
 
     InstThreads.push_back(this); // push instance thread
     _runningInst = this;
+    const size_t prof_depth = _profiler ? _profiler->GetDepth() : 0u;
+    if (_profiler)
+        _profiler->EnterFunction(_instanceof.get(), start_at, 0u);
     const ccInstError reterr = Run(start_at);
+    // The function should have returned already, unless there was an error
+    if (_profiler)
+        _profiler->Unwind(prof_depth);
     // Cleanup before returning, even if error
     ASSERT_STACK_SIZE(numargs);
     PopValuesFromStack(numargs);
@@ -561,6 +634,50 @@ inline bool FixupArgument(RuntimeScriptValue &arg, const int fixup, const uintpt
 }
 
 
+// Use direct-threaded instruction dispatch ("computed goto") where the compiler
+// supports it: each handler jumps to the next instruction's handler on its own,
+// instead of returning to a single shared switch.
+#if defined(__GNUC__)
+#define CC_EXEC_THREADED 1
+#else
+#define CC_EXEC_THREADED 0
+#endif
+
+#if (DEBUG_CC_EXEC)
+#define DUMP_OP() \
+    if (dump_opcodes) \
+        DumpInstruction(*codeOp)
+#else
+#define DUMP_OP()
+#endif
+
+// CASE_OP declares an instruction handler;
+// NEXT_OP advances the program counter and proceeds to the next instruction
+// NEXT_OP_SPAN advances the program counter by the given number of code
+// elements, which is used by the superinstructions.
+#if CC_EXEC_THREADED
+#define CASE_OP(OP) case OP: op_##OP
+#define DEFAULT_OP() default: op_default
+#define NEXT_OP_SPAN(SPAN) \
+    _pc += (SPAN); \
+    if (ops && ((_flags & INSTF_ABORTED) == 0)) \
+    { \
+        codeOp = &ops[op_index[_pc]]; \
+        if (profiler) \
+            profOps++; \
+        DUMP_OP(); \
+        goto *op_handlers[codeOp->Instruction.Code]; \
+    } \
+    continue
+#else
+#define CASE_OP(OP) case OP
+#define DEFAULT_OP() default
+#define NEXT_OP_SPAN(SPAN) \
+    _pc += (SPAN); \
+    continue
+#endif
+#define NEXT_OP() NEXT_OP_SPAN(codeOp->ArgCount + 1)
+
 #define MAXNEST 50  // number of recursive function calls allowed
 ccInstError ccInstance::Run(int32_t curpc)
 {
@@ -581,11 +698,18 @@ ccInstError ccInstance::Run(int32_t curpc)
     thisbase[0] = 0;
     funcstart[0] = _pc;
     ccInstance *codeInst = _runningInst;
-    ScriptOperation codeOp;
+    // Pre-decoded instruction stream, if one was prepared for this script
+    const ScriptOperation *const ops = codeInst->_ops;
+    const uint32_t *const op_index = codeInst->_op_index;
+    const uint8_t *const code_fixups = ops ? codeInst->_op_fixups : codeInst->_code_fixups;
+    ScriptOperation decodedOp; // storage for the instruction decoded from bytecode
+    const ScriptOperation *codeOp = &decodedOp;
     FunctionCallStack func_callstack;
 #if DEBUG_CC_EXEC
     const bool dump_opcodes = ccGetOption(SCOPT_DEBUGRUN) != 0;
 #endif
+    ScriptProfiler *const profiler = _profiler;
+    uint32_t profOps = 0u; // instructions executed since the last profiler notification
     int loopIterationCheckDisabled = 0;
     unsigned loopIterations = 0u; // any loop iterations (needed for timeout test)
     unsigned loopCheckIterations = 0u; // loop iterations accumulated only if check is enabled
@@ -593,6 +717,38 @@ ccInstError ccInstance::Run(int32_t curpc)
     const auto timeout = std::chrono::milliseconds(_timeoutCheckMs);
     _lastAliveTs = FastClock::now();
 
+#if CC_EXEC_THREADED
+    // Instruction handlers, indexed by the instruction code
+    static const void *const op_handlers[CC_NUM_EXEC_CMDS] =
+    {
+        &&op_default, // 0 is not a valid instruction
+        &&op_SCMD_ADD, &&op_SCMD_SUB, &&op_SCMD_REGTOREG, &&op_SCMD_WRITELIT,
+        &&op_SCMD_RET, &&op_SCMD_LITTOREG, &&op_SCMD_MEMREAD, &&op_SCMD_MEMWRITE,
+        &&op_SCMD_MULREG, &&op_SCMD_DIVREG, &&op_SCMD_ADDREG, &&op_SCMD_SUBREG,
+        &&op_SCMD_BITAND, &&op_SCMD_BITOR, &&op_SCMD_ISEQUAL, &&op_SCMD_NOTEQUAL,
+        &&op_SCMD_GREATER, &&op_SCMD_LESSTHAN, &&op_SCMD_GTE, &&op_SCMD_LTE,
+        &&op_SCMD_AND, &&op_SCMD_OR, &&op_SCMD_CALL, &&op_SCMD_MEMREADB,
+        &&op_SCMD_MEMREADW, &&op_SCMD_MEMWRITEB, &&op_SCMD_MEMWRITEW, &&op_SCMD_JZ,
+        &&op_SCMD_PUSHREG, &&op_SCMD_POPREG, &&op_SCMD_JMP, &&op_SCMD_MUL,
+        &&op_SCMD_CALLEXT, &&op_SCMD_PUSHREAL, &&op_SCMD_SUBREALSTACK, &&op_SCMD_LINENUM,
+        &&op_SCMD_CALLAS, &&op_SCMD_THISBASE, &&op_SCMD_NUMFUNCARGS, &&op_SCMD_MODREG,
+        &&op_SCMD_XORREG, &&op_SCMD_NOTREG, &&op_SCMD_SHIFTLEFT, &&op_SCMD_SHIFTRIGHT,
+        &&op_SCMD_CALLOBJ, &&op_SCMD_CHECKBOUNDS, &&op_SCMD_MEMWRITEPTR, &&op_SCMD_MEMREADPTR,
+        &&op_SCMD_MEMZEROPTR, &&op_SCMD_MEMINITPTR, &&op_SCMD_LOADSPOFFS, &&op_SCMD_CHECKNULL,
+        &&op_SCMD_FADD, &&op_SCMD_FSUB, &&op_SCMD_FMULREG, &&op_SCMD_FDIVREG,
+        &&op_SCMD_FADDREG, &&op_SCMD_FSUBREG, &&op_SCMD_FGREATER, &&op_SCMD_FLESSTHAN,
+        &&op_SCMD_FGTE, &&op_SCMD_FLTE, &&op_SCMD_ZEROMEMORY, &&op_SCMD_CREATESTRING,
+        &&op_SCMD_STRINGSEQUAL, &&op_SCMD_STRINGSNOTEQ, &&op_SCMD_CHECKNULLREG, &&op_SCMD_LOOPCHECKOFF,
+        &&op_SCMD_MEMZEROPTRND, &&op_SCMD_JNZ, &&op_SCMD_DYNAMICBOUNDS, &&op_SCMD_NEWARRAY,
+        &&op_SCMD_NEWUSEROBJECT,
+        // superinstructions
+        &&op_SCMDX_LOADSPOFFS_MEMREAD, &&op_SCMDX_LOADSPOFFS_MEMWRITE, &&op_SCMDX_LITTOREG_ADDREG,
+        &&op_SCMDX_PUSH_LITTOREG_POP, &&op_SCMDX_ISEQUAL_JZ, &&op_SCMDX_NOTEQUAL_JZ,
+        &&op_SCMDX_GREATER_JZ, &&op_SCMDX_LESSTHAN_JZ, &&op_SCMDX_GTE_JZ, &&op_SCMDX_LTE_JZ,
+        &&op_SCMDX_LITTOREG_IMPORT
+    };
+#endif
+
     /* Main bytecode execution loop */
     //=====================================================================
     while ((_flags & INSTF_ABORTED) == 0)
@@ -604,59 +760,68 @@ ccInstError ccInstance::Run(int32_t curpc)
         //
         /* Read operation */
         //=====================================================================
-        codeOp.Instruction.Code = codeInst->_code[_pc];
-        codeOp.Instruction.InstanceId = (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-        codeOp.Instruction.Code &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
-
-        CC_ERROR_IF_RETCODE((codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS),
-            "invalid instruction %d found in code stream", codeOp.Instruction.Code);
+        if (ops)
+        {
+            // All the instructions were decoded and validated when the script was loaded
+            codeOp = &ops[op_index[_pc]];
+        }
+        else
+        {
+            decodedOp.Instruction.Code = codeInst->_code[_pc];
+            decodedOp.Instruction.InstanceId = (decodedOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+            decodedOp.Instruction.Code &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
 
-        codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
+            CC_ERROR_IF_RETCODE((decodedOp.Instruction.Code < 0 || decodedOp.Instruction.Code >= CC_NUM_SCCMDS),
+                "invalid instruction %d found in code stream", decodedOp.Instruction.Code);
 
-        CC_ERROR_IF_RETCODE(static_cast<uint32_t>(_pc + codeOp.ArgCount) >= codeInst->_codesize,
-            "unexpected end of code data (%u; %u)", static_cast<uint32_t>(_pc + codeOp.ArgCount), codeInst->_codesize);
+            decodedOp.ArgCount = sccmd_info[decodedOp.Instruction.Code].ArgCount;
 
+            CC_ERROR_IF_RETCODE(static_cast<uint32_t>(_pc + decodedOp.ArgCount) >= codeInst->_codesize,
+                "unexpected end of code data (%u; %u)", static_cast<uint32_t>(_pc + decodedOp.ArgCount), codeInst->_codesize);
 
-        // Read arguments; use switch as it proved to be faster than the loop
-        switch (codeOp.ArgCount)
-        {
-        case 3:
-            codeOp.Args[2].SetInt32(static_cast<int32_t>(codeInst->_code[_pc + 3]));
-            /* fall-through */
-        case 2:
-            codeOp.Args[1].SetInt32(static_cast<int32_t>(codeInst->_code[_pc + 2]));
-            /* fall-through */
-        case 1:
-            codeOp.Args[0].SetInt32(static_cast<int32_t>(codeInst->_code[_pc + 1]));
-            break;
-        default:
-            break;
+            // Read arguments; use switch as it proved to be faster than the loop
+            switch (decodedOp.ArgCount)
+            {
+            case 3:
+                decodedOp.Args[2].SetInt32(static_cast<int32_t>(codeInst->_code[_pc + 3]));
+                /* fall-through */
+            case 2:
+                decodedOp.Args[1].SetInt32(static_cast<int32_t>(codeInst->_code[_pc + 2]));
+                /* fall-through */
+            case 1:
+                decodedOp.Args[0].SetInt32(static_cast<int32_t>(codeInst->_code[_pc + 1]));
+                break;
+            default:
+                break;
+            }
         }
         //---------------------------------------------------------------------
         /* End read operation */
         //=====================================================================
 
-#if (DEBUG_CC_EXEC)
-        if (dump_opcodes)
-        {
-            DumpInstruction(codeOp);
-        }
-#endif
+        if (profiler)
+            profOps++;
+        DUMP_OP();
 
         /* Perform operation */
         //=====================================================================
-        switch (codeOp.Instruction.Code)
+        switch (codeOp->Instruction.Code)
         {
-        case SCMD_LINENUM:
-            _lineNumber = codeOp.Arg1i();
+        CASE_OP(SCMD_LINENUM):
+            _lineNumber = codeOp->Arg1i();
             currentline = _lineNumber;
             if (new_line_hook)
                 new_line_hook(this, currentline);
-            break;
-        case SCMD_ADD:
+            if (profiler)
+            {
+                profiler->SetLine(_lineNumber, profOps);
+                profOps = 0u;
+            }
+            NEXT_OP();
+        CASE_OP(SCMD_ADD):
         {
-            const auto arg_reg = codeOp.Arg1i();
-            const auto arg_lit = codeOp.Arg2i();
+            const auto arg_reg = codeOp->Arg1i();
+            const auto arg_lit = codeOp->Arg2i();
             auto &reg1 = _registers[arg_reg];
             // If the the register is SREG_SP, we are allocating new variable on the stack
             if (arg_reg == SREG_SP)
@@ -683,12 +848,12 @@ ccInstError ccInstance::Run(int32_t curpc)
             {
                 reg1.IValue += arg_lit;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_SUB:
+        CASE_OP(SCMD_SUB):
         {
-            const auto arg_reg = codeOp.Arg1i();
-            const auto arg_lit = codeOp.Arg2i();
+            const auto arg_reg = codeOp->Arg1i();
+            const auto arg_lit = codeOp->Arg2i();
             auto &reg1 = _registers[arg_reg];
             if (reg1.Type == kScValStackPtr)
             {
@@ -713,16 +878,16 @@ ccInstError ccInstance::Run(int32_t curpc)
             {
                 reg1.IValue -= arg_lit;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_REGTOREG:
+        CASE_OP(SCMD_REGTOREG):
         {
-            const auto &reg1 = _registers[codeOp.Arg1i()];
-            auto       &reg2 = _registers[codeOp.Arg2i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
+            auto       &reg2 = _registers[codeOp->Arg2i()];
             reg2 = reg1;
-            break;
+            NEXT_OP();
         }
-        case SCMD_WRITELIT:
+        CASE_OP(SCMD_WRITELIT):
         {
             // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
             //
@@ -730,10 +895,10 @@ ccInstError ccInstance::Run(int32_t curpc)
             // long, or rather int32 due x32 build), written value may normally
             // be only up to 4 bytes large;
             // I guess that's an obsolete way to do WRITE, WRITEW and WRITEB
-            const auto arg_size = codeOp.Arg1i();
-            FixupArgument(codeOp.Args[1], codeInst->_code_fixups[_pc + 2], codeInst->_code[_pc + 2], _stackBegin, codeInst->_strings);
+            const auto arg_size = codeOp->Arg1i();
+            RuntimeScriptValue arg_value = codeOp->Arg2();
+            FixupArgument(arg_value, code_fixups[_pc + 2], codeInst->_code[_pc + 2], _stackBegin, codeInst->_strings);
             ASSERT_CC_ERROR();
-            const auto &arg_value = codeOp.Arg2();
             switch (arg_size)
             {
             case sizeof(char) :
@@ -750,9 +915,9 @@ ccInstError ccInstance::Run(int32_t curpc)
                 cc_error("unexpected data size for WRITELIT op: %d", arg_size);
                 break;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_RET:
+        CASE_OP(SCMD_RET):
         {
             if (loopIterationCheckDisabled > 0)
                 loopIterationCheckDisabled--;
@@ -761,6 +926,11 @@ ccInstError ccInstance::Run(int32_t curpc)
             RuntimeScriptValue rval = PopValueFromStack();
             curnest--;
             _pc = rval.IValue;
+            if (profiler)
+            {
+                profiler->LeaveFunction(profOps);
+                profOps = 0u;
+            }
             if (_pc == 0)
             {
                 _returnValue = _registers[SREG_AX].IValue;
@@ -769,167 +939,167 @@ ccInstError ccInstance::Run(int32_t curpc)
             POP_CALL_STACK();
             continue; // continue so that the PC doesn't get overwritten
         }
-        case SCMD_LITTOREG:
+        CASE_OP(SCMD_LITTOREG):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
-            FixupArgument(codeOp.Args[1], codeInst->_code_fixups[_pc + 2], codeInst->_code[_pc + 2], _stackBegin, codeInst->_strings);
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            RuntimeScriptValue arg_value = codeOp->Arg2();
+            FixupArgument(arg_value, code_fixups[_pc + 2], codeInst->_code[_pc + 2], _stackBegin, codeInst->_strings);
             ASSERT_CC_ERROR();
-            const auto &arg_value = codeOp.Arg2();
             reg1 = arg_value;
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMREAD:
+        CASE_OP(SCMD_MEMREAD):
         {
             // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             reg1 = _registers[SREG_MAR].ReadValue();
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMWRITE:
+        CASE_OP(SCMD_MEMWRITE):
         {
             // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             _registers[SREG_MAR].WriteValue(reg1);
-            break;
+            NEXT_OP();
         }
-        case SCMD_LOADSPOFFS:
+        CASE_OP(SCMD_LOADSPOFFS):
         {
-            const auto arg_off = codeOp.Arg1i();
+            const auto arg_off = codeOp->Arg1i();
             _registers[SREG_MAR] = GetStackPtrOffsetRw(arg_off);
             ASSERT_CC_ERROR();
-            break;
+            NEXT_OP();
         }
-        case SCMD_MULREG:
+        CASE_OP(SCMD_MULREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32(reg1.IValue * reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_DIVREG:
+        CASE_OP(SCMD_DIVREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             if (reg2.IValue == 0)
             {
                 cc_error("!Integer divide by zero");
                 return kInstErr_Generic;
             }
             reg1.SetInt32(reg1.IValue / reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_ADDREG:
+        CASE_OP(SCMD_ADDREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             // This may be pointer arithmetics, in which case IValue stores offset from base pointer
             reg1.IValue += reg2.IValue;
-            break;
+            NEXT_OP();
         }
-        case SCMD_SUBREG:
+        CASE_OP(SCMD_SUBREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             // This may be pointer arithmetics, in which case IValue stores offset from base pointer
             reg1.IValue -= reg2.IValue;
-            break;
+            NEXT_OP();
         }
-        case SCMD_BITAND:
+        CASE_OP(SCMD_BITAND):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32(reg1.IValue & reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_BITOR:
+        CASE_OP(SCMD_BITOR):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32(reg1.IValue | reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_ISEQUAL:
+        CASE_OP(SCMD_ISEQUAL):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1 == reg2);
-            break;
+            NEXT_OP();
         }
-        case SCMD_NOTEQUAL:
+        CASE_OP(SCMD_NOTEQUAL):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1 != reg2);
-            break;
+            NEXT_OP();
         }
-        case SCMD_GREATER:
+        CASE_OP(SCMD_GREATER):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_LESSTHAN:
+        CASE_OP(SCMD_LESSTHAN):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_GTE:
+        CASE_OP(SCMD_GTE):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_LTE:
+        CASE_OP(SCMD_LTE):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_AND:
+        CASE_OP(SCMD_AND):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_OR:
+        CASE_OP(SCMD_OR):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_XORREG:
+        CASE_OP(SCMD_XORREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32(reg1.IValue ^ reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_MODREG:
+        CASE_OP(SCMD_MODREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             if (reg2.IValue == 0)
             {
                 cc_error("!Integer divide by zero");
                 return kInstErr_Generic;
             }
             reg1.SetInt32(reg1.IValue % reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_NOTREG:
+        CASE_OP(SCMD_NOTREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
             reg1 = !(reg1);
-            break;
+            NEXT_OP();
         }
-        case SCMD_CALL:
+        CASE_OP(SCMD_CALL):
         {
             // Call another function within same script, just save PC
             // and continue from there
@@ -942,9 +1112,9 @@ ccInstError ccInstance::Run(int32_t curpc)
             PUSH_CALL_STACK();
 
             ASSERT_STACK_SPACE_VALS(1);
-            PushValueToStack(RuntimeScriptValue().SetInt32(_pc + codeOp.ArgCount + 1));
+            PushValueToStack(RuntimeScriptValue().SetInt32(_pc + codeOp->ArgCount + 1));
 
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             if (thisbase[curnest] == 0)
                 _pc = reg1.IValue;
             else {
@@ -960,68 +1130,73 @@ ccInstError ccInstance::Run(int32_t curpc)
             curnest++;
             thisbase[curnest] = 0;
             funcstart[curnest] = _pc;
+            if (profiler)
+            {
+                profiler->EnterFunction(codeInst->_instanceof.get(), _pc, profOps);
+                profOps = 0u;
+            }
             continue; // continue so that the PC doesn't get overwritten
         }
-        case SCMD_MEMREADB:
+        CASE_OP(SCMD_MEMREADB):
         {
             // Take the data address from reg[MAR] and copy byte to reg[arg1]
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             reg1.SetUInt8(_registers[SREG_MAR].ReadByte());
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMREADW:
+        CASE_OP(SCMD_MEMREADW):
         {
             // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             reg1.SetInt16(_registers[SREG_MAR].ReadInt16());
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMWRITEB:
+        CASE_OP(SCMD_MEMWRITEB):
         {
             // Take the data address from reg[MAR] and copy there byte from reg[arg1]
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             _registers[SREG_MAR].WriteByte(reg1.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMWRITEW:
+        CASE_OP(SCMD_MEMWRITEW):
         {
             // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             _registers[SREG_MAR].WriteInt16(reg1.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_JZ:
+        CASE_OP(SCMD_JZ):
         {
-            const auto arg_lit = codeOp.Arg1i();
+            const auto arg_lit = codeOp->Arg1i();
             if (_registers[SREG_AX].IsNull())
                 _pc += arg_lit;
-            break;
+            NEXT_OP();
         }
-        case SCMD_JNZ:
+        CASE_OP(SCMD_JNZ):
         {
-            const auto arg_lit = codeOp.Arg1i();
+            const auto arg_lit = codeOp->Arg1i();
             if (!_registers[SREG_AX].IsNull())
                 _pc += arg_lit;
-            break;
+            NEXT_OP();
         }
-        case SCMD_PUSHREG:
+        CASE_OP(SCMD_PUSHREG):
         {
             // Push reg[arg1] value to the stack
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             ASSERT_STACK_SPACE_VALS(1);
             PushValueToStack(reg1);
-            break;
+            NEXT_OP();
         }
-        case SCMD_POPREG:
+        CASE_OP(SCMD_POPREG):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             ASSERT_STACK_SIZE(1);
             reg1 = PopValueFromStack();
-            break;
+            NEXT_OP();
         }
-        case SCMD_JMP:
+        CASE_OP(SCMD_JMP):
         {
-            const auto arg_lit = codeOp.Arg1i();
+            const auto arg_lit = codeOp->Arg1i();
             _pc += arg_lit;
 
             // Make sure it's not stuck in a While loop
@@ -1050,30 +1225,30 @@ ccInstError ccInstance::Run(int32_t curpc)
                     _lastAliveTs = FastClock::now();
                 }
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_MUL:
+        CASE_OP(SCMD_MUL):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
-            const auto arg_lit = codeOp.Arg2i();
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            const auto arg_lit = codeOp->Arg2i();
             reg1.IValue *= arg_lit;
-            break;
+            NEXT_OP();
         }
-        case SCMD_CHECKBOUNDS:
+        CASE_OP(SCMD_CHECKBOUNDS):
         {
-            const auto &reg1 = _registers[codeOp.Arg1i()];
-            const auto arg_lit = codeOp.Arg2i();
+            const auto &reg1 = _registers[codeOp->Arg1i()];
+            const auto arg_lit = codeOp->Arg2i();
             if ((reg1.IValue < 0) ||
                 (reg1.IValue >= arg_lit))
             {
                 cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg_lit - 1);
                 return kInstErr_Generic;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_DYNAMICBOUNDS:
+        CASE_OP(SCMD_DYNAMICBOUNDS):
         {
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             void *arr_ptr = _registers[SREG_MAR].GetPtrWithOffset();
             const auto &hdr = CCDynamicArray::GetHeader(arr_ptr);
             if ((reg1.IValue < 0) ||
@@ -1091,11 +1266,11 @@ ccInstError ccInstance::Run(int32_t curpc)
                 }
                 return kInstErr_Generic;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMREADPTR:
+        CASE_OP(SCMD_MEMREADPTR):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             int32_t handle = _registers[SREG_MAR].ReadInt32();
             // FIXME: make pool return a ready RuntimeScriptValue with these set?
             // or another struct, which may be assigned to RSV
@@ -1104,13 +1279,14 @@ ccInstError ccInstance::Run(int32_t curpc)
             ScriptValueType obj_type = ccGetObjectAddressAndManagerFromHandle(handle, object, manager);
             reg1.SetScriptObject(obj_type, object, manager);
             ASSERT_CC_ERROR();
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMWRITEPTR:
+        CASE_OP(SCMD_MEMWRITEPTR):
         {
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             int32_t handle = _registers[SREG_MAR].ReadInt32();
             void *address;
+            IScriptObject *manager = nullptr;
 
             switch (reg1.Type)
             {
@@ -1120,6 +1296,9 @@ ccInstError ccInstance::Run(int32_t curpc)
                 address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
                 break;
             case kScValScriptObject:
+                address = reg1.Ptr;
+                manager = reg1.ObjMgr;
+                break;
             case kScValPluginObject:
             case kScValPluginArgPtr:
                 address = reg1.Ptr;
@@ -1135,7 +1314,7 @@ ccInstError ccInstance::Run(int32_t curpc)
                 break;
             }
 
-            int32_t newHandle = ccGetObjectHandleFromAddress(address);
+            int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
             if (newHandle == -1)
                 return kInstErr_Generic;
 
@@ -1146,12 +1325,13 @@ ccInstError ccInstance::Run(int32_t curpc)
             }
             // Assign always, avoid leaving undefined value
             _registers[SREG_MAR].WriteInt32(newHandle);
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMINITPTR:
+        CASE_OP(SCMD_MEMINITPTR):
         {
             void *address;
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            IScriptObject *manager = nullptr;
+            const auto &reg1 = _registers[codeOp->Arg1i()];
 
             switch (reg1.Type)
             {
@@ -1161,6 +1341,9 @@ ccInstError ccInstance::Run(int32_t curpc)
                 address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
                 break;
             case kScValScriptObject:
+                address = reg1.Ptr;
+                manager = reg1.ObjMgr;
+                break;
             case kScValPluginObject:
             case kScValPluginArgPtr:
                 address = reg1.Ptr;
@@ -1177,22 +1360,22 @@ ccInstError ccInstance::Run(int32_t curpc)
             }
 
             // like memwriteptr, but doesn't attempt to free the old one
-            int32_t newHandle = ccGetObjectHandleFromAddress(address);
+            int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
             if (newHandle == -1)
                 return kInstErr_Generic;
 
             ccAddObjectReference(newHandle);
             _registers[SREG_MAR].WriteInt32(newHandle);
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMZEROPTR:
+        CASE_OP(SCMD_MEMZEROPTR):
         {
             int32_t handle = _registers[SREG_MAR].ReadInt32();
             ccReleaseObjectReference(handle);
             _registers[SREG_MAR].WriteInt32(0);
-            break;
+            NEXT_OP();
         }
-        case SCMD_MEMZEROPTRND:
+        CASE_OP(SCMD_MEMZEROPTRND):
         {
             int32_t handle = _registers[SREG_MAR].ReadInt32();
 
@@ -1205,37 +1388,37 @@ ccInstError ccInstance::Run(int32_t curpc)
             ccReleaseObjectReference(handle);
             pool.disableDisposeForObject = nullptr;
             _registers[SREG_MAR].WriteInt32(0);
-            break;
+            NEXT_OP();
         }
-        case SCMD_CHECKNULL:
+        CASE_OP(SCMD_CHECKNULL):
             if (_registers[SREG_MAR].IsNull())
             {
                 cc_error("!Null pointer referenced");
                 return kInstErr_Generic;
             }
-            break;
-        case SCMD_CHECKNULLREG:
+            NEXT_OP();
+        CASE_OP(SCMD_CHECKNULLREG):
         {
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             if (reg1.IsNull())
             {
                 cc_error("!Null string referenced");
                 return kInstErr_Generic;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_NUMFUNCARGS:
+        CASE_OP(SCMD_NUMFUNCARGS):
         {
-            const auto arg_lit = codeOp.Arg1i();
+            const auto arg_lit = codeOp->Arg1i();
             num_args_to_func = arg_lit;
-            break;
+            NEXT_OP();
         }
-        case SCMD_CALLAS:
+        CASE_OP(SCMD_CALLAS):
         {
             PUSH_CALL_STACK();
 
             // Call to a function in another script
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
 
             // If there are nested CALLAS calls, the stack might
             // contain 2 calls worth of parameters, so only
@@ -1260,7 +1443,7 @@ ccInstError ccInstance::Run(int32_t curpc)
             ccInstance *wasRunning = _runningInst;
 
             // extract the instance ID
-            int32_t instId = codeOp.Instruction.InstanceId;
+            int32_t instId = codeOp->Instruction.InstanceId;
             // determine the offset into the code of the instance we want
             _runningInst = LoadedInstances[instId];
             uintptr_t callAddr = reg1.PtrU8 - reinterpret_cast<uint8_t*>(_runningInst->_code);
@@ -1271,6 +1454,11 @@ ccInstError ccInstance::Run(int32_t curpc)
             }
             callAddr /= sizeof(uintptr_t); // size of ccScript::code elements
 
+            if (profiler)
+            {
+                profiler->EnterFunction(_runningInst->_instanceof.get(), static_cast<int32_t>(callAddr), profOps);
+                profOps = 0u;
+            }
             if (Run(static_cast<int32_t>(callAddr)))
                 return kInstErr_Generic;
 
@@ -1285,12 +1473,12 @@ ccInstError ccInstance::Run(int32_t curpc)
             was_just_callas = func_callstack.Count;
             num_args_to_func = -1;
             POP_CALL_STACK();
-            break;
+            NEXT_OP();
         }
-        case SCMD_CALLEXT:
+        CASE_OP(SCMD_CALLEXT):
         {
             // Call to a real 'C' code function
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
 
             was_just_callas = -1;
             if (num_args_to_func < 0)
@@ -1306,6 +1494,11 @@ ccInstError ccInstance::Run(int32_t curpc)
             }
 
             RuntimeScriptValue return_value;
+            if (profiler)
+            {
+                profiler->EnterApi(reg1, profOps);
+                profOps = 0u;
+            }
 
             if (reg1.Type == kScValPluginFunction)
             {
@@ -1347,6 +1540,8 @@ ccInstError ccInstance::Run(int32_t curpc)
                 cc_error("invalid pointer type for function call: %d", reg1.Type);
             }
 
+            if (profiler)
+                profiler->LeaveApi();
             if (cc_has_error())
             {
                 return kInstErr_Generic;
@@ -1355,17 +1550,17 @@ ccInstError ccInstance::Run(int32_t curpc)
             _registers[SREG_AX] = return_value;
             next_call_needs_object = 0;
             num_args_to_func = -1;
-            break;
+            NEXT_OP();
         }
-        case SCMD_PUSHREAL:
+        CASE_OP(SCMD_PUSHREAL):
         {
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             PushToFuncCallStack(func_callstack, reg1);
-            break;
+            NEXT_OP();
         }
-        case SCMD_SUBREALSTACK:
+        CASE_OP(SCMD_SUBREALSTACK):
         {
-            const auto arg_lit = codeOp.Arg1i();
+            const auto arg_lit = codeOp->Arg1i();
             PopFromFuncCallStack(func_callstack, arg_lit);
             if (was_just_callas >= 0)
             {
@@ -1373,12 +1568,12 @@ ccInstError ccInstance::Run(int32_t curpc)
                 PopValuesFromStack(arg_lit);
                 was_just_callas = -1;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_CALLOBJ:
+        CASE_OP(SCMD_CALLOBJ):
         {
             // set the OP register
-            const auto &reg1 = _registers[codeOp.Arg1i()];
+            const auto &reg1 = _registers[codeOp->Arg1i()];
             if (reg1.IsNull())
             {
                 cc_error("!Null pointer referenced");
@@ -1410,34 +1605,34 @@ ccInstError ccInstance::Run(int32_t curpc)
                 return kInstErr_Generic;
             }
             next_call_needs_object = 1;
-            break;
+            NEXT_OP();
         }
-        case SCMD_SHIFTLEFT:
+        CASE_OP(SCMD_SHIFTLEFT):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32(reg1.IValue << reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_SHIFTRIGHT:
+        CASE_OP(SCMD_SHIFTRIGHT):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetInt32(reg1.IValue >> reg2.IValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_THISBASE:
+        CASE_OP(SCMD_THISBASE):
         {
-            const auto arg_lit = codeOp.Arg1i();
+            const auto arg_lit = codeOp->Arg1i();
             thisbase[curnest] = arg_lit;
-            break;
+            NEXT_OP();
         }
-        case SCMD_NEWARRAY:
+        CASE_OP(SCMD_NEWARRAY):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             const int arg_elnum = reg1.IValue;
-            const uint32_t arg_elsize = static_cast<uint32_t>(codeOp.Arg2i());
-            const bool arg_managed = codeOp.Arg3().GetAsBool();
+            const uint32_t arg_elsize = static_cast<uint32_t>(codeOp->Arg2i());
+            const bool arg_managed = codeOp->Arg3().GetAsBool();
             if (arg_elnum < 0)
             {
                 cc_error("Invalid size for dynamic array; requested: %d, range: 0..%d", arg_elnum, INT32_MAX);
@@ -1445,12 +1640,12 @@ ccInstError ccInstance::Run(int32_t curpc)
             }
             DynObjectRef ref = CCDynamicArray::Create(static_cast<uint32_t>(arg_elnum), arg_elsize, arg_managed);
             reg1.SetScriptObject(ref.Obj, &globalDynamicArray);
-            break;
+            NEXT_OP();
         }
-        case SCMD_NEWUSEROBJECT:
+        CASE_OP(SCMD_NEWUSEROBJECT):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
-            const uint32_t arg_size = static_cast<uint32_t>(codeOp.Arg2i());
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            const uint32_t arg_size = static_cast<uint32_t>(codeOp->Arg2i());
             if (arg_size > INT32_MAX)
             {
                 cc_error("Invalid size for user object; requested: %u, range: 0..%d", arg_size, INT32_MAX);
@@ -1458,86 +1653,86 @@ ccInstError ccInstance::Run(int32_t curpc)
             }
             DynObjectRef ref = ScriptUserObject::Create(arg_size);
             reg1.SetScriptObject(ref.Obj, ref.Mgr);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FADD:
+        CASE_OP(SCMD_FADD):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
-            const auto arg_lit = codeOp.Arg2i();
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            const auto arg_lit = codeOp->Arg2i();
             reg1.SetFloat(reg1.FValue + arg_lit); // arg2 was used as int here originally
-            break;
+            NEXT_OP();
         }
-        case SCMD_FSUB:
+        CASE_OP(SCMD_FSUB):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
-            const auto arg_lit = codeOp.Arg2i();
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            const auto arg_lit = codeOp->Arg2i();
             reg1.SetFloat(reg1.FValue - arg_lit); // arg2 was used as int here originally
-            break;
+            NEXT_OP();
         }
-        case SCMD_FMULREG:
+        CASE_OP(SCMD_FMULREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloat(reg1.FValue * reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FDIVREG:
+        CASE_OP(SCMD_FDIVREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             if (reg2.FValue == 0.0)
             {
                 cc_error("!Floating point divide by zero");
                 return kInstErr_Generic;
             }
             reg1.SetFloat(reg1.FValue / reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FADDREG:
+        CASE_OP(SCMD_FADDREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloat(reg1.FValue + reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FSUBREG:
+        CASE_OP(SCMD_FSUBREG):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloat(reg1.FValue - reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FGREATER:
+        CASE_OP(SCMD_FGREATER):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FLESSTHAN:
+        CASE_OP(SCMD_FLESSTHAN):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FGTE:
+        CASE_OP(SCMD_FGTE):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_FLTE:
+        CASE_OP(SCMD_FLTE):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
-            break;
+            NEXT_OP();
         }
-        case SCMD_ZEROMEMORY:
+        CASE_OP(SCMD_ZEROMEMORY):
         {
-            const auto arg_size = codeOp.Arg1i();
+            const auto arg_size = codeOp->Arg1i();
             // Check if we are zeroing at stack tail
             if (_registers[SREG_MAR] == _registers[SREG_SP])
             {
@@ -1554,20 +1749,20 @@ ccInstError ccInstance::Run(int32_t curpc)
                     _registers[SREG_MAR].Type);
                 return kInstErr_Generic;
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_CREATESTRING:
+        CASE_OP(SCMD_CREATESTRING):
         {
-            auto &reg1 = _registers[codeOp.Arg1i()];
+            auto &reg1 = _registers[codeOp->Arg1i()];
             const char *ptr = reinterpret_cast<const char*>(reg1.GetDirectPtr());
             DynObjectRef ref = ScriptString::Create(ptr);
             reg1.SetScriptObject(ref.Obj, &myScriptStringImpl);
-            break;
+            NEXT_OP();
         }
-        case SCMD_STRINGSEQUAL:
+        CASE_OP(SCMD_STRINGSEQUAL):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             if ((reg1.IsNull()) || (reg2.IsNull()))
             {
                 cc_error("!Null pointer referenced");
@@ -1577,14 +1772,17 @@ ccInstError ccInstance::Run(int32_t curpc)
             {
                 const char *ptr1 = reinterpret_cast<const char*>(reg1.GetDirectPtr());
                 const char *ptr2 = reinterpret_cast<const char*>(reg2.GetDirectPtr());
-                reg1.SetInt32AsBool(strcmp(ptr1, ptr2) == 0);
+                // Script strings are compared by their interned pointers and hashes
+                const bool equal = (ScriptString::IsScriptString(reg1) && ScriptString::IsScriptString(reg2)) ?
+                    ScriptString::Equals(ptr1, ptr2) : (strcmp(ptr1, ptr2) == 0);
+                reg1.SetInt32AsBool(equal);
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_STRINGSNOTEQ:
+        CASE_OP(SCMD_STRINGSNOTEQ):
         {
-            auto       &reg1 = _registers[codeOp.Arg1i()];
-            const auto &reg2 = _registers[codeOp.Arg2i()];
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
             if ((reg1.IsNull()) || (reg2.IsNull()))
             {
                 cc_error("!Null pointer referenced");
@@ -1594,22 +1792,135 @@ ccInstError ccInstance::Run(int32_t curpc)
             {
                 const char *ptr1 = reinterpret_cast<const char*>(reg1.GetDirectPtr());
                 const char *ptr2 = reinterpret_cast<const char*>(reg2.GetDirectPtr());
-                reg1.SetInt32AsBool(strcmp(ptr1, ptr2) != 0);
+                const bool equal = (ScriptString::IsScriptString(reg1) && ScriptString::IsScriptString(reg2)) ?
+                    ScriptString::Equals(ptr1, ptr2) : (strcmp(ptr1, ptr2) == 0);
+                reg1.SetInt32AsBool(!equal);
             }
-            break;
+            NEXT_OP();
         }
-        case SCMD_LOOPCHECKOFF:
+        CASE_OP(SCMD_LOOPCHECKOFF):
             if (loopIterationCheckDisabled == 0)
                 loopIterationCheckDisabled++;
-            break;
-        default:
-            cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
+            NEXT_OP();
+        // Superinstructions, only found in the pre-decoded code;
+        // each must have exactly the same effect as the sequence it replaced
+        CASE_OP(SCMDX_LOADSPOFFS_MEMREAD):
+        {
+            _registers[SREG_MAR] = GetStackPtrOffsetRw(codeOp->Arg1i());
+            ASSERT_CC_ERROR();
+            _registers[codeOp->Arg2i()] = _registers[SREG_MAR].ReadValue();
+            NEXT_OP_SPAN(4);
+        }
+        CASE_OP(SCMDX_LOADSPOFFS_MEMWRITE):
+        {
+            _registers[SREG_MAR] = GetStackPtrOffsetRw(codeOp->Arg1i());
+            ASSERT_CC_ERROR();
+            _registers[SREG_MAR].WriteValue(_registers[codeOp->Arg2i()]);
+            NEXT_OP_SPAN(4);
+        }
+        CASE_OP(SCMDX_LITTOREG_ADDREG):
+        {
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            reg1 = codeOp->Arg2();
+            _registers[codeOp->Arg3i()].IValue += reg1.IValue;
+            NEXT_OP_SPAN(6);
+        }
+        CASE_OP(SCMDX_PUSH_LITTOREG_POP):
+        {
+            auto &reg1 = _registers[codeOp->Arg1i()];
+            ASSERT_STACK_SPACE_VALS(1);
+            PushValueToStack(reg1);
+            reg1 = codeOp->Arg2();
+            _registers[codeOp->Arg3i()] = PopValueFromStack();
+            NEXT_OP_SPAN(7);
+        }
+        CASE_OP(SCMDX_ISEQUAL_JZ):
+        {
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
+            reg1.SetInt32AsBool(reg1 == reg2);
+            _registers[SREG_AX] = reg1;
+            if (_registers[SREG_AX].IsNull())
+                _pc += codeOp->Arg3i();
+            NEXT_OP_SPAN(8);
+        }
+        CASE_OP(SCMDX_NOTEQUAL_JZ):
+        {
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
+            reg1.SetInt32AsBool(reg1 != reg2);
+            _registers[SREG_AX] = reg1;
+            if (_registers[SREG_AX].IsNull())
+                _pc += codeOp->Arg3i();
+            NEXT_OP_SPAN(8);
+        }
+        CASE_OP(SCMDX_GREATER_JZ):
+        {
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
+            reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
+            _registers[SREG_AX] = reg1;
+            if (_registers[SREG_AX].IsNull())
+                _pc += codeOp->Arg3i();
+            NEXT_OP_SPAN(8);
+        }
+        CASE_OP(SCMDX_LESSTHAN_JZ):
+        {
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
+            reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
+            _registers[SREG_AX] = reg1;
+            if (_registers[SREG_AX].IsNull())
+                _pc += codeOp->Arg3i();
+            NEXT_OP_SPAN(8);
+        }
+        CASE_OP(SCMDX_GTE_JZ):
+        {
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
+            reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
+            _registers[SREG_AX] = reg1;
+            if (_registers[SREG_AX].IsNull())
+                _pc += codeOp->Arg3i();
+            NEXT_OP_SPAN(8);
+        }
+        CASE_OP(SCMDX_LTE_JZ):
+        {
+            auto       &reg1 = _registers[codeOp->Arg1i()];
+            const auto &reg2 = _registers[codeOp->Arg2i()];
+            reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
+            _registers[SREG_AX] = reg1;
+            if (_registers[SREG_AX].IsNull())
+                _pc += codeOp->Arg3i();
+            NEXT_OP_SPAN(8);
+        }
+        CASE_OP(SCMDX_LITTOREG_IMPORT):
+        {
+            // Imports may be registered and unregistered at runtime (e.g. room script's
+            // exports), so the cached value is only valid for the same imports generation
+            ScriptImportCache &cache = codeInst->_importCache[codeOp->Arg3i()];
+            if (cache.Generation == simp.GetGeneration())
+            {
+                _importCacheHits++;
+            }
+            else
+            {
+                _importCacheMisses++;
+                RuntimeScriptValue arg_value;
+                FixupArgument(arg_value, FIXUP_IMPORT, codeOp->Arg2i(), nullptr, nullptr);
+                ASSERT_CC_ERROR();
+                cache.Value = arg_value;
+                cache.Generation = simp.GetGeneration();
+            }
+            _registers[codeOp->Arg1i()] = cache.Value;
+            NEXT_OP_SPAN(3);
+        }
+        DEFAULT_OP():
+            cc_error("instruction %d is not implemented", codeOp->Instruction.Code);
             return kInstErr_Generic;
         }
         /* End perform operation */
         //=====================================================================
-
-        _pc += codeOp.ArgCount + 1;
     }
     return kInstErr_None;
 }
@@ -1642,6 +1953,13 @@ RuntimeScriptValue ccInstance::GetSymbolAddress(const String &symname) const
     return (exp_index < UINT32_MAX) ? _scriptData->exports[exp_index] : RuntimeScriptValue();
 }
 
+const ScriptOperation *ccInstance::GetPredecodedOp(int32_t pc) const
+{
+    if (!_ops || (pc < 0) || (static_cast<uint32_t>(pc) >= _codesize))
+        return nullptr;
+    return &_ops[_op_index[pc]];
+}
+
 void ccInstance::DumpInstruction(const ScriptOperation &op) const
 {
     // line_num local var should be shared between all the instances
@@ -1657,7 +1975,7 @@ void ccInstance::DumpInstruction(const ScriptOperation &op) const
     TextStreamWriter writer(std::move(data_s));
     writer.WriteFormat("Line %3d, IP:%8d (SP:%p) ", line_num, _pc, _registers[SREG_SP].RValue);
 
-    const ScriptCommandInfo &cmd_info = sccmd_info[op.Instruction.Code];
+    const ScriptCommandInfo &cmd_info = get_cmd_info(op.Instruction.Code);
     writer.WriteString(cmd_info.CmdName);
 
     for (int i = 0; i < cmd_info.ArgCount; ++i)
@@ -1791,6 +2109,13 @@ bool ccInstance::_Create(PScript scri, const ccInstance *joined)
     _code = _scriptData->code.data();
     _codesize = static_cast<int32_t>(_scriptData->code.size());
     _code_fixups = _scriptData->code_fixups.data();
+    if (!_scriptData->ops.empty())
+    {
+        _ops = _scriptData->ops.data();
+        _op_index = _scriptData->op_index.data();
+        _op_fixups = _scriptData->op_fixups.data();
+        _importCache = _scriptData->import_cache.data();
+    }
 
     // If this is a primary script's instance:
     // * register it in the loadedInstances array,
@@ -1865,6 +2190,8 @@ void ccInstance::Free()
         if (_instanceof->instances == 0)
         {
             simp.RemoveScriptExports(this);
+            if (_profiler)
+                _profiler->ForgetScript(_instanceof.get());
         }
     }
 
@@ -1876,6 +2203,10 @@ void ccInstance::Free()
     _scriptData = nullptr;
     _code = nullptr;
     _codesize = 0;
+    _ops = nullptr;
+    _op_index = nullptr;
+    _op_fixups = nullptr;
+    _importCache = nullptr;
     _strings = nullptr;
     _stringsize = 0u;
 
@@ -2198,9 +2529,197 @@ bool ccInstance::ResolveImportFixups()
         if (import->InstancePtr != nullptr && (_code[fixup + 1] & INSTANCE_ID_REMOVEMASK) == SCMD_CALLEXT)
             _code[fixup + 1] = SCMD_CALLAS | (import->InstancePtr->_loadedInstanceId << INSTANCE_ID_SHIFT);
     }
+
+    // The bytecode is final now, so it may be pre-decoded
+    if (_predecode)
+        CreatePredecodedCode();
     return true;
 }
 
+bool ccInstance::CreatePredecodedCode()
+{
+    auto &ops = _scriptData->ops;
+    auto &op_index = _scriptData->op_index;
+    auto &op_fixups = _scriptData->op_fixups;
+    auto &import_cache = _scriptData->import_cache;
+    ops.clear();
+    import_cache.clear();
+    // Bytecode positions which are not the instruction's start
+    // (or beyond the code's end) are pointing to the invalid instruction #0
+    op_index.assign(_codesize + 1, 0u);
+    op_fixups.assign(_code_fixups, _code_fixups + _codesize);
+    ops.emplace_back();
+
+    for (uint32_t pc = 0; pc < _codesize;)
+    {
+        ScriptOperation op;
+        op.Instruction.Code = static_cast<int32_t>(_code[pc]);
+        op.Instruction.InstanceId = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+        op.Instruction.Code &= INSTANCE_ID_REMOVEMASK;
+        if (op.Instruction.Code <= 0 || op.Instruction.Code >= CC_NUM_SCCMDS ||
+            pc + sccmd_info[op.Instruction.Code].ArgCount >= _codesize)
+        {
+            Debug::Printf(kDbgMsg_Warn, "WARNING: script '%s': invalid instruction %d at %u, cannot pre-decode the script",
+                _instanceof->GetScriptName().c_str(), op.Instruction.Code, pc);
+            ops.clear();
+            op_index.clear();
+            op_fixups.clear();
+            import_cache.clear();
+            return false;
+        }
+
+        op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+        for (int i = 0; i < op.ArgCount; ++i)
+            op.Args[i].SetInt32(static_cast<int32_t>(_code[pc + 1 + i]));
+
+        // Apply fixups which do not depend on the runtime state; these are
+        // only applied to the literal argument of WRITELIT and LITTOREG
+        if (op.Instruction.Code == SCMD_WRITELIT || op.Instruction.Code == SCMD_LITTOREG)
+        {
+            const uint8_t fixup = _code_fixups[pc + 2];
+            if (fixup == FIXUP_GLOBALDATA || fixup == FIXUP_FUNCTION || fixup == FIXUP_STRING)
+            {
+                FixupArgument(op.Args[1], fixup, _code[pc + 2], nullptr, _strings);
+                op_fixups[pc + 2] = FIXUP_NOFIXUP;
+            }
+        }
+
+        // Imports are resolved at runtime, but each reference gets its own cache
+        if (_useImportCache && op.Instruction.Code == SCMD_LITTOREG && _code_fixups[pc + 2] == FIXUP_IMPORT)
+        {
+            op.Instruction.Code = SCMDX_LITTOREG_IMPORT;
+            op.Args[2].SetInt32(static_cast<int32_t>(import_cache.size()));
+            op.ArgCount = 3;
+            import_cache.emplace_back();
+            op_fixups[pc + 2] = FIXUP_NOFIXUP;
+        }
+
+        op_index[pc] = static_cast<uint32_t>(ops.size());
+        ops.push_back(op);
+        pc += sccmd_info[_code[pc] & INSTANCE_ID_REMOVEMASK].ArgCount + 1;
+    }
+
+    FuseSuperInstructions();
+
+    _ops = ops.data();
+    _op_index = op_index.data();
+    _op_fixups = op_fixups.data();
+    _importCache = import_cache.data();
+    return true;
+}
+
+void ccInstance::FuseSuperInstructions()
+{
+    auto &ops = _scriptData->ops;
+    const auto &op_fixups = _scriptData->op_fixups;
+    // Instruction #0 is the invalid instruction placeholder, the real code starts at #1.
+    // Find out each instruction's bytecode position, and mark the positions
+    // which any jump instruction leads to.
+    std::vector<uint32_t> op_pc(ops.size() + 1, _codesize);
+    std::vector<bool> jump_dest(_codesize + 1, false);
+    for (uint32_t pc = 0, i = 1; pc < _codesize; ++i)
+    {
+        const int32_t code = _code[pc] & INSTANCE_ID_REMOVEMASK;
+        const uint32_t next_pc = pc + sccmd_info[code].ArgCount + 1;
+        op_pc[i] = pc;
+        if (code == SCMD_JZ || code == SCMD_JNZ || code == SCMD_JMP)
+        {
+            const int64_t dest = static_cast<int64_t>(next_pc) + static_cast<int32_t>(_code[pc + 1]);
+            if (dest >= 0 && dest <= _codesize)
+                jump_dest[static_cast<uint32_t>(dest)] = true;
+        }
+        pc = next_pc;
+    }
+
+    // A sequence which any jump leads into the middle of is left unfused.
+    // The replaced instructions are kept in the stream after the first one
+    // regardless, so that a call into the middle of a sequence still finds
+    // a valid instruction.
+    for (size_t i = 1; i + 1 < ops.size(); ++i)
+    {
+        if (jump_dest[op_pc[i + 1]])
+            continue;
+        const ScriptOperation &op1 = ops[i];
+        const ScriptOperation *op2 = &ops[i + 1];
+        const ScriptOperation *op3 = (i + 2 < ops.size() && !jump_dest[op_pc[i + 2]]) ? &ops[i + 2] : nullptr;
+        const uint32_t pc = op_pc[i];
+
+        ScriptOperation fused;
+        fused.Instruction.Code = 0;
+        switch (op1.Instruction.Code)
+        {
+        case SCMD_LOADSPOFFS:
+            // LOADSPOFFS off; MEMREAD/MEMWRITE reg
+            if (op2->Instruction.Code == SCMD_MEMREAD || op2->Instruction.Code == SCMD_MEMWRITE)
+            {
+                fused.Instruction.Code = (op2->Instruction.Code == SCMD_MEMREAD) ?
+                    SCMDX_LOADSPOFFS_MEMREAD : SCMDX_LOADSPOFFS_MEMWRITE;
+                fused.Args[0] = op1.Args[0];
+                fused.Args[1] = op2->Args[0];
+                fused.ArgCount = 2;
+            }
+            break;
+        case SCMD_LITTOREG:
+            // LITTOREG reg, lit; ADDREG reg3, reg; only if literal has no runtime fixup
+            if (op_fixups[pc + 2] == FIXUP_NOFIXUP &&
+                op2->Instruction.Code == SCMD_ADDREG && op2->Args[1].IValue == op1.Args[0].IValue)
+            {
+                fused.Instruction.Code = SCMDX_LITTOREG_ADDREG;
+                fused.Args[0] = op1.Args[0];
+                fused.Args[1] = op1.Args[1];
+                fused.Args[2] = op2->Args[0];
+                fused.ArgCount = 3;
+            }
+            break;
+        case SCMD_PUSHREG:
+            // PUSHREG reg; LITTOREG reg, lit; POPREG reg3; only if literal has no runtime fixup
+            if (op3 && op2->Instruction.Code == SCMD_LITTOREG && op3->Instruction.Code == SCMD_POPREG &&
+                op_fixups[pc + 2 + 2] == FIXUP_NOFIXUP && op2->Args[0].IValue == op1.Args[0].IValue)
+            {
+                fused.Instruction.Code = SCMDX_PUSH_LITTOREG_POP;
+                fused.Args[0] = op1.Args[0];
+                fused.Args[1] = op2->Args[1];
+                fused.Args[2] = op3->Args[0];
+                fused.ArgCount = 3;
+            }
+            break;
+        case SCMD_ISEQUAL:
+        case SCMD_NOTEQUAL:
+        case SCMD_GREATER:
+        case SCMD_LESSTHAN:
+        case SCMD_GTE:
+        case SCMD_LTE:
+            // CMP reg1, reg2; REGTOREG reg1, AX; JZ off
+            if (op3 && op2->Instruction.Code == SCMD_REGTOREG && op3->Instruction.Code == SCMD_JZ &&
+                op2->Args[0].IValue == op1.Args[0].IValue && op2->Args[1].IValue == SREG_AX)
+            {
+                switch (op1.Instruction.Code)
+                {
+                case SCMD_ISEQUAL: fused.Instruction.Code = SCMDX_ISEQUAL_JZ; break;
+                case SCMD_NOTEQUAL: fused.Instruction.Code = SCMDX_NOTEQUAL_JZ; break;
+                case SCMD_GREATER: fused.Instruction.Code = SCMDX_GREATER_JZ; break;
+                case SCMD_LESSTHAN: fused.Instruction.Code = SCMDX_LESSTHAN_JZ; break;
+                case SCMD_GTE: fused.Instruction.Code = SCMDX_GTE_JZ; break;
+                default: fused.Instruction.Code = SCMDX_LTE_JZ; break;
+                }
+                fused.Args[0] = op1.Args[0];
+                fused.Args[1] = op1.Args[1];
+                fused.Args[2] = op3->Args[0];
+                fused.ArgCount = 3;
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (fused.Instruction.Code != 0)
+        {
+            fused.Instruction.InstanceId = op1.Instruction.InstanceId;
+            ops[i] = fused;
+        }
+    }
+}
+
 void ccInstance::CopyGlobalData(const std::vector<uint8_t> &data)
 {
     const size_t copy_sz = std::min(data.size(), _scriptData->globaldata.size());
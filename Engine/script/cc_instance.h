@@ -96,7 +96,16 @@ struct ScriptVariable
     RuntimeScriptValue  RValue;
 };
 
+// Inline cache of a resolved import, used by the pre-decoded code:
+// holds the import's value for as long as the imports table is not changed
+struct ScriptImportCache
+{
+    uint32_t            Generation = 0u; // imports table generation, 0 = not resolved
+    RuntimeScriptValue  Value;
+};
+
 struct FunctionCallStack;
+class ScriptProfiler;
 
 struct ScriptPosition
 {
@@ -139,6 +148,17 @@ public:
     static std::unique_ptr<ccInstance> CreateFromScript(PScript script);
     static std::unique_ptr<ccInstance> CreateEx(PScript scri, const ccInstance * joined);
     static void SetExecTimeout(unsigned sys_poll_ms, unsigned abort_ms, unsigned abort_loops);
+    // Sets whether the scripts should be pre-decoded into the instruction stream
+    // when loaded; applies to the scripts loaded after this call
+    static void SetPredecode(bool on);
+    // Sets whether the pre-decoded code should cache the resolved imports;
+    // applies to the scripts loaded after this call
+    static void SetImportCache(bool on);
+    // Gets the total number of the import cache hits and misses, in the pre-decoded code
+    static void GetImportCacheStats(uint32_t &hits, uint32_t &misses);
+    // Sets the profiler which receives the script execution events;
+    // pass null to disable profiling
+    static void SetProfiler(ScriptProfiler *profiler);
 
     ccInstance() = default;
     ~ccInstance();
@@ -175,6 +195,9 @@ public:
     // Get the address of an exported symbol (function or variable) in the script
     RuntimeScriptValue GetSymbolAddress(const Common::String &symname) const;
     void    DumpInstruction(const ScriptOperation &op) const;
+    // Get the pre-decoded instruction at the given bytecode position,
+    // returns null if the script was not pre-decoded
+    const ScriptOperation *GetPredecodedOp(int32_t pc) const;
     // Tells whether this instance is in the process of executing the byte-code
     bool    IsBeingRun() const;
     // Notifies that the game was being updated (script not hanging)
@@ -200,6 +223,13 @@ private:
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(const ccScript *scri);
+    // Decodes the fixed up bytecode into the instruction stream, which is run
+    // in place of the raw bytecode; returns false if the bytecode could not be
+    // decoded, in which case the instance will keep running the bytecode.
+    bool    CreatePredecodedCode();
+    // Replaces the frequent instruction sequences in the pre-decoded code
+    // with the internal superinstructions.
+    void    FuseSuperInstructions();
     bool    ResolveExports(const ccScript *scri);
     // Registers this script's resolved exports as imports in the symbol import table
     bool    ImportScriptExports(const ccScript *scri);
@@ -259,6 +289,14 @@ private:
         ScriptSymbolsMap        export_lookup;
         // Array of real import indexes used in script
         std::vector<uint32_t>   resolved_imports;
+        // Pre-decoded instructions, with the load-time fixups already applied
+        std::vector<ScriptOperation> ops;
+        // Index of a pre-decoded instruction for each bytecode position
+        std::vector<uint32_t>   op_index;
+        // Fixups which have to be applied at runtime (stack and imports)
+        std::vector<uint8_t>    op_fixups;
+        // Inline caches of the import references in the pre-decoded code
+        std::vector<ScriptImportCache> import_cache;
 
         ResolvedScriptData();
     };
@@ -268,6 +306,10 @@ private:
     intptr_t   *_code = nullptr;
     uint32_t    _codesize = 0; // size of code is limited under 32-bit due to bytecode format
     const uint8_t *_code_fixups = nullptr;
+    const ScriptOperation *_ops = nullptr; // pre-decoded instructions, if available
+    const uint32_t *_op_index = nullptr;
+    const uint8_t *_op_fixups = nullptr;
+    ScriptImportCache *_importCache = nullptr;
     const char *_strings = nullptr; // pointer to ccScript's string data
     size_t      _stringsize = 0u;
 
@@ -299,6 +341,15 @@ private:
     // Maximal while loops without any engine update in between,
     // after which the interpreter will abort
     static unsigned _maxWhileLoops;
+    // Whether to pre-decode the newly loaded scripts
+    static bool _predecode;
+    // Whether the pre-decoded code caches the resolved imports
+    static bool _useImportCache;
+    // Import cache statistics
+    static uint32_t _importCacheHits;
+    static uint32_t _importCacheMisses;
+    // Script profiler, if enabled
+    static ScriptProfiler *_profiler;
     // Last time the script was noted of being "alive"
     AGS::Engine::FastClock::time_point _lastAliveTs;
 };
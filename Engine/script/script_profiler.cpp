@@ -0,0 +1,359 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "script/script_profiler.h"
+#include <algorithm>
+#include "script/cc_script.h"
+#include "script/script_runtime.h"
+#include "script/systemimports.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Max number of lines to print in the report
+static const size_t MaxReportLines = 200u;
+
+uint32_t ScriptProfiler::FuncKeyTraits::Hash(const FuncKey &key)
+{
+    const uint64_t code = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key.Code));
+    return IndexPairTraits::Hash(code ^ (static_cast<uint64_t>(key.Address) << 3));
+}
+
+uint32_t ScriptProfiler::IndexPairTraits::Hash(uint64_t key)
+{
+    // 64-bit mix function, taken from the MurmurHash3 finalizer
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<uint32_t>(key);
+}
+
+static uint64_t MakeIndexPair(uint32_t hi, uint32_t lo)
+{
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+static double ToMs(Clock::duration dur)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(dur).count() * 0.001;
+}
+
+void ScriptProfiler::Reset()
+{
+    _funcs.clear();
+    _lines.clear();
+    _nodes.clear();
+    _frames.clear();
+    _funcByCode.clear();
+    _funcByName.clear();
+    _lineByKey.clear();
+    _nodeByKey.clear();
+}
+
+void ScriptProfiler::EnterFunction(const ccScript *script, int32_t pc, uint32_t ops)
+{
+    const auto now = Tick(ops);
+    PushFrame(GetScriptFunc(script, pc), now);
+}
+
+void ScriptProfiler::LeaveFunction(uint32_t ops)
+{
+    if (_frames.empty())
+        return;
+    PopFrame(Tick(ops));
+}
+
+void ScriptProfiler::EnterApi(const RuntimeScriptValue &fn, uint32_t ops)
+{
+    const auto now = Tick(ops);
+    PushFrame(GetApiFunc(fn), now);
+}
+
+void ScriptProfiler::LeaveApi()
+{
+    if (_frames.empty())
+        return;
+    PopFrame(Tick(0u));
+}
+
+void ScriptProfiler::SetLine(int line, uint32_t ops)
+{
+    if (_frames.empty())
+        return;
+    const auto now = Tick(ops);
+    Frame &frame = _frames.back();
+    if (frame.Line != NoIndex)
+        _lines[frame.Line].Time += now - frame.LineStart;
+
+    uint32_t &line_index = _lineByKey[MakeIndexPair(frame.Func, static_cast<uint32_t>(line))];
+    if (line_index == 0u)
+    {
+        // line indexes are stored +1, to tell the newly added entry
+        _lines.push_back(LineStats());
+        _lines.back().Func = frame.Func;
+        _lines.back().Line = line;
+        line_index = static_cast<uint32_t>(_lines.size());
+    }
+    frame.Line = line_index - 1;
+    frame.LineStart = now;
+    _lines[frame.Line].Hits++;
+}
+
+void ScriptProfiler::Unwind(size_t depth)
+{
+    if (_frames.size() <= depth)
+        return;
+    const auto now = Tick(0u);
+    while (_frames.size() > depth)
+        PopFrame(now);
+}
+
+void ScriptProfiler::ForgetScript(const ccScript *script)
+{
+    // NOTE: erasing moves the last entry in place of the erased one
+    for (size_t i = 0; i < _funcByCode.size();)
+    {
+        const auto it = _funcByCode.begin() + i;
+        if (it->first.Code == script)
+            _funcByCode.erase(it);
+        else
+            ++i;
+    }
+}
+
+ScriptProfiler::Clock::time_point ScriptProfiler::Tick(uint32_t ops)
+{
+    const auto now = Clock::now();
+    if (!_frames.empty())
+    {
+        const Frame &frame = _frames.back();
+        const auto elapsed = now - _lastTime;
+        _nodes[frame.Node].SelfTime += elapsed;
+        _funcs[frame.Func].SelfTime += elapsed;
+        _funcs[frame.Func].Ops += ops;
+        if (frame.Line != NoIndex)
+            _lines[frame.Line].Ops += ops;
+    }
+    _lastTime = now;
+    return now;
+}
+
+void ScriptProfiler::PushFrame(uint32_t func, Clock::time_point now)
+{
+    const uint32_t parent = _frames.empty() ? NoIndex : _frames.back().Node;
+    uint32_t &node_index = _nodeByKey[MakeIndexPair(parent, func)];
+    if (node_index == 0u)
+    {
+        // node indexes are stored +1, to tell the newly added entry
+        _nodes.push_back(CallNode());
+        _nodes.back().Parent = parent;
+        _nodes.back().Func = func;
+        node_index = static_cast<uint32_t>(_nodes.size());
+    }
+
+    Frame frame;
+    frame.Node = node_index - 1;
+    frame.Func = func;
+    frame.Start = now;
+    _frames.push_back(frame);
+    _funcs[func].Calls++;
+    _funcs[func].Active++;
+}
+
+void ScriptProfiler::PopFrame(Clock::time_point now)
+{
+    const Frame &frame = _frames.back();
+    if (frame.Line != NoIndex)
+        _lines[frame.Line].Time += now - frame.LineStart;
+    // Only the outermost call of a recursive function counts in its total time
+    FunctionStats &fn = _funcs[frame.Func];
+    if (--fn.Active == 0u)
+        fn.TotalTime += now - frame.Start;
+    _frames.pop_back();
+}
+
+uint32_t ScriptProfiler::GetScriptFunc(const ccScript *script, int32_t pc)
+{
+    FuncKey key;
+    key.Code = script;
+    key.Address = pc;
+    const auto it = _funcByCode.find(key);
+    if (it != _funcByCode.end())
+        return it->second;
+
+    // Find the function's name among the script exports; the exported
+    // names are decorated with the number of arguments, after '$'
+    String name;
+    for (size_t i = 0; i < script->exports.size(); ++i)
+    {
+        const int32_t etype = (script->export_addr[i] >> 24L) & 0x000ff;
+        const int32_t eaddr = (script->export_addr[i] & 0x00ffffff);
+        if (etype == EXPORT_FUNCTION && eaddr == pc)
+        {
+            const std::string &exp_name = script->exports[i];
+            name = String(exp_name.c_str(), std::min(exp_name.size(), exp_name.find('$')));
+            break;
+        }
+    }
+    if (name.IsEmpty())
+        name.Format("func@%d", pc);
+
+    // NOTE: GetSectionName treats the section's starting offset as belonging
+    // to the previous section, while the function may start exactly there
+    const uint32_t func = AddFunc(script->GetSectionName(pc + 1).c_str(), name, false);
+    _funcByCode[key] = func;
+    return func;
+}
+
+uint32_t ScriptProfiler::GetApiFunc(const RuntimeScriptValue &fn)
+{
+    FuncKey key;
+    key.Code = fn.Ptr;
+    const auto it = _funcByCode.find(key);
+    if (it != _funcByCode.end())
+        return it->second;
+
+    // The registered API names may be decorated with the number of arguments, after '^'
+    String name = simp.FindName(fn);
+    if (name.IsEmpty())
+        name = "(unknown)";
+    else
+        name.TruncateToLeftSection('^');
+
+    const uint32_t func = AddFunc("", name, true);
+    _funcByCode[key] = func;
+    return func;
+}
+
+uint32_t ScriptProfiler::AddFunc(const String &section, const String &name, bool is_api)
+{
+    // Scripts may be reloaded (e.g. rooms), which gives their functions new
+    // addresses; but we want the stats to be accumulated per function name
+    const String full_name = is_api ? name : String::FromFormat("%s:%s", section.GetCStr(), name.GetCStr());
+    const auto it = _funcByName.find(full_name);
+    if (it != _funcByName.end())
+        return it->second;
+
+    FunctionStats fn;
+    fn.Section = section;
+    fn.Name = name;
+    fn.IsApi = is_api;
+    _funcs.push_back(fn);
+    const uint32_t func = static_cast<uint32_t>(_funcs.size() - 1);
+    _funcByName[full_name] = func;
+    return func;
+}
+
+String ScriptProfiler::GetFullName(uint32_t func) const
+{
+    const FunctionStats &fn = _funcs[func];
+    return fn.IsApi ? fn.Name : String::FromFormat("%s:%s", fn.Section.GetCStr(), fn.Name.GetCStr());
+}
+
+void ScriptProfiler::WriteFoldedStacks(TextWriter &out) const
+{
+    std::vector<uint32_t> stack;
+    for (const auto &node : _nodes)
+    {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(node.SelfTime).count();
+        if (us <= 0)
+            continue;
+        stack.clear();
+        for (const CallNode *n = &node; ; n = &_nodes[n->Parent])
+        {
+            stack.push_back(n->Func);
+            if (n->Parent == NoIndex)
+                break;
+        }
+
+        String line;
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it)
+        {
+            if (it != stack.rbegin())
+                line.AppendChar(';');
+            line.Append(GetFullName(*it));
+        }
+        line.AppendFmt(" %lld", static_cast<long long>(us));
+        out.WriteLine(line);
+    }
+}
+
+void ScriptProfiler::WriteReport(TextWriter &out) const
+{
+    Clock::duration total_time{};
+    for (const auto &node : _nodes)
+        if (node.Parent == NoIndex)
+            total_time += _funcs[node.Func].TotalTime;
+    uint64_t total_ops = 0u;
+    for (const auto &fn : _funcs)
+        total_ops += fn.Ops;
+
+    out.WriteLine("Script profile");
+    out.WriteFormat("Total script time: %.3f ms, instructions executed: %llu\n",
+        ToMs(total_time), static_cast<unsigned long long>(total_ops));
+
+    // Functions sorted by the self time
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < _funcs.size(); ++i)
+        if (!_funcs[i].IsApi)
+            order.push_back(i);
+    std::sort(order.begin(), order.end(),
+        [this](uint32_t a, uint32_t b) { return _funcs[a].SelfTime > _funcs[b].SelfTime; });
+    out.WriteLine("");
+    out.WriteLine("Script functions, by self time:");
+    out.WriteFormat("%10s %12s %12s %14s  %s\n", "Calls", "Total ms", "Self ms", "Instructions", "Function");
+    for (uint32_t i : order)
+    {
+        const FunctionStats &fn = _funcs[i];
+        out.WriteFormat("%10u %12.3f %12.3f %14llu  %s\n", fn.Calls, ToMs(fn.TotalTime), ToMs(fn.SelfTime),
+            static_cast<unsigned long long>(fn.Ops), GetFullName(i).GetCStr());
+    }
+
+    // Engine API functions sorted by the total time
+    order.clear();
+    for (uint32_t i = 0; i < _funcs.size(); ++i)
+        if (_funcs[i].IsApi)
+            order.push_back(i);
+    std::sort(order.begin(), order.end(),
+        [this](uint32_t a, uint32_t b) { return _funcs[a].TotalTime > _funcs[b].TotalTime; });
+    out.WriteLine("");
+    out.WriteLine("Engine API calls, by total time:");
+    out.WriteFormat("%10s %12s %12s  %s\n", "Calls", "Total ms", "Self ms", "Function");
+    for (uint32_t i : order)
+    {
+        const FunctionStats &fn = _funcs[i];
+        out.WriteFormat("%10u %12.3f %12.3f  %s\n", fn.Calls, ToMs(fn.TotalTime), ToMs(fn.SelfTime),
+            fn.Name.GetCStr());
+    }
+
+    // Lines sorted by the time, which includes the functions called
+    order.clear();
+    for (uint32_t i = 0; i < _lines.size(); ++i)
+        order.push_back(i);
+    std::sort(order.begin(), order.end(),
+        [this](uint32_t a, uint32_t b) { return _lines[a].Time > _lines[b].Time; });
+    if (order.size() > MaxReportLines)
+        order.resize(MaxReportLines);
+    out.WriteLine("");
+    out.WriteFormat("Script lines, by time including calls (top %u):\n", static_cast<unsigned>(MaxReportLines));
+    out.WriteFormat("%10s %12s %14s  %s\n", "Hits", "Time ms", "Instructions", "Line");
+    for (uint32_t i : order)
+    {
+        const LineStats &ln = _lines[i];
+        const FunctionStats &fn = _funcs[ln.Func];
+        out.WriteFormat("%10u %12.3f %14llu  %s:%d (%s)\n", ln.Hits, ToMs(ln.Time),
+            static_cast<unsigned long long>(ln.Ops), fn.Section.GetCStr(), ln.Line, fn.Name.GetCStr());
+    }
+}
@@ -0,0 +1,162 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ScriptProfiler records the time and number of executed instructions per
+// script function and per script line, and the time spent inside the engine
+// API calls. The script interpreter notifies the profiler about entering and
+// leaving the functions, and about the line changes; the profiler keeps its
+// own call stack, and accumulates the stats per each unique call path.
+//
+// The collected data may be written as a "folded stacks" text, which is
+// accepted by the flame graph tools, and as a human-readable report, where
+// functions and lines are sorted by the time spent in them.
+//
+//=============================================================================
+#ifndef __AGS_EE_CC__SCRIPTPROFILER_H
+#define __AGS_EE_CC__SCRIPTPROFILER_H
+
+#include <unordered_map>
+#include <vector>
+#include "script/runtimescriptvalue.h"
+#include "util/flathash.h"
+#include "util/string_types.h"
+#include "util/textwriter.h"
+#include "util/time_util.h"
+
+struct ccScript;
+
+class ScriptProfiler
+{
+    using String = AGS::Common::String;
+    using Clock = AGS::Engine::Clock;
+public:
+    ScriptProfiler() = default;
+
+    // Clears all the collected data
+    void Reset();
+
+    // Notifies that a script function starting at the given code address
+    // is called; ops is the number of instructions executed since the last
+    // profiler's notification
+    void EnterFunction(const ccScript *script, int32_t pc, uint32_t ops);
+    // Notifies that the current script function returned
+    void LeaveFunction(uint32_t ops);
+    // Notifies that the engine API function is called from script
+    void EnterApi(const RuntimeScriptValue &fn, uint32_t ops);
+    // Notifies that the current engine API function returned
+    void LeaveApi();
+    // Notifies that the current script function switched to the new line
+    void SetLine(int line, uint32_t ops);
+    // Gets the current call stack depth
+    size_t GetDepth() const { return _frames.size(); }
+    // Leaves all the functions above the given call stack depth;
+    // used when the script execution was interrupted
+    void Unwind(size_t depth);
+    // Forgets the code addresses in the script, which is about to be unloaded;
+    // the stats collected for its functions are kept
+    void ForgetScript(const ccScript *script);
+
+    // Writes the collected time per unique call stack, in microseconds,
+    // in the "folded stacks" format: "func1;func2;func3 time"
+    void WriteFoldedStacks(AGS::Common::TextWriter &out) const;
+    // Writes a text report with the function, engine API and line stats
+    void WriteReport(AGS::Common::TextWriter &out) const;
+
+private:
+    static const uint32_t NoIndex = UINT32_MAX;
+
+    // Identifies a function by its code: either script and code address,
+    // or engine function pointer and zero address
+    struct FuncKey
+    {
+        const void *Code = nullptr;
+        int32_t Address = 0;
+    };
+
+    struct FuncKeyTraits
+    {
+        static uint32_t Hash(const FuncKey &key);
+        static bool Equals(const FuncKey &stored, const FuncKey &key)
+            { return stored.Code == key.Code && stored.Address == key.Address; }
+        static FuncKey MakeKey(const FuncKey &key) { return key; }
+    };
+
+    struct IndexPairTraits
+    {
+        static uint32_t Hash(uint64_t key);
+        static bool Equals(uint64_t stored, uint64_t key) { return stored == key; }
+        static uint64_t MakeKey(uint64_t key) { return key; }
+    };
+
+    struct FunctionStats
+    {
+        String Section;
+        String Name;
+        bool IsApi = false;
+        uint32_t Calls = 0u;
+        uint32_t Active = 0u; // number of calls on the stack, for the recursion
+        Clock::duration TotalTime{};
+        Clock::duration SelfTime{};
+        uint64_t Ops = 0u;
+    };
+
+    struct LineStats
+    {
+        uint32_t Func = 0u;
+        int Line = 0;
+        uint32_t Hits = 0u;
+        Clock::duration Time{}; // includes the time of the functions called
+        uint64_t Ops = 0u;
+    };
+
+    // A node of the call tree, represents a unique call stack
+    struct CallNode
+    {
+        uint32_t Parent = NoIndex;
+        uint32_t Func = 0u;
+        Clock::duration SelfTime{};
+    };
+
+    struct Frame
+    {
+        uint32_t Node = 0u;
+        uint32_t Func = 0u;
+        uint32_t Line = NoIndex;
+        Clock::time_point Start;
+        Clock::time_point LineStart;
+    };
+
+    // Accounts the time passed and instructions executed since the last
+    // notification to the current function; returns the current time
+    Clock::time_point Tick(uint32_t ops);
+    void PushFrame(uint32_t func, Clock::time_point now);
+    void PopFrame(Clock::time_point now);
+    uint32_t GetScriptFunc(const ccScript *script, int32_t pc);
+    uint32_t GetApiFunc(const RuntimeScriptValue &fn);
+    uint32_t AddFunc(const String &section, const String &name, bool is_api);
+    String GetFullName(uint32_t func) const;
+
+    std::vector<FunctionStats> _funcs;
+    std::vector<LineStats> _lines;
+    std::vector<CallNode> _nodes;
+    std::vector<Frame> _frames;
+    // Lookups for the function, line and call node indexes
+    AGS::Common::FlatHashMap<FuncKey, uint32_t, FuncKeyTraits> _funcByCode;
+    std::unordered_map<String, uint32_t> _funcByName;
+    AGS::Common::FlatHashMap<uint64_t, uint32_t, IndexPairTraits> _lineByKey;
+    AGS::Common::FlatHashMap<uint64_t, uint32_t, IndexPairTraits> _nodeByKey;
+    Clock::time_point _lastTime;
+};
+
+#endif // __AGS_EE_CC__SCRIPTPROFILER_H
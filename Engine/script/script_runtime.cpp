@@ -17,12 +17,18 @@
 #include <string.h>
 #include "ac/dynobj/cc_dynamicarray.h"
 #include "script/cc_common.h"
+#include "script/script_profiler.h"
 #include "script/systemimports.h"
+#include "util/file.h"
+#include "util/textstreamwriter.h"
 
+using namespace AGS::Common;
 
 SystemImports simp;
 SystemImports simp_for_plugin;
 
+static std::unique_ptr<ScriptProfiler> script_profiler;
+
 
 bool ccAddExternalStaticFunction(const String &name, ScriptAPIFunction *scfn, void *dirfn)
 {
@@ -126,6 +132,40 @@ void ccSetScriptAliveTimer(unsigned sys_poll_timeout, unsigned abort_timeout,
     ccInstance::SetExecTimeout(sys_poll_timeout, abort_timeout, abort_loops);
 }
 
+void ccSetScriptPredecode(bool on)
+{
+    ccInstance::SetPredecode(on);
+}
+
+void ccGetScriptImportCacheStats(uint32_t &hits, uint32_t &misses)
+{
+    ccInstance::GetImportCacheStats(hits, misses);
+}
+
+void ccSetScriptProfiling(bool on)
+{
+    if (on && !script_profiler)
+        script_profiler.reset(new ScriptProfiler());
+    else if (!on)
+        script_profiler.reset();
+    ccInstance::SetProfiler(script_profiler.get());
+}
+
+bool ccWriteScriptProfile(const String &folded_path, const String &report_path)
+{
+    if (!script_profiler)
+        return false;
+    auto folded_out = File::CreateFile(folded_path);
+    auto report_out = File::CreateFile(report_path);
+    if (!folded_out || !report_out)
+        return false;
+    TextStreamWriter folded_writer(std::move(folded_out));
+    script_profiler->WriteFoldedStacks(folded_writer);
+    TextStreamWriter report_writer(std::move(report_out));
+    script_profiler->WriteReport(report_writer);
+    return true;
+}
+
 void ccNotifyScriptStillAlive () {
     ccInstance *cur_inst = ccInstance::GetCurrentInstance();
     if (cur_inst)
@@ -94,6 +94,16 @@ void ccSetDebugHook(new_line_hook_type jibble);
 // * abort_timeout - [temp disabled] defines the timeout (ms) at which the interpreter will cancel with error.
 // * abort_loops - max script loops without an engine update after which the interpreter will error;
 void ccSetScriptAliveTimer(unsigned sys_poll_timeout, unsigned abort_timeout, unsigned abort_loops);
+// Set whether the scripts should be pre-decoded when loaded; the pre-decoded
+// instruction stream is run in place of the raw bytecode
+void ccSetScriptPredecode(bool on);
+// Gets the number of import cache hits and misses in the pre-decoded scripts
+void ccGetScriptImportCacheStats(uint32_t &hits, uint32_t &misses);
+// Enables or disables the script profiler; disabling it discards the collected data
+void ccSetScriptProfiling(bool on);
+// Writes the collected script profile: the folded call stacks for the flame
+// graph tools, and the text report; returns if the files were written
+bool ccWriteScriptProfile(const String &folded_path, const String &report_path);
 // reset the current while loop counter
 void ccNotifyScriptStillAlive();
 
@@ -14,30 +14,178 @@
 #include "script/systemimports.h"
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include "util/string_types.h"
 
 using namespace AGS::Common;
 
 
+ScriptSymbolsMap::Entry *ScriptSymbolsMap::Table::Find(const char *key, size_t key_len, uint32_t hash)
+{
+    return const_cast<Entry*>(static_cast<const Table*>(this)->Find(key, key_len, hash));
+}
+
+const ScriptSymbolsMap::Entry *ScriptSymbolsMap::Table::Find(const char *key, size_t key_len, uint32_t hash) const
+{
+    if (Count == 0)
+        return nullptr;
+
+    const size_t mask = Slots.size() - 1;
+    for (size_t i = hash & mask; Slots[i].Index != UINT32_MAX; i = (i + 1) & mask)
+    {
+        const Entry &e = Slots[i];
+        if ((e.Hash == hash) && (e.KeyLen == key_len) && (memcmp(e.Name.GetCStr(), key, key_len) == 0))
+            return &e;
+    }
+    return nullptr;
+}
+
+ScriptSymbolsMap::Entry &ScriptSymbolsMap::Table::Insert(const String &name, size_t key_len, uint32_t hash)
+{
+    // Keep the load factor under 3/4
+    if ((Count + 1) * 4 > Slots.size() * 3)
+        Grow(Count + 1);
+
+    const size_t mask = Slots.size() - 1;
+    size_t i = hash & mask;
+    for (; Slots[i].Index != UINT32_MAX; i = (i + 1) & mask);
+    Entry &e = Slots[i];
+    e.Name = name;
+    e.KeyLen = key_len;
+    e.Hash = hash;
+    Count++;
+    return e;
+}
+
+void ScriptSymbolsMap::Table::Erase(Entry &entry)
+{
+    // Shift back the following entries of the same probe chain,
+    // so that there are no gaps left in it
+    const size_t mask = Slots.size() - 1;
+    size_t free_at = &entry - Slots.data();
+    for (size_t i = (free_at + 1) & mask; Slots[i].Index != UINT32_MAX; i = (i + 1) & mask)
+    {
+        const size_t home = Slots[i].Hash & mask;
+        // Move the entry if its home slot is not within (free_at, i]
+        if (((i - home) & mask) >= ((i - free_at) & mask))
+        {
+            Slots[free_at] = std::move(Slots[i]);
+            free_at = i;
+        }
+    }
+    Slots[free_at] = Entry();
+    Count--;
+}
+
+void ScriptSymbolsMap::Table::Grow(size_t min_count)
+{
+    size_t new_size = std::max<size_t>(16u, Slots.size());
+    while (min_count * 4 > new_size * 3)
+        new_size *= 2;
+    if (new_size == Slots.size())
+        return;
+
+    std::vector<Entry> old_slots(new_size);
+    std::swap(Slots, old_slots);
+    const size_t mask = Slots.size() - 1;
+    for (auto &old_e : old_slots)
+    {
+        if (old_e.Index == UINT32_MAX)
+            continue;
+        size_t i = old_e.Hash & mask;
+        for (; Slots[i].Index != UINT32_MAX; i = (i + 1) & mask);
+        Slots[i] = std::move(old_e);
+    }
+}
+
 void ScriptSymbolsMap::Add(const String &name, uint32_t index)
 {
-    _lookup[name] = index;
+    const uint32_t hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), name.GetLength()));
+    Entry *sym = _symbols.Find(name.GetCStr(), name.GetLength(), hash);
+    const bool is_new = (sym == nullptr);
+    if (is_new)
+        sym = &_symbols.Insert(name, name.GetLength(), hash);
+    sym->Index = index;
+
+    const size_t argnum_at = name.FindChar(_appendageSeparator);
+    if (argnum_at == String::NoIndex)
+        return;
+
+    // Update the expanded symbol reference for this base name
+    const uint32_t base_hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), argnum_at));
+    Entry *exp = _expanded.Find(name.GetCStr(), argnum_at, base_hash);
+    if (!exp)
+    {
+        exp = &_expanded.Insert(name, argnum_at, base_hash);
+        exp->Index = index;
+    }
+    else if (name.Compare(exp->Name) <= 0)
+    {
+        exp->Name = name;
+        exp->Index = index;
+    }
+    if (is_new)
+        exp->Count++;
 }
 
 void ScriptSymbolsMap::Remove(const String &name)
 {
-    _lookup.erase(name);
+    const uint32_t hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), name.GetLength()));
+    Entry *sym = _symbols.Find(name.GetCStr(), name.GetLength(), hash);
+    if (!sym)
+        return;
+    _symbols.Erase(*sym);
+
+    const size_t argnum_at = name.FindChar(_appendageSeparator);
+    if (argnum_at == String::NoIndex)
+        return;
+
+    const uint32_t base_hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), argnum_at));
+    Entry *exp = _expanded.Find(name.GetCStr(), argnum_at, base_hash);
+    assert(exp);
+    if (!exp)
+        return;
+    if (--exp->Count == 0)
+        _expanded.Erase(*exp);
+    else if (exp->Name == name)
+        ResolveExpanded(*exp);
+}
+
+void ScriptSymbolsMap::ResolveExpanded(Entry &exp_entry)
+{
+    // This is a slow path, only taken if the selected expanded symbol was removed,
+    // while there are more symbols left with the same base name
+    const Entry *best = nullptr;
+    const size_t base_len = exp_entry.KeyLen;
+    for (const auto &e : _symbols.Slots)
+    {
+        if ((e.Index == UINT32_MAX) || (e.Name.GetLength() <= base_len) ||
+            (e.Name[base_len] != _appendageSeparator) ||
+            (memcmp(e.Name.GetCStr(), exp_entry.Name.GetCStr(), base_len) != 0))
+            continue;
+        if (!best || e.Name.Compare(best->Name) < 0)
+            best = &e;
+    }
+    assert(best);
+    if (best)
+    {
+        exp_entry.Name = best->Name;
+        exp_entry.Index = best->Index;
+    }
 }
 
 void ScriptSymbolsMap::Clear()
 {
-    _lookup.clear();
+    _symbols = Table();
+    _expanded = Table();
 }
 
 uint32_t ScriptSymbolsMap::GetIndexOf(const String &name) const
 {
-    auto it = _lookup.find(name);
-    if (it != _lookup.end())
-        return it->second;
+    const uint32_t hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), name.GetLength()));
+    const Entry *sym = _symbols.Find(name.GetCStr(), name.GetLength(), hash);
+    if (sym)
+        return sym->Index;
 
     // Not found...
     return UINT32_MAX;
@@ -51,75 +199,35 @@ uint32_t ScriptSymbolsMap::GetIndexOfAny(const String &name) const
     //
     // where "type" is the name of a type, "name" is the name of a function,
     // "argnum" is the number of arguments.
-
-    const size_t argnum_at = std::min(name.GetLength(), name.FindChar(_appendageSeparator));
-    const size_t append_end = name.GetLength();
-    // TODO: optimize this by supporting string views! or compare methods which let compare with a substring of input
-    const String name_only = name.Left(argnum_at);
-    const String argnum_only = name.Mid(argnum_at + 1, append_end - argnum_at - 1);
-
-    // Scan the range of possible matches, starting with pure name without appendages.
-    // The match logic is this:
-    // * the request is compared one section after another, first base name, then first
-    //   appendage, then second appendage, and so forth (in case we support multiple appendages);
-    // * as we go we save and update the best match: symbol that has only base name,
-    //   symbol that has base name + first appendage, and so forth.
-    // * if no exact match is found, then we use the best saved match.
     //
-    // We know as a fact that in an ordered string container shorter names come first
-    // and longer names come after, meaning that symbols without appendage will be met first.
-    uint32_t best_match = UINT32_MAX;
-    for (auto it = _lookup.lower_bound(name_only); it != _lookup.end(); ++it)
+    // The match logic is this:
+    // * the exact match always has priority;
+    // * if the request has an appendage, then the symbol with only base name is a match;
+    // * if the request does not have an appendage, then optionally the first symbol
+    //   (in alphabetical order) with the same base name and any appendage is a match.
+
+    // First try the exact match
+    const uint32_t exact = GetIndexOf(name);
+    if (exact != UINT32_MAX)
+        return exact;
+
+    const size_t argnum_at = name.FindChar(_appendageSeparator);
+    if (argnum_at != String::NoIndex)
     {
-        const String &try_sym = it->first;
-        // First - compare base name section
-        // If base name is not matching, then there's no reason to continue the range
-        if (try_sym.CompareLeft(name_only, argnum_at) != 0)
-            break;
-
-        // If the symbol is longer, but there's no separator after base name,
-        // then the symbol has a different, longer base name (e.g. "FindChar" vs "FindCharacter")
-        if ((try_sym.GetLength() > name_only.GetLength()) && try_sym[name_only.GetLength()] != _appendageSeparator)
-            continue;
-
-        // Search for appendage separators in the matching symbol
-        const size_t sym_argnum_at = std::min(try_sym.GetLength(), try_sym.FindChar(_appendageSeparator, argnum_at));
-        const size_t sym_append_end = try_sym.GetLength();
-
-        //---------------------------------------------------------------------
-        // Check the argnum appendage
-
-        // If the symbol does not have any appendages, then:
-        // - if request does not have any either, that's the exact match;
-        // - otherwise save it as a best match and continue searching;
-        if (sym_argnum_at == try_sym.GetLength())
-        {
-            if (argnum_at == name.GetLength())
-                return it->second;
-            best_match = it->second;
-            continue;
-        }
-
-        // If the request is without argnum, then optionally choose the first found symbol
-        // which has at least base name matching
-        if (argnum_at == name.GetLength())
-        {
-            if (_allowMatchExpanded)
-                return it->second;
-            break; // exact base-name match would be first in order, so no reason to continue
-        }
-
-        // Compare argnum appendage, and skip on failure
-        if ((sym_append_end != append_end) || try_sym.CompareMid(argnum_only, argnum_at + 1) != 0)
-            continue;
+        // Request with appendage: look for the base name only
+        const uint32_t base_hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), argnum_at));
+        const Entry *sym = _symbols.Find(name.GetCStr(), argnum_at, base_hash);
+        return sym ? sym->Index : UINT32_MAX;
+    }
 
-        // Matched whole appendage, found exact match
-        return it->second;
+    // Request without appendage: optionally choose a symbol with the same base name
+    if (_allowMatchExpanded)
+    {
+        const uint32_t base_hash = static_cast<uint32_t>(FNV::Hash(name.GetCStr(), name.GetLength()));
+        const Entry *exp = _expanded.Find(name.GetCStr(), name.GetLength(), base_hash);
+        if (exp)
+            return exp->Index;
     }
-    
-    // If no exact match was found, then select the closest found match
-    if (best_match != UINT32_MAX)
-        return best_match;
 
     // Not found...
     return UINT32_MAX;
@@ -142,6 +250,7 @@ uint32_t SystemImports::Add(const String &name, const RuntimeScriptValue &value,
         if (inst == nullptr)
         {
             _imports[ixof] = ScriptImport(name, value, nullptr);
+            _generation++;
         }
         return ixof;
     }
@@ -161,6 +270,7 @@ uint32_t SystemImports::Add(const String &name, const RuntimeScriptValue &value,
     else
         _imports[ixof] = ScriptImport(name, value, inst);
     _lookup.Add(name, ixof);
+    _generation++;
     return ixof;
 }
 
@@ -172,6 +282,7 @@ void SystemImports::Remove(const String &name)
 
     _lookup.Remove(_imports[idx].Name);
     _imports[idx] = {};
+    _generation++;
 }
 
 const ScriptImport *SystemImports::GetByName(const String &name) const
@@ -219,6 +330,7 @@ void SystemImports::RemoveScriptExports(const ccInstance *inst)
         {
             _lookup.Remove(import.Name);
             import = {};
+            _generation++;
         }
     }
 }
@@ -227,4 +339,5 @@ void SystemImports::Clear()
 {
     _lookup.Clear();
     _imports.clear();
+    _generation++;
 }
@@ -14,7 +14,7 @@
 #ifndef __CC_SYSTEMIMPORTS_H
 #define __CC_SYSTEMIMPORTS_H
 
-#include <map>
+#include <vector>
 #include "script/runtimescriptvalue.h"
 #include "util/string.h"
 
@@ -49,15 +49,46 @@ public:
     uint32_t GetIndexOfAny(const String &name) const;
 
 private:
+    // Symbol table's entry, keyed by the first KeyLen chars of the Name
+    struct Entry
+    {
+        String   Name;
+        size_t   KeyLen = 0u;
+        uint32_t Hash = 0u;
+        uint32_t Index = UINT32_MAX; // UINT32_MAX marks a free slot
+        uint32_t Count = 0u; // number of symbols sharing the key (expanded table only)
+    };
+
+    // A hash table with open addressing and linear probing; lets to look up
+    // by a part of a string without constructing a new string object
+    struct Table
+    {
+        std::vector<Entry> Slots; // size is always a power of 2, or zero
+        size_t Count = 0u;
+
+        Entry *Find(const char *key, size_t key_len, uint32_t hash);
+        const Entry *Find(const char *key, size_t key_len, uint32_t hash) const;
+        Entry &Insert(const String &name, size_t key_len, uint32_t hash);
+        void Erase(Entry &entry);
+        void Grow(size_t min_count);
+    };
+
+    // Finds the expanded symbol with the lowest name in order among
+    // the symbols with the given base name
+    void ResolveExpanded(Entry &exp_entry);
+
     // Which char to use as a appendage separator
     const char _appendageSeparator;
     // Should we allow to select symbols that have extra appendages
     // compared to the request in case exact match was not found
     // (i.e. requested "func", select "func^2").
     const bool _allowMatchExpanded;
-    // Note we can't use a hash-map here, because we sometimes need to search
-    // by partial keys, so sorting is cruicial
-    std::map<String, uint32_t> _lookup;
+    // Symbols by their full names
+    Table _symbols;
+    // Symbols with appendages, by their base names; each entry references
+    // the lowest (in alphabetical order) of the symbols with the same base name,
+    // which is the one selected when the request does not have appendages
+    Table _expanded;
 };
 
 class ccInstance;
@@ -103,10 +134,15 @@ public:
     // or one of the simpler variants in case of a composite input name;
     // returns UINT32_MAX on failure
     uint32_t GetIndexOfAny(const String &name) const { return _lookup.GetIndexOfAny(name); }
+    // Gets the imports table's generation: the number which changes
+    // whenever any of the registered imports is added, replaced or removed;
+    // lets to tell whether a previously resolved import is still valid.
+    uint32_t GetGeneration() const { return _generation; }
 
 private:
     std::vector<ScriptImport> _imports;
     ScriptSymbolsMap _lookup;
+    uint32_t _generation = 1u;
 };
 
 #endif  // __CC_SYSTEMIMPORTS_H
@@ -0,0 +1,175 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/ali3dsw.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+using namespace AGS::Engine::ALSW;
+
+namespace
+{
+
+const int ScreenWidth = 320;
+const int ScreenHeight = 200;
+
+uint32_t NextRandom(uint32_t &seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) | (seed << 16);
+}
+
+// Creates a sprite with random pixels, including fully transparent ones
+// and the mask color
+std::unique_ptr<Bitmap> MakeSprite(int width, int height, int color_depth, uint32_t seed)
+{
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(width, height, color_depth));
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            uint32_t c = NextRandom(seed);
+            if (color_depth == 32)
+            {
+                switch (c % 5)
+                {
+                case 0: c = bitmap_mask_color(bmp->GetAllegroBitmap()); break;
+                case 1: c &= 0x00FFFFFF; break;
+                default: break;
+                }
+            }
+            else
+            {
+                c = (c % 5 == 0) ? bitmap_mask_color(bmp->GetAllegroBitmap()) : (c & 0xFFFF);
+            }
+            bmp->PutPixel(x, y, c);
+        }
+    }
+    return bmp;
+}
+
+struct TestSprite
+{
+    int Batch = 0;
+    int X = 0, Y = 0;
+    int TxFlags = 0;
+    int Alpha = 255;
+    bool Tint = false; // a screen tint entry instead of a sprite
+    std::unique_ptr<Bitmap> Image;
+};
+
+// Makes a list of sprites of different kinds, which are drawn in three batches:
+// on the whole screen, on a viewport with offset, and on a scaled surface.
+// Sprites partially or fully off the screen, translucent and invisible sprites,
+// and the entries which cannot be drawn in bands are mixed among the others.
+std::vector<TestSprite> MakeTestSprites()
+{
+    std::vector<TestSprite> sprites;
+    uint32_t seed = 17;
+    for (int i = 0; i < 90; ++i)
+    {
+        TestSprite spr;
+        spr.Batch = i / 30;
+        if (i == 15)
+        {
+            spr.Tint = true;
+            sprites.push_back(std::move(spr));
+            continue;
+        }
+        const int width = 1 + NextRandom(seed) % 90;
+        const int height = 1 + NextRandom(seed) % 120;
+        const int color_depth = (i % 11 == 5) ? 16 : 32;
+        spr.X = static_cast<int>(NextRandom(seed) % (ScreenWidth + 60)) - 50;
+        spr.Y = static_cast<int>(NextRandom(seed) % (ScreenHeight + 80)) - 70;
+        spr.TxFlags = (i % 7 == 3) ? kTxFlags_Opaque :
+            ((i % 2 == 0) ? kTxFlags_HasAlpha : kTxFlags_None);
+        const int alphas[] = { 255, 255, 255, 128, 1, 254, 0 };
+        spr.Alpha = alphas[i % 7];
+        spr.Image = MakeSprite(width, height, color_depth, NextRandom(seed));
+        sprites.push_back(std::move(spr));
+    }
+    return sprites;
+}
+
+// Renders the sprites using the given number of render threads,
+// returns a copy of the resulting screen
+std::unique_ptr<Bitmap> RenderTestSprites(const std::vector<TestSprite> &sprites, size_t threads)
+{
+    SDLRendererGraphicsDriver driver;
+    driver.SetRenderThreads(threads);
+    driver.SetNativeResolution(GraphicResolution(ScreenWidth, ScreenHeight, 32));
+    Bitmap *screen = driver.GetMemoryBackBuffer();
+    // Screen background, so that the blending results are not trivial
+    for (int y = 0; y < ScreenHeight; ++y)
+        for (int x = 0; x < ScreenWidth; ++x)
+            screen->PutPixel(x, y, makeacol32(x, y, x + y, 255));
+
+    const Rect viewports[] = { RectWH(0, 0, ScreenWidth, ScreenHeight),
+        RectWH(13, 27, 200, 150), RectWH(40, 10, 240, 180) };
+    const SpriteTransform transforms[] = { SpriteTransform(),
+        SpriteTransform(5, -9), SpriteTransform(0, 0, 2.f, 2.f) };
+    std::vector<IDriverDependantBitmap*> ddbs;
+    int batch = -1;
+    for (const auto &spr : sprites)
+    {
+        if (spr.Batch != batch)
+        {
+            if (batch >= 0)
+                driver.EndSpriteBatch();
+            batch = spr.Batch;
+            driver.BeginSpriteBatch(viewports[batch], transforms[batch]);
+        }
+        if (spr.Tint)
+        {
+            driver.SetScreenTint(120, 30, 200);
+            continue;
+        }
+        IDriverDependantBitmap *ddb = driver.CreateDDBFromBitmap(spr.Image.get(), spr.TxFlags);
+        ddb->SetAlpha(spr.Alpha);
+        driver.DrawSprite(spr.X, spr.Y, ddb);
+        ddbs.push_back(ddb);
+    }
+    driver.EndSpriteBatch();
+    driver.RenderToBackBuffer();
+
+    std::unique_ptr<Bitmap> result(BitmapHelper::CreateBitmapCopy(driver.GetMemoryBackBuffer()));
+    for (auto *ddb : ddbs)
+        driver.DestroyDDB(ddb);
+    return result;
+}
+
+} // namespace
+
+TEST(SoftwareRenderer, RenderInBands) {
+    const std::vector<TestSprite> sprites = MakeTestSprites();
+    const std::unique_ptr<Bitmap> serial = RenderTestSprites(sprites, 0);
+    ASSERT_NE(serial, nullptr);
+    // The result must not depend on the number of threads, which changes
+    // the number and height of the bands
+    const size_t thread_counts[] = { 1, 2, 3, 7 };
+    for (size_t threads : thread_counts)
+    {
+        const std::unique_ptr<Bitmap> banded = RenderTestSprites(sprites, threads);
+        ASSERT_NE(banded, nullptr);
+        for (int y = 0; y < ScreenHeight; ++y)
+        {
+            ASSERT_EQ(memcmp(serial->GetScanLine(y), banded->GetScanLine(y), serial->GetLineLength()), 0)
+                << "threads: " << threads << ", line: " << y;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/blender.h"
+#include "gfx/blender_simd.h"
+
+namespace
+{
+
+const uint32_t MaskColor32 = 0x00FF00FF;
+
+// Makes pixels with random colors, and some special values, which are the
+// edge cases for blenders: mask color, zero and full alpha
+std::vector<uint32_t> MakePixels(size_t count, uint32_t seed)
+{
+    std::vector<uint32_t> pixels(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t c = (seed >> 16) | (seed << 16);
+        switch ((seed >> 8) % 8)
+        {
+        case 0: c = MaskColor32; break;
+        case 1: c &= 0x00FFFFFF; break;
+        case 2: c |= 0xFF000000; break;
+        default: break;
+        }
+        pixels[i] = c;
+    }
+    return pixels;
+}
+
+// Blends the same pixels with the span blender and the pixel blender,
+// over the spans of various length, tests that the results are equal
+void TestSpanBlender(PfnBlender blender)
+{
+    PfnSpanBlender span_blender = get_span_blender(blender);
+    ASSERT_NE(span_blender, nullptr);
+    const std::vector<uint32_t> src = MakePixels(1024, 1);
+    const std::vector<uint32_t> dst = MakePixels(1024, 2);
+    const uint32_t params[] = { 0, 1, 2, 127, 128, 254, 255 };
+    for (uint32_t n : params)
+    {
+        for (size_t len = 0; len < 40; ++len)
+        {
+            for (size_t off = 0; off + len <= src.size(); off += 37 + len)
+            {
+                std::vector<uint32_t> expect(dst.begin() + off, dst.begin() + off + len);
+                for (size_t i = 0; i < len; ++i)
+                {
+                    if (src[off + i] != MaskColor32)
+                        expect[i] = blender(src[off + i], expect[i], n);
+                }
+                std::vector<uint32_t> result(dst.begin() + off, dst.begin() + off + len);
+                span_blender(src.data() + off, result.data(), len, n);
+                ASSERT_EQ(result, expect);
+            }
+        }
+    }
+}
+
+// Blends the same pixels with the given span blender and the reference one,
+// for every blender's parameter, over the spans of various length and
+// alignment, tests that the results are equal
+void TestSpanBlenderSet(PfnSpanBlender span_blender, PfnSpanBlender reference)
+{
+    ASSERT_NE(span_blender, nullptr);
+    ASSERT_NE(reference, nullptr);
+    const std::vector<uint32_t> src = MakePixels(256, 4);
+    const std::vector<uint32_t> dst = MakePixels(256, 5);
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+        for (size_t len = 0; len < 40; ++len)
+        {
+            for (size_t off = 0; off + len <= src.size(); off += 61 + len)
+            {
+                std::vector<uint32_t> expect(dst.begin() + off, dst.begin() + off + len);
+                reference(src.data() + off, expect.data(), len, n);
+                std::vector<uint32_t> result(dst.begin() + off, dst.begin() + off + len);
+                span_blender(src.data() + off, result.data(), len, n);
+                ASSERT_EQ(result, expect) << "n: " << n << ", len: " << len << ", offset: " << off;
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(Blender, SpanBlenders) {
+    TestSpanBlender(_argb2argb_blender);
+    TestSpanBlender(_argb2rgb_blender);
+    TestSpanBlender(_rgb2argb_blender);
+    TestSpanBlender(_opaque_alpha_blender);
+    TestSpanBlender(_additive_alpha_copysrc_blender);
+    TestSpanBlender(_blender_alpha32);
+    TestSpanBlender(_blender_trans24);
+    TestSpanBlender(_myblender_alpha_trans24);
+    TestSpanBlender(_trans_alpha_blender32);
+    ASSERT_EQ(get_span_blender(_myblender_color32), nullptr);
+}
+
+TEST(Blender, SpanBlenderSets) {
+    const SpanBlenderSet *scalar = get_span_blenders_scalar();
+    ASSERT_NE(scalar, nullptr);
+    // Test every instruction set which is compiled in, and supported by the CPU
+    struct { const char *Name; const SpanBlenderSet *Set; } sets[] = {
+        { "SSE2", cpu_has_sse2() ? get_span_blenders_sse2() : nullptr },
+        { "AVX2", cpu_has_avx2() ? get_span_blenders_avx2() : nullptr },
+        { "NEON", get_span_blenders_neon() } };
+    PfnSpanBlender SpanBlenderSet::*const blenders[] = {
+        &SpanBlenderSet::Argb2Argb, &SpanBlenderSet::Argb2Rgb, &SpanBlenderSet::Rgb2Argb,
+        &SpanBlenderSet::OpaqueAlpha, &SpanBlenderSet::AdditiveAlpha, &SpanBlenderSet::Alpha,
+        &SpanBlenderSet::Trans, &SpanBlenderSet::AlphaTrans, &SpanBlenderSet::TransAlpha };
+    for (const auto &set : sets)
+    {
+        if (!set.Set)
+            continue;
+        for (size_t i = 0; i < sizeof(blenders) / sizeof(blenders[0]); ++i)
+        {
+            SCOPED_TRACE(testing::Message() << set.Name << ", blender " << i);
+            TestSpanBlenderSet(set.Set->*blenders[i], scalar->*blenders[i]);
+        }
+    }
+}
+
+TEST(Blender, TintSpan) {
+    const std::vector<uint32_t> src = MakePixels(1024, 3);
+    const uint32_t colors[] = { 0x000000, 0xFF0000, 0x20A0F0, 0xFFFFFF };
+    const uint32_t lights[] = { 0, 100, 249, 250 };
+    for (uint32_t color : colors)
+    {
+        for (uint32_t light : lights)
+        {
+            PfnBlender blender = (light >= 250) ? _myblender_color32 : _myblender_color32_light;
+            uint32_t table[256];
+            make_tint_table32(table, blender, color, light);
+            std::vector<uint32_t> result(src.size(), 0x12345678);
+            tint_span32(table, src.data(), result.data(), src.size());
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                const uint32_t expect = (src[i] == MaskColor32) ? 0x12345678 :
+                    blender(color, src[i], light);
+                ASSERT_EQ(result[i], expect);
+            }
+        }
+    }
+}
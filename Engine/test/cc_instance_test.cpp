@@ -0,0 +1,453 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <initializer_list>
+#include "gtest/gtest.h"
+#include "script/cc_common.h"
+#include "script/cc_instance.h"
+#include "script/cc_internal.h"
+#include "script/cc_script.h"
+#include "script/script_runtime.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+// Helps to assemble a test script from the raw bytecode
+struct ScriptAsm
+{
+    PScript Script;
+
+    ScriptAsm() : Script(new ccScript("test")) {}
+
+    // Returns current code position
+    int32_t Pos() const { return static_cast<int32_t>(Script->code.size()); }
+    // Appends an instruction with arguments, returns its position
+    int32_t Emit(std::initializer_list<int32_t> op)
+    {
+        const int32_t pos = Pos();
+        Script->code.insert(Script->code.end(), op);
+        return pos;
+    }
+    // Appends a jump instruction, returns the position of its argument
+    int32_t EmitJump(int32_t jump_op)
+    {
+        return Emit({ jump_op, 0 }) + 1;
+    }
+    // Sets the jump argument so that it jumps to the given position
+    void SetJump(int32_t arg_pos, int32_t dest)
+    {
+        Script->code[arg_pos] = dest - (arg_pos + 1);
+    }
+    // Appends an instruction which loads the given function's address to the register
+    void EmitFunctionAddr(int32_t reg, int32_t fn_pos)
+    {
+        const int32_t pos = Emit({ SCMD_LITTOREG, reg, fn_pos });
+        AddFixup(pos + 2, FIXUP_FUNCTION);
+    }
+    // Appends an instruction which loads the import to the register
+    void EmitImport(int32_t reg, const char *name)
+    {
+        const int32_t pos = Emit({ SCMD_LITTOREG, reg, static_cast<int32_t>(Script->imports.size()) });
+        AddFixup(pos + 2, FIXUP_IMPORT);
+        Script->imports.push_back(name);
+    }
+    void AddFixup(int32_t pos, char type)
+    {
+        Script->fixups.push_back(pos);
+        Script->fixuptypes.push_back(type);
+    }
+    void Export(const char *name, int32_t fn_pos)
+    {
+        Script->exports.push_back(name);
+        Script->export_addr.push_back((EXPORT_FUNCTION << 24) | fn_pos);
+    }
+};
+
+// Runs the script's function as raw bytecode and as a pre-decoded code,
+// and tests that both return the expected result
+void TestRunBothWays(const PScript &scri, const char *fn_name, int expect_result)
+{
+    for (int predecode = 0; predecode < 2; ++predecode)
+    {
+        ccInstance::SetPredecode(predecode != 0);
+        auto inst = ccInstance::CreateFromScript(scri);
+        ASSERT_TRUE(inst);
+        ASSERT_TRUE(inst->ResolveScriptImports());
+        ASSERT_TRUE(inst->ResolveImportFixups());
+        // run twice, in case the code depends on anything cached at the first run
+        for (int run = 0; run < 2; ++run)
+        {
+            ASSERT_EQ(inst->CallScriptFunction(fn_name, 0, nullptr), kInstErr_None)
+                << cc_get_error().ErrorString.GetCStr();
+            ASSERT_EQ(inst->GetReturnValue(), expect_result)
+                << (predecode ? "pre-decoded" : "bytecode") << ", run " << run;
+        }
+    }
+    ccInstance::SetPredecode(false);
+}
+
+RuntimeScriptValue Sc_CcTest_Poly3(const RuntimeScriptValue *params, int32_t param_count)
+{
+    if (param_count != 3)
+        return RuntimeScriptValue().SetInt32(-1);
+    return RuntimeScriptValue().SetInt32(params[0].IValue + params[1].IValue * 10 + params[2].IValue * 100);
+}
+
+} // namespace
+
+TEST(CCInstance, Predecode_Branches) {
+    // sum = 0;
+    // for (n = 10; n != 0; n--)
+    //     if (n & 1) sum += n * 3; else sum -= 1;
+    // return sum;
+    ScriptAsm sa;
+    sa.Emit({ SCMD_LITTOREG, SREG_CX, 0 });
+    sa.Emit({ SCMD_LITTOREG, SREG_DX, 10 });
+    const int32_t loop_start = sa.Pos();
+    sa.Emit({ SCMD_REGTOREG, SREG_DX, SREG_AX });
+    const int32_t jz_end = sa.EmitJump(SCMD_JZ);
+    sa.Emit({ SCMD_LITTOREG, SREG_BX, 1 });
+    sa.Emit({ SCMD_BITAND, SREG_AX, SREG_BX });
+    const int32_t jnz_odd = sa.EmitJump(SCMD_JNZ);
+    sa.Emit({ SCMD_SUB, SREG_CX, 1 });
+    const int32_t jmp_next = sa.EmitJump(SCMD_JMP);
+    sa.SetJump(jnz_odd, sa.Pos());
+    sa.Emit({ SCMD_REGTOREG, SREG_DX, SREG_AX });
+    sa.Emit({ SCMD_MUL, SREG_AX, 3 });
+    sa.Emit({ SCMD_ADDREG, SREG_CX, SREG_AX });
+    sa.SetJump(jmp_next, sa.Pos());
+    sa.Emit({ SCMD_SUB, SREG_DX, 1 });
+    sa.SetJump(sa.EmitJump(SCMD_JMP), loop_start);
+    sa.SetJump(jz_end, sa.Pos());
+    sa.Emit({ SCMD_REGTOREG, SREG_CX, SREG_AX });
+    sa.Emit({ SCMD_RET });
+    sa.Export("branches$0", 0);
+
+    // odd: (9 + 7 + 5 + 3 + 1) * 3 = 75; even: 5 * -1
+    TestRunBothWays(sa.Script, "branches", 70);
+}
+
+TEST(CCInstance, Predecode_Calls) {
+    // int fact(int n) { if (n > 1) return n * fact(n - 1); return 1; }
+    ScriptAsm sa;
+    const int32_t fact = sa.Pos();
+    sa.Emit({ SCMD_LOADSPOFFS, 8 });
+    sa.Emit({ SCMD_MEMREAD, SREG_AX });
+    sa.Emit({ SCMD_LITTOREG, SREG_BX, 1 });
+    sa.Emit({ SCMD_GREATER, SREG_AX, SREG_BX });
+    const int32_t jnz_recurse = sa.EmitJump(SCMD_JNZ);
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 1 });
+    sa.Emit({ SCMD_RET });
+    sa.SetJump(jnz_recurse, sa.Pos());
+    sa.Emit({ SCMD_LOADSPOFFS, 8 });
+    sa.Emit({ SCMD_MEMREAD, SREG_AX });
+    sa.Emit({ SCMD_SUB, SREG_AX, 1 });
+    sa.Emit({ SCMD_PUSHREG, SREG_AX });
+    sa.EmitFunctionAddr(SREG_AX, fact);
+    sa.Emit({ SCMD_CALL, SREG_AX });
+    sa.Emit({ SCMD_SUB, SREG_SP, 4 });
+    sa.Emit({ SCMD_LOADSPOFFS, 8 });
+    sa.Emit({ SCMD_MEMREAD, SREG_BX });
+    sa.Emit({ SCMD_MULREG, SREG_AX, SREG_BX });
+    sa.Emit({ SCMD_RET });
+    // return fact(7);
+    const int32_t entry = sa.Pos();
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 7 });
+    sa.Emit({ SCMD_PUSHREG, SREG_AX });
+    sa.EmitFunctionAddr(SREG_AX, fact);
+    sa.Emit({ SCMD_CALL, SREG_AX });
+    sa.Emit({ SCMD_SUB, SREG_SP, 4 });
+    sa.Emit({ SCMD_RET });
+    sa.Export("calls$0", entry);
+
+    TestRunBothWays(sa.Script, "calls", 5040);
+}
+
+TEST(CCInstance, Predecode_Imports) {
+    ccAddExternalStaticFunction("CcTest_Poly3", Sc_CcTest_Poly3);
+
+    // sum = 0;
+    // for (n = 3; n != 0; n--)
+    //     sum += CcTest_Poly3(n, 2, 1);
+    // return sum;
+    ScriptAsm sa;
+    sa.Emit({ SCMD_LITTOREG, SREG_CX, 0 });
+    sa.Emit({ SCMD_LITTOREG, SREG_DX, 3 });
+    const int32_t loop_start = sa.Pos();
+    sa.Emit({ SCMD_REGTOREG, SREG_DX, SREG_AX });
+    const int32_t jz_end = sa.EmitJump(SCMD_JZ);
+    // the arguments are pushed in the reverse order
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 1 });
+    sa.Emit({ SCMD_PUSHREAL, SREG_AX });
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 2 });
+    sa.Emit({ SCMD_PUSHREAL, SREG_AX });
+    sa.Emit({ SCMD_PUSHREAL, SREG_DX });
+    sa.EmitImport(SREG_AX, "CcTest_Poly3");
+    sa.Emit({ SCMD_NUMFUNCARGS, 3 });
+    sa.Emit({ SCMD_CALLEXT, SREG_AX });
+    sa.Emit({ SCMD_SUBREALSTACK, 3 });
+    sa.Emit({ SCMD_ADDREG, SREG_CX, SREG_AX });
+    sa.Emit({ SCMD_SUB, SREG_DX, 1 });
+    sa.SetJump(sa.EmitJump(SCMD_JMP), loop_start);
+    sa.SetJump(jz_end, sa.Pos());
+    sa.Emit({ SCMD_REGTOREG, SREG_CX, SREG_AX });
+    sa.Emit({ SCMD_RET });
+    sa.Export("imports$0", 0);
+
+    // (3 + 2 + 1) + 3 * (20 + 100)
+    TestRunBothWays(sa.Script, "imports", 366);
+
+    ccRemoveExternalSymbol("CcTest_Poly3");
+}
+
+TEST(CCInstance, Predecode_FarStack) {
+    ccAddExternalStaticFunction("CcTest_Poly3", Sc_CcTest_Poly3);
+
+    // Pushes 40 local values (1..40) to the stack, then:
+    // * reads and writes the values far back from the stack top;
+    // * passes the values to the external function, keeping the outer call's
+    //   arguments on the far call stack while the inner call is made:
+    //     return CcTest_Poly3(CcTest_Poly3(#39, #20, #3), #2, #1 * 5);
+    ScriptAsm sa;
+    sa.Emit({ SCMD_LITTOREG, SREG_CX, 0 });
+    sa.Emit({ SCMD_LITTOREG, SREG_DX, 40 });
+    const int32_t loop_start = sa.Pos();
+    sa.Emit({ SCMD_ADD, SREG_CX, 1 });
+    sa.Emit({ SCMD_PUSHREG, SREG_CX });
+    sa.Emit({ SCMD_SUB, SREG_DX, 1 });
+    sa.Emit({ SCMD_REGTOREG, SREG_DX, SREG_AX });
+    sa.SetJump(sa.EmitJump(SCMD_JNZ), loop_start);
+    // #1 *= 5
+    sa.Emit({ SCMD_LOADSPOFFS, 160 });
+    sa.Emit({ SCMD_MEMREAD, SREG_AX });
+    sa.Emit({ SCMD_MUL, SREG_AX, 5 });
+    sa.Emit({ SCMD_LOADSPOFFS, 160 });
+    sa.Emit({ SCMD_MEMWRITE, SREG_AX });
+    // the arguments are pushed in the reverse order
+    for (int32_t offset : { 160, 156, 152, 84, 8 })
+    {
+        sa.Emit({ SCMD_LOADSPOFFS, offset });
+        sa.Emit({ SCMD_MEMREAD, SREG_AX });
+        sa.Emit({ SCMD_PUSHREAL, SREG_AX });
+    }
+    sa.EmitImport(SREG_AX, "CcTest_Poly3");
+    sa.Emit({ SCMD_NUMFUNCARGS, 3 });
+    sa.Emit({ SCMD_CALLEXT, SREG_AX });
+    sa.Emit({ SCMD_SUBREALSTACK, 3 });
+    sa.Emit({ SCMD_PUSHREAL, SREG_AX });
+    sa.EmitImport(SREG_AX, "CcTest_Poly3");
+    sa.Emit({ SCMD_NUMFUNCARGS, 3 });
+    sa.Emit({ SCMD_CALLEXT, SREG_AX });
+    sa.Emit({ SCMD_SUBREALSTACK, 3 });
+    sa.Emit({ SCMD_SUB, SREG_SP, 160 });
+    sa.Emit({ SCMD_RET });
+    sa.Export("far_stack$0", 0);
+
+    // inner: 39 + 20 * 10 + 3 * 100 = 539
+    // outer: 539 + 2 * 10 + 5 * 100 = 1059
+    TestRunBothWays(sa.Script, "far_stack", 1059);
+
+    ccRemoveExternalSymbol("CcTest_Poly3");
+}
+
+namespace
+{
+
+// Creates a pre-decoded instance of the script, and tests which instructions
+// were replaced by a superinstruction, and which were kept as they were
+void TestFusion(const PScript &scri, std::initializer_list<int32_t> fused_at,
+    std::initializer_list<int32_t> not_fused_at)
+{
+    ccInstance::SetPredecode(true);
+    auto inst = ccInstance::CreateFromScript(scri);
+    const bool created = inst && inst->ResolveScriptImports() && inst->ResolveImportFixups();
+    ccInstance::SetPredecode(false);
+    ASSERT_TRUE(created);
+    for (int32_t pc : fused_at)
+    {
+        const ScriptOperation *op = inst->GetPredecodedOp(pc);
+        ASSERT_TRUE(op);
+        ASSERT_GE(op->Instruction.Code, CC_NUM_SCCMDS) << "pc " << pc;
+    }
+    for (int32_t pc : not_fused_at)
+    {
+        const ScriptOperation *op = inst->GetPredecodedOp(pc);
+        ASSERT_TRUE(op);
+        ASSERT_EQ(op->Instruction.Code, scri->code[pc]) << "pc " << pc;
+    }
+}
+
+} // namespace
+
+TEST(CCInstance, Fuse_LoadSpOffsMem) {
+    // int a = 5, b = 8;
+    // b *= a;
+    // return b + a;
+    ScriptAsm sa;
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 5 });
+    sa.Emit({ SCMD_PUSHREG, SREG_AX });
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 8 });
+    sa.Emit({ SCMD_PUSHREG, SREG_AX });
+    const int32_t read1 = sa.Emit({ SCMD_LOADSPOFFS, 8 });
+    sa.Emit({ SCMD_MEMREAD, SREG_BX });
+    const int32_t read2 = sa.Emit({ SCMD_LOADSPOFFS, 4 });
+    sa.Emit({ SCMD_MEMREAD, SREG_AX });
+    sa.Emit({ SCMD_MULREG, SREG_AX, SREG_BX });
+    const int32_t write = sa.Emit({ SCMD_LOADSPOFFS, 4 });
+    sa.Emit({ SCMD_MEMWRITE, SREG_AX });
+    // not a sequence: an instruction in between
+    const int32_t read3 = sa.Emit({ SCMD_LOADSPOFFS, 4 });
+    sa.Emit({ SCMD_REGTOREG, SREG_BX, SREG_CX });
+    sa.Emit({ SCMD_MEMREAD, SREG_AX });
+    sa.Emit({ SCMD_ADDREG, SREG_AX, SREG_CX });
+    sa.Emit({ SCMD_SUB, SREG_SP, 8 });
+    sa.Emit({ SCMD_RET });
+    sa.Export("fuse$0", 0);
+
+    TestFusion(sa.Script, { read1, read2, write }, { read3 });
+    TestRunBothWays(sa.Script, "fuse", 45);
+}
+
+TEST(CCInstance, Fuse_LitToRegAddReg) {
+    ScriptAsm sa;
+    sa.Emit({ SCMD_LITTOREG, SREG_CX, 100 });
+    const int32_t add1 = sa.Emit({ SCMD_LITTOREG, SREG_BX, 20 });
+    sa.Emit({ SCMD_ADDREG, SREG_CX, SREG_BX });
+    // not a sequence: adds other register than the one assigned
+    const int32_t add2 = sa.Emit({ SCMD_LITTOREG, SREG_BX, 3 });
+    sa.Emit({ SCMD_ADDREG, SREG_CX, SREG_DX });
+    sa.Emit({ SCMD_ADDREG, SREG_CX, SREG_BX });
+    sa.Emit({ SCMD_REGTOREG, SREG_CX, SREG_AX });
+    sa.Emit({ SCMD_RET });
+    sa.Export("fuse$0", 0);
+
+    TestFusion(sa.Script, { add1 }, { add2 });
+    // DX is not initialized by the script, and is expected to be 0
+    TestRunBothWays(sa.Script, "fuse", 123);
+}
+
+TEST(CCInstance, Fuse_PushLitToRegPop) {
+    ScriptAsm sa;
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 6 });
+    const int32_t push1 = sa.Emit({ SCMD_PUSHREG, SREG_AX });
+    sa.Emit({ SCMD_LITTOREG, SREG_AX, 7 });
+    sa.Emit({ SCMD_POPREG, SREG_BX });
+    sa.Emit({ SCMD_MULREG, SREG_AX, SREG_BX });
+    // not a sequence: assigns other register than the one pushed
+    const int32_t push2 = sa.Emit({ SCMD_PUSHREG, SREG_AX });
+    sa.Emit({ SCMD_LITTOREG, SREG_CX, 2 });
+    sa.Emit({ SCMD_POPREG, SREG_BX });
+    sa.Emit({ SCMD_ADDREG, SREG_AX, SREG_BX });
+    sa.Emit({ SCMD_RET });
+    sa.Export("fuse$0", 0);
+
+    TestFusion(sa.Script, { push1 }, { push2 });
+    TestRunBothWays(sa.Script, "fuse", 84);
+}
+
+TEST(CCInstance, Fuse_CompareJz) {
+    const int32_t cmp_ops[] = { SCMD_ISEQUAL, SCMD_NOTEQUAL, SCMD_GREATER, SCMD_LESSTHAN, SCMD_GTE, SCMD_LTE };
+    const int32_t values[] = { 3, 5, 7 };
+    for (int32_t cmp_op : cmp_ops)
+    {
+        for (int32_t value : values)
+        {
+            // if (value CMP 5) return 100; return 0;
+            ScriptAsm sa;
+            sa.Emit({ SCMD_LITTOREG, SREG_BX, value });
+            sa.Emit({ SCMD_LITTOREG, SREG_CX, 5 });
+            const int32_t cmp = sa.Emit({ cmp_op, SREG_BX, SREG_CX });
+            sa.Emit({ SCMD_REGTOREG, SREG_BX, SREG_AX });
+            const int32_t jz_end = sa.EmitJump(SCMD_JZ);
+            sa.Emit({ SCMD_LITTOREG, SREG_AX, 100 });
+            sa.SetJump(jz_end, sa.Pos());
+            sa.Emit({ SCMD_RET });
+            sa.Export("fuse$0", 0);
+
+            bool cond = false;
+            switch (cmp_op)
+            {
+            case SCMD_ISEQUAL: cond = value == 5; break;
+            case SCMD_NOTEQUAL: cond = value != 5; break;
+            case SCMD_GREATER: cond = value > 5; break;
+            case SCMD_LESSTHAN: cond = value < 5; break;
+            case SCMD_GTE: cond = value >= 5; break;
+            case SCMD_LTE: cond = value <= 5; break;
+            }
+            SCOPED_TRACE(testing::Message() << "op " << cmp_op << ", value " << value);
+            TestFusion(sa.Script, { cmp }, {});
+            TestRunBothWays(sa.Script, "fuse", cond ? 100 : 0);
+        }
+    }
+}
+
+TEST(CCInstance, Fuse_NotIntoJumpDestination) {
+    // A loop which jumps to the MEMREAD, leaving LOADSPOFFS out:
+    //     int sum = 0;
+    //     MAR = &sum;
+    //     for (n = 5; n != 0; n--) *MAR += 10;
+    //     return sum;
+    {
+        ScriptAsm sa;
+        sa.Emit({ SCMD_LITTOREG, SREG_AX, 0 });
+        sa.Emit({ SCMD_PUSHREG, SREG_AX });
+        sa.Emit({ SCMD_LITTOREG, SREG_DX, 5 });
+        const int32_t load_mar = sa.Emit({ SCMD_LOADSPOFFS, 4 });
+        const int32_t loop_start = sa.Emit({ SCMD_MEMREAD, SREG_AX });
+        sa.Emit({ SCMD_ADD, SREG_AX, 10 });
+        sa.Emit({ SCMD_MEMWRITE, SREG_AX });
+        sa.Emit({ SCMD_SUB, SREG_DX, 1 });
+        sa.Emit({ SCMD_REGTOREG, SREG_DX, SREG_AX });
+        sa.SetJump(sa.EmitJump(SCMD_JNZ), loop_start);
+        const int32_t read = sa.Emit({ SCMD_LOADSPOFFS, 4 });
+        sa.Emit({ SCMD_MEMREAD, SREG_AX });
+        sa.Emit({ SCMD_SUB, SREG_SP, 4 });
+        sa.Emit({ SCMD_RET });
+        sa.Export("fuse$0", 0);
+
+        TestFusion(sa.Script, { read }, { load_mar });
+        TestRunBothWays(sa.Script, "fuse", 50);
+    }
+
+    // A loop which enters the comparison sequence after the comparison,
+    // either at REGTOREG or at JZ:
+    //     n = 0;
+    //     do { n++; } while (n < 4);
+    //     return n;
+    for (int dest_op = 1; dest_op <= 2; ++dest_op)
+    {
+        ScriptAsm sa;
+        sa.Emit({ SCMD_LITTOREG, SREG_CX, 0 });
+        sa.Emit({ SCMD_LITTOREG, SREG_DX, 4 });
+        sa.Emit({ SCMD_LITTOREG, SREG_BX, 1 });
+        sa.Emit({ SCMD_LITTOREG, SREG_AX, 1 });
+        const int32_t jmp_enter = sa.EmitJump(SCMD_JMP);
+        const int32_t loop_start = sa.Emit({ SCMD_ADD, SREG_CX, 1 });
+        sa.Emit({ SCMD_REGTOREG, SREG_CX, SREG_BX });
+        const int32_t cmp = sa.Emit({ SCMD_LESSTHAN, SREG_BX, SREG_DX });
+        const int32_t regtoreg = sa.Emit({ SCMD_REGTOREG, SREG_BX, SREG_AX });
+        const int32_t jz_end = sa.EmitJump(SCMD_JZ);
+        sa.SetJump(jmp_enter, (dest_op == 1) ? regtoreg : jz_end - 1);
+        sa.SetJump(sa.EmitJump(SCMD_JMP), loop_start);
+        sa.SetJump(jz_end, sa.Pos());
+        sa.Emit({ SCMD_REGTOREG, SREG_CX, SREG_AX });
+        sa.Emit({ SCMD_RET });
+        sa.Export("fuse$0", 0);
+
+        SCOPED_TRACE(testing::Message() << "jump to op " << dest_op);
+        TestFusion(sa.Script, {}, { cmp });
+        TestRunBothWays(sa.Script, "fuse", 4);
+    }
+}
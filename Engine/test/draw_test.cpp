@@ -0,0 +1,154 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/draw.h"
+#include "gfx/bitmap.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+uint32_t NextRandom(uint32_t &seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) | (seed << 16);
+}
+
+// Creates a sprite with random pixels, including the mask color
+std::unique_ptr<Bitmap> MakeSprite(int width, int height, int color_depth, uint32_t seed)
+{
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(width, height, color_depth));
+    const uint32_t mask_color = bmp->GetMaskColor();
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const uint32_t c = NextRandom(seed);
+            bmp->PutPixel(x, y, (c % 5 == 0) ? mask_color : c);
+        }
+    }
+    return bmp;
+}
+
+// Makes the jobs which scale and flip the sprites of various formats;
+// some of the jobs already have a result bitmap to reuse, and some have
+// no sprite, and must be skipped
+std::vector<SpriteTransformJob> MakeTestJobs(const std::vector<std::unique_ptr<Bitmap>> &sprites)
+{
+    std::vector<SpriteTransformJob> jobs;
+    uint32_t seed = 23;
+    const GraphicFlip flips[] = { kFlip_None, kFlip_Horizontal, kFlip_Vertical, kFlip_Both };
+    for (size_t i = 0; i < sprites.size(); ++i)
+    {
+        SpriteTransformJob job;
+        Bitmap *sprite = sprites[i].get();
+        job.Sprite = (i % 13 == 6) ? nullptr : sprite;
+        job.HasAlpha = (i % 2) == 0;
+        job.Flip = flips[i % 4];
+        // Scale up and down, and also only flip the sprite
+        if ((i % 5 == 0) && (job.Flip != kFlip_None))
+            job.DstSize = sprite->GetSize();
+        else
+            job.DstSize = Size(1 + NextRandom(seed) % 120, 1 + NextRandom(seed) % 90);
+        if (i % 3 == 0)
+            job.Result.reset(BitmapHelper::CreateBitmap(job.DstSize.Width, job.DstSize.Height,
+                sprite->GetColorDepth()));
+        else if (i % 7 == 1)
+            job.Result.reset(BitmapHelper::CreateBitmap(5, 5, 8));
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+// Runs the transformation jobs using the given number of threads
+std::vector<SpriteTransformJob> RunTestJobs(const std::vector<std::unique_ptr<Bitmap>> &sprites, size_t threads)
+{
+    std::vector<SpriteTransformJob> jobs = MakeTestJobs(sprites);
+    ThreadPool pool;
+    pool.SetThreadCount(threads);
+    run_sprite_transform_jobs(jobs, pool);
+    return jobs;
+}
+
+} // namespace
+
+TEST(Draw, SpriteTransformJobs) {
+    std::vector<std::unique_ptr<Bitmap>> sprites;
+    uint32_t seed = 11;
+    const int color_depths[] = { 8, 16, 32 };
+    for (int i = 0; i < 60; ++i)
+    {
+        const int width = 1 + NextRandom(seed) % 80;
+        const int height = 1 + NextRandom(seed) % 100;
+        sprites.push_back(MakeSprite(width, height, color_depths[i % 3], NextRandom(seed)));
+    }
+
+    const std::vector<SpriteTransformJob> serial = RunTestJobs(sprites, 0);
+    // The results must not depend on the number of threads
+    const size_t thread_counts[] = { 1, 2, 3, 7 };
+    for (size_t threads : thread_counts)
+    {
+        const std::vector<SpriteTransformJob> pooled = RunTestJobs(sprites, threads);
+        ASSERT_EQ(serial.size(), pooled.size());
+        for (size_t i = 0; i < serial.size(); ++i)
+        {
+            const SpriteTransformJob &expect = serial[i];
+            const SpriteTransformJob &job = pooled[i];
+            ASSERT_EQ(job.Done, expect.Done) << "threads: " << threads << ", job: " << i;
+            if (!job.Sprite)
+            {
+                ASSERT_FALSE(job.Done);
+                continue;
+            }
+            ASSERT_TRUE(job.Done);
+            ASSERT_NE(job.Result, nullptr);
+            ASSERT_EQ(job.Result->GetSize(), job.DstSize);
+            ASSERT_EQ(job.Result->GetColorDepth(), job.Sprite->GetColorDepth());
+            for (int y = 0; y < job.Result->GetHeight(); ++y)
+            {
+                ASSERT_EQ(memcmp(expect.Result->GetScanLine(y), job.Result->GetScanLine(y),
+                    job.Result->GetLineLength()), 0)
+                    << "threads: " << threads << ", job: " << i << ", line: " << y;
+            }
+        }
+    }
+
+    // The serial result must match the sprite scaled and flipped pixel by pixel
+    for (const auto &job : serial)
+    {
+        if (!job.Sprite)
+            continue;
+        const Bitmap *src = job.Sprite;
+        const Bitmap *dst = job.Result.get();
+        const bool flip_h = (job.Flip == kFlip_Horizontal) || (job.Flip == kFlip_Both);
+        const bool flip_v = (job.Flip == kFlip_Vertical) || (job.Flip == kFlip_Both);
+        for (int y = 0; y < dst->GetHeight(); ++y)
+        {
+            for (int x = 0; x < dst->GetWidth(); ++x)
+            {
+                // Nearest neighbour scaling, then flip
+                const int dx = flip_h ? (dst->GetWidth() - 1 - x) : x;
+                const int dy = flip_v ? (dst->GetHeight() - 1 - y) : y;
+                const int sx = dx * src->GetWidth() / dst->GetWidth();
+                const int sy = dy * src->GetHeight() / dst->GetHeight();
+                ASSERT_EQ(dst->GetPixel(x, y), src->GetPixel(sx, sy));
+            }
+        }
+    }
+}
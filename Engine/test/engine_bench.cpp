@@ -0,0 +1,394 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Engine micro-benchmarks:
+// * script interpreter: runs the same bytecode as raw bytecode and as
+//   pre-decoded instruction stream (which includes superinstructions).
+//   The bytecode follows the compiler's patterns for local variables,
+//   arithmetics and conditional loops;
+// * script imports: calls an engine API function in a loop, as raw bytecode,
+//   and as pre-decoded code with and without the per-site import cache;
+// * script symbols: registers and resolves imports, the way it's done
+//   when the game's scripts are loaded;
+// * managed objects: creates short-lived dynamic arrays and strings, assigns
+//   and releases them, the way it's done by a script running in a loop;
+// * dictionary: fills the hash and sorted Dictionary with script string keys,
+//   then looks them up and removes them, passing the string's cached hash
+//   the way it's done by the script API.
+//
+//=============================================================================
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include "ac/dynobj/cc_dynamicarray.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/scriptdict.h"
+#include "ac/dynobj/scriptstring.h"
+#include "script/cc_common.h"
+#include "script/cc_instance.h"
+#include "script/cc_internal.h"
+#include "script/cc_script.h"
+#include "script/script_runtime.h"
+#include "script/systemimports.h"
+#include "util/string.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+// Makes a script with a single function "bench_loop", which does:
+//     int sum = 0;
+//     for (int i = 0; i < count; i++)
+//         sum ^= i * 3;
+//     return sum;
+PScript MakeBenchScript(int32_t count)
+{
+    PScript scri(new ccScript("bench"));
+    auto &code = scri->code;
+    auto emit = [&code](std::initializer_list<int32_t> op) { code.insert(code.end(), op); };
+
+    emit({ SCMD_LOOPCHECKOFF });
+    emit({ SCMD_LITTOREG, SREG_AX, 0 });
+    emit({ SCMD_PUSHREG, SREG_AX }); // sum
+    emit({ SCMD_PUSHREG, SREG_AX }); // i
+    const int32_t loop_start = static_cast<int32_t>(code.size());
+    // i < count
+    emit({ SCMD_LOADSPOFFS, 4 });
+    emit({ SCMD_MEMREAD, SREG_AX });
+    emit({ SCMD_PUSHREG, SREG_AX });
+    emit({ SCMD_LITTOREG, SREG_AX, count });
+    emit({ SCMD_POPREG, SREG_BX });
+    emit({ SCMD_LESSTHAN, SREG_BX, SREG_AX });
+    emit({ SCMD_REGTOREG, SREG_BX, SREG_AX });
+    emit({ SCMD_JZ, 0 });
+    const size_t jz_arg = code.size() - 1;
+    // sum ^= i * 3
+    emit({ SCMD_LOADSPOFFS, 4 });
+    emit({ SCMD_MEMREAD, SREG_AX });
+    emit({ SCMD_MUL, SREG_AX, 3 });
+    emit({ SCMD_LOADSPOFFS, 8 });
+    emit({ SCMD_MEMREAD, SREG_BX });
+    emit({ SCMD_XORREG, SREG_BX, SREG_AX });
+    emit({ SCMD_LOADSPOFFS, 8 });
+    emit({ SCMD_MEMWRITE, SREG_BX });
+    // i++
+    emit({ SCMD_LOADSPOFFS, 4 });
+    emit({ SCMD_MEMREAD, SREG_AX });
+    emit({ SCMD_LITTOREG, SREG_BX, 1 });
+    emit({ SCMD_ADDREG, SREG_AX, SREG_BX });
+    emit({ SCMD_LOADSPOFFS, 4 });
+    emit({ SCMD_MEMWRITE, SREG_AX });
+    emit({ SCMD_JMP, 0 });
+    code.back() = loop_start - static_cast<int32_t>(code.size());
+    code[jz_arg] = static_cast<int32_t>(code.size() - (jz_arg + 1));
+    // return sum
+    emit({ SCMD_LOADSPOFFS, 8 });
+    emit({ SCMD_MEMREAD, SREG_AX });
+    emit({ SCMD_SUB, SREG_SP, 8 });
+    emit({ SCMD_RET });
+
+    scri->fixups.clear();
+    scri->fixuptypes.clear();
+    scri->exports.push_back("bench_loop$0");
+    scri->export_addr.push_back(EXPORT_FUNCTION << 24);
+    return scri;
+}
+
+bool RunBench(const PScript &scri, bool predecode, int reps, int &result, double &ms)
+{
+    ccInstance::SetPredecode(predecode);
+    auto inst = ccInstance::CreateFromScript(scri);
+    if (!inst || !inst->ResolveScriptImports() || !inst->ResolveImportFixups())
+        return false;
+
+    const auto t_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i)
+    {
+        if (inst->CallScriptFunction("bench_loop", 0, nullptr) != kInstErr_None)
+            return false;
+    }
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+    result = inst->GetReturnValue();
+    return true;
+}
+
+bool BenchBytecode(int reps)
+{
+    const PScript scri = MakeBenchScript(1000000);
+
+    int res_bytecode = 0, res_predecoded = 0;
+    double ms_bytecode = 0.0, ms_predecoded = 0.0;
+    if (!RunBench(scri, false, reps, res_bytecode, ms_bytecode) ||
+        !RunBench(scri, true, reps, res_predecoded, ms_predecoded))
+    {
+        std::printf("error: %s\n", cc_get_error().ErrorString.GetCStr());
+        return false;
+    }
+    ccInstance::SetPredecode(false);
+
+    std::printf("script bytecode:   %9.1f ms (result: %d)\n", ms_bytecode, res_bytecode);
+    std::printf("script pre-decoded:%9.1f ms (result: %d)\n", ms_predecoded, res_predecoded);
+    if (res_bytecode != res_predecoded)
+    {
+        std::printf("error: results do not match\n");
+        return false;
+    }
+    return true;
+}
+
+RuntimeScriptValue Sc_Bench_Inc(const RuntimeScriptValue *params, int32_t param_count)
+{
+    return RuntimeScriptValue().SetInt32(param_count > 0 ? params[0].IValue + 1 : 0);
+}
+
+// Makes a script with a single function "bench_import", which does:
+//     int n = 0;
+//     for (int i = count; i != 0; i--)
+//         n = Bench_Inc(n);
+//     return n;
+PScript MakeImportBenchScript(int32_t count)
+{
+    PScript scri(new ccScript("bench_import"));
+    auto &code = scri->code;
+    auto emit = [&code](std::initializer_list<int32_t> op) { code.insert(code.end(), op); };
+
+    emit({ SCMD_LOOPCHECKOFF });
+    emit({ SCMD_LITTOREG, SREG_CX, 0 });
+    emit({ SCMD_LITTOREG, SREG_DX, count });
+    const int32_t loop_start = static_cast<int32_t>(code.size());
+    emit({ SCMD_PUSHREAL, SREG_CX });
+    emit({ SCMD_LITTOREG, SREG_AX, 0 });
+    scri->fixups.push_back(static_cast<int32_t>(code.size() - 1));
+    scri->fixuptypes.push_back(FIXUP_IMPORT);
+    emit({ SCMD_NUMFUNCARGS, 1 });
+    emit({ SCMD_CALLEXT, SREG_AX });
+    emit({ SCMD_SUBREALSTACK, 1 });
+    emit({ SCMD_REGTOREG, SREG_AX, SREG_CX });
+    emit({ SCMD_SUB, SREG_DX, 1 });
+    emit({ SCMD_REGTOREG, SREG_DX, SREG_AX });
+    emit({ SCMD_JNZ, 0 });
+    code.back() = loop_start - static_cast<int32_t>(code.size());
+    emit({ SCMD_REGTOREG, SREG_CX, SREG_AX });
+    emit({ SCMD_RET });
+
+    scri->imports.push_back("Bench_Inc");
+    scri->exports.push_back("bench_import$0");
+    scri->export_addr.push_back(EXPORT_FUNCTION << 24);
+    return scri;
+}
+
+bool RunImportBench(const PScript &scri, bool predecode, bool import_cache, int reps, int &result, double &ms)
+{
+    ccInstance::SetPredecode(predecode);
+    ccInstance::SetImportCache(import_cache);
+    auto inst = ccInstance::CreateFromScript(scri);
+    if (!inst || !inst->ResolveScriptImports() || !inst->ResolveImportFixups())
+        return false;
+
+    const auto t_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i)
+    {
+        if (inst->CallScriptFunction("bench_import", 0, nullptr) != kInstErr_None)
+            return false;
+    }
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+    result = inst->GetReturnValue();
+    return true;
+}
+
+bool BenchImports(int reps)
+{
+    // Fill the imports table to a size similar to the engine API
+    for (uint32_t i = 0; i < 3000u; ++i)
+        ccAddExternalStaticFunction(String::FromFormat("Type%u::Function%u^%u", i % 50, i, i % 5), Sc_Bench_Inc);
+    ccAddExternalStaticFunction("Bench_Inc", Sc_Bench_Inc);
+    const PScript scri = MakeImportBenchScript(1000000);
+
+    int res_bytecode = 0, res_nocache = 0, res_cache = 0;
+    double ms_bytecode = 0.0, ms_nocache = 0.0, ms_cache = 0.0;
+    uint32_t hits_before, misses_before, hits, misses;
+    ccInstance::GetImportCacheStats(hits_before, misses_before);
+    const bool ok = RunImportBench(scri, false, true, reps, res_bytecode, ms_bytecode) &&
+        RunImportBench(scri, true, false, reps, res_nocache, ms_nocache) &&
+        RunImportBench(scri, true, true, reps, res_cache, ms_cache);
+    ccInstance::GetImportCacheStats(hits, misses);
+    ccInstance::SetPredecode(false);
+    ccInstance::SetImportCache(true);
+    ccRemoveAllSymbols();
+    if (!ok)
+    {
+        std::printf("error: %s\n", cc_get_error().ErrorString.GetCStr());
+        return false;
+    }
+
+    std::printf("imports bytecode:  %9.1f ms (result: %d)\n", ms_bytecode, res_bytecode);
+    std::printf("imports no cache:  %9.1f ms (result: %d)\n", ms_nocache, res_nocache);
+    std::printf("imports cached:    %9.1f ms (result: %d; %u hits, %u misses)\n", ms_cache, res_cache,
+        hits - hits_before, misses - misses_before);
+    if (res_bytecode != res_nocache || res_bytecode != res_cache)
+    {
+        std::printf("error: results do not match\n");
+        return false;
+    }
+    return true;
+}
+
+bool BenchSymbols(int reps)
+{
+    // Symbol names similar to the engine API and script exports
+    const uint32_t num_symbols = 5000u;
+    std::vector<String> symbols;
+    std::vector<String> imports;
+    for (uint32_t i = 0; i < num_symbols; ++i)
+    {
+        symbols.push_back(String::FromFormat("Type%u::Function%u^%u", i % 50, i, i % 5));
+        // Requests: exact match, base name match and expanded match
+        imports.push_back(symbols.back());
+        imports.push_back(String::FromFormat("Type%u::Function%u^%u", i % 50, i, i % 5 + 1));
+        imports.push_back(String::FromFormat("Type%u::Function%u", i % 50, i));
+    }
+
+    double ms_register = 0.0, ms_resolve = 0.0;
+    uint32_t resolved = 0u;
+    for (int rep = 0; rep < reps; ++rep)
+    {
+        ScriptSymbolsMap symbol_map('^', true);
+        auto t_start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < num_symbols; ++i)
+            symbol_map.Add(symbols[i], i);
+        auto t_end = std::chrono::steady_clock::now();
+        ms_register += std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+        t_start = std::chrono::steady_clock::now();
+        resolved = 0u;
+        for (const auto &import : imports)
+            resolved += (symbol_map.GetIndexOfAny(import) != UINT32_MAX) ? 1 : 0;
+        t_end = std::chrono::steady_clock::now();
+        ms_resolve += std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    }
+
+    std::printf("symbols register:  %9.1f ms (%u symbols)\n", ms_register, num_symbols);
+    std::printf("symbols resolve:   %9.1f ms (%u of %u imports)\n", ms_resolve, resolved, static_cast<uint32_t>(imports.size()));
+    if (resolved != num_symbols * 2)
+    {
+        std::printf("error: unexpected number of resolved imports\n");
+        return false;
+    }
+    return true;
+}
+
+bool BenchManagedObjects(int reps)
+{
+    const uint32_t num_objects = 100000u;
+    double ms_churn = 0.0;
+    uint32_t failed = 0u;
+    for (int rep = 0; rep < reps; ++rep)
+    {
+        auto t_start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < num_objects; ++i)
+        {
+            // Create an object, assign it to a variable (pointer write),
+            // then release when the variable goes out of scope
+            DynObjectRef ref = (i % 2 == 0) ?
+                CCDynamicArray::Create(1 + i % 32, sizeof(int32_t), false) :
+                ScriptString::Create("Lorem ipsum dolor sit amet");
+            const int32_t handle = ccGetObjectHandleFromAddress(ref.Obj, ref.Mgr);
+            failed += (handle != ref.Handle) ? 1 : 0;
+            ccAddObjectReference(handle);
+            ccReleaseObjectReference(handle);
+        }
+        auto t_end = std::chrono::steady_clock::now();
+        ms_churn += std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    }
+    ccUnregisterAllObjects();
+
+    std::printf("managed objects:   %9.1f ms (%u objects)\n", ms_churn, num_objects);
+    if (failed > 0u)
+    {
+        std::printf("error: handle lookup failed for %u objects\n", failed);
+        return false;
+    }
+    return true;
+}
+
+// Fills the dictionary with the given keys, then looks them up, and removes
+// a half of them; returns the number of keys found
+template <typename TDict>
+uint32_t RunDictBench(const std::vector<const char*> &keys, uint32_t num_lookups, int reps, double &ms)
+{
+    const uint32_t num_keys = keys.size();
+    uint32_t found = 0u;
+    for (int rep = 0; rep < reps; ++rep)
+    {
+        auto t_start = std::chrono::steady_clock::now();
+        TDict dic;
+        for (uint32_t i = 0; i < num_keys; ++i)
+            dic.Set(keys[i], ScriptString::GetHeader(keys[i]).Hash, keys[i]);
+        for (uint32_t i = 0; i < num_lookups; ++i)
+        {
+            const char *key = keys[(i * 7919u) % num_keys];
+            const char *value = dic.Get(key, ScriptString::GetHeader(key).Hash);
+            found += (value != nullptr && std::strcmp(key, value) == 0) ? 1 : 0;
+        }
+        for (uint32_t i = 0; i < num_keys; i += 2)
+            dic.Remove(keys[i], ScriptString::GetHeader(keys[i]).Hash);
+        auto t_end = std::chrono::steady_clock::now();
+        ms += std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    }
+    return found;
+}
+
+bool BenchDictionary(int reps)
+{
+    const uint32_t num_keys = 50000u;
+    const uint32_t num_lookups = 1000000u;
+    std::vector<const char*> keys;
+    char buf[32];
+    for (uint32_t i = 0; i < num_keys; ++i)
+    {
+        std::snprintf(buf, sizeof(buf), "Inventory_Item_%u", i);
+        DynObjectRef ref = ScriptString::Create(buf);
+        ccAddObjectReference(ref.Handle);
+        keys.push_back(static_cast<const char*>(ref.Obj));
+    }
+
+    double ms_hash = 0.0, ms_sorted = 0.0;
+    const uint32_t found_hash = RunDictBench<ScriptHashDict>(keys, num_lookups, reps, ms_hash);
+    const uint32_t found_sorted = RunDictBench<ScriptDict>(keys, num_lookups, reps, ms_sorted);
+    ccUnregisterAllObjects();
+
+    std::printf("hash dictionary:   %9.1f ms (%u keys, %u lookups)\n", ms_hash, num_keys, num_lookups);
+    std::printf("sorted dictionary: %9.1f ms (%u keys, %u lookups)\n", ms_sorted, num_keys, num_lookups);
+    if (found_hash != num_lookups * reps || found_sorted != num_lookups * reps)
+    {
+        std::printf("error: found %u and %u of %u keys\n", found_hash, found_sorted, num_lookups * reps);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int reps = (argc > 1) ? std::atoi(argv[1]) : 10;
+    if (!BenchBytecode(reps) || !BenchImports(reps) || !BenchSymbols(reps * 10) || !BenchManagedObjects(reps) ||
+        !BenchDictionary(reps))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
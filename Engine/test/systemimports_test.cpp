@@ -69,3 +69,41 @@ TEST(SystemImports, ScriptSymbolsMap_GetIndexOfAny) {
     ASSERT_EQ(sym.GetIndexOfAny("FunctionWithLongAppendage^123"), 7); // "FunctionWithLongAppendage^123" - exact match
     ASSERT_EQ(sym.GetIndexOfAny("FunctionWithLongAppendage^123456"), UINT32_MAX); // not matching any variant
 }
+
+TEST(SystemImports, ScriptSymbolsMap_Remove) {
+    ScriptSymbolsMap rsym('^', true);
+    rsym.Add("Function", 0);
+    rsym.Add("FunctionLong^1", 1);
+    rsym.Add("FunctionLong^3", 2);
+    rsym.Add("FunctionLong^5", 3);
+
+    rsym.Remove("Function");
+    ASSERT_EQ(rsym.GetIndexOf("Function"), UINT32_MAX);
+    ASSERT_EQ(rsym.GetIndexOfAny("Function^1"), UINT32_MAX);
+    // Request without appendage selects the next match of the base name
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong"), 1);
+    rsym.Remove("FunctionLong^1");
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong"), 2);
+    rsym.Remove("FunctionLong^5");
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong"), 2);
+    rsym.Remove("FunctionLong^3");
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong"), UINT32_MAX);
+    // Re-adding symbols
+    rsym.Add("FunctionLong^5", 4);
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong"), 4);
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong^5"), 4);
+    rsym.Add("FunctionLong^3", 5);
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong"), 5);
+
+    // Many symbols, forcing the table to grow and entries to be shifted on removal
+    for (uint32_t i = 0; i < 1000; ++i)
+        rsym.Add(String::FromFormat("Sym%u^%u", i, i % 7), i);
+    for (uint32_t i = 0; i < 1000; i += 2)
+        rsym.Remove(String::FromFormat("Sym%u^%u", i, i % 7));
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        const String name = String::FromFormat("Sym%u", i);
+        ASSERT_EQ(rsym.GetIndexOfAny(name), (i % 2 == 0) ? UINT32_MAX : i);
+    }
+    ASSERT_EQ(rsym.GetIndexOfAny("FunctionLong^5"), 4);
+}
@@ -0,0 +1,100 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/textureatlas.h"
+
+using namespace AGS::Engine;
+
+TEST(TextureAtlas, ShelfPacker) {
+    ShelfPacker packer(64, 64);
+    Rect a, b, c, d;
+    ASSERT_TRUE(packer.Allocate(20, 10, a));
+    ASSERT_TRUE(packer.Allocate(20, 12, b));
+    ASSERT_EQ(a, RectWH(0, 0, 20, 10));
+    ASSERT_EQ(b, RectWH(20, 0, 20, 12)); // same shelf, aligned to 16
+    // a lower region is put on a new shelf, rather than on a twice higher one
+    ASSERT_TRUE(packer.Allocate(10, 4, c));
+    ASSERT_EQ(c, RectWH(0, 16, 10, 4));
+    // too wide for the existing shelves
+    ASSERT_TRUE(packer.Allocate(30, 14, d));
+    ASSERT_EQ(d, RectWH(0, 24, 30, 14));
+    ASSERT_EQ(packer.GetRegionCount(), 4u);
+    ASSERT_FALSE(packer.Allocate(65, 1, d));
+    ASSERT_FALSE(packer.Allocate(1, 65, d));
+
+    // freed space is reused
+    packer.Free(b);
+    Rect e;
+    ASSERT_TRUE(packer.Allocate(44, 16, e));
+    ASSERT_EQ(e, RectWH(20, 0, 44, 16));
+    packer.Free(a);
+    packer.Free(c);
+    packer.Free(e);
+    packer.Free(RectWH(0, 24, 30, 14));
+    ASSERT_TRUE(packer.IsEmpty());
+    // all the space is available again
+    ASSERT_TRUE(packer.Allocate(64, 64, a));
+    ASSERT_EQ(a, RectWH(0, 0, 64, 64));
+}
+
+TEST(TextureAtlas, ReuseEmptyShelves) {
+    ShelfPacker packer(32, 32);
+    Rect a, b, c;
+    ASSERT_TRUE(packer.Allocate(32, 8, a));
+    ASSERT_TRUE(packer.Allocate(32, 8, b));
+    ASSERT_TRUE(packer.Allocate(32, 16, c));
+    Rect d;
+    ASSERT_FALSE(packer.Allocate(1, 1, d));
+    // two empty shelves are merged, and then split for the lower regions
+    packer.Free(a);
+    packer.Free(b);
+    ASSERT_TRUE(packer.Allocate(32, 4, d));
+    ASSERT_EQ(d, RectWH(0, 0, 32, 4));
+    ASSERT_TRUE(packer.Allocate(32, 6, a));
+    ASSERT_EQ(a, RectWH(0, 8, 32, 6));
+    ASSERT_FALSE(packer.Allocate(1, 1, b));
+}
+
+TEST(TextureAtlas, Pages) {
+    TextureAtlas atlas(64, 64);
+    size_t page;
+    Rect rc;
+    bool new_page;
+    ASSERT_FALSE(atlas.Allocate(65, 10, page, rc, new_page));
+    std::vector<Rect> rects;
+    for (int i = 0; i < 5; ++i)
+    {
+        ASSERT_TRUE(atlas.Allocate(32, 32, page, rc, new_page));
+        ASSERT_EQ(page, static_cast<size_t>(i / 4));
+        ASSERT_EQ(new_page, (i % 4) == 0);
+        rects.push_back(rc);
+    }
+    ASSERT_EQ(atlas.GetPageCount(), 2u);
+    ASSERT_FALSE(atlas.Free(0, rects[0]));
+    ASSERT_TRUE(atlas.Free(1, rects[4]));
+    ASSERT_TRUE(atlas.IsPageEmpty(1));
+    atlas.RemovePage(1);
+    ASSERT_FALSE(atlas.IsPageEmpty(1));
+    // freed space on the first page is used before adding pages
+    ASSERT_TRUE(atlas.Allocate(32, 32, page, rc, new_page));
+    ASSERT_EQ(page, 0u);
+    ASSERT_EQ(rc, rects[0]);
+    ASSERT_FALSE(new_page);
+    // removed page's slot is reused
+    ASSERT_TRUE(atlas.Allocate(32, 32, page, rc, new_page));
+    ASSERT_EQ(page, 1u);
+    ASSERT_TRUE(new_page);
+    ASSERT_EQ(atlas.GetPageCount(), 2u);
+}
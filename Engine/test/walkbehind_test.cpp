@@ -0,0 +1,208 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <memory>
+#include "gtest/gtest.h"
+#include "ac/walkbehind.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+const int MaskWidth = 37;
+const int MaskHeight = 9;
+
+uint32_t NextRandom(uint32_t &seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) | (seed << 16);
+}
+
+// Makes a walk-behind mask, which has runs of random length and area,
+// including single pixels, runs touching the left and right edges,
+// and the invalid area indexes
+std::unique_ptr<Bitmap> MakeMask()
+{
+    std::unique_ptr<Bitmap> mask(BitmapHelper::CreateBitmap(MaskWidth, MaskHeight, 8));
+    uint32_t seed = 7;
+    for (int y = 0; y < MaskHeight; ++y)
+    {
+        for (int x = 0; x < MaskWidth;)
+        {
+            int len = 1 + NextRandom(seed) % 6;
+            const uint32_t r = NextRandom(seed) % 10;
+            int area = (r < 7) ? (1 + NextRandom(seed) % 4) : ((r == 7) ? 0 : 16 + r);
+            if (y == 0)
+                area = 1 + x % 3; // a row of single pixels
+            if (y == 1)
+            {
+                area = 2; // a row of the same area, from edge to edge
+                len = MaskWidth;
+            }
+            for (int i = 0; (i < len) && (x < MaskWidth); ++i, ++x)
+                mask->PutPixel(x, y, area);
+        }
+    }
+    return mask;
+}
+
+std::unique_ptr<Bitmap> MakeImage(int width, int height, int color_depth, uint32_t seed)
+{
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(width, height, color_depth));
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            bmp->PutPixel(x, y, NextRandom(seed) & ((color_depth == 32) ? 0xFFFFFFFF : 0xFFFF));
+    return bmp;
+}
+
+int GetArea(const Bitmap *mask, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= mask->GetWidth() || y >= mask->GetHeight())
+        return 0;
+    const int area = mask->GetPixel(x, y);
+    return (area < MAX_WALK_BEHINDS) ? area : 0;
+}
+
+} // namespace
+
+TEST(WalkBehind, MakeSpans) {
+    const auto mask = MakeMask();
+    WalkBehindSpanIndex index;
+    ASSERT_TRUE(walkbehinds_make_spans(mask.get(), index));
+    ASSERT_EQ(index.Rows.size(), static_cast<size_t>(MaskHeight + 1));
+    ASSERT_EQ(index.Rows.back(), index.Spans.size());
+
+    Rect aabb[MAX_WALK_BEHINDS];
+    for (auto &rc : aabb)
+        rc = Rect(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
+    for (int y = 0; y < MaskHeight; ++y)
+    {
+        // Spans must cover exactly the pixels of the valid areas, in order,
+        // and must not be split
+        ASSERT_LE(index.Rows[y], index.Rows[y + 1]);
+        size_t i = index.Rows[y];
+        for (int x = 0; x < MaskWidth; ++x)
+        {
+            const int area = GetArea(mask.get(), x, y);
+            if (i < index.Rows[y + 1] && index.Spans[i].X2 == x)
+                ++i;
+            if (area == 0)
+            {
+                ASSERT_TRUE(i == index.Rows[y + 1] || index.Spans[i].X1 > x) << "x: " << x << ", y: " << y;
+                continue;
+            }
+            ASSERT_LT(i, index.Rows[y + 1]);
+            const auto &span = index.Spans[i];
+            ASSERT_EQ(span.Area, area) << "x: " << x << ", y: " << y;
+            ASSERT_LE(span.X1, x);
+            ASSERT_GT(span.X2, x);
+            if (x == span.X1)
+                ASSERT_NE(GetArea(mask.get(), x - 1, y), area);
+            if (x == span.X2 - 1)
+                ASSERT_NE(GetArea(mask.get(), x + 1, y), area);
+            aabb[area].Left = std::min(x, aabb[area].Left);
+            aabb[area].Top = std::min(y, aabb[area].Top);
+            aabb[area].Right = std::max(x, aabb[area].Right);
+            aabb[area].Bottom = std::max(y, aabb[area].Bottom);
+        }
+        if (i < index.Rows[y + 1] && index.Spans[i].X2 == MaskWidth)
+            ++i;
+        ASSERT_EQ(i, index.Rows[y + 1]) << "y: " << y;
+    }
+    for (int wb = 0; wb < MAX_WALK_BEHINDS; ++wb)
+        ASSERT_EQ(index.AABB[wb], aabb[wb]) << "area: " << wb;
+
+    // Empty mask
+    std::unique_ptr<Bitmap> empty(BitmapHelper::CreateClearBitmap(MaskWidth, MaskHeight, 8));
+    ASSERT_FALSE(walkbehinds_make_spans(empty.get(), index));
+    ASSERT_EQ(index.Spans.size(), 0u);
+    ASSERT_EQ(index.Rows.size(), static_cast<size_t>(MaskHeight + 1));
+}
+
+TEST(WalkBehind, CopyArea) {
+    const auto mask = MakeMask();
+    WalkBehindSpanIndex index;
+    ASSERT_TRUE(walkbehinds_make_spans(mask.get(), index));
+    const int color_depths[] = { 8, 16, 32 };
+    for (int color_depth : color_depths)
+    {
+        const auto bg = MakeImage(MaskWidth, MaskHeight, color_depth, 3);
+        for (int wb = 1; wb < MAX_WALK_BEHINDS; ++wb)
+        {
+            const Rect pos = index.AABB[wb];
+            if (pos.Right < 0)
+                continue;
+            std::unique_ptr<Bitmap> dst(BitmapHelper::CreateTransparentBitmap(pos.GetWidth(), pos.GetHeight(), color_depth));
+            walkbehinds_copy_area(index, wb, bg.get(), dst.get());
+            for (int y = 0; y < dst->GetHeight(); ++y)
+            {
+                for (int x = 0; x < dst->GetWidth(); ++x)
+                {
+                    const int expect = (GetArea(mask.get(), x + pos.Left, y + pos.Top) == wb) ?
+                        bg->GetPixel(x + pos.Left, y + pos.Top) : dst->GetMaskColor();
+                    ASSERT_EQ(dst->GetPixel(x, y), expect)
+                        << "depth: " << color_depth << ", area: " << wb << ", x: " << x << ", y: " << y;
+                }
+            }
+        }
+    }
+}
+
+TEST(WalkBehind, Cropout) {
+    const auto mask = MakeMask();
+    WalkBehindSpanIndex index;
+    ASSERT_TRUE(walkbehinds_make_spans(mask.get(), index));
+    short baselines[MAX_WALK_BEHINDS] = {};
+    for (int wb = 0; wb < MAX_WALK_BEHINDS; ++wb)
+        baselines[wb] = static_cast<short>(wb * 10);
+
+    // Sprites of various sizes, placed inside the mask and crossing each of
+    // its edges, including the sprites fully outside of the mask
+    struct { int X, Y, Width, Height; } sprites[] = {
+        { 0, 0, MaskWidth, MaskHeight }, { 3, 2, 1, 1 }, { 5, 1, 7, 4 },
+        { -4, -2, 9, 5 }, { MaskWidth - 5, 4, 11, 8 }, { -3, 3, MaskWidth + 6, 2 },
+        { 10, -3, 3, MaskHeight + 6 }, { MaskWidth, 0, 4, 4 }, { -5, 0, 5, 4 },
+        { 0, MaskHeight, 4, 4 }, { 0, -4, 4, 4 } };
+    const int color_depths[] = { 8, 16, 32 };
+    const int sprite_baselines[] = { -1, 0, 15, 25, 100 };
+    for (int color_depth : color_depths)
+    {
+        for (const auto &spr : sprites)
+        {
+            for (int basel : sprite_baselines)
+            {
+                const auto orig = MakeImage(spr.Width, spr.Height, color_depth, 5);
+                std::unique_ptr<Bitmap> sprite(BitmapHelper::CreateBitmapCopy(orig.get()));
+                const bool changed = walkbehinds_cropout(index, baselines, sprite.get(), spr.X, spr.Y, basel);
+                bool expect_changed = false;
+                for (int y = 0; y < spr.Height; ++y)
+                {
+                    for (int x = 0; x < spr.Width; ++x)
+                    {
+                        const int area = GetArea(mask.get(), spr.X + x, spr.Y + y);
+                        const bool hidden = (area > 0) && (baselines[area] > basel);
+                        expect_changed |= hidden;
+                        const int expect = hidden ? sprite->GetMaskColor() : orig->GetPixel(x, y);
+                        ASSERT_EQ(sprite->GetPixel(x, y), expect)
+                            << "depth: " << color_depth << ", sprite at " << spr.X << "," << spr.Y
+                            << ", baseline: " << basel << ", x: " << x << ", y: " << y;
+                    }
+                }
+                ASSERT_EQ(changed, expect_changed);
+            }
+        }
+    }
+}
@@ -21,61 +21,63 @@
 
 
 
-/* Information for stretching line */
-static struct {
+/* Information for stretching line; kept on stack by the stretch blit,
+ * so that separate bitmaps may be stretched on multiple threads at once.
+ */
+typedef struct STRETCH_LINE_INFO {
    int xcstart; /* x counter start */
    int sxinc; /* amount to increment src x every time */
    int xcdec; /* amount to deccrement counter by, increase sptr when this reaches 0 */
    int xcinc; /* amount to increment counter by when it reaches 0 */
    int linesize; /* size of a whole row of pixels */
-} _al_stretch;
+} STRETCH_LINE_INFO;
 
 
 
 /* Stretcher macros */
 #define DECLARE_STRETCHER(type, size, put, get) \
-   int xc = _al_stretch.xcstart; \
-   uintptr_t dend = dptr + _al_stretch.linesize; \
+   int xc = info->xcstart; \
+   uintptr_t dend = dptr + info->linesize; \
    ASSERT(dptr); \
    ASSERT(sptr); \
-   for (; dptr < dend; dptr += size, sptr += _al_stretch.sxinc) { \
+   for (; dptr < dend; dptr += size, sptr += info->sxinc) { \
       put(dptr, get((type*)sptr)); \
       if (xc <= 0) { \
 	 sptr += size; \
-	 xc += _al_stretch.xcinc; \
+	 xc += info->xcinc; \
       } \
       else \
-	 xc -= _al_stretch.xcdec; \
+	 xc -= info->xcdec; \
    }
 
 
 
 #define DECLARE_MASKED_STRETCHER(type, size, put, get, mask) \
-   int xc = _al_stretch.xcstart; \
-   uintptr_t dend = dptr + _al_stretch.linesize; \
+   int xc = info->xcstart; \
+   uintptr_t dend = dptr + info->linesize; \
    ASSERT(dptr); \
    ASSERT(sptr); \
-   for (; dptr < dend; dptr += size, sptr += _al_stretch.sxinc) { \
+   for (; dptr < dend; dptr += size, sptr += info->sxinc) { \
       int color = get((type*)sptr); \
       if (color != mask) \
 	 put(dptr, get((type*)sptr)); \
       if (xc <= 0) { \
 	 sptr += size; \
-	 xc += _al_stretch.xcinc; \
+	 xc += info->xcinc; \
       } \
       else \
-	 xc -= _al_stretch.xcdec; \
+	 xc -= info->xcdec; \
    }
 
 
 
 #ifdef ALLEGRO_COLOR8
-static void stretch_line8(uintptr_t dptr, unsigned char *sptr)
+static void stretch_line8(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_STRETCHER(unsigned char, 1, bmp_write8, *);
 }
 
-static void stretch_masked_line8(uintptr_t dptr, unsigned char *sptr)
+static void stretch_masked_line8(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_MASKED_STRETCHER(unsigned char, 1, bmp_write8, *, 0);
 }
@@ -84,22 +86,22 @@ static void stretch_masked_line8(uintptr_t dptr, unsigned char *sptr)
 
 
 #ifdef ALLEGRO_COLOR16
-static void stretch_line15(uintptr_t dptr, unsigned char* sptr)
+static void stretch_line15(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_STRETCHER(unsigned short, 2, bmp_write15, *);
 }
 
-static void stretch_line16(uintptr_t dptr, unsigned char* sptr)
+static void stretch_line16(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_STRETCHER(unsigned short, 2, bmp_write16, *);
 }
 
-static void stretch_masked_line15(uintptr_t dptr, unsigned char* sptr)
+static void stretch_masked_line15(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_MASKED_STRETCHER(unsigned short, 2, bmp_write15, *, MASK_COLOR_15);
 }
 
-static void stretch_masked_line16(uintptr_t dptr, unsigned char* sptr)
+static void stretch_masked_line16(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_MASKED_STRETCHER(unsigned short, 2, bmp_write16, *, MASK_COLOR_16);
 }
@@ -108,12 +110,12 @@ static void stretch_masked_line16(uintptr_t dptr, unsigned char* sptr)
 
 
 #ifdef ALLEGRO_COLOR24
-static void stretch_line24(uintptr_t dptr, unsigned char* sptr)
+static void stretch_line24(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_STRETCHER(unsigned char, 3, bmp_write24, READ3BYTES);
 }
 
-static void stretch_masked_line24(uintptr_t dptr, unsigned char* sptr)
+static void stretch_masked_line24(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_MASKED_STRETCHER(unsigned char, 3, bmp_write24, READ3BYTES, MASK_COLOR_24);
 }
@@ -122,12 +124,12 @@ static void stretch_masked_line24(uintptr_t dptr, unsigned char* sptr)
 
 
 #ifdef ALLEGRO_COLOR32
-static void stretch_line32(uintptr_t dptr, unsigned char* sptr)
+static void stretch_line32(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_STRETCHER(uint32_t, 4, bmp_write32, *);
 }
 
-static void stretch_masked_line32(uintptr_t dptr, unsigned char* sptr)
+static void stretch_masked_line32(const STRETCH_LINE_INFO *info, uintptr_t dptr, unsigned char *sptr)
 {
    DECLARE_MASKED_STRETCHER(uint32_t, 4, bmp_write32, *, MASK_COLOR_32);
 }
@@ -153,7 +155,8 @@ static void _al_stretch_blit(BITMAP *src, BITMAP *dst,
    int dybeg, dyend;
    int i;
 
-   void (*stretch_line)(uintptr_t, unsigned char*) = 0;
+   STRETCH_LINE_INFO line_info;
+   void (*stretch_line)(const STRETCH_LINE_INFO*, uintptr_t, unsigned char*) = 0;
 
    ASSERT(src);
    ASSERT(dst);
@@ -257,20 +260,20 @@ static void _al_stretch_blit(BITMAP *src, BITMAP *dst,
    sxofs = sx * size;
    dxofs = dx * size;
 
-   _al_stretch.sxinc = sw / dw * size;
-   _al_stretch.xcdec = sw - ((sw/dw)*dw);
-   _al_stretch.xcinc = dw - _al_stretch.xcdec;
-   _al_stretch.linesize = (dxend-dxbeg)*size;
+   line_info.sxinc = sw / dw * size;
+   line_info.xcdec = sw - ((sw/dw)*dw);
+   line_info.xcinc = dw - line_info.xcdec;
+   line_info.linesize = (dxend-dxbeg)*size;
 
    /* get start state (clip) */
-   _al_stretch.xcstart = _al_stretch.xcinc;
-   for (i = 0; i < dxbeg-dx; i++, sxofs += _al_stretch.sxinc) {
-      if (_al_stretch.xcstart <= 0) {
-	 _al_stretch.xcstart += _al_stretch.xcinc;
+   line_info.xcstart = line_info.xcinc;
+   for (i = 0; i < dxbeg-dx; i++, sxofs += line_info.sxinc) {
+      if (line_info.xcstart <= 0) {
+	 line_info.xcstart += line_info.xcinc;
 	 sxofs += size;
       }
       else
-	 _al_stretch.xcstart -= _al_stretch.xcdec;
+	 line_info.xcstart -= line_info.xcdec;
    }
 
    dxofs += i * size;
@@ -290,7 +293,7 @@ static void _al_stretch_blit(BITMAP *src, BITMAP *dst,
    bmp_select(dst);
 
    for (; y < dyend; y++, sy += syinc) {
-      (*stretch_line)(bmp_write_line(dst, y) + dxofs, src->line[sy] + sxofs);
+      (*stretch_line)(&line_info, bmp_write_line(dst, y) + dxofs, src->line[sy] + sxofs);
       if (yc <= 0) {
 	 sy++;
 	 yc += ycinc;